@@ -209,6 +209,9 @@ void Copter::fast_loop()
     // send outputs to the motors library immediately
     motors_output();
 
+    // move the gyro harmonic notch to follow the motors
+    update_dynamic_notch();
+
     // run EKF state estimator (expensive)
     // --------------------
     read_AHRS();
@@ -336,6 +339,10 @@ void Copter::ten_hz_logging_loop()
         Log_Write_Proximity();
         Log_Write_Beacon();
     }
+    if (should_log(MASK_LOG_PM)) {
+        // sample to output latency traces
+        AP::LatencyTrace::write_log();
+    }
 #if FRAME_CONFIG == HELI_FRAME
     Log_Write_Heli();
 #endif
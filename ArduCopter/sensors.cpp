@@ -97,6 +97,47 @@ void Copter::rpm_update(void)
     }
 }
 
+// update the harmonic notch base frequency from throttle or RPM
+void Copter::update_dynamic_notch()
+{
+    const HarmonicNotchFilterParams &notch = ins.get_harmonic_notch_params();
+    if (!notch.enabled()) {
+        return;
+    }
+    const float ref_freq = notch.center_freq_hz();
+
+    switch (notch.tracking_mode()) {
+    case HarmonicNotchFilterParams::Tracking_Throttle: {
+        // motor speed rises roughly with the square root of throttle
+        float ref = notch.reference();
+        if (!is_positive(ref)) {
+            ref = motors->get_throttle_hover();
+        }
+        if (is_positive(ref)) {
+            const float throttle = MAX(0.0f, motors->get_throttle());
+            ins.update_harmonic_notch_freq_hz(MAX(ref_freq, ref_freq * safe_sqrt(throttle / ref)));
+        }
+        break;
+    }
+
+    case HarmonicNotchFilterParams::Tracking_RPM: {
+        const float rpm = rpm_sensor.get_rpm(0);
+        if (rpm > 0) {
+            const float scale = is_positive(notch.reference()) ? notch.reference() : 1.0f;
+            ins.update_harmonic_notch_freq_hz(MAX(ref_freq, rpm * scale * (1.0f / 60.0f)));
+        } else {
+            ins.update_harmonic_notch_freq_hz(ref_freq);
+        }
+        break;
+    }
+
+    case HarmonicNotchFilterParams::Tracking_Fixed:
+    default:
+        ins.update_harmonic_notch_freq_hz(ref_freq);
+        break;
+    }
+}
+
 // initialise compass
 void Copter::init_compass()
 {
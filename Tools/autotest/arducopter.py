@@ -349,6 +349,64 @@ def fly_battery_failsafe(mavproxy, mav, timeout=30):
     return success
 
 
+# fly_dynamic_notches - hover with motor vibration on the gyros and check the harmonic notch reduces it
+def fly_dynamic_notches(mavproxy, mav, holdtime=10, vibe_freq=250):
+    """Hover with and without the harmonic notch filter."""
+    mavproxy.send('mode ALT_HOLD\n')
+    wait_mode(mav, 'ALT_HOLD')
+    set_rc(mavproxy, mav, 3, 1500)
+
+    set_parameter(mavproxy, 'SIM_VIB_AMP', 20)
+    set_parameter(mavproxy, 'SIM_VIB_FREQ', vibe_freq)
+
+    def sitl_throttle():
+        """Return the throttle SITL scales the vibration by, averaged over 2 seconds."""
+        # SITL sums (pwm-1000)/4000 over the four motor outputs
+        samples = []
+        tstart = get_sim_time(mav)
+        while get_sim_time(mav) < tstart + 2:
+            m = mav.recv_match(type='SERVO_OUTPUT_RAW', blocking=True)
+            pwm = [m.servo1_raw, m.servo2_raw, m.servo3_raw, m.servo4_raw]
+            samples.append(sum([(min(max(x, 1000), 2000) - 1000) / 4000.0 for x in pwm]))
+        return sum(samples) / len(samples)
+
+    def gyro_noise():
+        """Return the RMS deviation of the raw x gyro over holdtime."""
+        samples = []
+        tstart = get_sim_time(mav)
+        while get_sim_time(mav) < tstart + holdtime:
+            m = mav.recv_match(type='RAW_IMU', blocking=True)
+            samples.append(m.xgyro)
+        mean = sum(samples) / float(len(samples))
+        return math.sqrt(sum([(x - mean) ** 2 for x in samples]) / len(samples))
+
+    set_parameter(mavproxy, 'INS_HNTCH_ENABLE', 0)
+    noise_off = gyro_noise()
+    progress("Gyro noise without notch: %.1f" % noise_off)
+
+    # the SITL vibration frequency follows the square root of its motor output throttle
+    hover_freq = vibe_freq * math.sqrt(sitl_throttle())
+    progress("Expected vibration frequency in hover: %.1f Hz" % hover_freq)
+    set_parameter(mavproxy, 'INS_HNTCH_ENABLE', 1)
+    mavproxy.send('param fetch\n')
+    mavproxy.expect('Received [0-9]+ parameters')
+    set_parameter(mavproxy, 'INS_HNTCH_FREQ', int(round(hover_freq)))
+    set_parameter(mavproxy, 'INS_HNTCH_MODE', 1)
+    set_parameter(mavproxy, 'INS_HNTCH_REF', 0)
+    noise_on = gyro_noise()
+    progress("Gyro noise with notch: %.1f" % noise_on)
+
+    set_parameter(mavproxy, 'INS_HNTCH_ENABLE', 0)
+    set_parameter(mavproxy, 'SIM_VIB_FREQ', 0)
+    set_parameter(mavproxy, 'SIM_VIB_AMP', 0)
+
+    if noise_on > noise_off * 0.5:
+        progress("Harmonic notch did not reduce gyro noise")
+        return False
+    progress("Harmonic notch reduced gyro noise from %.1f to %.1f" % (noise_off, noise_on))
+    return True
+
+
 # fly_stability_patch - fly south, then hold loiter within 5m position and altitude and reduce 1 motor to 60% efficiency
 def fly_stability_patch(mavproxy, mav, holdtime=30, maxaltchange=5, maxdistchange=10):
     """Hold loiter position."""
@@ -1122,6 +1180,15 @@ def fly_ArduCopter(binary, viewerip=None, use_map=False, valgrind=False, gdb=Fal
             progress(failed_test_msg)
             failed = True
 
+        # Dynamic notches
+        progress("#")
+        progress("########## Test Dynamic Notches ##########")
+        progress("#")
+        if not fly_dynamic_notches(mavproxy, mav):
+            failed_test_msg = "fly_dynamic_notches failed"
+            progress(failed_test_msg)
+            failed = True
+
         # Stability patch
         progress("#")
         progress("########## Test Stability Patch ##########")
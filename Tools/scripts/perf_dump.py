@@ -0,0 +1,110 @@
+#!/usr/bin/env python
+'''
+print the perf counters written by a Linux board on exit with
+--perf-dump, see libraries/AP_HAL_Linux/Perf.cpp for the format
+'''
+
+import sys
+import struct
+import optparse
+
+parser = optparse.OptionParser("perf_dump.py [options] FILE")
+parser.add_option("--sort", default=None, help='sort counters by count, avg, p99 or max')
+parser.add_option("--histogram", default=None, help='print the histogram of the named counter')
+
+opts, args = parser.parse_args()
+
+if len(args) == 0:
+    print("Please supply a perf dump file")
+    sys.exit(1)
+
+# the dump is little-endian whatever board wrote it
+HEADER = '<4sHHBBBBQ'
+PC_COUNT = 0
+PC_ELAPSED = 1
+
+data = open(args[0], 'rb').read()
+
+(magic, version, n_counters, min_shift, sub_bits, octaves, reserved,
+ timestamp) = struct.unpack_from(HEADER, data, 0)
+if magic != b'APPF' or version != 1:
+    print("Not a perf dump file")
+    sys.exit(1)
+
+sub_buckets = 1 << sub_bits
+n_buckets = octaves * sub_buckets + 2
+COUNTER = '<32sB7xQQQQdd%uI' % n_buckets
+
+def bucket_max(b):
+    '''longest elapsed time in nanoseconds that goes in bucket b'''
+    if b == 0:
+        return (1 << min_shift) - 1
+    if b >= n_buckets - 1:
+        return None
+    octave = (b - 1) // sub_buckets
+    sub = (b - 1) % sub_buckets
+    return ((sub_buckets + sub + 1) << (min_shift + octave - sub_bits)) - 1
+
+def percentile(c, p):
+    if c['count'] == 0:
+        return 0
+    rank = max(int(-(-p * c['count'] // 1)), 1)
+    n = 0
+    for b in range(n_buckets):
+        n += c['histogram'][b]
+        if n >= rank:
+            m = bucket_max(b)
+            if m is None:
+                return c['max']
+            return min(m, c['max'])
+    return c['max']
+
+counters = []
+ofs = struct.calcsize(HEADER)
+for i in range(n_counters):
+    v = struct.unpack_from(COUNTER, data, ofs)
+    ofs += struct.calcsize(COUNTER)
+    counters.append({
+        'name': v[0].rstrip(b'\0').decode('ascii', 'replace'),
+        'type': v[1],
+        'count': v[2],
+        'total': v[3],
+        'min': v[4],
+        'max': v[5],
+        'avg': v[6],
+        'stddev': v[7],
+        'histogram': v[8:],
+    })
+
+for c in counters:
+    c['p50'] = percentile(c, 0.5)
+    c['p90'] = percentile(c, 0.9)
+    c['p99'] = percentile(c, 0.99)
+
+if opts.sort is not None:
+    counters.sort(key=lambda c: c[opts.sort], reverse=True)
+
+if opts.histogram is not None:
+    for c in counters:
+        if c['name'] != opts.histogram:
+            continue
+        for b in range(n_buckets):
+            if c['histogram'][b] == 0:
+                continue
+            m = bucket_max(b)
+            limit = "inf" if m is None else "%.3f" % (m / 1000.0)
+            print("<= %10s us %10u" % (limit, c['histogram'][b]))
+        sys.exit(0)
+    print("No counter named %s" % opts.histogram)
+    sys.exit(1)
+
+print("%-30s %10s %10s %10s %10s %10s %10s %10s" %
+      ("name", "count", "min", "avg", "p50", "p90", "p99", "max"))
+for c in counters:
+    if c['type'] != PC_ELAPSED or c['count'] == 0:
+        print("%-30s %10u" % (c['name'], c['count']))
+        continue
+    print("%-30s %10u %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f" %
+          (c['name'], c['count'], c['min'] / 1000.0, c['avg'] / 1000.0,
+           c['p50'] / 1000.0, c['p90'] / 1000.0, c['p99'] / 1000.0,
+           c['max'] / 1000.0))
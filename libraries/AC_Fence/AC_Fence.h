@@ -138,6 +138,9 @@ private:
     /// load polygon points stored in eeprom into boundary array and perform validation.  returns true if load successfully completed
     bool load_polygon_from_eeprom(bool force_reload = false);
 
+    /// returns true if location (in cm from the ekf origin) is outside the polygon fence
+    bool polygon_breached(const Vector2f& location) const;
+
     // pointers to other objects we depend upon
     const AP_AHRS_NavEKF& _ahrs;
 
@@ -178,4 +181,5 @@ private:
     bool            _boundary_create_attempted = false; // true if we have attempted to create the boundary array
     bool            _boundary_loaded = false;       // true if boundary array has been loaded from eeprom
     bool            _boundary_valid = false;        // true if boundary forms a closed polygon
+    Polygon_index<float> _boundary_index;          // slab index of the boundary (excluding the return point) for fast breach checks
 };
@@ -0,0 +1,97 @@
+#include "AC_SplineTable.h"
+
+/// set_hermite_solution - set the spline segment and build its arc length table
+void AC_SplineTable::set_hermite_solution(const Vector3f& origin, const Vector3f& dest, const Vector3f& origin_vel, const Vector3f& dest_vel)
+{
+    _hermite_solution[0] = origin;
+    _hermite_solution[1] = origin_vel;
+    _hermite_solution[2] = -origin*3.0f -origin_vel*2.0f + dest*3.0f - dest_vel;
+    _hermite_solution[3] = origin*2.0f + origin_vel -dest*2.0f + dest_vel;
+
+    // integrate the curve speed over each interval with two point Gauss-Legendre quadrature
+    const float dt = 1.0f / AC_SPLINE_TABLE_SIZE;
+    const float gauss_ofs = 0.5f * dt * (1.0f - 1.0f / sqrtf(3.0f));
+    Vector3f pos, vel;
+    _arc_length[0] = 0.0f;
+    for (uint8_t i = 0; i < AC_SPLINE_TABLE_SIZE; i++) {
+        const float t = i * dt;
+        calc_pos_vel(t + gauss_ofs, pos, vel);
+        float len = vel.length();
+        calc_pos_vel(t + dt - gauss_ofs, pos, vel);
+        len += vel.length();
+        _arc_length[i+1] = _arc_length[i] + 0.5f * dt * len;
+    }
+    for (uint8_t i = 0; i <= AC_SPLINE_TABLE_SIZE; i++) {
+        calc_pos_vel(i * dt, pos, vel);
+        _speed[i] = vel.length();
+    }
+}
+
+/// calc_pos_vel - calculate position and velocity for the given spline time
+void AC_SplineTable::calc_pos_vel(float spline_time, Vector3f& position, Vector3f& velocity) const
+{
+    float spline_time_sqrd = spline_time * spline_time;
+    float spline_time_cubed = spline_time_sqrd * spline_time;
+
+    position = _hermite_solution[0] + \
+               _hermite_solution[1] * spline_time + \
+               _hermite_solution[2] * spline_time_sqrd + \
+               _hermite_solution[3] * spline_time_cubed;
+
+    velocity = _hermite_solution[1] + \
+               _hermite_solution[2] * 2.0f * spline_time + \
+               _hermite_solution[3] * 3.0f * spline_time_sqrd;
+}
+
+/// interval_arc_length - distance from the start of table interval i to fraction u through it
+float AC_SplineTable::interval_arc_length(uint8_t i, float u) const
+{
+    // cubic hermite through the interval's end lengths with the curve speed as slope
+    const float dt = 1.0f / AC_SPLINE_TABLE_SIZE;
+    const float len = _arc_length[i+1] - _arc_length[i];
+    const float m0 = _speed[i] * dt;
+    const float m1 = _speed[i+1] * dt;
+    const float u2 = u * u;
+    return m0 * u + (3.0f * len - 2.0f * m0 - m1) * u2 + (m0 + m1 - 2.0f * len) * u2 * u;
+}
+
+/// arc_length - distance in cm along the segment from the origin to the given spline time
+float AC_SplineTable::arc_length(float spline_time) const
+{
+    float index = constrain_float(spline_time, 0.0f, 1.0f) * AC_SPLINE_TABLE_SIZE;
+    uint8_t i = MIN((uint8_t)index, AC_SPLINE_TABLE_SIZE-1);
+    return _arc_length[i] + interval_arc_length(i, index - i);
+}
+
+/// spline_time - spline time at the given distance in cm along the segment
+float AC_SplineTable::spline_time(float arc_length, float hint_time) const
+{
+    if (arc_length <= 0.0f) {
+        return 0.0f;
+    }
+
+    // search forward from the hint for the table interval holding the distance
+    uint8_t i = MIN((uint8_t)(constrain_float(hint_time, 0.0f, 1.0f) * AC_SPLINE_TABLE_SIZE), AC_SPLINE_TABLE_SIZE-1);
+    while (i > 0 && _arc_length[i] > arc_length) {
+        i--;
+    }
+    while (i < AC_SPLINE_TABLE_SIZE-1 && _arc_length[i+1] < arc_length) {
+        i++;
+    }
+
+    const float len = _arc_length[i+1] - _arc_length[i];
+    if (!is_positive(len)) {
+        return (float)(i+1) / AC_SPLINE_TABLE_SIZE;
+    }
+
+    // linear estimate within the interval, extrapolating past the end of the segment
+    float u = (arc_length - _arc_length[i]) / len;
+    if (u < 1.0f) {
+        // refine with a newton step on the interval's cubic
+        const float speed = (_speed[i] + (_speed[i+1] - _speed[i]) * u) / AC_SPLINE_TABLE_SIZE;
+        if (is_positive(speed)) {
+            u = constrain_float(u - (interval_arc_length(i, u) - (arc_length - _arc_length[i])) / speed, 0.0f, 1.0f);
+        }
+    }
+    return (i + u) / AC_SPLINE_TABLE_SIZE;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+#define AC_SPLINE_TABLE_SIZE    64      // number of arc length samples along a spline segment
+
+/*
+  Hermite spline segment with a table of arc length against spline time.
+  The table is built once when the segment is set, so that the target can
+  be moved a given distance along the curve each step with a table lookup
+  instead of scaling the spline time by the local curve velocity.
+  Between table entries the arc length is interpolated with a cubic using
+  the curve speed at both ends, which keeps the speed along the curve
+  within a small fraction of a percent of the requested speed
+ */
+class AC_SplineTable {
+public:
+    /// set_hermite_solution - set the spline segment and build its arc length table
+    void set_hermite_solution(const Vector3f& origin, const Vector3f& dest, const Vector3f& origin_vel, const Vector3f& dest_vel);
+
+    /// calc_pos_vel - calculate position and velocity for the given spline time
+    void calc_pos_vel(float spline_time, Vector3f& position, Vector3f& velocity) const;
+
+    /// length - total length of the segment in cm
+    float length() const { return _arc_length[AC_SPLINE_TABLE_SIZE]; }
+
+    /// arc_length - distance in cm along the segment from the origin to the given spline time
+    float arc_length(float spline_time) const;
+
+    /// spline_time - spline time at the given distance in cm along the segment
+    ///     hint_time should be a spline time at or before the result and keeps the search short while the target moves forward
+    ///     distances beyond the end of the segment return spline times above 1
+    float spline_time(float arc_length, float hint_time) const;
+
+private:
+    /// interval_arc_length - distance from the start of table interval i to fraction u through it
+    float interval_arc_length(uint8_t i, float u) const;
+
+    Vector3f    _hermite_solution[4];                   // polynomial coefficients of the segment
+    float       _arc_length[AC_SPLINE_TABLE_SIZE+1];    // distance in cm from the origin at evenly spaced spline times
+    float       _speed[AC_SPLINE_TABLE_SIZE+1];         // length of the curve velocity at the same spline times
+};
@@ -128,7 +128,6 @@ AC_WPNav::AC_WPNav(const AP_InertialNav& inav, const AP_AHRS_View& ahrs, AC_PosC
     _track_leash_length(0.0f),
     _slow_down_dist(0.0f),
     _spline_time(0.0f),
-    _spline_time_scale(0.0f),
     _spline_vel_scaler(0.0f),
     _yaw(0.0f)
 {
@@ -1074,15 +1073,12 @@ bool AC_WPNav::update_spline()
     return ret;
 }
 
-/// update_spline_solution - recalculates hermite_spline_solution grid
+/// update_spline_solution - recalculates hermite spline solution and its arc length table
 ///		relies on _spline_origin_vel, _spline_destination_vel and _origin and _destination
 void AC_WPNav::update_spline_solution(const Vector3f& origin, const Vector3f& dest, const Vector3f& origin_vel, const Vector3f& dest_vel)
 {
-    _hermite_spline_solution[0] = origin;
-    _hermite_spline_solution[1] = origin_vel;
-    _hermite_spline_solution[2] = -origin*3.0f -origin_vel*2.0f + dest*3.0f - dest_vel;
-    _hermite_spline_solution[3] = origin*2.0f + origin_vel -dest*2.0f + dest_vel;
- }
+    _spline_table.set_hermite_solution(origin, dest, origin_vel, dest_vel);
+}
 
 /// advance_spline_target_along_track - move target location along track from origin to destination
 bool AC_WPNav::advance_spline_target_along_track(float dt)
@@ -1156,9 +1152,6 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
         // constrain target velocity
         _spline_vel_scaler = constrain_float(_spline_vel_scaler, 0.0f, vel_limit);
 
-        // scale the spline_time by the velocity we've calculated vs the velocity that came out of the spline calculator
-        _spline_time_scale = _spline_vel_scaler / target_vel_length;
-
         // update target position
         target_pos.z += terr_offset;
         _pos_control.set_pos_target(target_pos);
@@ -1180,8 +1173,11 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
             }
         }
 
-        // advance spline time to next step
-        _spline_time += _spline_time_scale*dt;
+        // advance spline time to next step, moving the target _spline_vel_scaler*dt along the curve
+        // using the arc length table so the target speed does not vary with the curve's parameterisation
+        if (is_positive(dt)) {
+            _spline_time = _spline_table.spline_time(_spline_table.arc_length(_spline_time) + _spline_vel_scaler*dt, _spline_time);
+        }
 
         // we will reach the next waypoint in the next step so set reached_destination flag
         // To-Do: is this one step too early?
@@ -1196,17 +1192,7 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
 /// 	relies on update_spline_solution being called when the segment's origin and destination were set
 void AC_WPNav::calc_spline_pos_vel(float spline_time, Vector3f& position, Vector3f& velocity)
 {
-    float spline_time_sqrd = spline_time * spline_time;
-    float spline_time_cubed = spline_time_sqrd * spline_time;
-
-    position = _hermite_spline_solution[0] + \
-               _hermite_spline_solution[1] * spline_time + \
-               _hermite_spline_solution[2] * spline_time_sqrd + \
-               _hermite_spline_solution[3] * spline_time_cubed;
-
-    velocity = _hermite_spline_solution[1] + \
-               _hermite_spline_solution[2] * 2.0f * spline_time + \
-               _hermite_spline_solution[3] * 3.0f * spline_time_sqrd;
+    _spline_table.calc_pos_vel(spline_time, position, velocity);
 }
 
 // get terrain's altitude (in cm above the ekf origin) at the current position (+ve means terrain below vehicle is above ekf origin's altitude)
@@ -0,0 +1,72 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_WPNav/AC_SplineTable.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+// a spline segment like AC_WPNav builds for a fast waypoint with a sharp turn
+static const Vector3f origin(0.0f, 0.0f, 1000.0f);
+static const Vector3f dest(5000.0f, 2000.0f, 1500.0f);
+static const Vector3f origin_vel(5000.0f, 0.0f, 0.0f);
+static const Vector3f dest_vel(0.0f, 6000.0f, 0.0f);
+
+// steps taken along the segment per benchmark iteration, about 10s of flight at 400Hz
+#define SPLINE_STEPS 4000
+
+static void BM_SplineTableBuild(benchmark::State& state)
+{
+    AC_SplineTable table;
+
+    while (state.KeepRunning()) {
+        table.set_hermite_solution(origin, dest, origin_vel, dest_vel);
+        gbenchmark_escape(&table);
+    }
+}
+
+/*
+  advance the target along the segment by scaling the spline time by the
+  local curve velocity, as AC_WPNav did before the arc length table
+ */
+static void BM_SplineAdvanceScaled(benchmark::State& state)
+{
+    AC_SplineTable table;
+    table.set_hermite_solution(origin, dest, origin_vel, dest_vel);
+    const float step = table.length() / SPLINE_STEPS;
+
+    while (state.KeepRunning()) {
+        float spline_time = 0.0f;
+        Vector3f pos, vel;
+        for (uint16_t i = 0; i < SPLINE_STEPS && spline_time < 1.0f; i++) {
+            table.calc_pos_vel(spline_time, pos, vel);
+            spline_time += step / vel.length();
+        }
+        gbenchmark_escape(&pos);
+    }
+}
+
+/*
+  advance the target along the segment a fixed distance per step using
+  the arc length table
+ */
+static void BM_SplineAdvanceTable(benchmark::State& state)
+{
+    AC_SplineTable table;
+    table.set_hermite_solution(origin, dest, origin_vel, dest_vel);
+    const float step = table.length() / SPLINE_STEPS;
+
+    while (state.KeepRunning()) {
+        float spline_time = 0.0f;
+        Vector3f pos, vel;
+        for (uint16_t i = 0; i < SPLINE_STEPS && spline_time < 1.0f; i++) {
+            table.calc_pos_vel(spline_time, pos, vel);
+            spline_time = table.spline_time(table.arc_length(spline_time) + step, spline_time);
+        }
+        gbenchmark_escape(&pos);
+    }
+}
+
+BENCHMARK(BM_SplineTableBuild);
+BENCHMARK(BM_SplineAdvanceScaled);
+BENCHMARK(BM_SplineAdvanceTable);
+
+BENCHMARK_MAIN()
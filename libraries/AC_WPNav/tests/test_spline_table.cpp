@@ -0,0 +1,72 @@
+#include <AP_gtest.h>
+
+#include <AC_WPNav/AC_SplineTable.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+// a spline segment like AC_WPNav builds for a fast waypoint with a sharp turn
+static const Vector3f origin(0.0f, 0.0f, 1000.0f);
+static const Vector3f dest(5000.0f, 2000.0f, 1500.0f);
+static const Vector3f origin_vel(5000.0f, 0.0f, 0.0f);
+static const Vector3f dest_vel(0.0f, 6000.0f, 0.0f);
+
+// arc length from the origin to spline time t by Simpson's rule on the curve speed
+static double integrate_arc_length(const AC_SplineTable &table, double t)
+{
+    const int steps = 10000;
+    const double h = t / steps;
+    Vector3f pos, vel;
+    double sum = 0.0;
+    for (int i = 0; i <= steps; i++) {
+        table.calc_pos_vel(i * h, pos, vel);
+        const double weight = (i == 0 || i == steps) ? 1.0 : ((i % 2) ? 4.0 : 2.0);
+        sum += weight * vel.length();
+    }
+    return sum * h / 3.0;
+}
+
+TEST(AC_SplineTable, straight_segment_length)
+{
+    AC_SplineTable table;
+    const Vector3f a(100.0f, -200.0f, 500.0f);
+    const Vector3f b(3100.0f, 3800.0f, 500.0f);
+    const Vector3f vel = (b - a);
+    table.set_hermite_solution(a, b, vel, vel);
+
+    EXPECT_NEAR((b - a).length(), table.length(), 0.01f);
+    EXPECT_NEAR(0.5f * (b - a).length(), table.arc_length(0.5f), 0.01f);
+}
+
+TEST(AC_SplineTable, arc_length_matches_integration)
+{
+    AC_SplineTable table;
+    table.set_hermite_solution(origin, dest, origin_vel, dest_vel);
+
+    const double length = integrate_arc_length(table, 1.0);
+    EXPECT_NEAR(length, table.length(), length * 1.0e-5);
+
+    // within table intervals as well as on their edges
+    for (uint16_t i = 0; i <= 1000; i++) {
+        const float t = i / 1000.0f;
+        EXPECT_NEAR(integrate_arc_length(table, t), table.arc_length(t), length * 1.0e-5) << "t=" << t;
+    }
+}
+
+TEST(AC_SplineTable, spline_time_inverts_arc_length)
+{
+    AC_SplineTable table;
+    table.set_hermite_solution(origin, dest, origin_vel, dest_vel);
+
+    float hint = 0.0f;
+    for (uint16_t i = 0; i <= 1000; i++) {
+        const float t = i / 1000.0f;
+        const float t2 = table.spline_time(table.arc_length(t), hint);
+        EXPECT_NEAR(t, t2, 1.0e-4f) << "t=" << t;
+        hint = t2;
+    }
+
+    EXPECT_FLOAT_EQ(0.0f, table.spline_time(-1.0f, 0.5f));
+    EXPECT_GT(table.spline_time(table.length() + 100.0f, 0.9f), 1.0f);
+}
+
+AP_GTEST_MAIN()
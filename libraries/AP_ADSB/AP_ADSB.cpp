@@ -30,7 +30,11 @@
 
 #define VEHICLE_TIMEOUT_MS              5000   // if no updates in this time, drop it from the list
 #define ADSB_VEHICLE_LIST_SIZE_DEFAULT  25
-#define ADSB_VEHICLE_LIST_SIZE_MAX      100
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    #define ADSB_VEHICLE_LIST_SIZE_MAX      500
+#else
+    #define ADSB_VEHICLE_LIST_SIZE_MAX      100
+#endif
 #define ADSB_CHAN_TIMEOUT_MS            15000
 
 #if APM_BUILD_TYPE(APM_BUILD_ArduPlane)
@@ -54,8 +58,8 @@ const AP_Param::GroupInfo AP_ADSB::var_info[] = {
 
     // @Param: LIST_MAX
     // @DisplayName: ADSB vehicle list size
-    // @Description: ADSB list size of nearest vehicles. Longer lists take longer to refresh with lower SRx_ADSB values.
-    // @Range: 1 100
+    // @Description: ADSB list size of nearest vehicles. Longer lists take longer to refresh with lower SRx_ADSB values. The maximum is 100 except on Linux boards, where it is 500.
+    // @Range: 1 500
     // @User: Advanced
     AP_GROUPINFO("LIST_MAX",   2, AP_ADSB, in_state.list_size_param, ADSB_VEHICLE_LIST_SIZE_DEFAULT),
 
@@ -129,7 +133,19 @@ void AP_ADSB::init(void)
         in_state.list_size = in_state.list_size_param;
         in_state.vehicle_list = new adsb_vehicle_t[in_state.list_size];
 
-        if (in_state.vehicle_list == nullptr) {
+        // keep the hash index at most half full
+        uint16_t index_size = 4;
+        while (index_size < 2 * in_state.list_size) {
+            index_size *= 2;
+        }
+        in_state.icao_index = new uint16_t[index_size];
+        if (in_state.icao_index != nullptr) {
+            memset(in_state.icao_index, 0, index_size * sizeof(uint16_t));
+            in_state.icao_index_mask = index_size - 1;
+        }
+
+        if (in_state.vehicle_list == nullptr || in_state.icao_index == nullptr) {
+            deinit();
             // dynamic RAM allocation of _vehicle_list[] failed, disable gracefully
             hal.console->printf("Unable to initialize ADS-B vehicle list\n");
             _enabled.set_and_notify(0);
@@ -153,6 +169,10 @@ void AP_ADSB::deinit(void)
         delete [] in_state.vehicle_list;
         in_state.vehicle_list = nullptr;
     }
+    if (in_state.icao_index != nullptr) {
+        delete [] in_state.icao_index;
+        in_state.icao_index = nullptr;
+    }
 }
 
 /*
@@ -254,19 +274,26 @@ void AP_ADSB::update(void)
  */
 void AP_ADSB::determine_furthest_aircraft(void)
 {
-    float max_distance = 0;
+    float max_distance_sq = 0;
     uint16_t max_distance_index = 0;
 
+    // measure from where we are now, with a single longitude scale
+    // for the whole list so that there is no trig per vehicle
+    const float lng_scale = longitude_scale(_my_loc);
+
     for (uint16_t index = 0; index < in_state.vehicle_count; index++) {
-        float distance = _my_loc.get_distance(get_location(in_state.vehicle_list[index]));
-        if (max_distance < distance || index == 0) {
-            max_distance = distance;
+        const adsb_vehicle_t &vehicle = in_state.vehicle_list[index];
+        const float dlat = (float)(vehicle.info.lat - _my_loc.lat);
+        const float dlng = (float)(vehicle.info.lon - _my_loc.lng) * lng_scale;
+        const float distance_sq = sq(dlat, dlng);
+        if (max_distance_sq < distance_sq || index == 0) {
+            max_distance_sq = distance_sq;
             max_distance_index = index;
         }
     } // for index
 
     furthest_vehicle_index = max_distance_index;
-    furthest_vehicle_distance = max_distance;
+    furthest_vehicle_distance = sqrtf(max_distance_sq) * LOCATION_SCALING_FACTOR;
 }
 
 /*
@@ -295,7 +322,13 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
             furthest_vehicle_distance = 0;
             furthest_vehicle_index = 0;
         }
+        icao_index_remove(icao_index_find(in_state.vehicle_list[index].info.ICAO_address));
         if (index != (in_state.vehicle_count-1)) {
+            // the last vehicle moves into the gap
+            const int16_t slot = icao_index_find(in_state.vehicle_list[in_state.vehicle_count-1].info.ICAO_address);
+            if (slot >= 0) {
+                in_state.icao_index[slot] = index + 1;
+            }
             in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
         }
         // TODO: is memset needed? When we decrement the index we essentially forget about it
@@ -311,13 +344,67 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
-    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
-            *index = i;
-            return true;
+    const int16_t slot = icao_index_find(vehicle.info.ICAO_address);
+    if (slot < 0) {
+        return false;
+    }
+    *index = in_state.icao_index[slot] - 1;
+    return true;
+}
+
+/*
+ * home slot of an ICAO address in the hash index
+ */
+uint16_t AP_ADSB::icao_hash(const uint32_t ICAO_address) const
+{
+    return ((uint32_t)(ICAO_address * 2654435761U) >> 16) & in_state.icao_index_mask;
+}
+
+/*
+ * return the hash index slot holding the given ICAO address, or -1
+ */
+int16_t AP_ADSB::icao_index_find(const uint32_t ICAO_address) const
+{
+    for (uint16_t slot = icao_hash(ICAO_address); in_state.icao_index[slot] != 0; slot = (slot + 1) & in_state.icao_index_mask) {
+        if (in_state.vehicle_list[in_state.icao_index[slot] - 1].info.ICAO_address == ICAO_address) {
+            return slot;
         }
     }
-    return false;
+    return -1;
+}
+
+/*
+ * add the vehicle at the given list index to the hash index. The
+ * vehicle must not already be in the index
+ */
+void AP_ADSB::icao_index_insert(const uint16_t index)
+{
+    uint16_t slot = icao_hash(in_state.vehicle_list[index].info.ICAO_address);
+    while (in_state.icao_index[slot] != 0) {
+        slot = (slot + 1) & in_state.icao_index_mask;
+    }
+    in_state.icao_index[slot] = index + 1;
+}
+
+/*
+ * empty a hash index slot, moving back any later entries of the same
+ * probe sequence so that lookups still find them
+ */
+void AP_ADSB::icao_index_remove(const int16_t slot)
+{
+    if (slot < 0) {
+        return;
+    }
+    const uint16_t mask = in_state.icao_index_mask;
+    uint16_t hole = slot;
+    for (uint16_t i = (hole + 1) & mask; in_state.icao_index[i] != 0; i = (i + 1) & mask) {
+        const uint16_t home = icao_hash(in_state.vehicle_list[in_state.icao_index[i] - 1].info.ICAO_address);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            in_state.icao_index[hole] = in_state.icao_index[i];
+            hole = i;
+        }
+    }
+    in_state.icao_index[hole] = 0;
 }
 
 /*
@@ -336,8 +423,12 @@ void AP_ADSB::handle_vehicle(const mavlink_message_t* packet)
     mavlink_msg_adsb_vehicle_decode(packet, &vehicle.info);
     Location_Class vehicle_loc = Location_Class(AP_ADSB::get_location(vehicle));
     bool my_loc_is_zero = _my_loc.is_zero();
-    float my_loc_distance_to_vehicle = _my_loc.get_distance(vehicle_loc);
-    bool out_of_range = in_state.list_radius > 0 && !my_loc_is_zero && my_loc_distance_to_vehicle > in_state.list_radius;
+    // coarse check first: distant traffic is out of range on latitude
+    // alone, which needs no trig
+    bool out_of_range = in_state.list_radius > 0 && !my_loc_is_zero &&
+        labs(vehicle_loc.lat - _my_loc.lat) * LOCATION_SCALING_FACTOR > in_state.list_radius;
+    float my_loc_distance_to_vehicle = out_of_range ? 0 : _my_loc.get_distance(vehicle_loc);
+    out_of_range = out_of_range || (in_state.list_radius > 0 && !my_loc_is_zero && my_loc_distance_to_vehicle > in_state.list_radius);
     bool is_tracked_in_list = find_index(vehicle, &index);
     uint32_t now = AP_HAL::millis();
 
@@ -413,9 +504,21 @@ void AP_ADSB::handle_vehicle(const mavlink_message_t* packet)
  */
 void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
 {
-    if (index < in_state.list_size) {
+    if (index >= in_state.list_size) {
+        return;
+    }
+    if (index < in_state.vehicle_count &&
+        in_state.vehicle_list[index].info.ICAO_address == vehicle.info.ICAO_address) {
+        // update of a tracked vehicle, the hash index is unchanged
         in_state.vehicle_list[index] = vehicle;
+        return;
+    }
+    if (index < in_state.vehicle_count) {
+        // replacing another vehicle
+        icao_index_remove(icao_index_find(in_state.vehicle_list[index].info.ICAO_address));
     }
+    in_state.vehicle_list[index] = vehicle;
+    icao_index_insert(index);
 }
 
 void AP_ADSB::send_adsb_vehicle(const mavlink_channel_t chan)
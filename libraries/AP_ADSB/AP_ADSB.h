@@ -30,6 +30,8 @@
 #include <AP_Buffer/AP_Buffer.h>
 
 class AP_ADSB {
+    friend class AP_ADSB_Test;
+
 public:
     AP_ADSB(const AP_AHRS &ahrs)
         : _ahrs(ahrs)
@@ -88,6 +90,12 @@ private:
     // return index of given vehicle if ICAO_ADDRESS matches. return -1 if no match
     bool find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const;
 
+    // ICAO address hash index of the vehicle list
+    uint16_t icao_hash(uint32_t ICAO_address) const;
+    int16_t icao_index_find(uint32_t ICAO_address) const;
+    void icao_index_insert(uint16_t index);
+    void icao_index_remove(int16_t slot);
+
     // remove a vehicle from the list
     void delete_vehicle(const uint16_t index);
 
@@ -125,6 +133,11 @@ private:
         uint16_t    list_size = 1; // start with tiny list, then change to param-defined size. This ensures it doesn't fail on start
         adsb_vehicle_t *vehicle_list = nullptr;
         uint16_t    vehicle_count;
+
+        // open addressing hash table from ICAO address to vehicle_list
+        // index plus one, zero for an empty slot
+        uint16_t    *icao_index = nullptr;
+        uint16_t    icao_index_mask;
         AP_Int32    list_radius;
 
         // streamrate stuff
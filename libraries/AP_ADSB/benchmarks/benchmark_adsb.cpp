@@ -0,0 +1,88 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_ADSB/AP_ADSB.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static AP_Baro baro;
+static AP_AHRS_DCM ahrs{ins, baro};
+
+#define NUM_TARGETS 500
+
+class AP_ADSB_Test
+{
+public:
+    AP_ADSB_Test(uint16_t list_size) : adsb(ahrs)
+    {
+        adsb._enabled.set(1);
+        adsb.in_state.list_size_param.set(list_size);
+        adsb.in_state.list_radius.set(0);
+        adsb.init();
+
+        // spread the targets over a few kilometres around the first vehicle
+        for (uint16_t i = 0; i < NUM_TARGETS; i++) {
+            mavlink_adsb_vehicle_t vehicle {};
+            vehicle.ICAO_address = 0x400000 + i * 7919;
+            vehicle.lat = -353632610 + (int32_t)(i % 25) * 10000;
+            vehicle.lon = 1491652300 + (int32_t)(i / 25) * 10000;
+            vehicle.altitude = 100000;
+            vehicle.flags = ADSB_FLAGS_VALID_COORDS | ADSB_FLAGS_VALID_ALTITUDE;
+            mavlink_msg_adsb_vehicle_encode(1, 1, &msgs[i], &vehicle);
+        }
+    }
+
+    ~AP_ADSB_Test()
+    {
+        adsb.deinit();
+    }
+
+    // run the periodic update and feed every target once
+    void run(void)
+    {
+        adsb.update();
+        // there is no AHRS position here, so put back our own location
+        adsb._my_loc = my_loc;
+        for (uint16_t i = 0; i < NUM_TARGETS; i++) {
+            adsb.handle_vehicle(&msgs[i]);
+        }
+    }
+
+    void set_location(int32_t lat, int32_t lng)
+    {
+        my_loc.lat = lat;
+        my_loc.lng = lng;
+    }
+
+    AP_ADSB adsb;
+    Location_Class my_loc;
+    mavlink_message_t msgs[NUM_TARGETS];
+};
+
+// every target already tracked, so each message updates its entry
+static void BM_ADSBUpdateTracked(benchmark::State& state)
+{
+    AP_ADSB_Test test(NUM_TARGETS);
+    test.set_location(-353632610, 1491652300);
+    test.run();
+    while (state.KeepRunning()) {
+        test.run();
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_TARGETS);
+}
+
+// list smaller than the traffic, so new targets replace the furthest one
+static void BM_ADSBReplaceFurthest(benchmark::State& state)
+{
+    AP_ADSB_Test test(NUM_TARGETS / 5);
+    test.set_location(-353632610, 1491652300);
+    while (state.KeepRunning()) {
+        test.run();
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_TARGETS);
+}
+
+BENCHMARK(BM_ADSBUpdateTracked);
+BENCHMARK(BM_ADSBReplaceFurthest);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,172 @@
+#include <AP_gtest.h>
+
+#include <AP_ADSB/AP_ADSB.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static AP_Baro baro;
+static AP_AHRS_DCM ahrs{ins, baro};
+
+class AP_ADSB_Test
+{
+public:
+    AP_ADSB_Test() : adsb(ahrs)
+    {
+        // four vehicles give an index of eight slots
+        adsb.in_state.list_size_param.set(4);
+        adsb.init();
+    }
+
+    ~AP_ADSB_Test()
+    {
+        adsb.deinit();
+    }
+
+    uint16_t index_size() const
+    {
+        return adsb.in_state.icao_index_mask + 1;
+    }
+
+    // next address after the given one whose home slot is slot
+    uint32_t address_with_home(uint16_t slot, uint32_t after = 0) const
+    {
+        uint32_t address = after + 1;
+        while (adsb.icao_hash(address) != slot) {
+            address++;
+        }
+        return address;
+    }
+
+    void add(uint32_t address)
+    {
+        AP_ADSB::adsb_vehicle_t vehicle {};
+        vehicle.info.ICAO_address = address;
+        adsb.set_vehicle(adsb.in_state.vehicle_count, vehicle);
+        adsb.in_state.vehicle_count++;
+    }
+
+    bool find(uint32_t address) const
+    {
+        AP_ADSB::adsb_vehicle_t vehicle {};
+        vehicle.info.ICAO_address = address;
+        uint16_t index;
+        return adsb.find_index(vehicle, &index) &&
+            index < adsb.in_state.vehicle_count &&
+            adsb.in_state.vehicle_list[index].info.ICAO_address == address;
+    }
+
+    bool remove(uint32_t address)
+    {
+        AP_ADSB::adsb_vehicle_t vehicle {};
+        vehicle.info.ICAO_address = address;
+        uint16_t index;
+        if (!adsb.find_index(vehicle, &index)) {
+            return false;
+        }
+        adsb.delete_vehicle(index);
+        return true;
+    }
+
+    uint16_t used_slots() const
+    {
+        uint16_t used = 0;
+        for (uint16_t i = 0; i < index_size(); i++) {
+            if (adsb.in_state.icao_index[i] != 0) {
+                used++;
+            }
+        }
+        return used;
+    }
+
+    AP_ADSB adsb;
+};
+
+TEST(AP_ADSB, icao_index_insert)
+{
+    AP_ADSB_Test test;
+
+    ASSERT_EQ(8, test.index_size());
+    test.add(0x000001);
+    test.add(0xABCDEF);
+    test.add(0x123456);
+    test.add(0xFFFFFF);
+
+    EXPECT_TRUE(test.find(0x000001));
+    EXPECT_TRUE(test.find(0xABCDEF));
+    EXPECT_TRUE(test.find(0x123456));
+    EXPECT_TRUE(test.find(0xFFFFFF));
+    EXPECT_FALSE(test.find(0x000002));
+    EXPECT_EQ(4, test.used_slots());
+}
+
+TEST(AP_ADSB, icao_index_delete_colliding)
+{
+    AP_ADSB_Test test;
+
+    // three addresses probing from the same home slot
+    const uint32_t a = test.address_with_home(3);
+    const uint32_t b = test.address_with_home(3, a);
+    const uint32_t c = test.address_with_home(3, b);
+    const uint32_t d = test.address_with_home(4);
+    test.add(a);
+    test.add(b);
+    test.add(c);
+    test.add(d);
+
+    // deleting the head of the chain must shift the rest back
+    EXPECT_TRUE(test.remove(a));
+    EXPECT_FALSE(test.find(a));
+    EXPECT_TRUE(test.find(b));
+    EXPECT_TRUE(test.find(c));
+    EXPECT_TRUE(test.find(d));
+    EXPECT_EQ(3, test.used_slots());
+
+    // deleting from the middle of the chain
+    test.add(a);
+    EXPECT_TRUE(test.remove(c));
+    EXPECT_FALSE(test.find(c));
+    EXPECT_TRUE(test.find(a));
+    EXPECT_TRUE(test.find(b));
+    EXPECT_TRUE(test.find(d));
+    EXPECT_EQ(3, test.used_slots());
+
+    EXPECT_FALSE(test.remove(c));
+}
+
+TEST(AP_ADSB, icao_index_wrap_around)
+{
+    AP_ADSB_Test test;
+
+    // chain starting in the last slot wraps to the start of the index
+    const uint16_t last = test.index_size() - 1;
+    const uint32_t a = test.address_with_home(last);
+    const uint32_t b = test.address_with_home(last, a);
+    const uint32_t c = test.address_with_home(last, b);
+    const uint32_t d = test.address_with_home(0);
+    test.add(a);
+    test.add(b);
+    test.add(c);
+    test.add(d);
+    EXPECT_TRUE(test.find(a));
+    EXPECT_TRUE(test.find(b));
+    EXPECT_TRUE(test.find(c));
+    EXPECT_TRUE(test.find(d));
+
+    // entries past the wrap move back across it
+    EXPECT_TRUE(test.remove(a));
+    EXPECT_TRUE(test.find(b));
+    EXPECT_TRUE(test.find(c));
+    EXPECT_TRUE(test.find(d));
+
+    EXPECT_TRUE(test.remove(c));
+    EXPECT_TRUE(test.find(b));
+    EXPECT_TRUE(test.find(d));
+
+    EXPECT_TRUE(test.remove(b));
+    EXPECT_TRUE(test.remove(d));
+    EXPECT_EQ(0, test.adsb.get_vehicle_count());
+    EXPECT_EQ(0, test.used_slots());
+}
+
+AP_GTEST_MAIN()
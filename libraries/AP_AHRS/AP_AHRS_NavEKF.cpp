@@ -24,6 +24,7 @@
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <GCS_MAVLink/GCS.h>
 #include <AP_Module/AP_Module.h>
+#include <AP_Scheduler/LatencyTrace.h>
 
 #if AP_AHRS_NAVEKF_AVAILABLE
 
@@ -106,6 +107,8 @@ void AP_AHRS_NavEKF::update(bool skip_ins_update)
         update_EKF2();
     }
 
+    AP::LatencyTrace::record(AP::LatencyTrace::STAGE_AHRS);
+
 #if AP_MODULE_SUPPORTED
     // call AHRS_update hook if any
     AP_Module::call_hook_AHRS_update(*this);
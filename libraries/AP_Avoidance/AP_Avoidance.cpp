@@ -278,9 +278,16 @@ float closest_approach_xy(const Location &my_loc,
                           const Vector3f &obstacle_vel,
                           const uint8_t time_horizon)
 {
+    return closest_approach_xy(location_diff(obstacle_loc, my_loc), my_vel, obstacle_vel, time_horizon);
+}
+
+float closest_approach_xy(const Vector2f &delta_pos_ne,
+                          const Vector3f &my_vel,
+                          const Vector3f &obstacle_vel,
+                          const uint8_t time_horizon)
+{
 
     Vector2f delta_vel_ne = Vector2f(obstacle_vel[0] - my_vel[0], obstacle_vel[1] - my_vel[1]);
-    Vector2f delta_pos_ne = location_diff(obstacle_loc, my_loc);
 
     Vector2f line_segment_ne = delta_vel_ne * time_horizon;
 
@@ -325,22 +332,31 @@ float closest_approach_z(const Location &my_loc,
     return ret/100.0f;
 }
 
-void AP_Avoidance::update_threat_level(const Location &my_loc,
+void AP_Avoidance::update_threat_level(const Location_origin<float> &my_origin,
                                        const Vector3f &my_vel,
                                        AP_Avoidance::Obstacle &obstacle)
 {
 
+    const Location &my_loc = my_origin.get_origin();
     Location &obstacle_loc = obstacle._location;
     Vector3f &obstacle_vel = obstacle._velocity;
 
+    // our offset from the obstacle and the distance to it, using the
+    // trig of our own position cached in my_origin
+    Vector2f delta_pos_ne;
+    my_origin.diff(&obstacle_loc, &delta_pos_ne, 1);
+    delta_pos_ne = -delta_pos_ne;
+    float current_distance;
+    my_origin.distance(&obstacle_loc, &current_distance, 1);
+
     obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
 
     const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
-    float closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
+    float closest_xy = closest_approach_xy(delta_pos_ne, my_vel, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
     if (closest_xy < _fail_distance_xy) {
         obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
     } else {
-        closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
+        closest_xy = closest_approach_xy(delta_pos_ne, my_vel, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
         if (closest_xy < _warn_distance_xy) {
             obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
         }
@@ -369,7 +385,6 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
     // level is none - but only *once the GCS has been informed*!
     obstacle.closest_approach_xy = closest_xy;
     obstacle.closest_approach_z = closest_z;
-    float current_distance = get_distance(my_loc, obstacle_loc);
     obstacle.distance_to_closest_approach = current_distance - closest_xy;
     Vector2f net_velocity_ne = Vector2f(my_vel[0] - obstacle_vel[0], my_vel[1] - obstacle_vel[1]);
     obstacle.time_to_closest_approach = 0.0f;
@@ -448,6 +463,13 @@ void AP_Avoidance::check_for_threats()
         return;
     }
 
+#if AVOIDANCE_DEBUGGING
+    const uint32_t start_us = AP_HAL::micros();
+#endif
+
+    // the trig for our own position is calculated once for all obstacles
+    const Location_origin<float> my_origin(my_loc);
+
     // we always check all obstacles to see if they are threats since it
     // is most likely our own position and/or velocity have changed
     // determine the current most-serious-threat
@@ -458,7 +480,7 @@ void AP_Avoidance::check_for_threats()
         const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
         debug("i=%d src_id=%d timestamp=%u age=%d", i, obstacle.src_id, obstacle.timestamp_ms, obstacle_age);
 
-        update_threat_level(my_loc, my_vel, obstacle);
+        update_threat_level(my_origin, my_vel, obstacle);
         debug("   threat-level=%d", obstacle.threat_level);
 
         // ignore any really old data:
@@ -477,6 +499,9 @@ void AP_Avoidance::check_for_threats()
     if (_current_most_serious_threat != -1) {
         debug("Current most serious threat: %d level=%d", _current_most_serious_threat, _obstacles[_current_most_serious_threat].threat_level);
     }
+#if AVOIDANCE_DEBUGGING
+    debug("checked %u obstacles in %u us", (unsigned)_obstacle_count, (unsigned)(AP_HAL::micros() - start_us));
+#endif
 }
 
 
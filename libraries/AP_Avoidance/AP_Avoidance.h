@@ -159,7 +159,7 @@ private:
     uint32_t src_id_for_adsb_vehicle(AP_ADSB::adsb_vehicle_t vehicle) const;
 
     void check_for_threats();
-    void update_threat_level(const Location &my_loc,
+    void update_threat_level(const Location_origin<float> &my_loc,
                              const Vector3f &my_vel,
                              AP_Avoidance::Obstacle &obstacle);
 
@@ -205,6 +205,12 @@ float closest_approach_xy(const Location &my_loc,
                           const Vector3f &obstacle_vel,
                           uint8_t time_horizon);
 
+// as above, given our N/E offset in metres from the obstacle
+float closest_approach_xy(const Vector2f &delta_pos_ne,
+                          const Vector3f &my_vel,
+                          const Vector3f &obstacle_vel,
+                          uint8_t time_horizon);
+
 float closest_approach_z(const Location &my_loc,
                          const Vector3f &my_vel,
                          const Location &obstacle_loc,
@@ -39,7 +39,7 @@ void CompassLearn::update(void)
 
         // setup the expected earth field at this location
         float declination_deg=0, inclination_deg=0, intensity_gauss=0;
-        AP_Declination::get_mag_field_ef(loc.lat*1.0e-7, loc.lng*1.0e-7, intensity_gauss, declination_deg, inclination_deg);
+        AP_Declination::get_mag_field_ef(loc.lat*1.0e-7, loc.lng*1.0e-7, intensity_gauss, declination_deg, inclination_deg, mag_cell_cache);
 
         // create earth field
         mag_ef = Vector3f(intensity_gauss*1000, 0.0, 0.0);
@@ -26,6 +26,7 @@ private:
 
     // earth field
     Vector3f mag_ef;
+    AP_Declination::cell_cache mag_cell_cache;
 
     // semaphore for access to shared data with IO thread
     AP_HAL::Semaphore *sem;    
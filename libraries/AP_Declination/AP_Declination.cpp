@@ -81,94 +81,80 @@ const float AP_Declination::intensity_table[13][37] = {
 };
 
 
+/* sampling of the tables in degrees */
+static const float SAMPLING_RES = 10.0f;
+static const float SAMPLING_MIN_LAT = -60.0f;
+static const float SAMPLING_MAX_LAT = 60.0f;
+static const float SAMPLING_MIN_LON = -180.0f;
+static const float SAMPLING_MAX_LON = 180.0f;
+
+void AP_Declination::cell_coeffs::set(float sw, float se, float nw, float ne)
+{
+    c[0] = sw;
+    c[1] = se - sw;
+    c[2] = nw - sw;
+    c[3] = ne - nw - se + sw;
+}
+
+/*
+  load the interpolation coefficients for the cell with the given south
+  west corner
+ */
+void AP_Declination::load_cell(cell_cache &cache, uint8_t lat_index, uint8_t lon_index)
+{
+    const uint8_t i = lat_index;
+    const uint8_t j = lon_index;
+    cache.intensity.set(intensity_table[i][j], intensity_table[i][j+1],
+                        intensity_table[i+1][j], intensity_table[i+1][j+1]);
+    cache.declination.set(declination_table[i][j], declination_table[i][j+1],
+                          declination_table[i+1][j], declination_table[i+1][j+1]);
+    cache.inclination.set(inclination_table[i][j], inclination_table[i][j+1],
+                          inclination_table[i+1][j], inclination_table[i+1][j+1]);
+    cache.lat_index = lat_index;
+    cache.lon_index = lon_index;
+    cache.valid = true;
+}
+
 /*
   calculate magnetic field intensity and orientation
 */
 bool AP_Declination::get_mag_field_ef(float latitude_deg, float longitude_deg, float &intensity_gauss, float &declination_deg, float &inclination_deg)
 {
-    /* set this always to the sampling in degrees for the table below */
-    const float SAMPLING_RES = 10.0f;
-    const float SAMPLING_MIN_LAT = -60.0f;
-    const float SAMPLING_MAX_LAT = 60.0f;
-    const float SAMPLING_MIN_LON = -180.0f;
-    const float SAMPLING_MAX_LON = 180.0f;
-
-    bool valid_input_data = true;
-
-    /* round down to nearest sampling resolution */
-    int32_t min_lat = static_cast<int32_t>(static_cast<int32_t>(latitude_deg / SAMPLING_RES) * SAMPLING_RES);
-    int32_t min_lon = static_cast<int32_t>(static_cast<int32_t>(longitude_deg / SAMPLING_RES) * SAMPLING_RES);
-
-    /* for the rare case of hitting the bounds exactly
-     * the rounding logic wouldn't fit, so enforce it.
-     */
-
-    /* limit to table bounds - required for maxima even when table spans full globe range */
-    if (latitude_deg <= SAMPLING_MIN_LAT) {
-        min_lat = static_cast<int32_t>(SAMPLING_MIN_LAT);
-        valid_input_data = false;
-    }
-
-    if (latitude_deg >= SAMPLING_MAX_LAT) {
-        min_lat = static_cast<int32_t>(static_cast<int32_t>(latitude_deg / SAMPLING_RES) * SAMPLING_RES - SAMPLING_RES);
-        valid_input_data = false;
-    }
-
-    if (longitude_deg <= SAMPLING_MIN_LON) {
-        min_lon = static_cast<int32_t>(SAMPLING_MIN_LON);
-        valid_input_data = false;
-    }
+    cell_cache cache;
+    return get_mag_field_ef(latitude_deg, longitude_deg, intensity_gauss, declination_deg, inclination_deg, cache);
+}
 
-    if (longitude_deg >= SAMPLING_MAX_LON) {
-        min_lon = static_cast<int32_t>(static_cast<int32_t>(longitude_deg / SAMPLING_RES) * SAMPLING_RES - SAMPLING_RES);
-        valid_input_data = false;
+bool AP_Declination::get_mag_field_ef(float latitude_deg, float longitude_deg, float &intensity_gauss, float &declination_deg, float &inclination_deg,
+                                      cell_cache &cache)
+{
+    const bool valid_input_data = latitude_deg > SAMPLING_MIN_LAT && latitude_deg < SAMPLING_MAX_LAT &&
+                                  longitude_deg > SAMPLING_MIN_LON && longitude_deg < SAMPLING_MAX_LON;
+
+    /* position in table cells from the south west corner of the table */
+    const float lat_cells = (latitude_deg - SAMPLING_MIN_LAT) * (1.0f / SAMPLING_RES);
+    const float lon_cells = (longitude_deg - SAMPLING_MIN_LON) * (1.0f / SAMPLING_RES);
+
+    /* fractional position within the cached cell */
+    float x = lon_cells - cache.lon_index;
+    float y = lat_cells - cache.lat_index;
+
+    if (!cache.valid || !(x >= 0 && x < 1 && y >= 0 && y < 1)) {
+        /* find the cell containing the point. Points outside the table
+         * are extrapolated from the nearest edge cell
+         */
+        const uint8_t lat_index = constrain_float(floorf(lat_cells), 0, 11);
+        const uint8_t lon_index = constrain_float(floorf(lon_cells), 0, 35);
+        if (!cache.valid || cache.lat_index != lat_index || cache.lon_index != lon_index) {
+            load_cell(cache, lat_index, lon_index);
+        }
+        x = lon_cells - lon_index;
+        y = lat_cells - lat_index;
     }
 
-    /* find index of nearest low sampling point */
-    uint32_t min_lat_index = static_cast<uint32_t>((-(SAMPLING_MIN_LAT) + min_lat)  / SAMPLING_RES);
-    uint32_t min_lon_index = static_cast<uint32_t>((-(SAMPLING_MIN_LON) + min_lon) / SAMPLING_RES);
-
-    /* calculate intensity */
-
-    float data_sw = intensity_table[min_lat_index][min_lon_index];
-    float data_se = intensity_table[min_lat_index][min_lon_index + 1];;
-    float data_ne = intensity_table[min_lat_index + 1][min_lon_index + 1];
-    float data_nw = intensity_table[min_lat_index + 1][min_lon_index];
-
-    /* perform bilinear interpolation on the four grid corners */
-
-    float data_min = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_se - data_sw) + data_sw;
-    float data_max = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_ne - data_nw) + data_nw;
-
-    intensity_gauss = ((latitude_deg - min_lat) / SAMPLING_RES) * (data_max - data_min) + data_min;
-
-    /* calculate declination */
-
-    data_sw = declination_table[min_lat_index][min_lon_index];
-    data_se = declination_table[min_lat_index][min_lon_index + 1];;
-    data_ne = declination_table[min_lat_index + 1][min_lon_index + 1];
-    data_nw = declination_table[min_lat_index + 1][min_lon_index];
-
-    /* perform bilinear interpolation on the four grid corners */
-
-    data_min = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_se - data_sw) + data_sw;
-    data_max = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_ne - data_nw) + data_nw;
-
-    declination_deg = ((latitude_deg - min_lat) / SAMPLING_RES) * (data_max - data_min) + data_min;
-
-    /* calculate inclination */
-
-    data_sw = inclination_table[min_lat_index][min_lon_index];
-    data_se = inclination_table[min_lat_index][min_lon_index + 1];;
-    data_ne = inclination_table[min_lat_index + 1][min_lon_index + 1];
-    data_nw = inclination_table[min_lat_index + 1][min_lon_index];
-
-    /* perform bilinear interpolation on the four grid corners */
-
-    data_min = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_se - data_sw) + data_sw;
-    data_max = ((longitude_deg - min_lon) / SAMPLING_RES) * (data_ne - data_nw) + data_nw;
-
-    inclination_deg = ((latitude_deg - min_lat) / SAMPLING_RES) * (data_max - data_min) + data_min;
+    /* perform bilinear interpolation within the cell */
+    intensity_gauss = cache.intensity.interpolate(x, y);
+    declination_deg = cache.declination.interpolate(x, y);
+    inclination_deg = cache.inclination.interpolate(x, y);
 
     return valid_input_data;
 }
@@ -1,11 +1,42 @@
 #pragma once
 
+#include <stdint.h>
+
 /*
   magnetic data derived from WMM
  */
 class AP_Declination
 {
+private:
+    /*
+      bilinear interpolation coefficients for one table cell, giving
+      value = c[0] + c[1]*x + c[2]*y + c[3]*x*y
+      for x and y the fractional longitude and latitude within the cell
+     */
+    struct cell_coeffs {
+        float c[4];
+        void set(float sw, float se, float nw, float ne);
+        float interpolate(float x, float y) const {
+            return c[0] + x * (c[1] + y * c[3]) + y * c[2];
+        }
+    };
+
 public:
+    /*
+      the coefficients of the last table cell looked up. A caller making
+      repeated queries near one place can keep one of these and pass it
+      to get_mag_field_ef(), so the tables are only read again when the
+      point leaves the 10 degree cell. Each caller needs its own
+     */
+    struct cell_cache {
+        bool valid = false;
+        uint8_t lat_index = 0;
+        uint8_t lon_index = 0;
+        cell_coeffs intensity;
+        cell_coeffs declination;
+        cell_coeffs inclination;
+    };
+
     /*
      * Calculates the magnetic intensity, declination and inclination at a given WGS-84 latitude and longitude.
      * Assumes a WGS-84 height of zero
@@ -16,12 +47,21 @@ public:
     */    
     static bool get_mag_field_ef(float latitude_deg, float longitude_deg, float &intensity_gauss, float &declination_deg, float &inclination_deg);
 
+    /*
+      as above, reusing the coefficients in cache if the point is in the
+      same cell as the last query made with it
+     */
+    static bool get_mag_field_ef(float latitude_deg, float longitude_deg, float &intensity_gauss, float &declination_deg, float &inclination_deg,
+                                 cell_cache &cache);
+
     /*
       get declination in degrees for a given latitude_deg and longitude_deg
      */
     static float get_declination(float latitude_deg, float longitude_deg);
     
 private:
+    static void load_cell(cell_cache &cache, uint8_t lat_index, uint8_t lon_index);
+
     static const float declination_table[13][37];
     static const float inclination_table[13][37];
     static const float intensity_table[13][37];
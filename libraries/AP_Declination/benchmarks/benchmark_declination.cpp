@@ -0,0 +1,47 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Declination/AP_Declination.h>
+
+// a vehicle moving within one table cell, as seen by Compass_learn and SITL
+static void BM_DeclinationSameCell(benchmark::State& state)
+{
+    AP_Declination::cell_cache cache;
+    float lat = -35.36f;
+    float intensity, declination, inclination;
+    while (state.KeepRunning()) {
+        lat += 1.0e-6f;
+        AP_Declination::get_mag_field_ef(lat, 149.17f, intensity, declination, inclination, cache);
+        gbenchmark_escape(&declination);
+    }
+}
+
+// every query in a different cell, so the cached coefficients are reloaded
+static void BM_DeclinationNewCell(benchmark::State& state)
+{
+    AP_Declination::cell_cache cache;
+    bool north = false;
+    float intensity, declination, inclination;
+    while (state.KeepRunning()) {
+        north = !north;
+        AP_Declination::get_mag_field_ef(north ? 51.5f : -35.36f, 149.17f, intensity, declination, inclination, cache);
+        gbenchmark_escape(&declination);
+    }
+}
+
+// without a cache, as get_declination() is called
+static void BM_DeclinationUncached(benchmark::State& state)
+{
+    float lat = -35.36f;
+    float intensity, declination, inclination;
+    while (state.KeepRunning()) {
+        lat += 1.0e-6f;
+        AP_Declination::get_mag_field_ef(lat, 149.17f, intensity, declination, inclination);
+        gbenchmark_escape(&declination);
+    }
+}
+
+BENCHMARK(BM_DeclinationSameCell);
+BENCHMARK(BM_DeclinationNewCell);
+BENCHMARK(BM_DeclinationUncached);
+
+BENCHMARK_MAIN()
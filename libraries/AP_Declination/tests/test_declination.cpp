@@ -0,0 +1,65 @@
+#include <AP_gtest.h>
+
+#include <AP_Declination/AP_Declination.h>
+#include <AP_Math/AP_Math.h>
+
+TEST(DeclinationTest, table_points)
+{
+    float intensity, declination, inclination;
+
+    // south west corner of the table
+    EXPECT_TRUE(AP_Declination::get_mag_field_ef(-59.999f, -179.999f, intensity, declination, inclination));
+    EXPECT_NEAR(47.225f, declination, 0.01f);
+    EXPECT_NEAR(-77.62f, inclination, 0.01f);
+    EXPECT_NEAR(0.62195f, intensity, 0.0001f);
+
+    // a point on the grid in each hemisphere
+    AP_Declination::get_mag_field_ef(50.0f, 0.0f, intensity, declination, inclination);
+    EXPECT_NEAR(-0.46224f, declination, 0.001f);
+    AP_Declination::get_mag_field_ef(-30.0f, 150.0f, intensity, declination, inclination);
+    EXPECT_NEAR(10.847f, declination, 0.001f);
+
+    EXPECT_FALSE(AP_Declination::get_mag_field_ef(61.0f, 0.0f, intensity, declination, inclination));
+    EXPECT_FALSE(AP_Declination::get_mag_field_ef(0.0f, 180.0f, intensity, declination, inclination));
+}
+
+TEST(DeclinationTest, continuous_across_cells)
+{
+    // crossing a cell boundary should not jump, in either hemisphere
+    const float boundaries[][2] = {
+        {-30.0f, 145.0f}, {30.0f, 145.0f}, {15.0f, -120.0f}, {-15.0f, -120.0f}, {0.0f, 5.0f}, {5.0f, 0.0f},
+    };
+    for (const auto &b : boundaries) {
+        float i1, d1, n1, i2, d2, n2;
+        if (fmodf(b[0], 10.0f) == 0.0f) {
+            AP_Declination::get_mag_field_ef(b[0] - 0.001f, b[1], i1, d1, n1);
+            AP_Declination::get_mag_field_ef(b[0] + 0.001f, b[1], i2, d2, n2);
+        } else {
+            AP_Declination::get_mag_field_ef(b[0], b[1] - 0.001f, i1, d1, n1);
+            AP_Declination::get_mag_field_ef(b[0], b[1] + 0.001f, i2, d2, n2);
+        }
+        EXPECT_NEAR(d1, d2, 0.01f);
+        EXPECT_NEAR(n1, n2, 0.01f);
+        EXPECT_NEAR(i1, i2, 0.0001f);
+    }
+}
+
+TEST(DeclinationTest, cache_does_not_change_result)
+{
+    // the same point gives the same answer whichever cell was used last,
+    // with or without a cache
+    AP_Declination::cell_cache cache;
+    float i1, d1, n1, i2, d2, n2;
+    AP_Declination::get_mag_field_ef(-35.36f, 149.17f, i1, d1, n1);
+    AP_Declination::get_mag_field_ef(51.5f, -0.12f, i2, d2, n2, cache);
+    AP_Declination::get_mag_field_ef(-35.36f, 149.17f, i2, d2, n2, cache);
+    EXPECT_EQ(i1, i2);
+    EXPECT_EQ(d1, d2);
+    EXPECT_EQ(n1, n2);
+    AP_Declination::get_mag_field_ef(-35.37f, 149.18f, i1, d1, n1);
+    AP_Declination::get_mag_field_ef(-35.37f, 149.18f, i2, d2, n2, cache);
+    EXPECT_EQ(d1, d2);
+    EXPECT_EQ(d1, AP_Declination::get_declination(-35.37f, 149.18f));
+}
+
+AP_GTEST_MAIN()
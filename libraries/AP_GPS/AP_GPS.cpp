@@ -259,6 +259,116 @@ const AP_Param::GroupInfo AP_GPS::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("BLEND_TC", 21, AP_GPS, _blend_tc, 10.0f),
 
+#if GPS_MAX_RECEIVERS > 2
+    // @Param: TYPE3
+    // @DisplayName: 3rd GPS type
+    // @Description: GPS type of 3rd GPS
+    // @Values: 0:None,1:AUTO,2:uBlox,3:MTK,4:MTK19,5:NMEA,6:SiRF,7:HIL,8:SwiftNav,9:UAVCAN,10:SBF,11:GSOF,12:QURT,13:ERB,14:MAV,15:NOVA
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("TYPE3", 22, AP_GPS, _type[2], 0),
+
+    // @Param: GNSS_MODE3
+    // @DisplayName: GNSS system configuration
+    // @Description: Bitmask for what GNSS system to use on the 3rd GPS (all unchecked or zero to leave GPS as configured)
+    // @Values: 0:Leave as currently configured, 1:GPS-NoSBAS, 3:GPS+SBAS, 4:Galileo-NoSBAS, 6:Galileo+SBAS, 8:Beidou, 51:GPS+IMES+QZSS+SBAS (Japan Only), 64:GLONASS, 66:GLONASS+SBAS, 67:GPS+GLONASS+SBAS
+    // @Bitmask: 0:GPS,1:SBAS,2:Galileo,3:Beidou,4:IMES,5:QZSS,6:GLOSNASS
+    // @User: Advanced
+    AP_GROUPINFO("GNSS_MODE3", 23, AP_GPS, _gnss_mode[2], 0),
+
+    // @Param: RATE_MS3
+    // @DisplayName: GPS 3 update rate in milliseconds
+    // @Description: Controls how often the GPS should provide a position update. Lowering below 5Hz is not allowed
+    // @Units: ms
+    // @Values: 100:10Hz,125:8Hz,200:5Hz
+    // @Range: 50 200
+    // @User: Advanced
+    AP_GROUPINFO("RATE_MS3", 24, AP_GPS, _rate_ms[2], 200),
+
+    // @Param: POS3_X
+    // @DisplayName: Antenna X position offset
+    // @Description: X position of the 3rd GPS antenna in body frame. Positive X is forward of the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @User: Advanced
+
+    // @Param: POS3_Y
+    // @DisplayName: Antenna Y position offset
+    // @Description: Y position of the 3rd GPS antenna in body frame. Positive Y is to the right of the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @User: Advanced
+
+    // @Param: POS3_Z
+    // @DisplayName: Antenna Z position offset
+    // @Description: Z position of the 3rd GPS antenna in body frame. Positive Z is down from the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @User: Advanced
+    AP_GROUPINFO("POS3", 25, AP_GPS, _antenna_offset[2], 0.0f),
+
+    // @Param: DELAY_MS3
+    // @DisplayName: GPS 3 delay in milliseconds
+    // @Description: Controls the amount of GPS  measurement delay that the autopilot compensates for. Set to zero to use the default delay for the detected GPS type.
+    // @Units: ms
+    // @Range: 0 250
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("DELAY_MS3", 26, AP_GPS, _delay_ms[2], 0),
+#endif
+
+#if GPS_MAX_RECEIVERS > 3
+    // @Param: TYPE4
+    // @DisplayName: 4th GPS type
+    // @Description: GPS type of 4th GPS
+    // @Values: 0:None,1:AUTO,2:uBlox,3:MTK,4:MTK19,5:NMEA,6:SiRF,7:HIL,8:SwiftNav,9:UAVCAN,10:SBF,11:GSOF,12:QURT,13:ERB,14:MAV,15:NOVA
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("TYPE4", 27, AP_GPS, _type[3], 0),
+
+    // @Param: GNSS_MODE4
+    // @DisplayName: GNSS system configuration
+    // @Description: Bitmask for what GNSS system to use on the 4th GPS (all unchecked or zero to leave GPS as configured)
+    // @Values: 0:Leave as currently configured, 1:GPS-NoSBAS, 3:GPS+SBAS, 4:Galileo-NoSBAS, 6:Galileo+SBAS, 8:Beidou, 51:GPS+IMES+QZSS+SBAS (Japan Only), 64:GLONASS, 66:GLONASS+SBAS, 67:GPS+GLONASS+SBAS
+    // @Bitmask: 0:GPS,1:SBAS,2:Galileo,3:Beidou,4:IMES,5:QZSS,6:GLOSNASS
+    // @User: Advanced
+    AP_GROUPINFO("GNSS_MODE4", 28, AP_GPS, _gnss_mode[3], 0),
+
+    // @Param: RATE_MS4
+    // @DisplayName: GPS 4 update rate in milliseconds
+    // @Description: Controls how often the GPS should provide a position update. Lowering below 5Hz is not allowed
+    // @Units: ms
+    // @Values: 100:10Hz,125:8Hz,200:5Hz
+    // @Range: 50 200
+    // @User: Advanced
+    AP_GROUPINFO("RATE_MS4", 29, AP_GPS, _rate_ms[3], 200),
+
+    // @Param: POS4_X
+    // @DisplayName: Antenna X position offset
+    // @Description: X position of the 4th GPS antenna in body frame. Positive X is forward of the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @User: Advanced
+
+    // @Param: POS4_Y
+    // @DisplayName: Antenna Y position offset
+    // @Description: Y position of the 4th GPS antenna in body frame. Positive Y is to the right of the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @User: Advanced
+
+    // @Param: POS4_Z
+    // @DisplayName: Antenna Z position offset
+    // @Description: Z position of the 4th GPS antenna in body frame. Positive Z is down from the origin. Use antenna phase centroid location if provided by the manufacturer.
+    // @Units: m
+    // @User: Advanced
+    AP_GROUPINFO("POS4", 30, AP_GPS, _antenna_offset[3], 0.0f),
+
+    // @Param: DELAY_MS4
+    // @DisplayName: GPS 4 delay in milliseconds
+    // @Description: Controls the amount of GPS  measurement delay that the autopilot compensates for. Set to zero to use the default delay for the detected GPS type.
+    // @Units: ms
+    // @Range: 0 250
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("DELAY_MS4", 31, AP_GPS, _delay_ms[3], 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -282,8 +392,9 @@ void AP_GPS::init(const AP_SerialManager& serial_manager)
     primary_instance = 0;
 
     // search for serial ports with gps protocol
-    _port[0] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, 0);
-    _port[1] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, 1);
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        _port[i] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, i);
+    }
     _last_instance_swap_ms = 0;
 
     // Initialise class variables used to do GPS blending
@@ -984,8 +1095,13 @@ bool AP_GPS::all_consistent(float &distance) const
         return true;
     }
 
-    // calculate distance
-    distance = location_3d_diff_NED(state[0].location, state[1].location).length();
+    // calculate the largest distance between any pair of receivers
+    distance = 0;
+    for (uint8_t i=0; i<num_instances; i++) {
+        for (uint8_t j=i+1; j<num_instances; j++) {
+            distance = MAX(distance, location_3d_diff_NED(state[i].location, state[j].location).length());
+        }
+    }
     // success if distance is within 50m
     return (distance < 50);
 }
@@ -1135,6 +1251,29 @@ uint16_t AP_GPS::get_rate_ms(uint8_t instance) const
     return MIN(_rate_ms[instance], GPS_MAX_RATE_MS);
 }
 
+/*
+ accumulate normalised inverse variance weights for one accuracy metric.
+ A zero variance marks a receiver that does not contribute to the metric.
+ Returns true if the metric produced a valid set of weights
+*/
+bool AP_GPS::add_blend_weights(const float variance[GPS_MAX_RECEIVERS], float weights[GPS_MAX_RECEIVERS])
+{
+    float inv_variance[GPS_MAX_RECEIVERS];
+    float sum_of_inv_variance = 0.0f;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        inv_variance[i] = (variance[i] > 0.0f) ? 1.0f / variance[i] : 0.0f;
+        sum_of_inv_variance += inv_variance[i];
+    }
+    if (sum_of_inv_variance <= 0.0f) {
+        return false;
+    }
+    const float scaler = 1.0f / sum_of_inv_variance;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        weights[i] += inv_variance[i] * scaler;
+    }
+    return true;
+}
+
 /*
  calculate the weightings used to blend GPSs location and velocity data
 */
@@ -1144,7 +1283,13 @@ bool AP_GPS::calc_blend_weights(void)
     memset(&_blend_weights, 0, sizeof(_blend_weights));
 
     // exit immediately if not enough receivers to do blending
-    if (num_instances < 2 || drivers[1] == nullptr || _type[1] == GPS_TYPE_NONE) {
+    uint8_t num_receivers = 0;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (drivers[i] != nullptr && _type[i] != GPS_TYPE_NONE) {
+            num_receivers++;
+        }
+    }
+    if (num_instances < 2 || num_receivers < 2) {
         return false;
     }
 
@@ -1172,126 +1317,70 @@ bool AP_GPS::calc_blend_weights(void)
         return false;
     }
 
-    // calculate the sum squared speed accuracy across all GPS sensors
-    float speed_accuracy_sum_sq = 0.0f;
-    if (_blend_mask & BLEND_MASK_USE_SPD_ACC) {
-        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-            if (state[i].status >= GPS_OK_FIX_3D) {
-                if (state[i].have_speed_accuracy && state[i].speed_accuracy > 0.0f) {
-                    speed_accuracy_sum_sq += state[i].speed_accuracy * state[i].speed_accuracy;
-                } else {
-                    // not all receivers support this metric so set it to zero and don't use it
-                    speed_accuracy_sum_sq = 0.0f;
-                    break;
+    /*
+      gather the variance of each accuracy metric for all receivers in
+      a single pass. A metric is only used if every receiver with a
+      suitable fix reports it, as not all receivers support all
+      metrics. A zero variance excludes that receiver from the metric.
+     */
+    struct {
+        float hpos[GPS_MAX_RECEIVERS];
+        float vpos[GPS_MAX_RECEIVERS];
+        float spd[GPS_MAX_RECEIVERS];
+    } variance {};
+    bool use_hpos = (_blend_mask & BLEND_MASK_USE_HPOS_ACC) != 0;
+    bool use_vpos = (_blend_mask & BLEND_MASK_USE_VPOS_ACC) != 0;
+    bool use_spd = (_blend_mask & BLEND_MASK_USE_SPD_ACC) != 0;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        const GPS_State &s = state[i];
+        if (s.status >= GPS_OK_FIX_2D) {
+            if (s.have_horizontal_accuracy && s.horizontal_accuracy > 0.0f) {
+                if (s.horizontal_accuracy >= 0.001f) {
+                    variance.hpos[i] = sq(s.horizontal_accuracy);
                 }
+            } else {
+                use_hpos = false;
             }
         }
-    }
-
-    // calculate the sum squared horizontal position accuracy across all GPS sensors
-    float horizontal_accuracy_sum_sq = 0.0f;
-    if (_blend_mask & BLEND_MASK_USE_HPOS_ACC) {
-        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-            if (state[i].status >= GPS_OK_FIX_2D) {
-                if (state[i].have_horizontal_accuracy && state[i].horizontal_accuracy > 0.0f) {
-                    horizontal_accuracy_sum_sq += state[i].horizontal_accuracy * state[i].horizontal_accuracy;
-                } else {
-                    // not all receivers support this metric so set it to zero and don't use it
-                    horizontal_accuracy_sum_sq = 0.0f;
-                    break;
+        if (s.status >= GPS_OK_FIX_3D) {
+            if (s.have_vertical_accuracy && s.vertical_accuracy > 0.0f) {
+                if (s.vertical_accuracy >= 0.001f) {
+                    variance.vpos[i] = sq(s.vertical_accuracy);
                 }
+            } else {
+                use_vpos = false;
             }
-        }
-    }
-
-    // calculate the sum squared vertical position accuracy across all GPS sensors
-    float vertical_accuracy_sum_sq = 0.0f;
-    if (_blend_mask & BLEND_MASK_USE_VPOS_ACC) {
-        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-            if (state[i].status >= GPS_OK_FIX_3D) {
-                if (state[i].have_vertical_accuracy && state[i].vertical_accuracy > 0.0f) {
-                    vertical_accuracy_sum_sq += state[i].vertical_accuracy * state[i].vertical_accuracy;
-                } else {
-                    // not all receivers support this metric so set it to zero and don't use it
-                    vertical_accuracy_sum_sq = 0.0f;
-                    break;
+            if (s.have_speed_accuracy && s.speed_accuracy > 0.0f) {
+                if (s.speed_accuracy >= 0.001f) {
+                    variance.spd[i] = sq(s.speed_accuracy);
                 }
+            } else {
+                use_spd = false;
             }
         }
     }
-    // Check if we can do blending using reported accuracy
-    bool can_do_blending = (horizontal_accuracy_sum_sq > 0.0f || vertical_accuracy_sum_sq > 0.0f || speed_accuracy_sum_sq > 0.0f);
 
-    // if we can't do blending using reported accuracy, return false and hard switch logic will be used instead
-    if (!can_do_blending) {
-        return false;
+    // calculate a weighting for each metric using the inverse of the variances
+    uint8_t num_metrics = 0;
+    if (use_hpos && add_blend_weights(variance.hpos, _blend_weights)) {
+        num_metrics++;
     }
-
-    float sum_of_all_weights = 0.0f;
-
-    // calculate a weighting using the reported horizontal position
-    float hpos_blend_weights[GPS_MAX_RECEIVERS] = {};
-    if (horizontal_accuracy_sum_sq > 0.0f && (_blend_mask & BLEND_MASK_USE_HPOS_ACC)) {
-        // calculate the weights using the inverse of the variances
-        float sum_of_hpos_weights = 0.0f;
-        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-            if (state[i].status >= GPS_OK_FIX_2D && state[i].horizontal_accuracy >= 0.001f) {
-                hpos_blend_weights[i] = horizontal_accuracy_sum_sq / (state[i].horizontal_accuracy * state[i].horizontal_accuracy);
-                sum_of_hpos_weights += hpos_blend_weights[i];
-            }
-        }
-        // normalise the weights
-        if (sum_of_hpos_weights > 0.0f) {
-            for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-                hpos_blend_weights[i] = hpos_blend_weights[i] / sum_of_hpos_weights;
-            }
-            sum_of_all_weights += 1.0f;
-        }
+    if (use_vpos && add_blend_weights(variance.vpos, _blend_weights)) {
+        num_metrics++;
     }
-
-    // calculate a weighting using the reported vertical position accuracy
-    float vpos_blend_weights[GPS_MAX_RECEIVERS] = {};
-    if (vertical_accuracy_sum_sq > 0.0f && (_blend_mask & BLEND_MASK_USE_VPOS_ACC)) {
-        // calculate the weights using the inverse of the variances
-        float sum_of_vpos_weights = 0.0f;
-        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-            if (state[i].status >= GPS_OK_FIX_3D && state[i].vertical_accuracy >= 0.001f) {
-                vpos_blend_weights[i] = vertical_accuracy_sum_sq / (state[i].vertical_accuracy * state[i].vertical_accuracy);
-                sum_of_vpos_weights += vpos_blend_weights[i];
-            }
-        }
-        // normalise the weights
-        if (sum_of_vpos_weights > 0.0f) {
-            for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-                vpos_blend_weights[i] = vpos_blend_weights[i] / sum_of_vpos_weights;
-            }
-            sum_of_all_weights += 1.0f;
-        };
+    if (use_spd && add_blend_weights(variance.spd, _blend_weights)) {
+        num_metrics++;
     }
 
-    // calculate a weighting using the reported speed accuracy
-    float spd_blend_weights[GPS_MAX_RECEIVERS] = {};
-    if (speed_accuracy_sum_sq > 0.0f && (_blend_mask & BLEND_MASK_USE_SPD_ACC)) {
-        // calculate the weights using the inverse of the variances
-        float sum_of_spd_weights = 0.0f;
-        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-            if (state[i].status >= GPS_OK_FIX_3D && state[i].speed_accuracy >= 0.001f) {
-                spd_blend_weights[i] = speed_accuracy_sum_sq / (state[i].speed_accuracy * state[i].speed_accuracy);
-                sum_of_spd_weights += spd_blend_weights[i];
-            }
-        }
-        // normalise the weights
-        if (sum_of_spd_weights > 0.0f) {
-            for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-                spd_blend_weights[i] = spd_blend_weights[i] / sum_of_spd_weights;
-            }
-            sum_of_all_weights += 1.0f;
-        }
+    // if we can't do blending using reported accuracy, return false and hard switch logic will be used instead
+    if (num_metrics == 0) {
+        return false;
     }
 
     // calculate an overall weight
+    const float scaler = 1.0f / num_metrics;
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-        _blend_weights[i] = (hpos_blend_weights[i] + vpos_blend_weights[i] + spd_blend_weights[i]) / sum_of_all_weights;
+        _blend_weights[i] *= scaler;
     }
 
     return true;
@@ -1402,13 +1491,22 @@ void AP_GPS::calc_blended_state(void)
         }
     }
 
+    // Calculate the horizontal offset of each receiver from the reference position once. These
+    // are reused below to find the offset from each receiver to the blended solution
+    Vector2f NE_offset_from_ref_m[GPS_MAX_RECEIVERS];
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (i != best_index && state[i].status >= GPS_OK_FIX_2D) {
+            NE_offset_from_ref_m[i] = location_diff(state[GPS_BLENDED_INSTANCE].location, state[i].location);
+        }
+    }
+
     // Calculate the weighted sum of horizontal and vertical position offsets relative to the reference position
     Vector2f blended_NE_offset_m;
     float blended_alt_offset_cm = 0.0f;
     blended_NE_offset_m.zero();
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         if (_blend_weights[i] > 0.0f && i != best_index) {
-            blended_NE_offset_m += location_diff(state[GPS_BLENDED_INSTANCE].location, state[i].location) * _blend_weights[i];
+            blended_NE_offset_m += NE_offset_from_ref_m[i] * _blend_weights[i];
             blended_alt_offset_cm += (float)(state[i].location.alt - state[GPS_BLENDED_INSTANCE].location.alt) * _blend_weights[i];
         }
     }
@@ -1443,9 +1541,16 @@ void AP_GPS::calc_blended_state(void)
         }
     }
 
-    // Calculate the offset from each GPS solution to the blended solution
+    // Calculate the offset from each GPS solution to the blended solution. Receivers without a fix
+    // keep the full location_diff() as they may be a long way from the reference position
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-        _NE_pos_offset_m[i] = location_diff(state[i].location, state[GPS_BLENDED_INSTANCE].location) * alpha[i] + _NE_pos_offset_m[i] * (1.0f - alpha[i]);
+        Vector2f NE_offset_to_blend_m;
+        if (i == best_index || state[i].status >= GPS_OK_FIX_2D) {
+            NE_offset_to_blend_m = blended_NE_offset_m - NE_offset_from_ref_m[i];
+        } else {
+            NE_offset_to_blend_m = location_diff(state[i].location, state[GPS_BLENDED_INSTANCE].location);
+        }
+        _NE_pos_offset_m[i] = NE_offset_to_blend_m * alpha[i] + _NE_pos_offset_m[i] * (1.0f - alpha[i]);
         _hgt_offset_cm[i] = (float)(state[GPS_BLENDED_INSTANCE].location.alt - state[i].location.alt) *  alpha[i] + _hgt_offset_cm[i] * (1.0f - alpha[i]);
     }
 
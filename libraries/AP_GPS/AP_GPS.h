@@ -27,9 +27,14 @@
    maximum number of GPS instances available on this platform. If more
    than 1 then redundant sensors may be available
  */
+#ifndef GPS_MAX_RECEIVERS
 #define GPS_MAX_RECEIVERS 2 // maximum number of physical GPS sensors allowed - does not include virtual GPS created by blending receiver data
+#endif
+#if GPS_MAX_RECEIVERS < 2 || GPS_MAX_RECEIVERS > 4
+#error "GPS_MAX_RECEIVERS must be between 2 and 4"
+#endif
 #define GPS_MAX_INSTANCES  (GPS_MAX_RECEIVERS + 1) // maximum number of GPs instances including the 'virtual' GPS created by blending receiver data
-#define GPS_BLENDED_INSTANCE GPS_MAX_RECEIVERS  // the virtual blended GPS is always the highest instance (2)
+#define GPS_BLENDED_INSTANCE GPS_MAX_RECEIVERS  // the virtual blended GPS is always the highest instance
 #define GPS_RTK_INJECT_TO_ALL 127
 #define GPS_MAX_RATE_MS 200 // maximum value of rate_ms (i.e. slowest update rate) is 5hz or 200ms
 #define GPS_UNKNOWN_DOP UINT16_MAX // set unknown DOP's to maximum value, which is also correct for MAVLink
@@ -62,6 +67,7 @@ class AP_GPS
     friend class AP_GPS_SIRF;
     friend class AP_GPS_UBLOX;
     friend class AP_GPS_Backend;
+    friend class AP_GPS_Test;
 
 public:
     AP_GPS();
@@ -468,13 +474,13 @@ private:
     AP_HAL::UARTDriver *_port[GPS_MAX_RECEIVERS];
 
     /// primary GPS instance
-    uint8_t primary_instance:2;
+    uint8_t primary_instance:3;
 
     /// number of GPS instances present
-    uint8_t num_instances:2;
+    uint8_t num_instances:3;
 
     // which ports are locked
-    uint8_t locked_ports:2;
+    uint8_t locked_ports:GPS_MAX_RECEIVERS;
 
     // state of auto-detection process, per instance
     struct detect_state {
@@ -548,6 +554,9 @@ private:
     // calculate the blend weight.  Returns true if blend could be calculated, false if not
     bool calc_blend_weights(void);
 
+    // accumulate normalised inverse variance weights for one accuracy metric into weights[]
+    static bool add_blend_weights(const float variance[GPS_MAX_RECEIVERS], float weights[GPS_MAX_RECEIVERS]);
+
     // calculate the blended state
     void calc_blended_state(void);
 
@@ -0,0 +1,150 @@
+#include <AP_gtest.h>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/GPS_Backend.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+// a receiver that never produces data, so the test controls its state
+class GPS_Backend_Stub : public AP_GPS_Backend
+{
+public:
+    GPS_Backend_Stub(AP_GPS &gps, AP_GPS::GPS_State &state) :
+        AP_GPS_Backend(gps, state, nullptr) { }
+
+    bool read() override { return false; }
+    const char *name() const override { return "Stub"; }
+};
+
+// AP_GPS is a singleton, so every test shares this one
+static AP_GPS gps;
+
+class AP_GPS_Test
+{
+public:
+    AP_GPS_Test()
+    {
+        for (uint8_t i = 0; i < GPS_MAX_RECEIVERS; i++) {
+            gps.drivers[i] = new GPS_Backend_Stub(gps, gps.state[i]);
+            gps._type[i].set(AP_GPS::GPS_TYPE_AUTO);
+        }
+        gps.num_instances = GPS_MAX_RECEIVERS;
+        // horizontal position accuracy only
+        gps._blend_mask.set(1);
+    }
+
+    ~AP_GPS_Test()
+    {
+        for (uint8_t i = 0; i < GPS_MAX_RECEIVERS; i++) {
+            delete gps.drivers[i];
+            gps.drivers[i] = nullptr;
+            gps.state[i] = {};
+        }
+        gps.num_instances = 0;
+    }
+
+    // a 3D fix with the given horizontal accuracy, a negative accuracy is not reported
+    void set_receiver(uint8_t instance, float horizontal_accuracy)
+    {
+        AP_GPS::GPS_State &s = gps.state[instance];
+        s.status = AP_GPS::GPS_OK_FIX_3D;
+        s.last_gps_time_ms = 1000;
+        s.have_horizontal_accuracy = horizontal_accuracy >= 0.0f;
+        s.horizontal_accuracy = MAX(horizontal_accuracy, 0.0f);
+    }
+
+    bool calc_blend_weights()
+    {
+        return gps.calc_blend_weights();
+    }
+
+    float weight(uint8_t instance) const
+    {
+        return gps._blend_weights[instance];
+    }
+
+    static bool add_blend_weights(const float variance[GPS_MAX_RECEIVERS], float weights[GPS_MAX_RECEIVERS])
+    {
+        return AP_GPS::add_blend_weights(variance, weights);
+    }
+};
+
+TEST(AP_GPS, add_blend_weights_inverse_variance)
+{
+    // receiver i has variance (i+1)^2
+    float variance[GPS_MAX_RECEIVERS];
+    float sum = 0.0f;
+    for (uint8_t i = 0; i < GPS_MAX_RECEIVERS; i++) {
+        variance[i] = sq(i + 1.0f);
+        sum += 1.0f / variance[i];
+    }
+
+    float weights[GPS_MAX_RECEIVERS] {};
+    ASSERT_TRUE(AP_GPS_Test::add_blend_weights(variance, weights));
+    float total = 0.0f;
+    for (uint8_t i = 0; i < GPS_MAX_RECEIVERS; i++) {
+        EXPECT_FLOAT_EQ((1.0f / variance[i]) / sum, weights[i]);
+        total += weights[i];
+    }
+    EXPECT_FLOAT_EQ(1.0f, total);
+
+    // weights accumulate over metrics
+    ASSERT_TRUE(AP_GPS_Test::add_blend_weights(variance, weights));
+    EXPECT_FLOAT_EQ(2.0f * (1.0f / variance[0]) / sum, weights[0]);
+}
+
+TEST(AP_GPS, add_blend_weights_zero_variance)
+{
+    // a zero variance leaves that receiver out
+    float variance[GPS_MAX_RECEIVERS] {};
+    variance[GPS_MAX_RECEIVERS-1] = 4.0f;
+    float weights[GPS_MAX_RECEIVERS] {};
+    ASSERT_TRUE(AP_GPS_Test::add_blend_weights(variance, weights));
+    for (uint8_t i = 0; i < GPS_MAX_RECEIVERS-1; i++) {
+        EXPECT_FLOAT_EQ(0.0f, weights[i]);
+    }
+    EXPECT_FLOAT_EQ(1.0f, weights[GPS_MAX_RECEIVERS-1]);
+
+    // no receiver reports the metric
+    float none[GPS_MAX_RECEIVERS] {};
+    float unused[GPS_MAX_RECEIVERS] {};
+    EXPECT_FALSE(AP_GPS_Test::add_blend_weights(none, unused));
+    EXPECT_FLOAT_EQ(0.0f, unused[0]);
+}
+
+TEST(AP_GPS, calc_blend_weights_all_receivers)
+{
+    AP_GPS_Test test;
+
+    float sum = 0.0f;
+    for (uint8_t i = 0; i < GPS_MAX_RECEIVERS; i++) {
+        test.set_receiver(i, i + 1.0f);
+        sum += 1.0f / sq(i + 1.0f);
+    }
+
+    ASSERT_TRUE(test.calc_blend_weights());
+    float total = 0.0f;
+    for (uint8_t i = 0; i < GPS_MAX_RECEIVERS; i++) {
+        EXPECT_FLOAT_EQ((1.0f / sq(i + 1.0f)) / sum, test.weight(i));
+        total += test.weight(i);
+    }
+    EXPECT_FLOAT_EQ(1.0f, total);
+}
+
+TEST(AP_GPS, calc_blend_weights_unreported_accuracy)
+{
+    AP_GPS_Test test;
+
+    // a receiver with a fix but no accuracy disables the metric
+    for (uint8_t i = 0; i < GPS_MAX_RECEIVERS; i++) {
+        test.set_receiver(i, i + 1.0f);
+    }
+    test.set_receiver(GPS_MAX_RECEIVERS-1, -1.0f);
+
+    EXPECT_FALSE(test.calc_blend_weights());
+    for (uint8_t i = 0; i < GPS_MAX_RECEIVERS; i++) {
+        EXPECT_FLOAT_EQ(0.0f, test.weight(i));
+    }
+}
+
+AP_GTEST_MAIN()
@@ -51,6 +51,7 @@ bool AP_HAL::Device::setup_checked_registers(uint8_t nregs, uint8_t frequency)
     _checked.n_allocated = nregs;
     _checked.frequency = frequency;
     _checked.counter = 0;
+    _checked.queued = false;
     return true;
 }
 
@@ -94,7 +95,13 @@ bool AP_HAL::Device::check_next_register(void)
 
     struct checkreg &reg = _checked.regs[_checked.next];
     uint8_t v;
-    if (!read_registers(reg.regnum, &v, 1) || v != reg.value) {
+    return _check_register_value(read_registers(reg.regnum, &v, 1), v);
+}
+
+bool AP_HAL::Device::_check_register_value(bool read_ok, uint8_t v)
+{
+    struct checkreg &reg = _checked.regs[_checked.next];
+    if (!read_ok || v != reg.value) {
         // a register has changed value unexpectedly. Try changing it back
         // and re-check it next time
 #if 0
@@ -108,3 +115,113 @@ bool AP_HAL::Device::check_next_register(void)
     _checked.next = (_checked.next+1) % _checked.n_set;
     return true;
 }
+
+/*
+  queue a transfer for submit_queued()
+ */
+bool AP_HAL::Device::queue_transfer(const uint8_t *send, uint32_t send_len,
+                                    uint8_t *recv, uint32_t recv_len)
+{
+    if (_queue == nullptr) {
+        _queue = new struct QueuedTransfer[HAL_DEVICE_QUEUE_LEN];
+        if (_queue == nullptr) {
+            return false;
+        }
+    }
+    if (_queue_len == HAL_DEVICE_QUEUE_LEN) {
+        return false;
+    }
+    struct QueuedTransfer &t = _queue[_queue_len++];
+    t.send = send;
+    t.send_len = send_len;
+    t.recv = recv;
+    t.recv_len = recv_len;
+    t.speed = -1;
+    return true;
+}
+
+bool AP_HAL::Device::queue_read_registers(uint8_t first_reg, uint8_t *recv, uint32_t recv_len)
+{
+    if (!queue_transfer(nullptr, 1, recv, recv_len)) {
+        return false;
+    }
+    // the register is kept in the queue so the caller need not
+    struct QueuedTransfer &t = _queue[_queue_len-1];
+    t.buf[0] = first_reg | _read_flag;
+    t.send = t.buf;
+    return true;
+}
+
+bool AP_HAL::Device::queue_write_register(uint8_t reg, uint8_t val, bool checked)
+{
+    if (!queue_transfer(nullptr, 2, nullptr, 0)) {
+        return false;
+    }
+    struct QueuedTransfer &t = _queue[_queue_len-1];
+    t.buf[0] = reg;
+    t.buf[1] = val;
+    t.send = t.buf;
+    if (checked) {
+        set_checked_register(reg, val);
+    }
+    return true;
+}
+
+bool AP_HAL::Device::queue_set_speed(Speed speed)
+{
+    if (!queue_transfer(nullptr, 0, nullptr, 0)) {
+        return false;
+    }
+    _queue[_queue_len-1].speed = speed;
+    return true;
+}
+
+/*
+  queue the read for the next register check, if one is due
+ */
+bool AP_HAL::Device::queue_check_next_register(void)
+{
+    if (_checked.n_set == 0 || _checked.queued) {
+        return true;
+    }
+    if (_checked.counter+1 < _checked.frequency) {
+        _checked.counter++;
+        return true;
+    }
+    if (!queue_read_registers(_checked.regs[_checked.next].regnum, &_checked.value, 1)) {
+        return false;
+    }
+    _checked.counter = 0;
+    _checked.queued = true;
+    return true;
+}
+
+bool AP_HAL::Device::check_queued_register(bool read_ok)
+{
+    if (!_checked.queued) {
+        return true;
+    }
+    _checked.queued = false;
+    return _check_register_value(read_ok, _checked.value);
+}
+
+/*
+  do the queued transfers one at a time
+ */
+bool AP_HAL::Device::submit_queued(TransferCb cb)
+{
+    bool ret = true;
+    for (uint8_t i=0; i<_queue_len && ret; i++) {
+        const struct QueuedTransfer &t = _queue[i];
+        if (t.speed >= 0) {
+            ret = set_speed((Speed)t.speed);
+            continue;
+        }
+        ret = transfer(t.send, t.send_len, t.recv, t.recv_len);
+    }
+    _queue_len = 0;
+    if (cb) {
+        cb(ret);
+    }
+    return ret;
+}
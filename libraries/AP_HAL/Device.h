@@ -21,6 +21,11 @@
 #include "AP_HAL_Namespace.h"
 #include "utility/functor.h"
 
+// maximum number of transfers waiting for submit_queued()
+#ifndef HAL_DEVICE_QUEUE_LEN
+#define HAL_DEVICE_QUEUE_LEN 8
+#endif
+
 /*
  * This is an interface abstracting I2C and SPI devices
  */
@@ -41,6 +46,8 @@ public:
     FUNCTOR_TYPEDEF(PeriodicCb, void);
     typedef void* PeriodicHandle;
 
+    FUNCTOR_TYPEDEF(TransferCb, void, bool);
+
     Device(enum BusType type)
     {
         _bus_id.devid_s.bus_type = type;
@@ -76,6 +83,7 @@ public:
         if (_checked.regs != nullptr) {
             delete[] _checked.regs;
         }
+        delete[] _queue;
     }
 
     /*
@@ -125,6 +133,66 @@ public:
         return transfer(buf, sizeof(buf), nullptr, 0);
     }
 
+    /**
+     * Queue a transfer to be done by the next #submit_queued(), as a bus
+     * transaction of its own like with #transfer(). The buffers must stay
+     * valid until the queue is submitted.
+     *
+     * Return: false if the queue is full.
+     */
+    bool queue_transfer(const uint8_t *send, uint32_t send_len,
+                        uint8_t *recv, uint32_t recv_len);
+
+    /**
+     * Queue a read of registers, see #read_registers().
+     */
+    bool queue_read_registers(uint8_t first_reg, uint8_t *recv, uint32_t recv_len);
+
+    /**
+     * Queue a register write, see #write_register().
+     */
+    bool queue_write_register(uint8_t reg, uint8_t val, bool checked=false);
+
+    /**
+     * Queue a change of bus speed for the transfers queued after it, see
+     * #set_speed(). The speed stays in effect after the queue is submitted.
+     */
+    bool queue_set_speed(Speed speed);
+
+    /**
+     * Queue the read for the next register check, if one is due, see
+     * #check_next_register(). Once the queue is submitted the check is
+     * completed with #check_queued_register().
+     *
+     * Return: false if the queue is full.
+     */
+    bool queue_check_next_register(void);
+
+    /**
+     * Complete a register check queued by #queue_check_next_register().
+     * read_ok is the result of #submit_queued(). Return false if the value
+     * read was incorrect, as #check_next_register() does. Does nothing if
+     * no check was queued.
+     */
+    bool check_queued_register(bool read_ok);
+
+    /**
+     * Do the queued transfers in order and empty the queue, then call cb,
+     * if any, with the result. Buses that can do so submit all of them in a
+     * single request; by default #transfer() is called for each of them,
+     * stopping at the first failure.
+     *
+     * Return: true if all the transfers succeeded.
+     */
+    virtual bool submit_queued(TransferCb cb = nullptr);
+
+    /**
+     * Return true if #submit_queued() does all the queued transfers in a
+     * single request, so that queueing saves bus requests rather than
+     * only grouping them.
+     */
+    virtual bool queued_in_single_request() const { return false; }
+
     /**
      * set a value for a checked register
      */
@@ -286,6 +354,18 @@ protected:
         _bus_id.devid_s.bus = bus;
     }
 
+    // transfers waiting for submit_queued()
+    struct QueuedTransfer {
+        const uint8_t *send;
+        uint32_t send_len;
+        uint8_t *recv;
+        uint32_t recv_len;
+        uint8_t buf[2];     // register and value of queued register accesses
+        int8_t speed;       // speed to switch to, instead of a transfer, or -1
+    };
+    struct QueuedTransfer *_queue = nullptr;    // allocated on first use
+    uint8_t _queue_len = 0;
+
 private:
     // checked registers
     struct checkreg {
@@ -298,6 +378,11 @@ private:
         uint8_t next;
         uint8_t frequency;
         uint8_t counter;
+        bool queued;        // a check has been queued and not completed
+        uint8_t value;      // value read by the queued check
         struct checkreg *regs;
-    } _checked;
+    } _checked {};
+
+    // compare the value read for the next checked register and fix it if wrong
+    bool _check_register_value(bool read_ok, uint8_t v);
 };
@@ -58,4 +58,25 @@ public:
 
     virtual void create_uavcan_thread() {};
 
+    /*
+      scheduling of a HAL thread, for logging
+     */
+    struct thread_stats {
+        const char *name;
+        int16_t cpu;            // CPU it last ran on, -1 if unknown
+        uint32_t run_ms;        // time spent running since it started
+        uint32_t wait_ms;       // time spent waiting for a CPU since it started
+        uint32_t preemptions;   // times it was preempted since it started
+        uint32_t wakeups;       // periods run since the previous call
+        uint32_t max_late_us;   // worst wakeup lateness since the previous call
+        uint32_t avg_late_us;   // average wakeup lateness since the previous call
+    };
+
+    /*
+      optional function to get the scheduling of the HAL thread at
+      index. Returns false when there is no such thread. This may need
+      file access so should only be called from an IO process
+     */
+    virtual bool get_thread_stats(uint8_t index, thread_stats &stats) { return false; }
+
 };
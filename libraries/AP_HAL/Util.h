@@ -103,6 +103,10 @@ public:
     virtual void perf_end(perf_counter_t h) {}
     virtual void perf_count(perf_counter_t h) {}
 
+    // record that a traced sensor sample has reached a stage of the
+    // control loop, see AP::LatencyTrace
+    virtual void perf_trace(uint16_t trace_id, uint8_t stage) {}
+
     // create a new semaphore
     virtual Semaphore *new_semaphore(void) { return nullptr; }
 
@@ -412,6 +412,11 @@
 #define HAL_LINUX_UARTS_ON_TIMER_THREAD 0
 #endif
 
+// collect wait and hold times of the scheduler and bus semaphores
+#ifndef HAL_LINUX_SEMAPHORE_STATS
+#define HAL_LINUX_SEMAPHORE_STATS 0
+#endif
+
 #ifndef HAL_OPTFLOW_PX4FLOW_I2C_ADDRESS
 #define HAL_OPTFLOW_PX4FLOW_I2C_ADDRESS 0x42
 #endif
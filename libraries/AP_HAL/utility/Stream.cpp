@@ -0,0 +1,14 @@
+#include "Stream.h"
+
+ssize_t AP_HAL::Stream::read(uint8_t *buffer, uint16_t count)
+{
+    uint16_t offset = 0;
+    while (offset < count) {
+        const int16_t c = read();
+        if (c == -1) {
+            break;
+        }
+        buffer[offset++] = (uint8_t)c;
+    }
+    return offset;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <sys/types.h>
+
 #include <AP_HAL/AP_HAL_Namespace.h>
 #include "Print.h"
 
@@ -17,4 +19,8 @@ public:
      * -1 if nothing available, uint8_t value otherwise. */
     virtual int16_t read() = 0;
 
+    /* read up to count bytes into buffer, returning the number of bytes
+     * read. The default implementation reads them one at a time */
+    virtual ssize_t read(uint8_t *buffer, uint16_t count);
+
 };
@@ -0,0 +1,346 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BusScheduler.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+#include "Perf.h"
+#include "Scheduler.h"
+
+/* Longest sleep, so new callbacks and stop() are noticed */
+#define BUS_SCHEDULER_MAX_SLEEP_USEC 10000
+
+/* Most callbacks of one device run in a row after its first */
+#define BUS_SCHEDULER_MAX_BATCH 4
+
+extern const AP_HAL::HAL &hal;
+
+namespace Linux {
+
+BusScheduler::~BusScheduler()
+{
+    for (Callback *c : _callbacks) {
+        delete c;
+    }
+}
+
+uint64_t BusScheduler::now_usec()
+{
+    return AP_HAL::micros64();
+}
+
+AP_HAL::Device::PeriodicHandle BusScheduler::add(PeriodicCb cb,
+                                                 uint32_t period_usec,
+                                                 uint32_t device_id)
+{
+    if (period_usec == 0) {
+        return nullptr;
+    }
+
+    Callback *c = new Callback;
+    if (!c) {
+        return nullptr;
+    }
+
+    const uint64_t now = now_usec();
+
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    auto it = std::find_if(_devices.begin(), _devices.end(),
+                           [device_id](const DeviceStats &d) { return d.device_id == device_id; });
+    if (it == _devices.end()) {
+        if (_devices.size() > UINT8_MAX) {
+            _sem.give();
+            delete c;
+            return nullptr;
+        }
+        DeviceStats stats = { };
+        stats.device_id = device_id;
+        it = _devices.insert(_devices.end(), stats);
+        _perf.push_back(_add_perf(device_id));
+    }
+    if (_callbacks.empty()) {
+        _stats_start_usec = now;
+        _last_debug_usec = now;
+    }
+
+    c->cb = cb;
+    c->period_usec = period_usec;
+    c->deadline_usec = now + period_usec;
+    c->run_usec = 0;
+    c->device = it - _devices.begin();
+    _callbacks.push_back(c);
+
+    _sem.give();
+
+    return static_cast<AP_HAL::Device::PeriodicHandle>(c);
+}
+
+bool BusScheduler::adjust(AP_HAL::Device::PeriodicHandle h, uint32_t period_usec)
+{
+    if (period_usec == 0) {
+        return false;
+    }
+
+    const uint64_t now = now_usec();
+    bool ret = false;
+
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    /* Make sure the handle points to a valid callback */
+    auto it = std::find(_callbacks.begin(), _callbacks.end(), static_cast<Callback*>(h));
+    if (it != _callbacks.end()) {
+        (*it)->period_usec = period_usec;
+        (*it)->deadline_usec = now + period_usec;
+        ret = true;
+    }
+
+    _sem.give();
+
+    return ret;
+}
+
+BusScheduler::DevicePerf BusScheduler::_add_perf(uint32_t device_id)
+{
+    Perf *perf = Perf::get_instance();
+    DevicePerf counters;
+    char name[32];
+
+    snprintf(name, sizeof(name), "bus_%08x", device_id);
+    counters.run = perf->add(AP_HAL::Util::PC_ELAPSED, strdup(name));
+    snprintf(name, sizeof(name), "bus_%08x_batched", device_id);
+    counters.batched = perf->add(AP_HAL::Util::PC_COUNT, strdup(name));
+    snprintf(name, sizeof(name), "bus_%08x_missed", device_id);
+    counters.missed = perf->add(AP_HAL::Util::PC_COUNT, strdup(name));
+
+    return counters;
+}
+
+/*
+ * Earliest deadline first among the callbacks that are due, preferring the
+ * device that just used the bus as long as the earliest callback of the
+ * other devices can still run within its period. Must be called with _sem
+ * taken.
+ */
+BusScheduler::Callback *BusScheduler::_next_due(uint64_t now, bool &batched)
+{
+    Callback *earliest = nullptr;
+    Callback *same_device = nullptr;
+
+    for (Callback *c : _callbacks) {
+        if (c->deadline_usec > now) {
+            continue;
+        }
+        if (!earliest || c->deadline_usec < earliest->deadline_usec) {
+            earliest = c;
+        }
+        if (c->device == _last_device &&
+            (!same_device || c->deadline_usec < same_device->deadline_usec)) {
+            same_device = c;
+        }
+    }
+
+    batched = same_device != nullptr;
+    if (!batched || same_device == earliest) {
+        return earliest;
+    }
+
+    if (_batch_count >= BUS_SCHEDULER_MAX_BATCH ||
+        now + same_device->run_usec + earliest->run_usec >
+        earliest->deadline_usec + earliest->period_usec) {
+        batched = false;
+        return earliest;
+    }
+
+    return same_device;
+}
+
+uint64_t BusScheduler::run_due()
+{
+    while (!_should_exit) {
+        uint64_t now = now_usec();
+        bool batched;
+
+        _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+        Callback *c = _next_due(now, batched);
+        if (!c) {
+            uint64_t next_deadline = 0;
+            for (Callback *p : _callbacks) {
+                if (next_deadline == 0 || p->deadline_usec < next_deadline) {
+                    next_deadline = p->deadline_usec;
+                }
+            }
+            /* The bus goes idle, nothing is gained from keeping the device */
+            _last_device = -1;
+            _batch_count = 0;
+            _sem.give();
+            return next_deadline;
+        }
+
+        /* Skip the periods that have already passed, keeping the phase */
+        const uint32_t missed = (now - c->deadline_usec) / c->period_usec;
+        c->deadline_usec += (uint64_t)(missed + 1) * c->period_usec;
+
+        PeriodicCb cb = c->cb;
+        const uint8_t device = c->device;
+        const DevicePerf perf = _perf[device];
+
+        _sem.give();
+
+        if (_wrapper) {
+            _wrapper->start_cb();
+        }
+
+        Perf::get_instance()->begin(perf.run);
+        const uint64_t start = now_usec();
+        cb();
+        now = now_usec();
+        Perf::get_instance()->end(perf.run);
+
+        if (_wrapper) {
+            _wrapper->end_cb();
+        }
+
+        const uint32_t busy = now - start;
+
+        if (batched) {
+            Perf::get_instance()->count(perf.batched);
+        }
+        for (uint32_t i = 0; i < missed; i++) {
+            Perf::get_instance()->count(perf.missed);
+        }
+
+        _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+        /* Callbacks are never removed, so c is still valid */
+        c->run_usec = busy;
+
+        DeviceStats &stats = _devices[device];
+        stats.runs++;
+        stats.batched += batched;
+        stats.missed += missed;
+        stats.busy_usec += busy;
+        if (busy > stats.max_usec) {
+            stats.max_usec = busy;
+        }
+        _batch_count = batched ? _batch_count + 1 : 0;
+        _last_device = device;
+
+        _sem.give();
+    }
+
+    return 0;
+}
+
+bool BusScheduler::get_device_stats(uint8_t n, DeviceStats &stats)
+{
+    bool ret = false;
+
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    if (n < _devices.size()) {
+        stats = _devices[n];
+        ret = true;
+    }
+    _sem.give();
+
+    return ret;
+}
+
+float BusScheduler::get_utilization(const DeviceStats &stats)
+{
+    const uint64_t elapsed = now_usec() - _stats_start_usec;
+    if (elapsed == 0) {
+        return 0.0f;
+    }
+    return (float)stats.busy_usec / elapsed;
+}
+
+void BusScheduler::reset_stats()
+{
+    const uint64_t now = now_usec();
+
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    for (DeviceStats &stats : _devices) {
+        const uint32_t device_id = stats.device_id;
+        stats = { };
+        stats.device_id = device_id;
+    }
+    _stats_start_usec = now;
+    _sem.give();
+}
+
+void BusScheduler::_debug_stats()
+{
+#ifdef DEBUG_BUS_SCHEDULER
+    const uint64_t now = now_usec();
+
+    if (now - _last_debug_usec < 5000000) {
+        return;
+    }
+    _last_debug_usec = now;
+
+    fprintf(stderr, "\n");
+    for (uint8_t i = 0; ; i++) {
+        DeviceStats stats;
+        if (!get_device_stats(i, stats)) {
+            break;
+        }
+        fprintf(stderr, "0x%08x\truns %u\tbatched %u\tmissed %u\tmax %uus\tutil %.1f%%\n",
+                stats.device_id, stats.runs, stats.batched, stats.missed,
+                stats.max_usec, get_utilization(stats) * 100.0f);
+    }
+    reset_stats();
+#endif
+}
+
+void BusScheduler::mainloop()
+{
+    while (!_should_exit) {
+        const uint64_t next_deadline = run_due();
+
+        _debug_stats();
+
+        uint64_t sleep_usec = BUS_SCHEDULER_MAX_SLEEP_USEC;
+        const uint64_t now = now_usec();
+        if (next_deadline != 0) {
+            sleep_usec = next_deadline > now ? MIN(next_deadline - now, sleep_usec) : 0;
+        }
+        if (sleep_usec > 0) {
+            Scheduler::from(hal.scheduler)->microsleep(sleep_usec);
+        }
+    }
+
+    _started = false;
+    _should_exit = false;
+}
+
+bool BusScheduler::stop()
+{
+    if (!is_started()) {
+        return false;
+    }
+
+    _should_exit = true;
+
+    return true;
+}
+
+}
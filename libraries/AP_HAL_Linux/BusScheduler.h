@@ -0,0 +1,141 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <AP_HAL/Device.h>
+
+#include "PollerThread.h"
+#include "Semaphores.h"
+#include "Thread.h"
+
+namespace Linux {
+
+/*
+ * Thread running the periodic callbacks of all devices on a bus.
+ *
+ * The callback with the earliest deadline runs first, except that once a
+ * device has the bus, its other callbacks that are already due run
+ * straight after it so its transfers go back to back. A device keeps the
+ * bus only while the earliest callback of the other devices can still run
+ * within its period afterwards, judged by the last bus time of both, and
+ * for at most BUS_SCHEDULER_MAX_BATCH callbacks in a row. Periods that
+ * pass completely before a callback gets to run are counted as missed and
+ * skipped, keeping the callback's phase. The bus time of each callback is
+ * accounted to its device, giving the bus utilization per device, and
+ * recorded in perf counters named after the device id.
+ */
+class BusScheduler : public Thread {
+public:
+    using PeriodicCb = AP_HAL::Device::PeriodicCb;
+
+    /* Bus time and deadlines of one device since the last reset_stats() */
+    struct DeviceStats {
+        uint32_t device_id;
+        uint32_t runs;          // callbacks run
+        uint32_t batched;       // callbacks run straight after another of the same device
+        uint32_t missed;        // periods skipped because the callback was too late
+        uint32_t max_usec;      // longest bus time of one callback
+        uint64_t busy_usec;     // total bus time
+    };
+
+    /*
+     * @wrapper is called around each callback, usually to take the bus
+     * semaphore
+     */
+    BusScheduler(TimerPollable::WrapperCb *wrapper)
+        : Thread{FUNCTOR_BIND_MEMBER(&BusScheduler::mainloop, void)}
+        , _wrapper(wrapper)
+    { }
+
+    virtual ~BusScheduler();
+
+    /*
+     * Add a callback run every @period_usec for the device @device_id,
+     * starting one period from now. Returns nullptr on failure.
+     */
+    AP_HAL::Device::PeriodicHandle add(PeriodicCb cb, uint32_t period_usec,
+                                       uint32_t device_id);
+
+    /* Change the period of a callback from its next run */
+    bool adjust(AP_HAL::Device::PeriodicHandle h, uint32_t period_usec);
+
+    /*
+     * Run callbacks that are due until none are left. Returns the time of
+     * the next deadline, or zero if there are no callbacks.
+     */
+    uint64_t run_due();
+
+    /* Statistics of the n-th device to register a callback */
+    bool get_device_stats(uint8_t n, DeviceStats &stats);
+
+    /* Fraction of the time since the last reset the device held the bus */
+    float get_utilization(const DeviceStats &stats);
+
+    void reset_stats();
+
+    void mainloop();
+
+    bool stop() override;
+
+protected:
+    /* Time source, overridden to run against a simulated bus */
+    virtual uint64_t now_usec();
+
+private:
+    struct Callback {
+        PeriodicCb cb;
+        uint32_t period_usec;
+        uint64_t deadline_usec;
+        uint32_t run_usec;      // bus time of the last run
+        uint8_t device;         // index into _devices
+    };
+
+    /* Perf counters of one device, in the same order as _devices */
+    struct DevicePerf {
+        AP_HAL::Util::perf_counter_t run;
+        AP_HAL::Util::perf_counter_t batched;
+        AP_HAL::Util::perf_counter_t missed;
+    };
+
+    DevicePerf _add_perf(uint32_t device_id);
+
+    /* Pick the next callback to run, or nullptr if none are due */
+    Callback *_next_due(uint64_t now, bool &batched);
+
+    void _debug_stats();
+
+    TimerPollable::WrapperCb *_wrapper;
+
+    /* protects the callback and device lists, not held while running callbacks */
+    Semaphore _sem;
+
+    std::vector<Callback*> _callbacks;
+    std::vector<DeviceStats> _devices;
+    std::vector<DevicePerf> _perf;
+
+    /* device whose callback ran last, if any */
+    int16_t _last_device = -1;
+
+    /* callbacks of _last_device run in a row after its first */
+    uint8_t _batch_count = 0;
+
+    uint64_t _stats_start_usec = 0;
+    uint64_t _last_debug_usec = 0;
+};
+
+}
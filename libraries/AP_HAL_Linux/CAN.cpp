@@ -33,13 +33,16 @@
 
 #include <AP_UAVCAN/AP_UAVCAN.h>
 
+#include <algorithm>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
 
 #include <sys/socket.h>
 #include <sys/ioctl.h>
 #include <net/if.h>
 #include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -81,6 +84,31 @@ static uavcan::CanFrame makeUavcanFrame(const can_frame& sockcan_frame)
     return uavcan_frame;
 }
 
+CAN::CAN(int socket_fd)
+    : _fd(socket_fd)
+    , _max_frames_in_socket_tx_queue(CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE)
+    , _frames_in_socket_tx_queue(0)
+    , _tx_frame_counter(0)
+    , _rx_queue(CAN_RX_QUEUE_SIZE)
+    , _rx_batch()
+    , _tx_batch()
+{
+    for (unsigned i = 0; i < CAN_RX_BATCH_SIZE; i++) {
+        _rx_batch.iovs[i].iov_base = &_rx_batch.frames[i];
+        _rx_batch.iovs[i].iov_len = sizeof(can_frame);
+        _rx_batch.msgs[i].msg_hdr.msg_iov = &_rx_batch.iovs[i];
+        _rx_batch.msgs[i].msg_hdr.msg_iovlen = 1;
+        _rx_batch.msgs[i].msg_hdr.msg_control = _rx_batch.control[i];
+    }
+
+    for (unsigned i = 0; i < CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE; i++) {
+        _tx_batch.iovs[i].iov_base = &_tx_batch.frames[i];
+        _tx_batch.iovs[i].iov_len = sizeof(can_frame);
+        _tx_batch.msgs[i].msg_hdr.msg_iov = &_tx_batch.iovs[i];
+        _tx_batch.msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
 bool CAN::begin(uint32_t bitrate)
 {
     if (_initialized) return _initialized;
@@ -126,7 +154,7 @@ int32_t CAN::tx_pending()
 int32_t CAN::available()
 {
     if (_initialized) {
-        return _rx_queue.size();
+        return _rx_queue.available();
     } else {
         return -1;
     }
@@ -168,8 +196,11 @@ int CAN::openSocket(const std::string& iface_name)
     // Configure
     {
         const int on = 1;
-        // Timestamping
-        if (setsockopt(s, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) < 0) {
+        // Timestamping, preferably when the kernel gets the frame from the
+        // driver rather than when it is queued to the socket
+        const int ts_flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (setsockopt(s, SOL_SOCKET, SO_TIMESTAMPING, &ts_flags, sizeof(ts_flags)) < 0 &&
+            setsockopt(s, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) < 0) {
             return -1;
         }
         // Socket loopback
@@ -211,18 +242,15 @@ int16_t CAN::receive(uavcan::CanFrame& out_frame, uavcan::MonotonicTime& out_ts_
 {
     if (_rx_queue.empty()) {
         _pollRead();            // This allows to use the socket not calling poll() explicitly.
-        if (_rx_queue.empty()) {
-            return 0;
-        }
     }
-    {
-        const RxItem& rx = _rx_queue.front();
-        out_frame        = rx.frame;
-        out_ts_monotonic = rx.ts_mono;
-        out_ts_utc       = rx.ts_utc;
-        out_flags        = rx.flags;
+    RxItem rx;
+    if (!_rx_queue.pop(rx)) {
+        return 0;
     }
-    _rx_queue.pop();
+    out_frame        = rx.frame;
+    out_ts_monotonic = rx.ts_mono;
+    out_ts_utc       = rx.ts_utc;
+    out_flags        = rx.flags;
     return 1;
 }
 
@@ -293,40 +321,92 @@ uint64_t CAN::getErrorCount() const
 void CAN::_pollWrite()
 {
     while (hasReadyTx()) {
-        const TxItem tx = _tx_queue.top();
+        // Take as many frames as may be in flight and write them at once
+        const uavcan::MonotonicTime now = getMonotonic();
+        unsigned n = 0;
+        while (n < _max_frames_in_socket_tx_queue - _frames_in_socket_tx_queue && !_tx_queue.empty()) {
+            const TxItem& tx = _tx_queue.top();
+            if (tx.deadline >= now) {
+                _tx_batch.items[n] = tx;
+                _tx_batch.frames[n] = makeSocketCanFrame(tx.frame);
+                n++;
+            } else {
+                _registerError(SocketCanError::TxTimeout);
+            }
+            _tx_queue.pop();
+        }
+        if (n == 0) {
+            break;
+        }
 
-        if (tx.deadline >= getMonotonic()) {
-            const int res = _write(tx.frame);
-            if (res == 1) {                   // Transmitted successfully
+        const int res = _write(n);
+        unsigned sent = 0;
+        if (res > 0) {                        // Transmitted successfully
+            sent = res;
+            for (unsigned i = 0; i < sent; i++) {
                 _incrementNumFramesInSocketTxQueue();
-                if (tx.flags & uavcan::CanIOFlagLoopback) {
-                    _pending_loopback_ids.insert(tx.frame.id);
+                if (_tx_batch.items[i].flags & uavcan::CanIOFlagLoopback) {
+                    _pending_loopback_ids.insert(_tx_batch.items[i].frame.id);
                 }
-            } else if (res == 0) {            // Not transmitted, nor is it an error
-                break;                        // Leaving the loop, the frame remains enqueued for the next retry
-            } else {                          // Transmission error
-                _registerError(SocketCanError::SocketWriteFailure);
             }
-        } else {
-            _registerError(SocketCanError::TxTimeout);
+        } else if (res < 0) {                 // Transmission error
+            // Removing the frame from the queue even if transmission failed
+            _registerError(SocketCanError::SocketWriteFailure);
+            sent = 1;
         }
 
-        // Removing the frame from the queue even if transmission failed
-        _tx_queue.pop();
+        // The frames that weren't written remain enqueued for the next retry
+        for (unsigned i = sent; i < n; i++) {
+            _tx_queue.push(_tx_batch.items[i]);
+        }
+        if (sent < n) {
+            break;
+        }
     }
 }
 
 void CAN::_pollRead()
 {
-    uint8_t iterations_count = 0;
-    while (iterations_count < CAN_MAX_POLL_ITERATIONS_COUNT)
-    {
-        iterations_count++;
-        RxItem rx;
-        rx.ts_mono = getMonotonic();  // Monotonic timestamp is not required to be precise (unlike UTC)
-        bool loopback = false;
-        const int res = _read(rx.frame, rx.ts_utc, loopback);
-        if (res == 1) {
+    // Monotonic timestamps are derived from the kernel UTC timestamps,
+    // so they don't include the time frames waited to be read
+    struct timespec now_utc;
+    clock_gettime(CLOCK_REALTIME, &now_utc);
+    const uint64_t now_utc_usec = uint64_t(now_utc.tv_sec) * 1000000ULL + now_utc.tv_nsec / 1000;
+    const uint64_t now_mono_usec = AP_HAL::micros64();
+
+    unsigned frames_count = 0;
+    while (frames_count < CAN_MAX_POLL_ITERATIONS_COUNT) {
+        const unsigned max_frames = std::min({unsigned(_rx_queue.space()), unsigned(CAN_RX_BATCH_SIZE),
+                                              CAN_MAX_POLL_ITERATIONS_COUNT - frames_count});
+        if (max_frames == 0) {
+            break;
+        }
+
+        const int res = _read(max_frames);
+        if (res < 0) {
+            _registerError(SocketCanError::SocketReadFailure);
+            break;
+        }
+
+        for (int i = 0; i < res; i++) {
+            RxItem rx;
+            uint64_t ts_utc_usec = 0;
+            bool loopback = false;
+            if (!_parse(i, rx.frame, ts_utc_usec, loopback)) {
+                continue;
+            }
+
+            uint64_t age_usec = 0;
+            if (ts_utc_usec != 0) {
+                rx.ts_utc = uavcan::UtcTime::fromUSec(ts_utc_usec);
+                if (now_utc_usec > ts_utc_usec && now_utc_usec - ts_utc_usec <= CAN_RX_MAX_AGE_USEC) {
+                    age_usec = std::min(now_utc_usec - ts_utc_usec, now_mono_usec);
+                }
+            } else {
+                rx.ts_utc = uavcan::UtcTime::fromUSec(now_utc_usec);
+            }
+            rx.ts_mono = uavcan::MonotonicTime::fromUSec(now_mono_usec - age_usec);
+
             bool accept = true;
             if (loopback) {           // We receive loopback for all CAN frames
                 _confirmSentFrame();
@@ -336,57 +416,56 @@ void CAN::_pollRead()
             if (accept) {
                 _rx_queue.push(rx);
             }
-        } else if (res == 0) {
-            break;
-        } else {
-            _registerError(SocketCanError::SocketReadFailure);
+        }
+
+        frames_count += res;
+        if ((unsigned)res < max_frames) {
             break;
         }
     }
 }
 
-int CAN::_write(const uavcan::CanFrame& frame) const
+int CAN::_write(unsigned num_frames)
 {
     errno = 0;
 
-    const can_frame sockcan_frame = makeSocketCanFrame(frame);
-
-    const int res = write(_fd, &sockcan_frame, sizeof(sockcan_frame));
+    const int res = sendmmsg(_fd, _tx_batch.msgs, num_frames, MSG_DONTWAIT);
     if (res <= 0) {
         if (errno == ENOBUFS || errno == EAGAIN) {  // Writing is not possible atm, not an error
             return 0;
         }
-        return res;
-    }
-    if (res != sizeof(sockcan_frame)) {
         return -1;
     }
-    return 1;
+    for (int i = 0; i < res; i++) {
+        if (_tx_batch.msgs[i].msg_len != sizeof(can_frame)) {
+            return i > 0 ? i : -1;
+        }
+    }
+    return res;
 }
 
-
-int CAN::_read(uavcan::CanFrame& frame, uavcan::UtcTime& ts_utc, bool& loopback) const
+int CAN::_read(unsigned max_frames)
 {
-    auto iov = iovec();
-    auto sockcan_frame = can_frame();
-    iov.iov_base = &sockcan_frame;
-    iov.iov_len  = sizeof(sockcan_frame);
+    for (unsigned i = 0; i < max_frames; i++) {
+        // the kernel overwrites these
+        _rx_batch.msgs[i].msg_hdr.msg_controllen = sizeof(_rx_batch.control[i]);
+        _rx_batch.msgs[i].msg_hdr.msg_flags = 0;
+    }
 
-    struct Control
-    {
-        cmsghdr cm;
-        std::uint8_t data[sizeof(::timeval)];
-    } control;
+    const int res = recvmmsg(_fd, _rx_batch.msgs, max_frames, MSG_DONTWAIT, nullptr);
+    if (res < 0) {
+        return (errno == EWOULDBLOCK) ? 0 : res;
+    }
+    return res;
+}
 
-    auto msg = msghdr();
-    msg.msg_iov    = &iov;
-    msg.msg_iovlen = 1;
-    msg.msg_control = &control;
-    msg.msg_controllen = sizeof(control);
+bool CAN::_parse(unsigned idx, uavcan::CanFrame& frame, uint64_t& ts_utc_usec, bool& loopback)
+{
+    msghdr& msg = _rx_batch.msgs[idx].msg_hdr;
+    const can_frame& sockcan_frame = _rx_batch.frames[idx];
 
-    const int res = recvmsg(_fd, &msg, MSG_DONTWAIT);
-    if (res <= 0) {
-        return (res < 0 && errno == EWOULDBLOCK) ? 0 : res;
+    if (_rx_batch.msgs[idx].msg_len != sizeof(sockcan_frame)) {
+        return false;
     }
     /*
      * Flags
@@ -394,22 +473,29 @@ int CAN::_read(uavcan::CanFrame& frame, uavcan::UtcTime& ts_utc, bool& loopback)
     loopback = (msg.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
 
     if (!loopback && !_checkHWFilters(sockcan_frame)) {
-        return 0;
+        return false;
     }
 
     frame = makeUavcanFrame(sockcan_frame);
     /*
-     * Timestamp
+     * Timestamp, the software one of SO_TIMESTAMPING is first. Hardware
+     * timestamps aren't used as they don't come from the system clock.
      */
-    const cmsghdr* const cmsg = CMSG_FIRSTHDR(&msg);
-    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMP) {
-        auto tv = timeval();
-        std::memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));  // Copy to avoid alignment problems
-        ts_utc = uavcan::UtcTime::fromUSec(std::uint64_t(tv.tv_sec) * 1000000ULL + tv.tv_usec);
-    } else {
-        return -1;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            timespec ts[3];
+            std::memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));  // Copy to avoid alignment problems
+            ts_utc_usec = std::uint64_t(ts[0].tv_sec) * 1000000ULL + ts[0].tv_nsec / 1000;
+        } else if (cmsg->cmsg_type == SCM_TIMESTAMP) {
+            auto tv = timeval();
+            std::memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));  // Copy to avoid alignment problems
+            ts_utc_usec = std::uint64_t(tv.tv_sec) * 1000000ULL + tv.tv_usec;
+        }
     }
-    return 1;
+    return true;
 }
 
 void CAN::_incrementNumFramesInSocketTxQueue()
@@ -28,6 +28,7 @@
 
 #include "AP_HAL_Linux.h"
 #include <AP_HAL/CAN.h>
+#include <AP_HAL/utility/RingBuffer.h>
 
 #include <linux/can.h>
 
@@ -37,6 +38,7 @@
 #include <map>
 #include <unordered_set>
 #include <poll.h>
+#include <sys/socket.h>
 
 namespace Linux {
 
@@ -51,13 +53,19 @@ enum class SocketCanError
 #define CAN_MAX_INIT_TRIES_COUNT 100
 #define CAN_FILTER_NUMBER 8
 
+// frames read from the socket with one recvmmsg() call
+#define CAN_RX_BATCH_SIZE 32
+// frames waiting to be taken by receive(), reading stops when it is full
+#define CAN_RX_QUEUE_SIZE 256
+// longest believable time a frame waited in the socket, an older kernel
+// timestamp means the system clock was stepped and it is ignored
+#define CAN_RX_MAX_AGE_USEC 100000
+// frames written but not yet looped back, more could be sent out of priority order
+#define CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE 2
+
 class CAN: public AP_HAL::CAN {
 public:
-    CAN(int socket_fd=0)
-      : _fd(socket_fd)
-      , _frames_in_socket_tx_queue(0)
-      , _max_frames_in_socket_tx_queue(2)
-    { }
+    CAN(int socket_fd=0);
     ~CAN() { }
 
     bool begin(uint32_t bitrate) override;
@@ -103,6 +111,8 @@ private:
         uavcan::CanIOFlags flags = 0;
         std::uint64_t order = 0;
 
+        TxItem() { }
+
         TxItem(const uavcan::CanFrame& arg_frame, uavcan::MonotonicTime arg_deadline,
                uavcan::CanIOFlags arg_flags, std::uint64_t arg_order)
             : frame(arg_frame)
@@ -139,9 +149,11 @@ private:
 
     void _pollRead();
 
-    int _write(const uavcan::CanFrame& frame) const;
+    int _write(unsigned num_frames);
 
-    int _read(uavcan::CanFrame& frame, uavcan::UtcTime& ts_utc, bool& loopback) const;
+    int _read(unsigned max_frames);
+
+    bool _parse(unsigned idx, uavcan::CanFrame& frame, uint64_t& ts_utc_usec, bool& loopback);
 
     void _incrementNumFramesInSocketTxQueue();
 
@@ -165,7 +177,27 @@ private:
 
     std::map<SocketCanError, uint64_t> _errors;
     std::priority_queue<TxItem> _tx_queue;
-    std::queue<RxItem> _rx_queue;
+    // single producer, single consumer so it needs no lock
+    ObjectBuffer<RxItem> _rx_queue;
+
+    /*
+     * Buffers of recvmmsg() and sendmmsg(), set up once. The control
+     * buffers fit SCM_TIMESTAMPING, which is larger than SCM_TIMESTAMP.
+     */
+    struct {
+        mmsghdr msgs[CAN_RX_BATCH_SIZE];
+        iovec iovs[CAN_RX_BATCH_SIZE];
+        can_frame frames[CAN_RX_BATCH_SIZE];
+        uint8_t control[CAN_RX_BATCH_SIZE][CMSG_SPACE(3 * sizeof(timespec))];
+    } _rx_batch;
+
+    struct {
+        mmsghdr msgs[CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE];
+        iovec iovs[CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE];
+        can_frame frames[CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE];
+        TxItem items[CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE];
+    } _tx_batch;
+
     std::unordered_multiset<uint32_t> _pending_loopback_ids;
     std::vector<can_filter> _hw_filters_container;
 };
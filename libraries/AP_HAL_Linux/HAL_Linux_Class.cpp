@@ -19,6 +19,7 @@
 #include "GPIO.h"
 #include "I2CDevice.h"
 #include "OpticalFlow_Onboard.h"
+#include "Perf.h"
 #include "RCInput.h"
 #include "RCInput_AioPRU.h"
 #include "RCInput_DSM.h"
@@ -43,6 +44,7 @@
 #include "SPIUARTDriver.h"
 #include "Scheduler.h"
 #include "Storage.h"
+#include "ThreadPlacement.h"
 #include "UARTDriver.h"
 #include "Util.h"
 #include "Util_RPI.h"
@@ -277,11 +279,18 @@ void _usage(void)
     printf("\tmodule support:\n");
     printf("\t                   --module-directory %s\n", AP_MODULE_DEFAULT_DIRECTORY);
     printf("\t                   -M %s\n", AP_MODULE_DEFAULT_DIRECTORY);
+    printf("\tthread CPU placement:\n");
+    printf("\t                   --cpu-affinity 'timer=3;spi=3;io=isolated;*=0-2'\n");
+    printf("\t                   -c 'timer=3;spi=3;io=isolated;*=0-2'\n");
+    printf("\tperf counters dump on exit:\n");
+    printf("\t                   --perf-dump /var/APM/perf.bin\n");
+    printf("\t                   -P /var/APM/perf.bin\n");
 }
 
 void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
 {
     const char *module_path = AP_MODULE_DEFAULT_DIRECTORY;
+    const char *perf_dump_path = nullptr;
     
     assert(callbacks);
 
@@ -300,11 +309,13 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"log-directory",       true,  0, 'l'},
         {"terrain-directory",   true,  0, 't'},
         {"module-directory",    true,  0, 'M'},
+        {"perf-dump",           true,  0, 'P'},
+        {"cpu-affinity",        true,  0, 'c'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:he:SM:",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:he:SM:P:c:",
                     options);
 
     /*
@@ -347,6 +358,15 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         case 'M':
             module_path = gopt.optarg;
             break;
+        case 'P':
+            perf_dump_path = gopt.optarg;
+            break;
+        case 'c':
+            if (!ThreadPlacement::get_instance()->parse(gopt.optarg)) {
+                printf("Invalid CPU placement '%s'\n", gopt.optarg);
+                exit(1);
+            }
+            break;
         case 'h':
             _usage();
             exit(0);
@@ -390,6 +410,11 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
     I2CDeviceManager::from(i2c_mgr)->teardown();
     SPIDeviceManager::from(spi)->teardown();
     Scheduler::from(scheduler)->teardown();
+
+    if (perf_dump_path != nullptr &&
+        !Perf::get_instance()->dump(perf_dump_path)) {
+        fprintf(stderr, "Failed to write perf counters to %s\n", perf_dump_path);
+    }
 }
 
 void HAL_Linux::setup_signal_handlers() const
@@ -45,6 +45,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
+#include "BusScheduler.h"
 #include "PollerThread.h"
 #include "Scheduler.h"
 #include "Semaphores.h"
@@ -89,7 +90,7 @@ public:
 
     int open(uint8_t n);
 
-    PollerThread thread;
+    BusScheduler thread{this};
     Semaphore sem;
     int fd = -1;
     uint8_t bus;
@@ -253,7 +254,9 @@ AP_HAL::Semaphore *I2CDevice::get_semaphore()
 AP_HAL::Device::PeriodicHandle I2CDevice::register_periodic_callback(
     uint32_t period_usec, AP_HAL::Device::PeriodicCb cb)
 {
-    TimerPollable *p = _bus.thread.add_timer(cb, &_bus, period_usec);
+    /* Group callbacks by device, whatever device type is set later */
+    AP_HAL::Device::PeriodicHandle p = _bus.thread.add(
+        cb, period_usec, get_bus_id_devtype(0));
     if (!p) {
         AP_HAL::panic("Could not create periodic callback");
     }
@@ -267,13 +270,13 @@ AP_HAL::Device::PeriodicHandle I2CDevice::register_periodic_callback(
                           AP_LINUX_SENSORS_SCHED_PRIO);
     }
 
-    return static_cast<AP_HAL::Device::PeriodicHandle>(p);
+    return p;
 }
 
 bool I2CDevice::adjust_periodic_callback(
     AP_HAL::Device::PeriodicHandle h, uint32_t period_usec)
 {
-    return _bus.thread.adjust_timer(static_cast<TimerPollable*>(h), period_usec);
+    return _bus.thread.adjust(h, period_usec);
 }
 
 I2CDeviceManager::I2CDeviceManager()
@@ -365,6 +368,12 @@ I2CDeviceManager::get_device(uint8_t bus, uint8_t address,
         return nullptr;
     }
 
+#if HAL_LINUX_SEMAPHORE_STATS
+    char sem_name[24];
+    snprintf(sem_name, sizeof(sem_name), "i2c%u_sem", bus);
+    b->sem.enable_stats(sem_name);
+#endif
+
     auto dev = _create_device(*b, address);
     if (!dev) {
         return nullptr;
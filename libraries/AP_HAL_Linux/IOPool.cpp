@@ -0,0 +1,326 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "IOPool.h"
+
+#include <stdio.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+#include "Scheduler.h"
+
+/* Longest sleep, so new tasks, steals and stop() are noticed */
+#define IO_POOL_MAX_SLEEP_USEC 10000
+
+extern const AP_HAL::HAL &hal;
+
+namespace Linux {
+
+IOPool::IOPool(uint8_t n_workers)
+{
+    for (uint8_t i = 0; i < n_workers; i++) {
+        _workers.push_back(new Worker(*this, i));
+    }
+}
+
+IOPool::~IOPool()
+{
+    for (Worker *w : _workers) {
+        delete w;
+    }
+    for (Task *t : _tasks) {
+        delete t;
+    }
+}
+
+uint64_t IOPool::now_usec()
+{
+    return AP_HAL::micros64();
+}
+
+bool IOPool::add(AP_HAL::MemberProc proc, uint32_t period_usec)
+{
+    if (period_usec == 0 || _workers.empty()) {
+        return false;
+    }
+
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    for (Task *t : _tasks) {
+        if (t->proc == proc) {
+            _sem.give();
+            return true;
+        }
+    }
+
+    if (_tasks.size() > UINT8_MAX) {
+        _sem.give();
+        return false;
+    }
+
+    Task *t = new Task();
+    if (!t) {
+        _sem.give();
+        return false;
+    }
+
+    t->proc = proc;
+    t->period_usec = period_usec;
+    t->deadline_usec = now_usec();
+    t->home = _tasks.size() % _workers.size();
+    if (_tasks.empty()) {
+        _last_debug_usec = t->deadline_usec;
+    }
+    _tasks.push_back(t);
+
+    _sem.give();
+
+    _push(t);
+
+    return true;
+}
+
+bool IOPool::start(const char *name, int policy, int prio)
+{
+    char thread_name[16];
+    bool ret = true;
+
+    for (uint8_t i = 0; i < _workers.size(); i++) {
+        snprintf(thread_name, sizeof(thread_name), "%s-%u", name, i);
+        _workers[i]->set_stack_size(1024 * 1024);
+        ret = _workers[i]->start(thread_name, policy, prio) && ret;
+    }
+
+    return ret;
+}
+
+void IOPool::_push(Task *t)
+{
+    Worker &w = *_workers[t->home];
+
+    w.sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    w.queue.push_back(t);
+    w.sem.give();
+}
+
+IOPool::Task *IOPool::_pop_due(Worker &w, uint64_t now, uint64_t &next_deadline)
+{
+    w.sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    auto earliest = w.queue.end();
+    for (auto it = w.queue.begin(); it != w.queue.end(); it++) {
+        const uint64_t deadline = (*it)->deadline_usec;
+        if (deadline > now) {
+            if (next_deadline == 0 || deadline < next_deadline) {
+                next_deadline = deadline;
+            }
+            continue;
+        }
+        if (earliest == w.queue.end() || deadline < (*earliest)->deadline_usec) {
+            earliest = it;
+        }
+    }
+
+    Task *t = nullptr;
+    if (earliest != w.queue.end()) {
+        t = *earliest;
+        w.queue.erase(earliest);
+    }
+
+    w.sem.give();
+
+    return t;
+}
+
+bool IOPool::run_one(uint8_t worker, uint64_t &next_deadline)
+{
+    const uint8_t n_workers = _workers.size();
+    const uint64_t now = now_usec();
+    Task *t = nullptr;
+    uint8_t i;
+
+    next_deadline = 0;
+
+    /* Own queue first, then the others */
+    for (i = 0; i < n_workers && !t; i++) {
+        t = _pop_due(*_workers[(worker + i) % n_workers], now, next_deadline);
+    }
+    if (!t) {
+        return false;
+    }
+    const bool stolen = i > 1;
+
+    t->sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    const uint64_t start = now_usec();
+    t->proc();
+    const uint64_t end = now_usec();
+
+    const uint32_t latency = start - t->deadline_usec;
+
+    /* Skip the periods that have already passed, keeping the phase */
+    const uint32_t missed = (start - t->deadline_usec) / t->period_usec;
+    t->deadline_usec += (uint64_t)(missed + 1) * t->period_usec;
+
+    t->sem.give();
+
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    TaskStats &stats = t->stats;
+    stats.runs++;
+    stats.stolen += stolen;
+    stats.missed += missed;
+    stats.busy_usec += end - start;
+    stats.max_usec = MAX(stats.max_usec, (uint32_t)(end - start));
+    stats.max_latency_usec = MAX(stats.max_latency_usec, latency);
+    _sem.give();
+
+    _push(t);
+
+    return true;
+}
+
+void IOPool::run_all()
+{
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    std::vector<Task*> tasks = _tasks;
+    _sem.give();
+
+    for (Task *t : tasks) {
+        t->sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+        t->proc();
+        t->sem.give();
+    }
+}
+
+uint8_t IOPool::get_num_tasks()
+{
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    const uint8_t n = _tasks.size();
+    _sem.give();
+
+    return n;
+}
+
+bool IOPool::get_task_stats(uint8_t n, TaskStats &stats)
+{
+    bool ret = false;
+
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    if (n < _tasks.size()) {
+        stats = _tasks[n]->stats;
+        ret = true;
+    }
+    _sem.give();
+
+    return ret;
+}
+
+void IOPool::reset_stats()
+{
+    _sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    for (Task *t : _tasks) {
+        t->stats = { };
+    }
+    _sem.give();
+}
+
+void IOPool::_debug_stats()
+{
+#ifdef DEBUG_IO_POOL
+    const uint64_t now = now_usec();
+
+    if (now - _last_debug_usec < 5000000) {
+        return;
+    }
+    _last_debug_usec = now;
+
+    fprintf(stderr, "\n");
+    for (uint8_t i = 0; ; i++) {
+        TaskStats stats;
+        if (!get_task_stats(i, stats)) {
+            break;
+        }
+        fprintf(stderr, "io task %u\truns %u\tstolen %u\tmissed %u\tmax latency %uus\tmax %uus\n",
+                i, stats.runs, stats.stolen, stats.missed,
+                stats.max_latency_usec, stats.max_usec);
+    }
+    reset_stats();
+#endif
+}
+
+void IOPool::stop()
+{
+    for (Worker *w : _workers) {
+        w->stop();
+    }
+}
+
+void IOPool::join()
+{
+    for (Worker *w : _workers) {
+        w->join();
+    }
+}
+
+size_t IOPool::get_stack_usage()
+{
+    size_t usage = 0;
+
+    for (Worker *w : _workers) {
+        usage = MAX(usage, w->get_stack_usage());
+    }
+
+    return usage;
+}
+
+bool IOPool::Worker::stop()
+{
+    if (!is_started()) {
+        return false;
+    }
+
+    _should_exit = true;
+
+    return true;
+}
+
+void IOPool::Worker::_mainloop()
+{
+    while (!_should_exit) {
+        uint64_t next_deadline;
+
+        if (_pool.run_one(_n, next_deadline)) {
+            continue;
+        }
+
+        if (_n == 0) {
+            _pool._debug_stats();
+        }
+
+        uint64_t sleep_usec = IO_POOL_MAX_SLEEP_USEC;
+        const uint64_t now = _pool.now_usec();
+        if (next_deadline != 0) {
+            sleep_usec = next_deadline > now ? MIN(next_deadline - now, sleep_usec) : 0;
+        }
+        if (sleep_usec > 0) {
+            Scheduler::from(hal.scheduler)->microsleep(sleep_usec);
+        }
+    }
+
+    _started = false;
+    _should_exit = false;
+}
+
+}
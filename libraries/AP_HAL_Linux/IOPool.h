@@ -0,0 +1,134 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+
+#include "Semaphores.h"
+#include "Thread.h"
+
+namespace Linux {
+
+/*
+ * Threads running the IO processes, each as a task of its own so a slow
+ * one only holds up the worker running it.
+ *
+ * Each task has a home worker it is queued on. A worker runs the due task
+ * of its queue with the earliest deadline and, when none is due, steals
+ * one from the other workers. A task is out of all queues while it runs,
+ * so its runs never overlap and happen in order.
+ */
+class IOPool {
+public:
+    /* Runs and latency of one task since the last reset_stats() */
+    struct TaskStats {
+        uint32_t runs;
+        uint32_t stolen;        // runs by a worker other than the home one
+        uint32_t missed;        // periods skipped because the task was too late
+        uint32_t max_latency_usec;  // longest delay from deadline to start
+        uint32_t max_usec;      // longest run
+        uint64_t busy_usec;     // total run time
+    };
+
+    IOPool(uint8_t n_workers);
+    virtual ~IOPool();
+
+    /*
+     * Add a task running @proc every @period_usec, starting now. Adding
+     * the same proc twice has no effect.
+     */
+    bool add(AP_HAL::MemberProc proc, uint32_t period_usec);
+
+    /* Start the worker threads */
+    bool start(const char *name, int policy, int prio);
+
+    /*
+     * Run one due task as worker @worker. Returns false if none was due,
+     * with @next_deadline set to the earliest deadline or 0 without tasks.
+     */
+    bool run_one(uint8_t worker, uint64_t &next_deadline);
+
+    /* Run every task once in the calling thread */
+    void run_all();
+
+    uint8_t get_num_tasks();
+
+    bool get_task_stats(uint8_t n, TaskStats &stats);
+
+    void reset_stats();
+
+    void stop();
+    void join();
+
+    size_t get_stack_usage();
+
+protected:
+    /* Time source, overridden to run against a simulated clock */
+    virtual uint64_t now_usec();
+
+private:
+    struct Task {
+        AP_HAL::MemberProc proc;
+        uint32_t period_usec;
+        uint64_t deadline_usec;
+        uint8_t home;
+
+        /* held while the task runs */
+        Semaphore sem;
+
+        TaskStats stats;
+    };
+
+    class Worker : public Thread {
+    public:
+        Worker(IOPool &pool, uint8_t n)
+            : Thread{FUNCTOR_BIND_MEMBER(&Worker::_mainloop, void)}
+            , _pool(pool)
+            , _n(n)
+        { }
+
+        bool stop() override;
+
+        /* Tasks waiting for their deadline, protected by sem */
+        std::vector<Task*> queue;
+        Semaphore sem;
+
+    private:
+        void _mainloop();
+
+        IOPool &_pool;
+        uint8_t _n;
+    };
+
+    /* Take the due task of @w with the earliest deadline out of its queue */
+    Task *_pop_due(Worker &w, uint64_t now, uint64_t &next_deadline);
+
+    void _push(Task *t);
+
+    void _debug_stats();
+
+    std::vector<Worker*> _workers;
+
+    /* protects the task list and their stats */
+    Semaphore _sem;
+    std::vector<Task*> _tasks;
+
+    uint64_t _last_debug_usec = 0;
+};
+
+}
@@ -16,10 +16,13 @@
  */
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <vector>
 
+#include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/sparse-endian.h>
 #include <AP_Math/AP_Math.h>
 
 #include "AP_HAL_Linux.h"
@@ -31,12 +34,55 @@
 #define PRIu64 "llu"
 #endif
 
+/*
+ * Dump file format, all values little-endian: a header followed by one
+ * record per counter, see Tools/scripts/perf_dump.py
+ */
+#define PERF_DUMP_MAGIC     "APPF"
+#define PERF_DUMP_VERSION   1
+#define PERF_DUMP_NAME_LEN  32
+
+struct PACKED perf_dump_header {
+    char magic[4];
+    le16_t version;
+    le16_t n_counters;
+    uint8_t histogram_min_shift;
+    uint8_t histogram_sub_bits;
+    uint8_t histogram_octaves;
+    uint8_t reserved;
+    le64_t timestamp_nsec;
+};
+
+struct PACKED perf_dump_counter {
+    char name[PERF_DUMP_NAME_LEN];
+    uint8_t type;
+    uint8_t reserved[7];
+    le64_t count;
+    le64_t total;
+    le64_t min;
+    le64_t max;
+    le64_t avg;
+    le64_t stddev;
+    le32_t histogram[PERF_HISTOGRAM_BUCKETS];
+};
+
+/* IEEE 754 double in the dump's byte order */
+static le64_t htole_double(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return htole64(bits);
+}
+
 using namespace Linux;
 
 static const AP_HAL::HAL &hal = AP_HAL::get_HAL();
 
 Perf *Perf::_instance;
 
+/* The shard of the calling thread, created on its first event */
+static thread_local void *thread_shard;
+
 static inline uint64_t now_nsec()
 {
     struct timespec ts;
@@ -53,6 +99,130 @@ Perf *Perf::get_instance()
     return _instance;
 }
 
+double Perf_Summary::stddev() const
+{
+    if (count == 0) {
+        return 0;
+    }
+    return sqrt(m2 / count);
+}
+
+uint64_t Perf_Summary::percentile(float p) const
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = MAX((uint64_t)ceilf(p * count), 1ULL);
+    uint64_t n = 0;
+
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        n += histogram[i];
+        if (n >= rank) {
+            return MIN(Perf::histogram_bucket_max(i), max);
+        }
+    }
+
+    return max;
+}
+
+uint8_t Perf::histogram_bucket(uint64_t elapsed)
+{
+    if (elapsed < (1ULL << PERF_HISTOGRAM_MIN_SHIFT)) {
+        return 0;
+    }
+
+    const uint8_t msb = 63 - __builtin_clzll(elapsed);
+    if (msb >= PERF_HISTOGRAM_MIN_SHIFT + PERF_HISTOGRAM_OCTAVES) {
+        return PERF_HISTOGRAM_BUCKETS - 1;
+    }
+
+    const uint8_t sub = (elapsed >> (msb - PERF_HISTOGRAM_SUB_BITS)) & (PERF_HISTOGRAM_SUB_BUCKETS - 1);
+    return 1 + (msb - PERF_HISTOGRAM_MIN_SHIFT) * PERF_HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+/* Longest elapsed time that goes in @bucket */
+uint64_t Perf::histogram_bucket_max(uint8_t bucket)
+{
+    if (bucket == 0) {
+        return (1ULL << PERF_HISTOGRAM_MIN_SHIFT) - 1;
+    }
+    if (bucket >= PERF_HISTOGRAM_BUCKETS - 1) {
+        return UINT64_MAX;
+    }
+
+    const uint8_t octave = (bucket - 1) / PERF_HISTOGRAM_SUB_BUCKETS;
+    const uint8_t sub = (bucket - 1) % PERF_HISTOGRAM_SUB_BUCKETS;
+    const uint8_t shift = PERF_HISTOGRAM_MIN_SHIFT + octave - PERF_HISTOGRAM_SUB_BITS;
+
+    return ((uint64_t)(PERF_HISTOGRAM_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+bool Perf::get_summary(Util::perf_counter_t pc, Perf_Summary &summary)
+{
+    uintptr_t idx = (uintptr_t)pc;
+
+    if (idx >= _n_perf_counters) {
+        return false;
+    }
+
+    memset(&summary, 0, sizeof(summary));
+    summary.min = UINT64_MAX;
+
+    pthread_mutex_lock(&_lock);
+
+    for (Shard *shard : _shards) {
+        const Perf_Stats *stats = shard->stats[idx].load(std::memory_order_acquire);
+        if (!stats) {
+            continue;
+        }
+
+        /* Copy it without stopping the owner thread */
+        Perf_Stats copy;
+        uint32_t seq;
+        do {
+            seq = stats->seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+            copy.count = stats->count;
+            copy.total = stats->total;
+            copy.min = stats->min;
+            copy.max = stats->max;
+            copy.avg = stats->avg;
+            copy.m2 = stats->m2;
+            memcpy(copy.histogram, stats->histogram, sizeof(copy.histogram));
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq & 1) || seq != stats->seq.load(std::memory_order_relaxed));
+
+        if (copy.count == 0) {
+            continue;
+        }
+
+        /* Chan et al. parallel variance */
+        const uint64_t n = summary.count + copy.count;
+        const double delta = copy.avg - summary.avg;
+        summary.avg += delta * copy.count / n;
+        summary.m2 += copy.m2 + delta * delta * summary.count * copy.count / n;
+        summary.count = n;
+
+        summary.total += copy.total;
+        summary.min = MIN(summary.min, copy.min);
+        summary.max = MAX(summary.max, copy.max);
+        for (uint8_t i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+            summary.histogram[i] += copy.histogram[i];
+        }
+    }
+
+    pthread_mutex_unlock(&_lock);
+
+    if (summary.count == 0) {
+        summary.min = 0;
+    }
+
+    return true;
+}
+
 void Perf::_debug_counters()
 {
     uint64_t now = AP_HAL::millis64();
@@ -61,17 +231,13 @@ void Perf::_debug_counters()
         return;
     }
 
-    pthread_rwlock_rdlock(&_perf_counters_lock);
-    unsigned int uc = _update_count;
-    auto v = _perf_counters;
-    pthread_rwlock_unlock(&_perf_counters_lock);
+    for (unsigned int i = 0; i < _n_perf_counters; i++) {
+        const Perf_Counter &c = *_perf_counters[i];
+        Perf_Summary s;
 
-    if (uc != _update_count) {
-        fprintf(stderr, "WARNING!! potentially wrong counters!!!");
-    }
+        get_summary((Util::perf_counter_t)(uintptr_t)i, s);
 
-    for (auto &c : v) {
-        if (!c.count) {
+        if (!s.count) {
             fprintf(stderr, "%-30s\t"
                     "(no events)\n", c.name);
         } else if (c.type == Util::PC_ELAPSED) {
@@ -80,12 +246,15 @@ void Perf::_debug_counters()
                     "min: %" PRIu64 "\t"
                     "max: %" PRIu64 "\t"
                     "avg: %.4f\t"
-                    "stddev: %.4f\n",
-                    c.name, c.count, c.min, c.max, c.avg, sqrt(c.m2));
+                    "stddev: %.4f\t"
+                    "p50: %" PRIu64 "\t"
+                    "p99: %" PRIu64 "\n",
+                    c.name, s.count, s.min, s.max, s.avg, s.stddev(),
+                    s.percentile(0.5f), s.percentile(0.99f));
         } else {
             fprintf(stderr, "%-30s\t"
                     "count: %" PRIu64 "\n",
-                    c.name, c.count);
+                    c.name, s.count);
         }
     }
 
@@ -94,29 +263,78 @@ void Perf::_debug_counters()
 
 Perf::Perf()
 {
-    if (pthread_rwlock_init(&_perf_counters_lock, nullptr) != 0) {
-        AP_HAL::panic("Perf: fail to initialize rw lock");
+    if (pthread_mutex_init(&_lock, nullptr) != 0) {
+        AP_HAL::panic("Perf: fail to initialize lock");
     }
 
-    /* TODO: this number should come from vehicle code - just estimate the
-     * number of perf counters for now; if we grow more, it will just
-     * reallocate the memory pool */
-    _perf_counters.reserve(50);
+    _n_perf_counters = 0;
 
 #ifdef DEBUG_PERF
     hal.scheduler->register_timer_process(FUNCTOR_BIND_MEMBER(&Perf::_debug_counters, void));
 #endif
 }
 
+/*
+ * Values of a counter for the calling thread, allocated on the first event
+ * of the thread and of the counter
+ */
+Perf_Stats *Perf::_get_stats(uintptr_t idx)
+{
+    Shard *shard = (Shard *)thread_shard;
+
+    if (!shard) {
+        shard = new Shard();
+        for (uint16_t i = 0; i < PERF_MAX_COUNTERS; i++) {
+            shard->stats[i].store(nullptr, std::memory_order_relaxed);
+        }
+        pthread_mutex_lock(&_lock);
+        _shards.push_back(shard);
+        pthread_mutex_unlock(&_lock);
+        thread_shard = shard;
+    }
+
+    Perf_Stats *stats = shard->stats[idx].load(std::memory_order_relaxed);
+    if (!stats) {
+        stats = new Perf_Stats();
+        stats->seq.store(0, std::memory_order_relaxed);
+        stats->start = 0;
+        stats->count = 0;
+        stats->total = 0;
+        stats->min = UINT64_MAX;
+        stats->max = 0;
+        stats->avg = 0;
+        stats->m2 = 0;
+        memset(stats->histogram, 0, sizeof(stats->histogram));
+        shard->stats[idx].store(stats, std::memory_order_release);
+    }
+
+    return stats;
+}
+
+/*
+ * Only the owner thread updates its stats: mark them as being updated so
+ * readers retry instead of taking a lock
+ */
+static inline void stats_update_begin(Perf_Stats &stats)
+{
+    stats.seq.store(stats.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+static inline void stats_update_end(Perf_Stats &stats)
+{
+    stats.seq.store(stats.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
 void Perf::begin(Util::perf_counter_t pc)
 {
     uintptr_t idx = (uintptr_t)pc;
 
-    if (idx >= _perf_counters.size()) {
+    if (idx >= _n_perf_counters) {
         return;
     }
 
-    Perf_Counter &perf = _perf_counters[idx];
+    Perf_Counter &perf = *_perf_counters[idx];
     if (perf.type != Util::PC_ELAPSED) {
         hal.console->printf("perf_begin() called on perf_counter_t(%s) that"
                             " is not of PC_ELAPSED type.\n",
@@ -124,15 +342,14 @@ void Perf::begin(Util::perf_counter_t pc)
         return;
     }
 
-    if (perf.start != 0) {
+    Perf_Stats &stats = *_get_stats(idx);
+    if (stats.start != 0) {
         hal.console->printf("perf_begin() called twice on perf_counter_t(%s)\n",
                             perf.name);
         return;
     }
 
-    _update_count++;
-
-    perf.start = now_nsec();
+    stats.start = now_nsec();
 
     perf.lttng.begin(perf.name);
 }
@@ -141,11 +358,11 @@ void Perf::end(Util::perf_counter_t pc)
 {
     uintptr_t idx = (uintptr_t)pc;
 
-    if (idx >= _perf_counters.size()) {
+    if (idx >= _n_perf_counters) {
         return;
     }
 
-    Perf_Counter &perf = _perf_counters[idx];
+    Perf_Counter &perf = *_perf_counters[idx];
     if (perf.type != Util::PC_ELAPSED) {
         hal.console->printf("perf_begin() called on perf_counter_t(%s) that"
                             " is not of PC_ELAPSED type.\n",
@@ -153,24 +370,27 @@ void Perf::end(Util::perf_counter_t pc)
         return;
     }
 
-    if (perf.start == 0) {
+    Perf_Stats &stats = *_get_stats(idx);
+    if (stats.start == 0) {
         hal.console->printf("perf_begin() called before begin() on perf_counter_t(%s)\n",
                             perf.name);
         return;
     }
 
-    _update_count++;
+    const uint64_t elapsed = now_nsec() - stats.start;
+    stats.start = 0;
 
-    const uint64_t elapsed = now_nsec() - perf.start;
-    perf.count++;
-    perf.total += elapsed;
+    stats_update_begin(stats);
 
-    if (perf.min > elapsed) {
-        perf.min = elapsed;
+    stats.count++;
+    stats.total += elapsed;
+
+    if (stats.min > elapsed) {
+        stats.min = elapsed;
     }
 
-    if (perf.max < elapsed) {
-        perf.max = elapsed;
+    if (stats.max < elapsed) {
+        stats.max = elapsed;
     }
 
     /*
@@ -178,10 +398,13 @@ void Perf::end(Util::perf_counter_t pc)
      * Knuth/Welford recursive avg and variance of update intervals (via Wikipedia)
      * Same implementation of PX4.
      */
-    const double delta_intvl = elapsed - perf.avg;
-    perf.avg += (delta_intvl / perf.count);
-    perf.m2 += (delta_intvl * (elapsed - perf.avg));
-    perf.start = 0;
+    const double delta_intvl = elapsed - stats.avg;
+    stats.avg += (delta_intvl / stats.count);
+    stats.m2 += (delta_intvl * (elapsed - stats.avg));
+
+    stats.histogram[histogram_bucket(elapsed)]++;
+
+    stats_update_end(stats);
 
     perf.lttng.end(perf.name);
 }
@@ -190,11 +413,11 @@ void Perf::count(Util::perf_counter_t pc)
 {
     uintptr_t idx = (uintptr_t)pc;
 
-    if (idx >= _perf_counters.size()) {
+    if (idx >= _n_perf_counters) {
         return;
     }
 
-    Perf_Counter &perf = _perf_counters[idx];
+    Perf_Counter &perf = *_perf_counters[idx];
     if (perf.type != Util::PC_COUNT) {
         hal.console->printf("perf_begin() called on perf_counter_t(%s) that"
                             " is not of PC_COUNT type.\n",
@@ -202,10 +425,18 @@ void Perf::count(Util::perf_counter_t pc)
         return;
     }
 
-    _update_count++;
-    perf.count++;
+    Perf_Stats &stats = *_get_stats(idx);
 
-    perf.lttng.count(perf.name, perf.count);
+    stats_update_begin(stats);
+    stats.count++;
+    stats_update_end(stats);
+
+    perf.lttng.count(perf.name, stats.count);
+}
+
+void Perf::trace(uint16_t trace_id, uint8_t stage)
+{
+    _lttng.trace(trace_id, stage);
 }
 
 Util::perf_counter_t Perf::add(Util::perf_counter_type type, const char *name)
@@ -218,10 +449,65 @@ Util::perf_counter_t Perf::add(Util::perf_counter_type type, const char *name)
         return (Util::perf_counter_t)(uintptr_t) -1;
     }
 
-    pthread_rwlock_wrlock(&_perf_counters_lock);
-    Util::perf_counter_t pc = (Util::perf_counter_t) _perf_counters.size();
-    _perf_counters.emplace_back(type, name);
-    pthread_rwlock_unlock(&_perf_counters_lock);
+    pthread_mutex_lock(&_lock);
+    const unsigned int idx = _n_perf_counters;
+    if (idx >= PERF_MAX_COUNTERS) {
+        pthread_mutex_unlock(&_lock);
+        return (Util::perf_counter_t)(uintptr_t) -1;
+    }
+    _perf_counters[idx] = new Perf_Counter(type, name);
+    /* publish the counter only once it's ready to be used */
+    _n_perf_counters.store(idx + 1, std::memory_order_release);
+    pthread_mutex_unlock(&_lock);
+
+    return (Util::perf_counter_t)(uintptr_t) idx;
+}
+
+bool Perf::dump(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+
+    const uint16_t n_counters = _n_perf_counters;
+
+    struct perf_dump_header header = { };
+    memcpy(header.magic, PERF_DUMP_MAGIC, sizeof(header.magic));
+    header.version = htole16(PERF_DUMP_VERSION);
+    header.n_counters = htole16(n_counters);
+    header.histogram_min_shift = PERF_HISTOGRAM_MIN_SHIFT;
+    header.histogram_sub_bits = PERF_HISTOGRAM_SUB_BITS;
+    header.histogram_octaves = PERF_HISTOGRAM_OCTAVES;
+    header.timestamp_nsec = htole64(now_nsec());
+
+    bool ret = fwrite(&header, sizeof(header), 1, f) == 1;
+
+    for (unsigned int i = 0; i < n_counters && ret; i++) {
+        const Perf_Counter &c = *_perf_counters[i];
+        Perf_Summary s;
+
+        get_summary((Util::perf_counter_t)(uintptr_t)i, s);
+
+        struct perf_dump_counter record = { };
+        strncpy(record.name, c.name, sizeof(record.name) - 1);
+        record.type = c.type;
+        record.count = htole64(s.count);
+        record.total = htole64(s.total);
+        record.min = htole64(s.min);
+        record.max = htole64(s.max);
+        record.avg = htole_double(s.avg);
+        record.stddev = htole_double(s.stddev());
+        for (unsigned int b = 0; b < PERF_HISTOGRAM_BUCKETS; b++) {
+            record.histogram[b] = htole32(s.histogram[b]);
+        }
+
+        ret = fwrite(&record, sizeof(record), 1, f) == 1;
+    }
+
+    if (fclose(f) != 0) {
+        ret = false;
+    }
 
-    return pc;
+    return ret;
 }
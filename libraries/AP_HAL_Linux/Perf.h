@@ -17,26 +17,37 @@
 #pragma once
 
 #include <atomic>
-#include <limits.h>
 #include <pthread.h>
 #include <vector>
 
+#include <AP_HAL/Util.h>
+
 #include "AP_HAL_Linux.h"
 #include "Perf_Lttng.h"
 #include "Thread.h"
-#include "Util.h"
+
+#define PERF_MAX_COUNTERS 256
+
+/*
+ * Elapsed times are kept in a histogram with PERF_HISTOGRAM_SUB_BUCKETS
+ * buckets per power of two from 2^PERF_HISTOGRAM_MIN_SHIFT nanoseconds,
+ * plus one bucket for shorter and one for longer times
+ */
+#define PERF_HISTOGRAM_MIN_SHIFT    6
+#define PERF_HISTOGRAM_SUB_BITS     2
+#define PERF_HISTOGRAM_SUB_BUCKETS  (1U << PERF_HISTOGRAM_SUB_BITS)
+#define PERF_HISTOGRAM_OCTAVES      26
+#define PERF_HISTOGRAM_BUCKETS      (PERF_HISTOGRAM_OCTAVES * PERF_HISTOGRAM_SUB_BUCKETS + 2)
 
 namespace Linux {
 
 class Perf_Counter {
     using perf_counter_type = AP_HAL::Util::perf_counter_type;
-    using perf_counter_t = AP_HAL::Util::perf_counter_t;
 
 public:
     Perf_Counter(perf_counter_type type_, const char *name_)
         : name{name_}
         , type{type_}
-        , min{ULONG_MAX}
     {
     }
 
@@ -44,17 +55,50 @@ public:
     Perf_Lttng lttng;
 
     perf_counter_type type;
+};
+
+/*
+ * Values of one counter from one thread. Only the owner thread writes to
+ * it, so no lock is needed to update it; readers retry if seq changed or
+ * was odd while they were copying.
+ */
+struct Perf_Stats {
+    std::atomic<uint32_t> seq;
+
+    /* Only used by the owner thread */
+    uint64_t start;
 
     uint64_t count;
 
     /* Everything below is in nanoseconds */
-    uint64_t start;
     uint64_t total;
     uint64_t min;
     uint64_t max;
 
     double avg;
     double m2;
+
+    uint32_t histogram[PERF_HISTOGRAM_BUCKETS];
+};
+
+/* Values of one counter merged from all threads */
+struct Perf_Summary {
+    uint64_t count;
+
+    /* Everything below is in nanoseconds */
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+
+    double avg;
+    double m2;
+
+    uint32_t histogram[PERF_HISTOGRAM_BUCKETS];
+
+    double stddev() const;
+
+    /* Upper bound of the elapsed time of the fraction @p of the events */
+    uint64_t percentile(float p) const;
 };
 
 class Perf {
@@ -71,25 +115,48 @@ public:
     void begin(perf_counter_t pc);
     void end(perf_counter_t pc);
     void count(perf_counter_t pc);
+    void trace(uint16_t trace_id, uint8_t stage);
+
+    /* Merge the values of a counter from all threads */
+    bool get_summary(perf_counter_t pc, Perf_Summary &summary);
 
-    unsigned int get_update_count() { return _update_count; }
+    /*
+     * Write all counters to @path in the format read by
+     * Tools/scripts/perf_dump.py
+     */
+    bool dump(const char *path);
+
+    static uint8_t histogram_bucket(uint64_t elapsed);
+    static uint64_t histogram_bucket_max(uint8_t bucket);
 
 private:
+    /* The values of each counter for one thread */
+    struct Shard {
+        std::atomic<Perf_Stats*> stats[PERF_MAX_COUNTERS];
+    };
+
     static Perf *_instance;
 
     Perf();
 
+    Perf_Stats *_get_stats(uintptr_t idx);
+
     void _debug_counters();
 
     uint64_t _last_debug_msec;
 
-    std::vector<Perf_Counter> _perf_counters;
+    /* Counters are never removed, so they can be used without a lock */
+    Perf_Counter *_perf_counters[PERF_MAX_COUNTERS];
+    std::atomic<unsigned int> _n_perf_counters;
+
+    /* Shards of all threads, including the ones that finished */
+    std::vector<Shard*> _shards;
 
-    /* synchronize addition of new perf counters */
-    pthread_rwlock_t _perf_counters_lock;
+    /* latency trace events are only sent to lttng */
+    Perf_Lttng _lttng;
 
-    /* allow to check if memory pool has changed */
-    std::atomic<unsigned int> _update_count;
+    /* synchronize addition of new perf counters and shards */
+    pthread_mutex_t _lock;
 };
 
 }
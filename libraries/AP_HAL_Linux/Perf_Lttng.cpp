@@ -40,6 +40,11 @@ void Perf_Lttng::count(const char *name, uint64_t val)
     tracepoint(ardupilot, count, name, val);
 }
 
+void Perf_Lttng::trace(uint16_t trace_id, uint8_t stage)
+{
+    tracepoint(ardupilot, trace, trace_id, stage);
+}
+
 #else
 
 #include "Perf_Lttng.h"
@@ -49,5 +54,6 @@ using namespace Linux;
 void Perf_Lttng::begin(const char *name) { }
 void Perf_Lttng::end(const char *name) { }
 void Perf_Lttng::count(const char *name, uint64_t val) { }
+void Perf_Lttng::trace(uint16_t trace_id, uint8_t stage) { }
 
 #endif
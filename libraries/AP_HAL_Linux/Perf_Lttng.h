@@ -25,6 +25,7 @@ public:
     void begin(const char *name);
     void end(const char *name);
     void count(const char *name, uint64_t val);
+    void trace(uint16_t trace_id, uint8_t stage);
 };
 
 }
@@ -59,6 +59,19 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    ardupilot,
+    trace,
+    TP_ARGS(
+        int, trace_id_arg,
+        int, stage_arg
+    ),
+    TP_FIELDS(
+        ctf_integer(int, trace_id_field, trace_id_arg)
+        ctf_integer(int, stage_field, stage_arg)
+    )
+)
+
 #endif
 
 #include <lttng/tracepoint-event.h>
@@ -90,6 +90,21 @@ bool Poller::register_pollable(Pollable *p, uint32_t events)
     return epoll_ctl(_epfd, EPOLL_CTL_ADD, p->get_fd(), &epev) == 0;
 }
 
+bool Poller::modify_pollable(Pollable *p, uint32_t events)
+{
+    events |= EPOLLWAKEUP;
+
+    if (_epfd < 0) {
+        return false;
+    }
+
+    struct epoll_event epev = { };
+    epev.events = events;
+    epev.data.ptr = static_cast<void *>(p);
+
+    return epoll_ctl(_epfd, EPOLL_CTL_MOD, p->get_fd(), &epev) == 0;
+}
+
 void Poller::unregister_pollable(const Pollable *p)
 {
     if (_epfd >= 0 && p->get_fd() >= 0) {
@@ -97,14 +112,14 @@ void Poller::unregister_pollable(const Pollable *p)
     }
 }
 
-int Poller::poll() const
+int Poller::poll(int timeout_ms) const
 {
     const int max_events = 16;
     epoll_event events[max_events];
     int r;
 
     do {
-        r = epoll_wait(_epfd, events, max_events, -1);
+        r = epoll_wait(_epfd, events, max_events, timeout_ms);
     } while (r < 0 && errno == EINTR);
 
     if (r < 0) {
@@ -98,6 +98,12 @@ public:
      */
     bool register_pollable(Pollable *p, uint32_t events);
 
+    /*
+     * Change the events @p, previously registered with register_pollable(),
+     * is waiting for.
+     */
+    bool modify_pollable(Pollable *p, uint32_t events);
+
     /*
      * Unregister @p from this Poller so it doesn't generate any more
      * event. Note that this doesn't destroy @p.
@@ -108,8 +114,11 @@ public:
      * Wait for events on all Pollable objects registered with
      * register_pollable(). New Pollable objects can be registered at any
      * time, including when a thread is sleeping on a poll() call.
+     *
+     * If @timeout_ms is not negative, return 0 after waiting that long
+     * without any event.
      */
-    int poll() const;
+    int poll(int timeout_ms = -1) const;
 
     /*
      * Wake up the thread sleeping on a poll() call if it is in fact
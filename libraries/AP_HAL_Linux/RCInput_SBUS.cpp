@@ -37,9 +37,14 @@ extern const AP_HAL::HAL& hal;
 using namespace Linux;
 
 #define SBUS_FRAME_SIZE 25
+#define SBUS_BAUDRATE 100000
+// 8E2 is 12 bits on the line per byte
+#define SBUS_BYTE_US (12 * 1000000UL / SBUS_BAUDRATE)
 
 void RCInput_SBUS::init()
 {
+    rcin_prot.init();
+
     fd = open(device_path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
     if (fd != -1) {
         printf("Opened SBUS input %s fd=%d\n", device_path, (int)fd);
@@ -59,8 +64,8 @@ void RCInput_SBUS::init()
         tio.c_cflag &= ~(CSIZE | CRTSCTS | PARODD | CBAUD);
         // use BOTHER to specify speed directly in c_[io]speed member
         tio.c_cflag |= (CS8 | CSTOPB | CLOCAL | PARENB | BOTHER | CREAD);
-        tio.c_ispeed = 100000;
-        tio.c_ospeed = 100000;
+        tio.c_ispeed = SBUS_BAUDRATE;
+        tio.c_ospeed = SBUS_BAUDRATE;
         // see select() comment below
         tio.c_cc[VMIN] = SBUS_FRAME_SIZE;
         tio.c_cc[VTIME] = 0;
@@ -128,38 +133,7 @@ void RCInput_SBUS::_timer_tick(void)
     do {
         nread = ::read(fd, bytes, sizeof(bytes));
     } while (nread == sizeof(bytes));
-    
-    if (nread % SBUS_FRAME_SIZE != 0) {
-        /*
-          SBUS frames are 25 bytes long, and always start with
-          0x0f, but there is no other framing information to
-          prevent us getting out of sync. All we have are the
-          timing guarantees
-          
-          In this case we have read a partial frame, or lost some
-          bytes. A 25 bytes frame at 100000 baud takes 2.5ms. By
-          delaying 3.5ms here we will get any remaining bytes for
-          this frame. We shouldn't get the start of the next frame
-          as frames happen at most every 7ms
-          
-          This strategy allows us to resync even if we lose
-          bytes. It assumes an interframe gap of more than
-          3.5ms. If SBUS is run at very high rate (like 300Hz)
-          then this won't work
-        */
-        hal.scheduler->delay_microseconds(3500);
-        int n2 = ::read(fd, bytes+nread, sizeof(bytes)-nread);
-        if (n2 > 0) {
-            nread += n2;
-        }
-    }
-    if (nread % SBUS_FRAME_SIZE != 0) {
-        // if we don't have a multuple of 25 then throw away the lot
-#if SBUS_DEBUG_LOG
-        dprintf(logfd, "discard %u\n", (unsigned)nread);
-#endif
-        return;
-    }
+
     if (nread <= 0) {
         return;
     }
@@ -172,9 +146,26 @@ void RCInput_SBUS::_timer_tick(void)
         dprintf(logfd, "\n");
     }
 #endif
-    // only process the last SBUS_FRAME_SIZE bytes. Only the latest
-    // frame matters
-    add_sbus_input(&bytes[nread-SBUS_FRAME_SIZE], SBUS_FRAME_SIZE);
+
+    /*
+      SBUS frames have no framing information other than the gap
+      between them, so the decoder needs to know when each byte came
+      in rather than when we got round to reading it. The last byte
+      arrived at most a tick ago, and the ones before it back to back
+    */
+    const uint32_t now = AP_HAL::micros();
+    for (int i = 0; i < nread; i++) {
+        rcin_prot.process_byte(bytes[i], SBUS_BAUDRATE, now - (nread - 1 - i) * SBUS_BYTE_US);
+    }
+
+    if (rcin_prot.new_input()) {
+        uint16_t values[MAX_RCIN_CHANNELS];
+        const uint8_t n = rcin_prot.num_channels();
+        for (uint8_t i = 0; i < n; i++) {
+            values[i] = rcin_prot.read(i);
+        }
+        _update_periods(values, n);
+    }
 }
 #endif // CONFIG_HAL_BOARD_SUBTYPE
 
@@ -21,6 +21,8 @@
     CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_OCPOC_ZYNQ || \
     CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_RST_ZYNQ
 
+#include <AP_RCProtocol/AP_RCProtocol.h>
+
 #include "RCInput.h"
 
 namespace Linux {
@@ -45,6 +47,7 @@ private:
     const char *device_path = nullptr;
 #endif
     int32_t fd = -1;
+    AP_RCProtocol rcin_prot;
 };
 
 }
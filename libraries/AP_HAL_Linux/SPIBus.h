@@ -0,0 +1,78 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Bus state shared by the SPIDevices on a spidev bus. Private to the
+ * SPIDevice implementation and its tests
+ */
+
+#include <inttypes.h>
+
+#include "BusScheduler.h"
+#include "PollerThread.h"
+#include "Semaphores.h"
+
+#define SPI_CS_KERNEL -1
+
+namespace Linux {
+
+struct SPIDesc {
+    SPIDesc(const char *name_, uint16_t bus_, uint16_t subdev_, uint8_t mode_,
+            uint8_t bits_per_word_, int16_t cs_pin_, uint32_t lowspeed_,
+            uint32_t highspeed_)
+        : name(name_), bus(bus_), subdev(subdev_), mode(mode_)
+        , bits_per_word(bits_per_word_), cs_pin(cs_pin_), lowspeed(lowspeed_)
+        , highspeed(highspeed_)
+    {
+    }
+
+    const char *name;
+    uint16_t bus;
+    uint16_t subdev;
+    uint8_t mode;
+    uint8_t bits_per_word;
+    int16_t cs_pin;
+    uint32_t lowspeed;
+    uint32_t highspeed;
+};
+
+/* Struct to maintain for each bus */
+class SPIBus : public TimerPollable::WrapperCb {
+public:
+    virtual ~SPIBus();
+
+    /*
+     * TimerPollable::WrapperCb methods to take
+     * and release semaphore while calling the callback
+     */
+    void start_cb() override;
+    void end_cb() override;
+
+    int open(uint16_t bus_, uint16_t kernel_cs_);
+
+    /* All requests to spidev go through here, so tests can fake the bus */
+    virtual int ioctl(unsigned long request, void *arg);
+
+    BusScheduler thread{this};
+    Semaphore sem;
+    int fd = -1;
+    uint16_t bus;
+    uint16_t kernel_cs;
+    uint8_t ref;
+    int16_t last_mode = -1;
+};
+
+}
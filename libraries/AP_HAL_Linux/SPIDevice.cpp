@@ -31,9 +31,8 @@
 #include <AP_HAL/utility/OwnPtr.h>
 
 #include "GPIO.h"
-#include "PollerThread.h"
+#include "SPIBus.h"
 #include "Scheduler.h"
-#include "Semaphores.h"
 #include "Thread.h"
 #include "Util.h"
 
@@ -43,28 +42,6 @@ static const AP_HAL::HAL &hal = AP_HAL::get_HAL();
 
 #define MHZ (1000U*1000U)
 #define KHZ (1000U)
-#define SPI_CS_KERNEL -1
-
-struct SPIDesc {
-    SPIDesc(const char *name_, uint16_t bus_, uint16_t subdev_, uint8_t mode_,
-            uint8_t bits_per_word_, int16_t cs_pin_, uint32_t lowspeed_,
-            uint32_t highspeed_)
-        : name(name_), bus(bus_), subdev(subdev_), mode(mode_)
-        , bits_per_word(bits_per_word_), cs_pin(cs_pin_), lowspeed(lowspeed_)
-        , highspeed(highspeed_)
-    {
-    }
-
-    const char *name;
-    uint16_t bus;
-    uint16_t subdev;
-    uint8_t mode;
-    uint8_t bits_per_word;
-    int16_t cs_pin;
-    uint32_t lowspeed;
-    uint32_t highspeed;
-};
-
 
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_PXF || CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_ERLEBOARD
 SPIDesc SPIDeviceManager::_device[] = {
@@ -156,29 +133,6 @@ SPIDesc SPIDeviceManager::_device[] = {
 const uint8_t SPIDeviceManager::_n_device_desc = LINUX_SPI_DEVICE_NUM_DEVICES;
 
 
-/* Private struct to maintain for each bus */
-class SPIBus : public TimerPollable::WrapperCb {
-public:
-    ~SPIBus();
-
-    /*
-     * TimerPollable::WrapperCb methods to take
-     * and release semaphore while calling the callback
-     */
-    void start_cb() override;
-    void end_cb() override;
-
-    int open(uint16_t bus_, uint16_t kernel_cs_);
-
-    PollerThread thread;
-    Semaphore sem;
-    int fd = -1;
-    uint16_t bus;
-    uint16_t kernel_cs;
-    uint8_t ref;
-    int16_t last_mode = -1;
-};
-
 SPIBus::~SPIBus()
 {
     if (fd >= 0) {
@@ -196,6 +150,11 @@ void SPIBus::end_cb()
     sem.give();
 }
 
+int SPIBus::ioctl(unsigned long request, void *arg)
+{
+    return ::ioctl(fd, request, arg);
+}
+
 
 int SPIBus::open(uint16_t bus_, uint16_t kernel_cs_)
 {
@@ -294,39 +253,12 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         return false;
     }
 
-    int r;
-    if (_bus.last_mode == _desc.mode) {
-        /*
-          the mode in the kernel is not tied to the file descriptor,
-          so there is a chance some other process has changed it since
-          we last used the bus. We want to report when this happens so
-          the user has a chance of figuring out when there is
-          conflicted use of the SPI bus. Unfortunately this costs us
-          an extra syscall per transfer.
-         */
-        uint8_t current_mode;
-        if (ioctl(_bus.fd, SPI_IOC_RD_MODE, &current_mode) < 0) {
-            hal.console->printf("SPIDevice: error on getting mode fd=%d (%s)\n",
-                                _bus.fd, strerror(errno));
-            _bus.last_mode = -1;
-        } else if (current_mode != _bus.last_mode) {
-            hal.console->printf("SPIDevice: bus mode conflict fd=%d mode=%u/%u\n",
-                                _bus.fd, (unsigned)_bus.last_mode, (unsigned)current_mode);
-            _bus.last_mode = -1;
-        }
-    }
-    if (_desc.mode != _bus.last_mode) {
-        r = ioctl(_bus.fd, SPI_IOC_WR_MODE, &_desc.mode);
-        if (r < 0) {
-            hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
-                                _bus.fd, strerror(errno));
-            return false;
-        }
-        _bus.last_mode = _desc.mode;
+    if (!_set_mode()) {
+        return false;
     }
 
     _cs_assert();
-    r = ioctl(_bus.fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    int r = _bus.ioctl(SPI_IOC_MESSAGE(nmsgs), &msgs);
     _cs_release();
 
     if (r == -1) {
@@ -357,7 +289,7 @@ bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
     msgs[0].bits_per_word = _desc.bits_per_word;
     msgs[0].cs_change = 0;
 
-    int r = ioctl(_bus.fd, SPI_IOC_WR_MODE, &_desc.mode);
+    int r = _bus.ioctl(SPI_IOC_WR_MODE, &_desc.mode);
     if (r < 0) {
         hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
                             _bus.fd, strerror(errno));
@@ -365,7 +297,7 @@ bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
     }
 
     _cs_assert();
-    r = ioctl(_bus.fd, SPI_IOC_MESSAGE(1), &msgs);
+    r = _bus.ioctl(SPI_IOC_MESSAGE(1), &msgs);
     _cs_release();
 
     if (r == -1) {
@@ -378,6 +310,115 @@ bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
 }
 
 
+bool SPIDevice::_set_mode()
+{
+    if (_bus.last_mode == _desc.mode) {
+        /*
+          the mode in the kernel is not tied to the file descriptor,
+          so there is a chance some other process has changed it since
+          we last used the bus. We want to report when this happens so
+          the user has a chance of figuring out when there is
+          conflicted use of the SPI bus. Unfortunately this costs us
+          an extra syscall per transfer, or per batch of queued
+          transfers.
+         */
+        uint8_t current_mode;
+        if (_bus.ioctl(SPI_IOC_RD_MODE, &current_mode) < 0) {
+            hal.console->printf("SPIDevice: error on getting mode fd=%d (%s)\n",
+                                _bus.fd, strerror(errno));
+            _bus.last_mode = -1;
+        } else if (current_mode != _bus.last_mode) {
+            hal.console->printf("SPIDevice: bus mode conflict fd=%d mode=%u/%u\n",
+                                _bus.fd, (unsigned)_bus.last_mode, (unsigned)current_mode);
+            _bus.last_mode = -1;
+        }
+    }
+    if (_desc.mode != _bus.last_mode) {
+        if (_bus.ioctl(SPI_IOC_WR_MODE, &_desc.mode) < 0) {
+            hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
+                                _bus.fd, strerror(errno));
+            return false;
+        }
+        _bus.last_mode = _desc.mode;
+    }
+
+
+    return true;
+}
+
+/*
+ * Each queued transfer is a transaction of its own, so the chip select is
+ * released after the last message of each transfer but the last one
+ */
+bool SPIDevice::queued_in_single_request() const
+{
+    return _desc.cs_pin == SPI_CS_KERNEL;
+}
+
+bool SPIDevice::submit_queued(AP_HAL::Device::TransferCb cb)
+{
+    if (_desc.cs_pin != SPI_CS_KERNEL) {
+        /* Userspace CS can only be toggled between ioctls */
+        return AP_HAL::SPIDevice::submit_queued(cb);
+    }
+
+    struct spi_ioc_transfer msgs[2 * HAL_DEVICE_QUEUE_LEN] = { };
+    unsigned nmsgs = 0;
+
+    assert(_bus.fd >= 0);
+
+    for (uint8_t i = 0; i < _queue_len; i++) {
+        const QueuedTransfer &t = _queue[i];
+        const unsigned first = nmsgs;
+
+        if (t.speed >= 0) {
+            /* spidev takes the speed per message, so no need to split the request */
+            set_speed((AP_HAL::Device::Speed)t.speed);
+            continue;
+        }
+
+        if (t.send && t.send_len != 0) {
+            msgs[nmsgs].tx_buf = (uint64_t) t.send;
+            msgs[nmsgs].len = t.send_len;
+            nmsgs++;
+        }
+
+        if (t.recv && t.recv_len != 0) {
+            msgs[nmsgs].rx_buf = (uint64_t) t.recv;
+            msgs[nmsgs].len = t.recv_len;
+            nmsgs++;
+        }
+
+        for (unsigned j = first; j < nmsgs; j++) {
+            msgs[j].speed_hz = _speed;
+            msgs[j].bits_per_word = _desc.bits_per_word;
+        }
+        if (nmsgs > first) {
+            msgs[nmsgs - 1].cs_change = 1;
+        }
+    }
+    _queue_len = 0;
+
+    bool ret = true;
+    if (nmsgs > 0) {
+        /* Keeping the CS asserted after the last message would hold the bus */
+        msgs[nmsgs - 1].cs_change = 0;
+
+        ret = _set_mode();
+        if (ret && _bus.ioctl(SPI_IOC_MESSAGE(nmsgs), &msgs) == -1) {
+            hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
+                                _bus.fd, strerror(errno));
+            ret = false;
+        }
+    }
+
+    if (cb) {
+        cb(ret);
+    }
+
+    return ret;
+}
+
 void SPIDevice::_cs_assert()
 {
     if (_desc.cs_pin == SPI_CS_KERNEL) {
@@ -404,7 +445,9 @@ AP_HAL::Semaphore *SPIDevice::get_semaphore()
 AP_HAL::Device::PeriodicHandle SPIDevice::register_periodic_callback(
     uint32_t period_usec, AP_HAL::Device::PeriodicCb cb)
 {
-    TimerPollable *p = _bus.thread.add_timer(cb, &_bus, period_usec);
+    /* Group callbacks by device, whatever device type is set later */
+    AP_HAL::Device::PeriodicHandle p = _bus.thread.add(
+        cb, period_usec, get_bus_id_devtype(0));
     if (!p) {
         AP_HAL::panic("Could not create periodic callback");
     }
@@ -418,13 +461,13 @@ AP_HAL::Device::PeriodicHandle SPIDevice::register_periodic_callback(
                           AP_LINUX_SENSORS_SCHED_PRIO);
     }
 
-    return static_cast<AP_HAL::Device::PeriodicHandle>(p);
+    return p;
 }
 
 bool SPIDevice::adjust_periodic_callback(
     AP_HAL::Device::PeriodicHandle h, uint32_t period_usec)
 {
-    return _bus.thread.adjust_timer(static_cast<TimerPollable*>(h), period_usec);
+    return _bus.thread.adjust(h, period_usec);
 }
 
 
@@ -460,6 +503,12 @@ SPIDeviceManager::get_device(const char *name)
         return nullptr;
     }
 
+#if HAL_LINUX_SEMAPHORE_STATS
+    char sem_name[24];
+    snprintf(sem_name, sizeof(sem_name), "spi%u.%u_sem", desc->bus, desc->subdev);
+    b->sem.enable_stats(sem_name);
+#endif
+
     auto dev = _create_device(*b, *desc);
     if (!dev) {
         return nullptr;
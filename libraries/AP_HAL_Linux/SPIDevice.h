@@ -57,6 +57,15 @@ public:
     bool adjust_periodic_callback(
         AP_HAL::Device::PeriodicHandle h, uint32_t period_usec) override;
 
+    /*
+     * See AP_HAL::Device::submit_queued(). With the kernel driving the chip
+     * select all the queued transfers are done by a single ioctl
+     */
+    bool submit_queued(AP_HAL::Device::TransferCb cb = nullptr) override;
+
+    /* Only if the kernel drives the chip select, see submit_queued() */
+    bool queued_in_single_request() const override;
+
 protected:
     SPIBus &_bus;
     SPIDesc &_desc;
@@ -72,6 +81,11 @@ protected:
      * Deselect device if using userspace CS
      */
     void _cs_release();
+
+    /*
+     * Set the SPI mode of the bus for this device
+     */
+    bool _set_mode();
 };
 
 class SPIDeviceManager : public AP_HAL::SPIDeviceManager {
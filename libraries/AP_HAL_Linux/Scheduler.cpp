@@ -10,11 +10,13 @@
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 #include "RCInput.h"
 #include "SPIUARTDriver.h"
 #include "Storage.h"
+#include "ThreadPlacement.h"
 #include "UARTDriver.h"
 #include "Util.h"
 
@@ -82,11 +84,14 @@ void Scheduler::init()
         SCHED_THREAD(uart, UART),
         SCHED_THREAD(rcin, RCIN),
         SCHED_THREAD(tonealarm, TONEALARM),
-        SCHED_THREAD(io, IO),
     };
 
     _main_ctx = pthread_self();
 
+#if HAL_LINUX_SEMAPHORE_STATS
+    _timer_semaphore.enable_stats("timer_sem");
+#endif
+
 #if !APM_BUILD_TYPE(APM_BUILD_Replay)
     // we don't run Replay in real-time...
     mlockall(MCL_CURRENT|MCL_FUTURE);
@@ -98,6 +103,13 @@ void Scheduler::init()
     }
 #endif
 
+    cpu_set_t cpus;
+    if (ThreadPlacement::get_instance()->get_cpus("main", cpus) &&
+        sched_setaffinity(0, sizeof(cpus), &cpus) == -1) {
+        AP_HAL::panic("Scheduler: failed to set CPU affinity: %s",
+                      strerror(errno));
+    }
+
     /* set barrier to N + 1 threads: worker threads + main */
     unsigned n_threads = ARRAY_SIZE(sched_table) + 1;
     ret = pthread_barrier_init(&_initialized_barrier, nullptr, n_threads);
@@ -106,6 +118,12 @@ void Scheduler::init()
                       strerror(ret));
     }
 
+#if !HAL_LINUX_UARTS_ON_TIMER_THREAD
+    if (_uart_poller) {
+        _uart_thread.set_poller(&_uart_poller);
+    }
+#endif
+
     for (size_t i = 0; i < ARRAY_SIZE(sched_table); i++) {
         const struct sched_table *t = &sched_table[i];
 
@@ -114,6 +132,10 @@ void Scheduler::init()
         t->thread->start(t->name, t->policy, t->prio);
     }
 
+    // process any pending storage writes
+    _io_pool.add(FUNCTOR_BIND(hal.storage, &AP_HAL::Storage::_timer_tick, void),
+                 hz_to_usec(APM_LINUX_IO_RATE));
+
 #if defined(DEBUG_STACK) && DEBUG_STACK
     register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_stack, void));
 #endif
@@ -131,7 +153,7 @@ void Scheduler::_debug_stack()
                 "\tuart  = %zu\n"
                 "\ttone  = %zu\n",
                 _timer_thread.get_stack_usage(),
-                _io_thread.get_stack_usage(),
+                _io_pool.get_stack_usage(),
                 _rcin_thread.get_stack_usage(),
                 _uart_thread.get_stack_usage(),
                 _tonealarm_thread.get_stack_usage());
@@ -139,6 +161,49 @@ void Scheduler::_debug_stack()
     }
 }
 
+/*
+ * Where the scheduler thread at @index ran and how late it woke up, to
+ * check its CPU placement. Reads /proc so it must not be called from the
+ * scheduler threads themselves.
+ */
+bool Scheduler::get_thread_stats(uint8_t index, thread_stats &stats)
+{
+    const struct {
+        const char *name;
+        SchedulerThread *thread;
+    } threads[] = {
+        { "timer", &_timer_thread },
+        { "rcin", &_rcin_thread },
+        { "uart", &_uart_thread },
+        { "tone", &_tonealarm_thread },
+    };
+
+    if (index >= ARRAY_SIZE(threads)) {
+        return false;
+    }
+
+    stats = { };
+    stats.name = threads[index].name;
+    stats.cpu = -1;
+
+    Thread::Stats kernel;
+    if (threads[index].thread->get_stats(kernel)) {
+        stats.cpu = kernel.cpu;
+        stats.run_ms = kernel.run_usec / 1000;
+        stats.wait_ms = kernel.wait_usec / 1000;
+        stats.preemptions = kernel.involuntary_switches;
+    }
+
+    PeriodicThread::WakeupStats wakeup;
+    if (threads[index].thread->take_wakeup_stats(wakeup) && wakeup.wakeups > 0) {
+        stats.wakeups = wakeup.wakeups;
+        stats.max_late_us = wakeup.max_late_usec;
+        stats.avg_late_us = wakeup.total_late_usec / wakeup.wakeups;
+    }
+
+    return true;
+}
+
 void Scheduler::microsleep(uint32_t usec)
 {
     struct timespec ts;
@@ -205,16 +270,7 @@ void Scheduler::register_timer_process(AP_HAL::MemberProc proc)
 
 void Scheduler::register_io_process(AP_HAL::MemberProc proc)
 {
-    for (uint8_t i = 0; i < _num_io_procs; i++) {
-        if (_io_proc[i] == proc) {
-            return;
-        }
-    }
-
-    if (_num_io_procs < LINUX_SCHEDULER_MAX_IO_PROCS) {
-        _io_proc[_num_io_procs] = proc;
-        _num_io_procs++;
-    } else {
+    if (!_io_pool.add(proc, hz_to_usec(APM_LINUX_IO_RATE))) {
         hal.console->printf("Out of IO processes\n");
     }
 }
@@ -287,22 +343,6 @@ void Scheduler::_timer_task()
 #endif
 }
 
-void Scheduler::_run_io(void)
-{
-    if (!_io_semaphore.take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
-        return;
-    }
-
-    // now call the IO based drivers
-    for (int i = 0; i < _num_io_procs; i++) {
-        if (_io_proc[i]) {
-            _io_proc[i]();
-        }
-    }
-
-    _io_semaphore.give();
-}
-
 /*
   run timers for all UARTs
  */
@@ -317,6 +357,18 @@ void Scheduler::_run_uarts()
     hal.uartF->_timer_tick();
 }
 
+Poller *Scheduler::get_uart_poller()
+{
+#if HAL_LINUX_UARTS_ON_TIMER_THREAD
+    return nullptr;
+#else
+    if (!_uart_poller) {
+        return nullptr;
+    }
+    return &_uart_poller;
+#endif
+}
+
 void Scheduler::_rcin_task()
 {
 #if !HAL_LINUX_UARTS_ON_TIMER_THREAD
@@ -337,15 +389,6 @@ void Scheduler::_tonealarm_task()
     Util::from(hal.util)->_toneAlarm_timer_tick();
 }
 
-void Scheduler::_io_task()
-{
-    // process any pending storage writes
-    hal.storage->_timer_tick();
-
-    // run registered IO processes
-    _run_io();
-}
-
 bool Scheduler::in_main_thread() const
 {
     return pthread_equal(pthread_self(), _main_ctx);
@@ -368,6 +411,10 @@ void Scheduler::system_initialized()
     _initialized = true;
 
     _wait_all_threads();
+
+    if (!_io_pool.start("ap-io", SCHED_FIFO, APM_LINUX_IO_PRIORITY)) {
+        AP_HAL::panic("Scheduler: failed to start IO threads");
+    }
 }
 
 void Scheduler::reboot(bool hold_in_bootloader)
@@ -379,7 +426,7 @@ void Scheduler::stop_clock(uint64_t time_usec)
 {
     if (time_usec >= _stopped_clock_usec) {
         _stopped_clock_usec = time_usec;
-        _run_io();
+        _io_pool.run_all();
     }
 }
 
@@ -401,13 +448,13 @@ bool Scheduler::SchedulerThread::_run()
 void Scheduler::teardown()
 {
     _timer_thread.stop();
-    _io_thread.stop();
+    _io_pool.stop();
     _rcin_thread.stop();
     _uart_thread.stop();
     _tonealarm_thread.stop();
 
     _timer_thread.join();
-    _io_thread.join();
+    _io_pool.join();
     _rcin_thread.join();
     _uart_thread.join();
     _tonealarm_thread.join();
@@ -3,12 +3,14 @@
 #include <pthread.h>
 
 #include "AP_HAL_Linux.h"
+#include "IOPool.h"
+#include "Poller.h"
 #include "Semaphores.h"
 #include "Thread.h"
 
 #define LINUX_SCHEDULER_MAX_TIMER_PROCS 10
 #define LINUX_SCHEDULER_MAX_TIMESLICED_PROCS 10
-#define LINUX_SCHEDULER_MAX_IO_PROCS 10
+#define LINUX_SCHEDULER_IO_WORKERS 2
 
 #define AP_LINUX_SENSORS_STACK_SIZE  256 * 1024
 #define AP_LINUX_SENSORS_SCHED_POLICY  SCHED_FIFO
@@ -37,6 +39,8 @@ public:
 
     bool     in_main_thread() const override;
 
+    bool     get_thread_stats(uint8_t index, thread_stats &stats) override;
+
     void     register_timer_failsafe(AP_HAL::Proc, uint32_t period_us);
 
     void     system_initialized();
@@ -51,6 +55,13 @@ public:
 
     void teardown();
 
+    /*
+     * Poller the UART thread waits on between ticks, so devices with a
+     * file descriptor can be serviced as soon as they have input. Returns
+     * nullptr if UARTs can only be polled.
+     */
+    Poller *get_uart_poller();
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -81,22 +92,16 @@ private:
     uint8_t _num_timer_procs;
     volatile bool _in_timer_proc;
 
-    AP_HAL::MemberProc _io_proc[LINUX_SCHEDULER_MAX_IO_PROCS];
-    uint8_t _num_io_procs;
-
     SchedulerThread _timer_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_timer_task, void), *this};
-    SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
     SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
     SchedulerThread _tonealarm_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_tonealarm_task, void), *this};
 
     void _timer_task();
-    void _io_task();
     void _rcin_task();
     void _uart_task();
     void _tonealarm_task();
 
-    void _run_io();
     void _run_uarts();
 
     uint64_t _stopped_clock_usec;
@@ -104,7 +109,11 @@ private:
     pthread_t _main_ctx;
 
     Semaphore _timer_semaphore;
-    Semaphore _io_semaphore;
+
+    /* Runs the IO processes, each as its own task */
+    IOPool _io_pool{LINUX_SCHEDULER_IO_WORKERS};
+
+    Poller _uart_poller;
 };
 
 }
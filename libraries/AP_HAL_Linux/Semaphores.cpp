@@ -1,35 +1,242 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+
 #include <AP_HAL/AP_HAL.h>
 
 #include "Semaphores.h"
+#include "Perf.h"
 
 extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
 
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 30)
+#define HAVE_PTHREAD_MUTEX_CLOCKLOCK 1
+#endif
+#endif
+
+/* Longest wait on CLOCK_REALTIME when pthread_mutex_clocklock() isn't available */
+#define TIMEDLOCK_SLICE_USEC 10000
+
+static void timespec_add_usec(struct timespec &ts, uint64_t usec)
+{
+    ts.tv_sec += usec / 1000000;
+    ts.tv_nsec += (usec % 1000000) * 1000;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+}
+
+/*
+ * Wait for @lock for up to @timeout_usec. The timeout is measured on the
+ * monotonic clock, since the system clock is stepped to GPS time in flight.
+ */
+static int mutex_lock_timeout(pthread_mutex_t *lock, uint64_t timeout_usec)
+{
+#ifdef HAVE_PTHREAD_MUTEX_CLOCKLOCK
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    timespec_add_usec(ts, timeout_usec);
+    return pthread_mutex_clocklock(lock, CLOCK_MONOTONIC, &ts);
+#else
+    /*
+     * pthread_mutex_timedlock() only takes CLOCK_REALTIME deadlines, so
+     * wait in short slices and check the time left against micros64(): a
+     * step of the system clock then only shortens or stretches one slice
+     */
+    const uint64_t deadline = AP_HAL::micros64() + timeout_usec;
+    for (;;) {
+        const uint64_t now = AP_HAL::micros64();
+        if (now >= deadline) {
+            return ETIMEDOUT;
+        }
+        const uint64_t left = deadline - now;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        timespec_add_usec(ts, left < TIMEDLOCK_SLICE_USEC ? left : TIMEDLOCK_SLICE_USEC);
+        const int ret = pthread_mutex_timedlock(lock, &ts);
+        if (ret != ETIMEDOUT) {
+            return ret;
+        }
+    }
+#endif
+}
+
+struct Semaphore::Stats {
+    char name[24];
+
+    AP_HAL::Util::perf_counter_t wait;
+    AP_HAL::Util::perf_counter_t hold;
+
+    /* name of the thread holding the semaphore */
+    char owner[16];
+
+    Contention contention;
+    uint32_t reported_contended;
+    uint64_t last_report_msec;
+};
+
+/* Name of the calling thread, read once */
+static const char *thread_name()
+{
+    static thread_local char name[16];
+
+    if (!name[0]) {
+        if (prctl(PR_GET_NAME, name, 0, 0, 0) < 0 || !name[0]) {
+            strncpy(name, "?", sizeof(name));
+        }
+    }
+
+    return name;
+}
+
+Semaphore::Semaphore()
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+Semaphore::~Semaphore()
+{
+    pthread_mutex_destroy(&_lock);
+    delete _stats;
+}
+
+void Semaphore::enable_stats(const char *name)
+{
+    if (_stats) {
+        return;
+    }
+
+    Stats *stats = new Stats();
+    if (!stats) {
+        return;
+    }
+
+    char counter[40];
+    strncpy(stats->name, name, sizeof(stats->name) - 1);
+    snprintf(counter, sizeof(counter), "%s_wait", stats->name);
+    stats->wait = Perf::get_instance()->add(AP_HAL::Util::PC_ELAPSED, strdup(counter));
+    snprintf(counter, sizeof(counter), "%s_hold", stats->name);
+    stats->hold = Perf::get_instance()->add(AP_HAL::Util::PC_ELAPSED, strdup(counter));
+
+    _stats = stats;
+}
+
+bool Semaphore::get_contention(Contention &contention)
+{
+    if (!_stats) {
+        return false;
+    }
+
+    /* Not taking the semaphore so the stats don't count this read */
+    contention = _stats->contention;
+
+    return true;
+}
+
+/* Called with the semaphore held */
+void Semaphore::_taken()
+{
+    Perf::get_instance()->begin(_stats->hold);
+    memcpy(_stats->owner, thread_name(), sizeof(_stats->owner));
+    _stats->contention.takes++;
+}
+
+/* Called with the semaphore held after waiting for @owner */
+void Semaphore::_contended(uint64_t wait_usec, const char *owner)
+{
+    Contention &c = _stats->contention;
+
+    c.contended++;
+    if (wait_usec > c.max_wait_usec) {
+        c.max_wait_usec = wait_usec;
+        strncpy(c.max_wait_owner, owner, sizeof(c.max_wait_owner) - 1);
+    }
+
+    const uint64_t now = AP_HAL::millis64();
+    if (now - _stats->last_report_msec < 5000) {
+        return;
+    }
+
+    fprintf(stderr, "Semaphore %s: %u of %u takes waited, longest %" PRIu64 "us for %s\n",
+            _stats->name, c.contended - _stats->reported_contended, c.takes,
+            c.max_wait_usec, c.max_wait_owner);
+    _stats->reported_contended = c.contended;
+    _stats->last_report_msec = now;
+}
+
 bool Semaphore::give()
 {
+    if (_stats) {
+        Perf::get_instance()->end(_stats->hold);
+    }
     return pthread_mutex_unlock(&_lock) == 0;
 }
 
 bool Semaphore::take(uint32_t timeout_ms)
 {
-    if (timeout_ms == HAL_SEMAPHORE_BLOCK_FOREVER) {
+    if (!_stats && timeout_ms == HAL_SEMAPHORE_BLOCK_FOREVER) {
         return pthread_mutex_lock(&_lock) == 0;
     }
     if (take_nonblocking()) {
         return true;
     }
-    uint64_t start = AP_HAL::micros64();
-    do {
-        hal.scheduler->delay_microseconds(200);
-        if (take_nonblocking()) {
-            return true;
-        }
-    } while ((AP_HAL::micros64() - start) < timeout_ms*1000);
-    return false;
+
+    /*
+     * Block in the kernel instead of polling so the owner inherits our
+     * priority while we wait
+     */
+    char owner[16] = "?";
+    uint64_t start = 0;
+    if (_stats) {
+        memcpy(owner, _stats->owner, sizeof(owner) - 1);
+        start = AP_HAL::micros64();
+        Perf::get_instance()->begin(_stats->wait);
+    }
+
+    int ret;
+    if (timeout_ms == HAL_SEMAPHORE_BLOCK_FOREVER) {
+        ret = pthread_mutex_lock(&_lock);
+    } else {
+        ret = mutex_lock_timeout(&_lock, timeout_ms * 1000ULL);
+    }
+
+    if (_stats) {
+        Perf::get_instance()->end(_stats->wait);
+    }
+
+    if (ret != 0) {
+        return false;
+    }
+
+    if (_stats) {
+        _taken();
+        _contended(AP_HAL::micros64() - start, owner);
+    }
+
+    return true;
 }
 
 bool Semaphore::take_nonblocking()
 {
-    return pthread_mutex_trylock(&_lock) == 0;
+    if (pthread_mutex_trylock(&_lock) != 0) {
+        return false;
+    }
+
+    if (_stats) {
+        _taken();
+    }
+
+    return true;
 }
@@ -8,16 +8,45 @@
 
 namespace Linux {
 
+/*
+ * Mutex with priority inheritance: a thread holding it runs at the
+ * priority of the highest priority thread waiting for it.
+ */
 class Semaphore : public AP_HAL::Semaphore {
 public:
-    Semaphore() {
-        pthread_mutex_init(&_lock, nullptr);
-    }
+    /* Contention since stats were enabled */
+    struct Contention {
+        uint32_t takes;
+        uint32_t contended;         // takes that had to wait
+        uint64_t max_wait_usec;
+        char max_wait_owner[16];    // thread holding it during the longest wait
+    };
+
+    Semaphore();
+    ~Semaphore();
+
     bool give();
     bool take(uint32_t timeout_ms);
     bool take_nonblocking();
+
+    /*
+     * Time waits and holds in the perf counters @name_wait and
+     * @name_hold and report the longest wait every few seconds. Must be
+     * called before the semaphore is used.
+     */
+    void enable_stats(const char *name);
+
+    bool get_contention(Contention &contention);
+
 private:
+    struct Stats;
+
+    void _taken();
+    void _contended(uint64_t wait_usec, const char *owner);
+
     pthread_mutex_t _lock;
+
+    Stats *_stats = nullptr;
 };
 
 }
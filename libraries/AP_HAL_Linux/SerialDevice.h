@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <AP_HAL/utility/RingBuffer.h>
+
 #include "AP_HAL_Linux.h"
 
 class SerialDevice {
@@ -20,4 +22,41 @@ public:
     {
         /* most devices simply ignore this setting */
     };
+
+    /*
+     * File descriptor that becomes readable when read() has data, or -1 if
+     * the device has to be polled. It may change while the device is open,
+     * e.g. when a TCP client connects.
+     */
+    virtual int get_fd() const { return -1; }
+
+    /*
+     * Changes whenever the descriptor returned by get_fd() is replaced, even
+     * by one with the same number, so users know to register it again.
+     */
+    uint32_t get_fd_generation() const { return _fd_generation; }
+
+    /*
+     * Write both parts of a ring buffer. Devices that can gather the parts
+     * in a single system call override this, the default writes them one
+     * after the other and stops on a short write.
+     */
+    virtual ssize_t writev(const ByteBuffer::IoVec vec[], uint8_t n_vec)
+    {
+        ssize_t total = 0;
+        for (uint8_t i = 0; i < n_vec; i++) {
+            ssize_t ret = write(vec[i].data, (uint16_t)vec[i].len);
+            if (ret < 0) {
+                return total > 0 ? total : ret;
+            }
+            total += ret;
+            if ((size_t)ret != vec[i].len) {
+                break;
+            }
+        }
+        return total;
+    }
+
+protected:
+    uint32_t _fd_generation = 0;
 };
@@ -3,6 +3,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
@@ -32,6 +33,29 @@ ssize_t TCPServerDevice::write(const uint8_t *buf, uint16_t n)
     return sock->send(buf, n);
 }
 
+ssize_t TCPServerDevice::writev(const ByteBuffer::IoVec vec[], uint8_t n_vec)
+{
+    if (sock == nullptr) {
+        return -1;
+    }
+
+    struct iovec iov[2];
+    if (n_vec > 2) {
+        n_vec = 2;
+    }
+    for (uint8_t i = 0; i < n_vec; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+
+    struct msghdr msg = { };
+    msg.msg_iov = iov;
+    msg.msg_iovlen = n_vec;
+
+    // a client that went away must not raise SIGPIPE
+    return ::sendmsg(sock->get_fd(), &msg, MSG_NOSIGNAL);
+}
+
 /*
   when we try to read we accept new connections if one isn't already
   established
@@ -42,6 +66,7 @@ ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
         sock = listener.accept(0);
         if (sock != nullptr) {
             sock->set_blocking(_blocking);
+            _fd_generation++;
         }
     }
     if (sock == nullptr) {
@@ -52,6 +77,7 @@ ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
         // EOF, go back to waiting for a new connection
         delete sock;
         sock = nullptr;
+        _fd_generation++;
         return -1;
     }
     return ret;
@@ -93,6 +119,7 @@ bool TCPServerDevice::open()
             sock = listener.accept(1000);
         }
         sock->set_blocking(_blocking);
+        _fd_generation++;
         ::printf("connected\n");
         ::fflush(stdout);
     }
@@ -105,6 +132,7 @@ bool TCPServerDevice::close()
     if (sock != nullptr) {
         delete sock;
         sock = nullptr;
+        _fd_generation++;
     }
     return true;
 }
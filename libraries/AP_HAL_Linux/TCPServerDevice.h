@@ -14,6 +14,10 @@ public:
     virtual void set_speed(uint32_t speed) override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+    virtual ssize_t writev(const ByteBuffer::IoVec vec[], uint8_t n_vec) override;
+
+    /* until a client connects, wait on the listener for new connections */
+    virtual int get_fd() const override { return sock ? sock->get_fd() : listener.get_fd(); }
 
 private:
     SocketAPM listener{false};
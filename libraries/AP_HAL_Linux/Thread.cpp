@@ -17,15 +17,20 @@
 #include "Thread.h"
 
 #include <alloca.h>
+#include <inttypes.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <utility>
 
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
+#include "Poller.h"
 #include "Scheduler.h"
+#include "ThreadPlacement.h"
 
 #define STACK_POISON 0xBEBACAFE
 
@@ -37,6 +42,7 @@ namespace Linux {
 void *Thread::_run_trampoline(void *arg)
 {
     Thread *thread = static_cast<Thread *>(arg);
+    thread->_tid = syscall(SYS_gettid);
     thread->_poison_stack();
     thread->_run();
 
@@ -184,6 +190,14 @@ bool Thread::start(const char *name, int policy, int prio)
         }
     }
 
+    cpu_set_t cpus;
+    if (name && ThreadPlacement::get_instance()->get_cpus(name, cpus)) {
+        if ((r = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus)) != 0) {
+            AP_HAL::panic("Failed to set CPU affinity for thread '%s': %s",
+                          name, strerror(r));
+        }
+    }
+
     r = pthread_create(&_ctx, &attr, &Thread::_run_trampoline, this);
     if (r != 0) {
         AP_HAL::panic("Failed to create thread '%s': %s",
@@ -222,6 +236,63 @@ bool Thread::join()
 }
 
 
+bool Thread::get_stats(Stats &stats)
+{
+    char path[64];
+    char buf[1024];
+    FILE *f;
+
+    if (_tid == 0) {
+        return false;
+    }
+
+    stats = { };
+
+    /* The processor is the 39th field, the 37th after the command name */
+    snprintf(path, sizeof(path), "/proc/self/task/%d/stat", (int)_tid);
+    f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    char *p = fgets(buf, sizeof(buf), f);
+    fclose(f);
+    if (!p || !(p = strrchr(buf, ')'))) {
+        return false;
+    }
+    for (uint8_t i = 0; i < 37 && p; i++) {
+        p = strchr(p + 1, ' ');
+    }
+    if (!p || sscanf(p, "%d", &stats.cpu) != 1) {
+        return false;
+    }
+
+    /* Nanoseconds running and waiting on a runqueue */
+    snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", (int)_tid);
+    f = fopen(path, "r");
+    if (f) {
+        unsigned long long run_nsec, wait_nsec;
+        if (fscanf(f, "%llu %llu", &run_nsec, &wait_nsec) == 2) {
+            stats.run_usec = run_nsec / 1000;
+            stats.wait_usec = wait_nsec / 1000;
+        }
+        fclose(f);
+    }
+
+    snprintf(path, sizeof(path), "/proc/self/task/%d/status", (int)_tid);
+    f = fopen(path, "r");
+    if (f) {
+        while (fgets(buf, sizeof(buf), f)) {
+            if (sscanf(buf, "nonvoluntary_ctxt_switches: %" SCNu32,
+                       &stats.involuntary_switches) == 1) {
+                break;
+            }
+        }
+        fclose(f);
+    }
+
+    return true;
+}
+
 bool PeriodicThread::set_rate(uint32_t rate_hz)
 {
     if (_started || rate_hz == 0) {
@@ -233,6 +304,17 @@ bool PeriodicThread::set_rate(uint32_t rate_hz)
     return true;
 }
 
+bool PeriodicThread::set_poller(Poller *poller)
+{
+    if (_started) {
+        return false;
+    }
+
+    _poller = poller;
+
+    return true;
+}
+
 bool Thread::set_stack_size(size_t stack_size)
 {
     if (_started) {
@@ -244,6 +326,18 @@ bool Thread::set_stack_size(size_t stack_size)
     return true;
 }
 
+bool PeriodicThread::take_wakeup_stats(WakeupStats &stats)
+{
+    if (_wakeup_stats_requested.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    stats = _wakeup_stats_published;
+    _wakeup_stats_requested.store(true, std::memory_order_release);
+
+    return true;
+}
+
 bool PeriodicThread::_run()
 {
     if (_period_usec == 0) {
@@ -257,9 +351,26 @@ bool PeriodicThread::_run()
         if (dt > _period_usec) {
             // we've lost sync - restart
             next_run_usec = AP_HAL::micros64();
+        } else if (_poller) {
+            _poll_until(next_run_usec);
         } else {
             Scheduler::from(hal.scheduler)->microsleep(dt);
         }
+
+        const uint64_t now_usec = AP_HAL::micros64();
+        if (now_usec > next_run_usec) {
+            const uint32_t late = now_usec - next_run_usec;
+            _wakeup_stats.max_late_usec = MAX(_wakeup_stats.max_late_usec, late);
+            _wakeup_stats.total_late_usec += late;
+        }
+        _wakeup_stats.wakeups++;
+
+        if (_wakeup_stats_requested.load(std::memory_order_acquire)) {
+            _wakeup_stats_published = _wakeup_stats;
+            _wakeup_stats = { };
+            _wakeup_stats_requested.store(false, std::memory_order_release);
+        }
+
         next_run_usec += _period_usec;
 
         _task();
@@ -271,6 +382,22 @@ bool PeriodicThread::_run()
     return true;
 }
 
+/*
+ * Handle events from the poller until @deadline_usec. epoll only has
+ * millisecond resolution so the timeout is rounded up: the next deadline is
+ * still computed from the previous one, so this doesn't accumulate.
+ */
+void PeriodicThread::_poll_until(uint64_t deadline_usec)
+{
+    uint64_t now_usec = AP_HAL::micros64();
+
+    while (now_usec < deadline_usec && !_should_exit) {
+        int timeout_ms = (deadline_usec - now_usec + 999) / 1000;
+        _poller->poll(timeout_ms);
+        now_usec = AP_HAL::micros64();
+    }
+}
+
 bool PeriodicThread::stop()
 {
     if (!is_started()) {
@@ -278,6 +405,9 @@ bool PeriodicThread::stop()
     }
 
     _should_exit = true;
+    if (_poller) {
+        _poller->wakeup();
+    }
 
     return true;
 }
@@ -16,14 +16,18 @@
  */
 #pragma once
 
+#include <atomic>
 #include <pthread.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <sys/types.h>
 
 #include <AP_HAL/utility/functor.h>
 
 namespace Linux {
 
+class Poller;
+
 /*
  * Interface abstracting threads
  */
@@ -31,6 +35,14 @@ class Thread {
 public:
     FUNCTOR_TYPEDEF(task_t, void);
 
+    /* Scheduling of the thread since it started, as seen by the kernel */
+    struct Stats {
+        int cpu;                        // CPU it last ran on
+        uint64_t run_usec;              // time spent running
+        uint64_t wait_usec;             // time spent runnable, waiting for a CPU
+        uint32_t involuntary_switches;  // times it was preempted
+    };
+
     Thread(task_t t) : _task(t) { }
 
     virtual ~Thread() { }
@@ -49,6 +61,8 @@ public:
 
     bool join();
 
+    bool get_stats(Stats &stats);
+
 protected:
     static void *_run_trampoline(void *arg);
 
@@ -65,6 +79,7 @@ protected:
     bool _started = false;
     bool _should_exit = false;
     pthread_t _ctx = 0;
+    pid_t _tid = 0;
 
     struct stack_debug {
         uint32_t *start;
@@ -82,12 +97,45 @@ public:
 
     bool set_rate(uint32_t rate_hz);
 
+    /*
+     * Dispatch events from @poller while waiting for the next period
+     * instead of sleeping. Must be called before the thread is started.
+     */
+    bool set_poller(Poller *poller);
+
     bool stop() override;
 
+    /* How late the thread woke up for each period */
+    struct WakeupStats {
+        uint32_t wakeups;
+        uint32_t max_late_usec;
+        uint64_t total_late_usec;
+    };
+
+    /*
+     * Get the wakeup stats the thread published since the previous call
+     * and ask it for the next ones. Returns false if it has not run since
+     * the previous call.
+     */
+    bool take_wakeup_stats(WakeupStats &stats);
+
 protected:
     bool _run() override;
 
+    void _poll_until(uint64_t deadline_usec);
+
     uint64_t _period_usec = 0;
+    Poller *_poller = nullptr;
+
+    /* Only used by the thread itself */
+    WakeupStats _wakeup_stats = { };
+
+    /*
+     * Handed over to a reader: the thread only writes it while requested
+     * is set and the reader only reads it while requested is clear
+     */
+    WakeupStats _wakeup_stats_published = { };
+    std::atomic<bool> _wakeup_stats_requested { false };
 };
 
 }
@@ -0,0 +1,170 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ThreadPlacement.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sysinfo.h>
+
+#define ISOLATED_CPUS_PATH "/sys/devices/system/cpu/isolated"
+
+namespace Linux {
+
+ThreadPlacement *ThreadPlacement::_instance;
+
+ThreadPlacement *ThreadPlacement::get_instance()
+{
+    if (!_instance) {
+        _instance = new ThreadPlacement();
+    }
+
+    return _instance;
+}
+
+static bool read_isolated_cpus(cpu_set_t &cpus)
+{
+    char buf[256];
+
+    FILE *f = fopen(ISOLATED_CPUS_PATH, "r");
+    if (!f) {
+        return false;
+    }
+    const bool ok = fgets(buf, sizeof(buf), f) != nullptr;
+    fclose(f);
+
+    if (!ok) {
+        return false;
+    }
+    buf[strcspn(buf, "\n")] = '\0';
+
+    /* The kernel uses an empty list when no CPU is isolated */
+    return buf[0] != '\0' && strcmp(buf, "isolated") != 0 &&
+        ThreadPlacement::parse_cpu_list(buf, cpus);
+}
+
+bool ThreadPlacement::parse_cpu_list(const char *list, cpu_set_t &cpus)
+{
+    const long n_cpus = get_nprocs_conf();
+
+    CPU_ZERO(&cpus);
+
+    if (strcmp(list, "isolated") == 0) {
+        if (!read_isolated_cpus(cpus)) {
+            fprintf(stderr, "ThreadPlacement: no isolated CPUs\n");
+            return false;
+        }
+        return true;
+    }
+
+    const char *p = list;
+    do {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+
+        if (end == p) {
+            return false;
+        }
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p) {
+                return false;
+            }
+        }
+        if (first < 0 || last < first || last >= n_cpus || last >= CPU_SETSIZE) {
+            fprintf(stderr, "ThreadPlacement: invalid CPUs in '%s'\n", list);
+            return false;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+
+        p = end;
+    } while (*p++ == ',');
+
+    return *(p - 1) == '\0';
+}
+
+bool ThreadPlacement::parse(const char *spec)
+{
+    std::vector<Entry> entries;
+    char *copy = strdup(spec);
+    char *saveptr = nullptr;
+    bool ok = copy != nullptr;
+
+    for (char *tok = ok ? strtok_r(copy, ";", &saveptr) : nullptr;
+         tok && ok; tok = strtok_r(nullptr, ";", &saveptr)) {
+        Entry e { };
+        char *eq = strchr(tok, '=');
+
+        if (!eq || eq == tok || (size_t)(eq - tok) >= sizeof(e.name)) {
+            fprintf(stderr, "ThreadPlacement: invalid entry '%s'\n", tok);
+            ok = false;
+            break;
+        }
+        memcpy(e.name, tok, eq - tok);
+        ok = parse_cpu_list(eq + 1, e.cpus);
+        entries.push_back(e);
+    }
+
+    free(copy);
+
+    if (ok) {
+        _entries = entries;
+    }
+
+    return ok;
+}
+
+bool ThreadPlacement::get_cpus(const char *name, cpu_set_t &cpus) const
+{
+    const Entry *match = nullptr;
+    size_t match_len = 0;
+
+    if (strncmp(name, "ap-", 3) == 0) {
+        name += 3;
+    }
+
+    for (const Entry &e : _entries) {
+        const size_t len = strlen(e.name);
+
+        if (strcmp(e.name, "*") == 0) {
+            if (!match) {
+                match = &e;
+            }
+            continue;
+        }
+        if (strncmp(name, e.name, len) != 0 ||
+            (name[len] != '\0' && name[len] != '-')) {
+            continue;
+        }
+        if (match_len < len) {
+            match = &e;
+            match_len = len;
+        }
+    }
+
+    if (!match) {
+        return false;
+    }
+
+    cpus = match->cpus;
+
+    return true;
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <sched.h>
+#include <vector>
+
+#include "AP_HAL_Linux.h"
+
+namespace Linux {
+
+/*
+ * CPUs each thread may run on, from a list of <thread>=<cpus> entries
+ * separated by ';' such as "timer=3;spi=3;io=isolated;*=0-2".
+ *
+ * <thread> is the thread name without its "ap-" prefix, or the start of
+ * it up to a '-': "spi" is for all the SPI bus threads and "spi-1" for the
+ * second one only. The longest match is used and "*" is for the threads
+ * no other entry matches. "main" is for the main thread.
+ *
+ * <cpus> is a list of CPUs and ranges such as "0,2-3", or "isolated" for
+ * the CPUs isolated from the kernel scheduler with isolcpus=.
+ */
+class ThreadPlacement {
+public:
+    static ThreadPlacement *get_instance();
+
+    /* Replace the placement with the one in @spec */
+    bool parse(const char *spec);
+
+    /* CPUs for the thread @name, false if it may run anywhere */
+    bool get_cpus(const char *name, cpu_set_t &cpus) const;
+
+    /* Parse a list of CPUs such as "0,2-3" or "isolated" */
+    static bool parse_cpu_list(const char *list, cpu_set_t &cpus);
+
+private:
+    struct Entry {
+        char name[16];
+        cpu_set_t cpus;
+    };
+
+    static ThreadPlacement *_instance;
+
+    std::vector<Entry> _entries;
+};
+
+}
@@ -4,6 +4,7 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <stdio.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -42,6 +43,7 @@ bool UARTDevice::open()
     }
 
     _disable_crlf();
+    _fd_generation++;
 
     return true;
 }
@@ -67,6 +69,31 @@ ssize_t UARTDevice::write(const uint8_t *buf, uint16_t n)
     return ret;
 }
 
+/*
+  gather both parts of the ring buffer in a single system call. The
+  descriptor is non-blocking so a full output queue is reported as 0
+  bytes written, matching write()
+ */
+ssize_t UARTDevice::writev(const ByteBuffer::IoVec vec[], uint8_t n_vec)
+{
+    struct iovec iov[2];
+
+    if (n_vec > 2) {
+        n_vec = 2;
+    }
+    for (uint8_t i = 0; i < n_vec; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+
+    ssize_t ret = ::writev(_fd, iov, n_vec);
+    if (ret < 0 && errno == EAGAIN) {
+        return 0;
+    }
+
+    return ret;
+}
+
 void UARTDevice::set_blocking(bool blocking)
 {
     int flags = fcntl(_fd, F_GETFL, 0);
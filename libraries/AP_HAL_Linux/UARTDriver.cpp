@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -20,6 +21,7 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "ConsoleDevice.h"
+#include "Scheduler.h"
 #include "TCPServerDevice.h"
 #include "UARTDevice.h"
 #include "UARTQFlight.h"
@@ -202,14 +204,17 @@ AP_HAL::OwnPtr<SerialDevice> UARTDriver::_parseDevicePath(const char *arg)
  */
 void UARTDriver::end()
 {
+    // wait for the UART thread to leave the device before closing it
+    _pollable_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
     _initialised = false;
     _connected = false;
 
-    while (_in_timer) {
-        hal.scheduler->delay(1);
-    }
-
+    _unregister_pollable();
     _device->close();
+
+    _pollable_sem.give();
+
     _deallocate_buffers();
 }
 
@@ -282,6 +287,15 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+ssize_t UARTDriver::read(uint8_t *buffer, uint16_t count)
+{
+    if (!_initialised) {
+        return -1;
+    }
+
+    return _readbuf.read(buffer, count);
+}
+
 /* Linux implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
@@ -425,41 +439,115 @@ bool UARTDriver::_write_pending_bytes(void)
         } else {
             ByteBuffer::IoVec vec[2];
             const auto n_vec = _writebuf.peekiovec(vec, n);
-            for (int i = 0; i < n_vec; i++) {
-                ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
-                if (ret < 0) {
-                    break;
+            if (_pollable.get_fd() >= 0 && _connected) {
+                // write both parts of the ring buffer in one go
+                ret = _device->writev(vec, n_vec);
+                if (ret > 0) {
+                    _writebuf.advance(ret);
                 }
-                _writebuf.advance(ret);
-
-                /* We wrote less than we asked for, stop */
-                if ((unsigned)ret != vec[i].len) {
-                    break;
+            } else {
+                for (int i = 0; i < n_vec; i++) {
+                    ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
+                    if (ret < 0) {
+                        break;
+                    }
+                    _writebuf.advance(ret);
+
+                    /* We wrote less than we asked for, stop */
+                    if ((unsigned)ret != vec[i].len) {
+                        break;
+                    }
                 }
             }
         }
     }
 
+    // the device didn't take everything we had ready for it
+    _write_blocked = n > 0 && available_bytes - _writebuf.available() < n;
+
     return _writebuf.available() != available_bytes;
 }
 
 /*
-  push any pending bytes to/from the serial port. This is called at
-  1kHz in the timer thread. Doing it this way reduces the system call
-  overhead in the main task enormously.
+  register the device file descriptor with the UART thread poller so
+  that input is read as soon as it arrives rather than on the next
+  tick. The descriptor can change (e.g. TCP clients connecting, or the
+  device being reopened under the same fd number), so this is
+  re-checked from every tick
  */
-void UARTDriver::_timer_tick(void)
+void UARTDriver::_update_pollable()
 {
-    if (!_initialised) return;
+    Poller *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+    if (poller == nullptr) {
+        return;
+    }
 
-    _in_timer = true;
+    const int fd = _device->get_fd();
+    const uint32_t generation = _device->get_fd_generation();
+    if (fd == _pollable.get_fd() && generation == _pollable_generation) {
+        return;
+    }
+
+    /*
+     * A closed descriptor is dropped from epoll by the kernel, so a new
+     * one with the same number must be registered again
+     */
+    _unregister_pollable();
+
+    if (fd < 0) {
+        return;
+    }
+
+    _pollable.set_fd(fd);
+    if (!poller->register_pollable(&_pollable, EPOLLIN)) {
+        _pollable.set_fd(-1);
+        return;
+    }
+    _pollable_generation = generation;
+}
+
+void UARTDriver::_unregister_pollable()
+{
+    Poller *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+    if (poller == nullptr || _pollable.get_fd() < 0) {
+        return;
+    }
+
+    poller->unregister_pollable(&_pollable);
+    _pollable.set_fd(-1);
+    _waiting_can_write = false;
+}
 
+/*
+  push out pending bytes. If the device can't take all of them, ask
+  the poller to tell us when it can rather than waiting for the next
+  tick
+ */
+void UARTDriver::_flush_pending_bytes()
+{
     uint8_t num_send = 10;
     while (num_send != 0 && _write_pending_bytes()) {
         num_send--;
     }
 
-    // try to fill the read buffer
+    if (_pollable.get_fd() < 0) {
+        return;
+    }
+
+    const bool waiting = _write_blocked && _writebuf.available() > 0;
+    if (waiting != _waiting_can_write) {
+        Poller *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+        if (poller->modify_pollable(&_pollable, waiting ? (EPOLLIN | EPOLLOUT) : EPOLLIN)) {
+            _waiting_can_write = waiting;
+        }
+    }
+}
+
+/*
+  try to fill the read buffer
+ */
+void UARTDriver::_read_pending_bytes()
+{
     int ret;
     ByteBuffer::IoVec vec[2];
 
@@ -476,6 +564,90 @@ void UARTDriver::_timer_tick(void)
             break;
         }
     }
+}
+
+/*
+  called from the UART thread poller when the device has input
+ */
+void UARTDriver::_handle_can_read()
+{
+    _pollable_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    if (_initialised) {
+        _in_timer = true;
+
+        _read_pending_bytes();
+
+        // replies to what was just read are likely to be waiting already
+        _flush_pending_bytes();
+
+        _in_timer = false;
+    }
+
+    _pollable_sem.give();
+}
+
+/*
+  called from the UART thread poller when the device can take more
+  output after a short write
+ */
+void UARTDriver::_handle_can_write()
+{
+    _pollable_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    if (_initialised) {
+        _in_timer = true;
+
+        _flush_pending_bytes();
+
+        _in_timer = false;
+    }
+
+    _pollable_sem.give();
+}
+
+/*
+  called from the UART thread poller on an error or hang up on the
+  device descriptor
+ */
+void UARTDriver::_handle_poll_error()
+{
+    _pollable_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    _unregister_pollable();
+
+    _pollable_sem.give();
+}
+
+/*
+  push any pending bytes to/from the serial port. This is called at
+  1kHz in the timer thread. Doing it this way reduces the system call
+  overhead in the main task enormously. Devices registered with the
+  UART thread poller are read as soon as input arrives instead.
+ */
+void UARTDriver::_timer_tick(void)
+{
+    if (!_initialised) return;
+
+    _pollable_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+
+    if (!_initialised) {
+        _pollable_sem.give();
+        return;
+    }
+
+    _in_timer = true;
+
+    _update_pollable();
+
+    _flush_pending_bytes();
+
+    // devices without a descriptor to wait on are polled for input
+    if (_pollable.get_fd() < 0) {
+        _read_pending_bytes();
+    }
 
     _in_timer = false;
+
+    _pollable_sem.give();
 }
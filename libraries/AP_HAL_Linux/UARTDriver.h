@@ -4,6 +4,8 @@
 #include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
+#include "Semaphores.h"
 #include "SerialDevice.h"
 
 namespace Linux {
@@ -29,6 +31,7 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    ssize_t read(uint8_t *buffer, uint16_t count) override;
 
     /* Linux implementations of Print virtual methods */
     size_t write(uint8_t c);
@@ -50,7 +53,38 @@ public:
    }
 
 private:
+    /*
+     * Dispatches events on the device's file descriptor to the driver. The
+     * descriptor is owned by the SerialDevice, so it's not closed here.
+     */
+    class DevicePollable : public Pollable {
+    public:
+        DevicePollable(UARTDriver &uart) : _uart(uart) { }
+        ~DevicePollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+
+        void on_can_read() override { _uart._handle_can_read(); }
+        void on_can_write() override { _uart._handle_can_write(); }
+
+        /* fall back to polling until the next tick registers us again */
+        void on_error() override { _uart._handle_poll_error(); }
+        void on_hang_up() override { _uart._handle_poll_error(); }
+
+    private:
+        UARTDriver &_uart;
+    };
+
     AP_HAL::OwnPtr<SerialDevice> _device;
+    DevicePollable _pollable{*this};
+    uint32_t _pollable_generation; // device fd generation _pollable was registered for
+    /*
+     * Held by the UART thread while it services the device and by end(), so
+     * the device isn't unregistered and closed under a running handler.
+     */
+    Semaphore _pollable_sem;
+    bool _write_blocked; // the last write to the device was short
+    bool _waiting_can_write; // EPOLLOUT requested after a short write
     bool _nonblocking_writes;
     bool _console;
     volatile bool _in_timer;
@@ -63,6 +97,14 @@ private:
     void _allocate_buffers(uint16_t rxS, uint16_t txS);
     void _deallocate_buffers();
 
+    void _update_pollable();
+    void _unregister_pollable();
+    void _handle_can_read();
+    void _handle_can_write();
+    void _handle_poll_error();
+    void _read_pending_bytes();
+    void _flush_pending_bytes();
+
     AP_HAL::OwnPtr<SerialDevice> _parseDevicePath(const char *arg);
     uint64_t _last_write_time;
 
@@ -91,6 +91,11 @@ public:
         return Perf::get_instance()->count(perf);
     }
 
+    void perf_trace(uint16_t trace_id, uint8_t stage) override
+    {
+        return Perf::get_instance()->trace(trace_id, stage);
+    }
+
     // create a new semaphore
     AP_HAL::Semaphore *new_semaphore(void) override { return new Semaphore; }
 
@@ -0,0 +1,88 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_WITH_UAVCAN && CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <AP_HAL_Linux/CAN.h>
+
+#include <unistd.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  Bursts of frames sent by another socket on a virtual CAN interface,
+  set up with:
+
+    ip link add dev vcan0 type vcan && ip link set up vcan0
+
+  and read back through the driver. The items processed are the frames
+  received and the label is the mean time from the kernel timestamp of a
+  frame until receive() returned it.
+ */
+#define BENCH_CAN_IFACE "vcan0"
+
+static void BM_CANReceive(benchmark::State& state)
+{
+    const int tx_fd = Linux::CAN::openSocket(BENCH_CAN_IFACE);
+    if (tx_fd < 0) {
+        fprintf(stderr, "error: couldn't open " BENCH_CAN_IFACE "\n");
+        return;
+    }
+    Linux::CAN can(Linux::CAN::openSocket(BENCH_CAN_IFACE));
+    if (can.getFileDescriptor() < 0) {
+        fprintf(stderr, "error: couldn't open second socket on " BENCH_CAN_IFACE "\n");
+        close(tx_fd);
+        return;
+    }
+
+    can_frame frame {};
+    frame.can_id = 0x1401550a | CAN_EFF_FLAG;
+    frame.can_dlc = 8;
+
+    uint64_t frames = 0;
+    uint64_t latency_usec = 0;
+    while (state.KeepRunning()) {
+        for (int i = 0; i < state.range_x(); i++) {
+            frame.data[0] = i;
+            if (write(tx_fd, &frame, sizeof(frame)) != sizeof(frame)) {
+                fprintf(stderr, "error: couldn't write to " BENCH_CAN_IFACE "\n");
+                close(tx_fd);
+                can.end();
+                return;
+            }
+        }
+
+        const uint64_t start_usec = AP_HAL::micros64();
+        for (int received = 0; received < state.range_x(); ) {
+            uavcan::CanFrame rx_frame;
+            uavcan::MonotonicTime ts_mono;
+            uavcan::UtcTime ts_utc;
+            uavcan::CanIOFlags flags;
+            if (can.receive(rx_frame, ts_mono, ts_utc, flags) == 1) {
+                latency_usec += AP_HAL::micros64() - ts_mono.toUSec();
+                received++;
+            } else if (AP_HAL::micros64() - start_usec > 1000000) {
+                fprintf(stderr, "error: frames lost on " BENCH_CAN_IFACE "\n");
+                close(tx_fd);
+                can.end();
+                return;
+            }
+        }
+        frames += state.range_x();
+    }
+
+    close(tx_fd);
+    can.end();
+
+    state.SetItemsProcessed(frames);
+
+    char label[32];
+    snprintf(label, sizeof(label), "%.1fus rx latency", frames ? (double)latency_usec / frames : 0.0);
+    state.SetLabel(label);
+}
+
+BENCHMARK(BM_CANReceive)->Arg(1)->Arg(8)->Arg(32)->Arg(128);
+
+#endif
+
+BENCHMARK_MAIN()
@@ -0,0 +1,101 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <AP_HAL_Linux/Poller.h>
+#include <AP_HAL_Linux/UARTDevice.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class DevicePollable : public Pollable {
+public:
+    DevicePollable(int fd) : Pollable(fd) { }
+    ~DevicePollable() { _fd = -1; }
+
+    void on_can_read() override { }
+};
+
+/*
+  Bytes written to the master side of a pseudo terminal and read back
+  from a UARTDevice on the slave side once the poller wakes up, as the
+  UART thread does. The label is the mean time from the write until the
+  poller woke up and until read() returned the bytes.
+ */
+static void BM_UARTPollToRead(benchmark::State& state)
+{
+    const int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        fprintf(stderr, "error: couldn't open pseudo terminal\n");
+        return;
+    }
+
+    UARTDevice dev(ptsname(master));
+    if (!dev.open()) {
+        fprintf(stderr, "error: couldn't open %s\n", ptsname(master));
+        close(master);
+        return;
+    }
+    dev.set_blocking(false);
+
+    Poller poller;
+    DevicePollable p(dev.get_fd());
+    if (!poller || !poller.register_pollable(&p, EPOLLIN)) {
+        fprintf(stderr, "error: couldn't register device with poller\n");
+        close(master);
+        return;
+    }
+
+    const ssize_t len = state.range_x();
+    uint8_t msg[64];
+    uint8_t buf[sizeof(msg)];
+    memset(msg, 'x', sizeof(msg));
+
+    uint64_t reads = 0;
+    uint64_t wakeup_usec = 0;
+    uint64_t read_usec = 0;
+    while (state.KeepRunning()) {
+        const uint64_t start_usec = AP_HAL::micros64();
+        if (write(master, msg, len) != len) {
+            fprintf(stderr, "error: couldn't write to pseudo terminal\n");
+            break;
+        }
+
+        if (poller.poll(1000) != 1) {
+            fprintf(stderr, "error: poller didn't wake up\n");
+            break;
+        }
+        wakeup_usec += AP_HAL::micros64() - start_usec;
+
+        for (ssize_t n = 0; n < len; ) {
+            const ssize_t r = dev.read(buf + n, len - n);
+            if (r > 0) {
+                n += r;
+            }
+        }
+        read_usec += AP_HAL::micros64() - start_usec;
+        reads++;
+    }
+
+    poller.unregister_pollable(&p);
+    close(master);
+
+    state.SetItemsProcessed(reads);
+
+    char label[48];
+    snprintf(label, sizeof(label), "%.1fus to wakeup, %.1fus to read",
+             reads ? (double)wakeup_usec / reads : 0.0,
+             reads ? (double)read_usec / reads : 0.0);
+    state.SetLabel(label);
+}
+
+BENCHMARK(BM_UARTPollToRead)->Arg(1)->Arg(16)->Arg(64);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,234 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/BusScheduler.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * Bus with a simulated clock: each transfer advances the clock by its
+ * latency and the bus is otherwise idle until the next deadline.
+ */
+class SimBus : public BusScheduler {
+public:
+    SimBus() : BusScheduler(nullptr) { }
+
+    uint64_t now = 0;
+
+    /* Run the callbacks with deadlines before @end_usec */
+    void run_until(uint64_t end_usec)
+    {
+        while (true) {
+            const uint64_t next_deadline = run_due();
+            if (next_deadline == 0 || next_deadline >= end_usec) {
+                return;
+            }
+            if (next_deadline > now) {
+                now = next_deadline;
+            }
+        }
+    }
+
+protected:
+    uint64_t now_usec() override { return now; }
+};
+
+class SimDevice {
+public:
+    SimDevice(SimBus &bus, uint32_t transfer_usec)
+        : _bus(bus)
+        , _transfer_usec(transfer_usec)
+    { }
+
+    void transfer()
+    {
+        _bus.now += _transfer_usec;
+        last_transfer_usec = _bus.now;
+        n_transfers++;
+    }
+
+    AP_HAL::Device::PeriodicCb cb()
+    {
+        return FUNCTOR_BIND_MEMBER(&SimDevice::transfer, void);
+    }
+
+    unsigned n_transfers = 0;
+    uint64_t last_transfer_usec = 0;
+
+private:
+    SimBus &_bus;
+    uint32_t _transfer_usec;
+};
+
+TEST(LinuxBusScheduler, rates)
+{
+    SimBus bus;
+    SimDevice imu(bus, 100), baro(bus, 300), compass(bus, 200);
+
+    bus.add(imu.cb(), 1000, 1);
+    bus.add(baro.cb(), 10000, 2);
+    bus.add(compass.cb(), 10000, 3);
+
+    bus.run_until(1000000);
+
+    /* Every device gets its rate, the IMU losing none of its periods */
+    EXPECT_NEAR(imu.n_transfers, 1000U, 1);
+    EXPECT_NEAR(baro.n_transfers, 100U, 1);
+    EXPECT_NEAR(compass.n_transfers, 100U, 1);
+
+    BusScheduler::DeviceStats stats;
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(bus.get_device_stats(i, stats));
+        EXPECT_EQ(stats.missed, 0U);
+    }
+    EXPECT_FALSE(bus.get_device_stats(3, stats));
+}
+
+TEST(LinuxBusScheduler, utilization)
+{
+    SimBus bus;
+    SimDevice imu(bus, 250), baro(bus, 500);
+
+    bus.add(imu.cb(), 1000, 1);
+    bus.add(baro.cb(), 20000, 2);
+
+    bus.run_until(1000000);
+
+    BusScheduler::DeviceStats stats;
+    EXPECT_TRUE(bus.get_device_stats(0, stats));
+    EXPECT_EQ(stats.device_id, 1U);
+    EXPECT_EQ(stats.max_usec, 250U);
+    EXPECT_NEAR(bus.get_utilization(stats), 0.25f, 0.01f);
+
+    EXPECT_TRUE(bus.get_device_stats(1, stats));
+    EXPECT_EQ(stats.device_id, 2U);
+    EXPECT_NEAR(bus.get_utilization(stats), 0.025f, 0.005f);
+
+    bus.reset_stats();
+    EXPECT_TRUE(bus.get_device_stats(0, stats));
+    EXPECT_EQ(stats.runs, 0U);
+    EXPECT_EQ(stats.busy_usec, 0U);
+}
+
+TEST(LinuxBusScheduler, missed_deadlines)
+{
+    SimBus bus;
+    SimDevice imu(bus, 100), slow(bus, 2950);
+
+    bus.add(imu.cb(), 1000, 1);
+    bus.add(slow.cb(), 100000, 2);
+
+    bus.run_until(1000000);
+
+    /*
+     * Each slow transfer makes the IMU skip two whole periods, and every
+     * period that has passed is either run or missed
+     */
+    BusScheduler::DeviceStats stats;
+    EXPECT_TRUE(bus.get_device_stats(0, stats));
+    EXPECT_EQ(stats.missed, 2 * slow.n_transfers);
+    EXPECT_EQ(stats.runs + stats.missed, bus.now / 1000);
+    EXPECT_EQ(imu.n_transfers, stats.runs);
+
+    EXPECT_TRUE(bus.get_device_stats(1, stats));
+    EXPECT_EQ(stats.missed, 0U);
+    EXPECT_EQ(stats.max_usec, 2950U);
+}
+
+TEST(LinuxBusScheduler, batching)
+{
+    SimBus bus;
+    SimDevice accel(bus, 100), baro(bus, 100), gyro(bus, 100);
+
+    /* deadlines at 1000, 1010 and 1020, accel and gyro on the same device */
+    bus.add(accel.cb(), 1000, 1);
+    bus.now = 10;
+    bus.add(baro.cb(), 1000, 2);
+    bus.now = 20;
+    bus.add(gyro.cb(), 1000, 1);
+
+    /* all due at once: the gyro goes straight after the accel */
+    bus.now = 1200;
+    bus.run_due();
+
+    EXPECT_EQ(accel.last_transfer_usec, 1300U);
+    EXPECT_EQ(gyro.last_transfer_usec, 1400U);
+    EXPECT_EQ(baro.last_transfer_usec, 1500U);
+
+    BusScheduler::DeviceStats stats;
+    EXPECT_TRUE(bus.get_device_stats(0, stats));
+    EXPECT_EQ(stats.device_id, 1U);
+    EXPECT_EQ(stats.runs, 2U);
+    EXPECT_EQ(stats.batched, 1U);
+
+    EXPECT_TRUE(bus.get_device_stats(1, stats));
+    EXPECT_EQ(stats.device_id, 2U);
+    EXPECT_EQ(stats.runs, 1U);
+    EXPECT_EQ(stats.batched, 0U);
+}
+
+TEST(LinuxBusScheduler, batching_limit)
+{
+    SimBus bus;
+    SimDevice fifo(bus, 150), baro(bus, 50);
+
+    /*
+     * Five callbacks of one device, due 100us apart, take most of each
+     * millisecond. Once their bus time is known they must leave the other
+     * device room to run within its period
+     */
+    for (uint8_t i = 0; i < 5; i++) {
+        bus.now = 100 * i;
+        bus.add(fifo.cb(), 1000, 1);
+    }
+    bus.now = 50;
+    bus.add(baro.cb(), 500, 2);
+    bus.now = 400;
+
+    bus.run_until(1000000);
+
+    BusScheduler::DeviceStats stats;
+    EXPECT_TRUE(bus.get_device_stats(0, stats));
+    EXPECT_EQ(stats.missed, 0U);
+    EXPECT_NEAR(fifo.n_transfers, 5000U, 5);
+    EXPECT_GT(stats.batched, 0U);
+
+    /* at most in the first period, before any bus time was measured */
+    EXPECT_TRUE(bus.get_device_stats(1, stats));
+    EXPECT_LE(stats.missed, 1U);
+    EXPECT_NEAR(baro.n_transfers, 2000U, 5);
+}
+
+TEST(LinuxBusScheduler, adjust)
+{
+    SimBus bus;
+    SimDevice imu(bus, 10), other(bus, 10);
+
+    AP_HAL::Device::PeriodicHandle h = bus.add(imu.cb(), 10000, 1);
+    EXPECT_NE(h, nullptr);
+    EXPECT_TRUE(bus.adjust(h, 1000));
+    EXPECT_FALSE(bus.adjust(&other, 1000));
+    EXPECT_FALSE(bus.adjust(h, 0));
+
+    bus.run_until(100000);
+
+    EXPECT_NEAR(imu.n_transfers, 100U, 1);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,206 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <algorithm>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/IOPool.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/* Pool with a simulated clock, its workers run by the test */
+class SimPool : public IOPool {
+public:
+    SimPool(uint8_t n_workers) : IOPool(n_workers) { }
+
+    uint64_t now = 0;
+
+protected:
+    uint64_t now_usec() override { return now; }
+};
+
+class SimTask {
+public:
+    SimTask(SimPool &pool, uint32_t run_usec)
+        : _pool(pool)
+        , _run_usec(run_usec)
+    { }
+
+    void run()
+    {
+        _pool.now += _run_usec;
+        n_runs++;
+        if (during_run) {
+            during_run();
+        }
+    }
+
+    AP_HAL::MemberProc proc()
+    {
+        return FUNCTOR_BIND_MEMBER(&SimTask::run, void);
+    }
+
+    unsigned n_runs = 0;
+    AP_HAL::MemberProc during_run = nullptr;
+
+private:
+    SimPool &_pool;
+    uint32_t _run_usec;
+};
+
+TEST(LinuxIOPool, add)
+{
+    SimPool pool(2);
+    SimTask a(pool, 10);
+
+    EXPECT_TRUE(pool.add(a.proc(), 20000));
+    EXPECT_TRUE(pool.add(a.proc(), 20000));
+    EXPECT_FALSE(pool.add(a.proc(), 0));
+    EXPECT_EQ(pool.get_num_tasks(), 1U);
+
+    uint64_t next_deadline;
+    EXPECT_TRUE(pool.run_one(0, next_deadline));
+    EXPECT_FALSE(pool.run_one(0, next_deadline));
+    EXPECT_EQ(next_deadline, 20000U);
+    EXPECT_EQ(a.n_runs, 1U);
+}
+
+TEST(LinuxIOPool, stealing)
+{
+    SimPool pool(2);
+    SimTask a(pool, 10), b(pool, 10), c(pool, 10);
+
+    /* a and c go on worker 0, b on worker 1 */
+    pool.add(a.proc(), 20000);
+    pool.add(b.proc(), 20000);
+    pool.add(c.proc(), 20000);
+
+    uint64_t next_deadline;
+    EXPECT_TRUE(pool.run_one(1, next_deadline));
+    EXPECT_EQ(b.n_runs, 1U);
+
+    /* worker 1 has nothing due and takes work from worker 0 */
+    EXPECT_TRUE(pool.run_one(1, next_deadline));
+    EXPECT_TRUE(pool.run_one(1, next_deadline));
+    EXPECT_FALSE(pool.run_one(1, next_deadline));
+    EXPECT_EQ(a.n_runs, 1U);
+    EXPECT_EQ(c.n_runs, 1U);
+
+    IOPool::TaskStats stats;
+    EXPECT_TRUE(pool.get_task_stats(0, stats));
+    EXPECT_EQ(stats.stolen, 1U);
+    EXPECT_TRUE(pool.get_task_stats(1, stats));
+    EXPECT_EQ(stats.stolen, 0U);
+    EXPECT_FALSE(pool.get_task_stats(3, stats));
+}
+
+TEST(LinuxIOPool, slow_task)
+{
+    SimPool pool(2);
+    SimTask log(pool, 0), terrain(pool, 1000);
+
+    pool.add(log.proc(), 20000);
+    pool.add(terrain.proc(), 20000);
+
+    /*
+     * While the log writes block the first worker for 100ms, the second
+     * one keeps running terrain at its rate and the log isn't run again
+     */
+    unsigned during_log = 0;
+    class Other {
+    public:
+        Other(SimPool &pool, unsigned &n) : _pool(pool), _n(n) { }
+        void run()
+        {
+            const uint64_t end = _pool.now + 100000;
+            uint64_t next_deadline;
+            while (_pool.now < end) {
+                if (_pool.run_one(1, next_deadline)) {
+                    _n++;
+                } else {
+                    _pool.now = std::min(next_deadline, end);
+                }
+            }
+        }
+    private:
+        SimPool &_pool;
+        unsigned &_n;
+    } other(pool, during_log);
+    log.during_run = FUNCTOR_BIND(&other, &Other::run, void);
+
+    uint64_t next_deadline;
+    EXPECT_TRUE(pool.run_one(0, next_deadline));
+
+    EXPECT_EQ(log.n_runs, 1U);
+    EXPECT_EQ(terrain.n_runs, during_log);
+    EXPECT_NEAR(terrain.n_runs, 5U, 1);
+
+    /* Its next run skips the periods that passed while it ran */
+    log.during_run = nullptr;
+    EXPECT_TRUE(pool.run_one(0, next_deadline));
+    EXPECT_EQ(log.n_runs, 2U);
+    IOPool::TaskStats stats;
+    EXPECT_TRUE(pool.get_task_stats(0, stats));
+    EXPECT_EQ(stats.runs, 2U);
+    EXPECT_EQ(stats.missed, 4U);
+    EXPECT_EQ(stats.max_latency_usec, 80000U);
+}
+
+TEST(LinuxIOPool, latency)
+{
+    SimPool pool(1);
+    SimTask a(pool, 100), b(pool, 5000);
+
+    pool.add(a.proc(), 1000);
+    pool.add(b.proc(), 10000);
+
+    uint64_t next_deadline;
+    while (pool.now < 100000) {
+        if (!pool.run_one(0, next_deadline)) {
+            pool.now = next_deadline;
+        }
+    }
+
+    /* a is late by up to b's run time and skips the periods b takes */
+    IOPool::TaskStats stats;
+    EXPECT_TRUE(pool.get_task_stats(0, stats));
+    EXPECT_EQ(stats.max_usec, 100U);
+    EXPECT_GE(stats.max_latency_usec, 4000U);
+    EXPECT_LE(stats.max_latency_usec, 5100U);
+    EXPECT_GT(stats.missed, 0U);
+    EXPECT_EQ(stats.runs, a.n_runs);
+
+    pool.reset_stats();
+    EXPECT_TRUE(pool.get_task_stats(0, stats));
+    EXPECT_EQ(stats.runs, 0U);
+}
+
+TEST(LinuxIOPool, run_all)
+{
+    SimPool pool(2);
+    SimTask a(pool, 10), b(pool, 10);
+
+    pool.add(a.proc(), 20000);
+    pool.add(b.proc(), 20000);
+
+    pool.run_all();
+    EXPECT_EQ(a.n_runs, 1U);
+    EXPECT_EQ(b.n_runs, 1U);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,178 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Perf.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+TEST(LinuxPerf, count_from_threads)
+{
+    Perf *perf = Perf::get_instance();
+    AP_HAL::Util::perf_counter_t pc = perf->add(AP_HAL::Util::PC_COUNT, "test_count");
+
+    std::vector<std::thread> threads;
+    for (uint8_t i = 0; i < 4; i++) {
+        threads.emplace_back([perf, pc] {
+            for (uint32_t n = 0; n < 10000; n++) {
+                perf->count(pc);
+            }
+        });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    /* The shards of the threads are kept after they finish */
+    Perf_Summary s;
+    EXPECT_TRUE(perf->get_summary(pc, s));
+    EXPECT_EQ(s.count, 40000U);
+}
+
+TEST(LinuxPerf, elapsed_from_threads)
+{
+    Perf *perf = Perf::get_instance();
+    AP_HAL::Util::perf_counter_t pc = perf->add(AP_HAL::Util::PC_ELAPSED, "test_elapsed");
+
+    std::vector<std::thread> threads;
+    for (uint8_t i = 0; i < 2; i++) {
+        threads.emplace_back([perf, pc, i] {
+            for (uint32_t n = 0; n < 50; n++) {
+                perf->begin(pc);
+                usleep(100 * (i + 1));
+                perf->end(pc);
+            }
+        });
+    }
+
+    /* Reading while the threads are updating their stats */
+    Perf_Summary s;
+    for (uint8_t n = 0; n < 10; n++) {
+        EXPECT_TRUE(perf->get_summary(pc, s));
+        if (s.count) {
+            EXPECT_LE(s.min, s.max);
+        }
+    }
+
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    EXPECT_TRUE(perf->get_summary(pc, s));
+    EXPECT_EQ(s.count, 100U);
+    EXPECT_GE(s.min, 100000U);
+    EXPECT_GE(s.max, 200000U);
+    EXPECT_NEAR(s.avg, (double)s.total / s.count, 1.0);
+    EXPECT_GT(s.stddev(), 0.0);
+
+    uint64_t histogram_count = 0;
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        histogram_count += s.histogram[i];
+    }
+    EXPECT_EQ(histogram_count, s.count);
+
+    const uint64_t p50 = s.percentile(0.5f);
+    const uint64_t p99 = s.percentile(0.99f);
+    EXPECT_GE(p50, s.min);
+    EXPECT_LE(p50, p99);
+    EXPECT_LE(p99, s.max);
+    EXPECT_EQ(s.percentile(1.0f), s.max);
+}
+
+TEST(LinuxPerf, invalid_counter)
+{
+    Perf *perf = Perf::get_instance();
+    Perf_Summary s;
+
+    EXPECT_FALSE(perf->get_summary((AP_HAL::Util::perf_counter_t)(uintptr_t)-1, s));
+    EXPECT_EQ(perf->add(AP_HAL::Util::PC_INTERVAL, "test_interval"),
+              (AP_HAL::Util::perf_counter_t)(uintptr_t)-1);
+}
+
+TEST(LinuxPerf, histogram_buckets)
+{
+    EXPECT_EQ(Perf::histogram_bucket(0), 0U);
+    EXPECT_EQ(Perf::histogram_bucket(63), 0U);
+    EXPECT_EQ(Perf::histogram_bucket(64), 1U);
+    EXPECT_EQ(Perf::histogram_bucket(UINT64_MAX), PERF_HISTOGRAM_BUCKETS - 1);
+
+    /* Each value goes in the bucket whose range contains it */
+    uint8_t last = 0;
+    for (uint64_t ns = 1; ns < (1ULL << 40); ns = ns * 9 / 8 + 1) {
+        const uint8_t b = Perf::histogram_bucket(ns);
+        EXPECT_GE(b, last);
+        EXPECT_LE(ns, Perf::histogram_bucket_max(b));
+        if (b > 0) {
+            EXPECT_GT(ns, Perf::histogram_bucket_max(b - 1));
+        }
+        last = b;
+    }
+
+    /* Buckets are at most a quarter of their lower bound wide */
+    for (uint8_t b = 2; b < PERF_HISTOGRAM_BUCKETS - 1; b++) {
+        const uint64_t lo = Perf::histogram_bucket_max(b - 1) + 1;
+        const uint64_t hi = Perf::histogram_bucket_max(b);
+        EXPECT_EQ(Perf::histogram_bucket(lo), b);
+        EXPECT_EQ(Perf::histogram_bucket(hi), b);
+        EXPECT_LE(hi - lo + 1, lo / PERF_HISTOGRAM_SUB_BUCKETS);
+    }
+}
+
+TEST(LinuxPerf, dump)
+{
+    Perf *perf = Perf::get_instance();
+    AP_HAL::Util::perf_counter_t pc = perf->add(AP_HAL::Util::PC_COUNT, "test_dump");
+    perf->count(pc);
+
+    char path[] = "/tmp/perf_dump_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    EXPECT_TRUE(perf->dump(path));
+
+    FILE *f = fopen(path, "r");
+    ASSERT_NE(f, nullptr);
+    uint8_t header[20];
+    EXPECT_EQ(fread(header, 1, sizeof(header), f), sizeof(header));
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fclose(f);
+    unlink(path);
+
+    EXPECT_EQ(memcmp(header, "APPF", 4), 0);
+    /* Little-endian whatever the host byte order */
+    const uint16_t version = header[4] | (header[5] << 8);
+    const uint16_t n_counters = header[6] | (header[7] << 8);
+    EXPECT_EQ(version, 1U);
+    EXPECT_GE(n_counters, 1U);
+    EXPECT_EQ(header[8], PERF_HISTOGRAM_MIN_SHIFT);
+
+    /* One record per counter with its whole histogram */
+    const long record_size = 32 + 8 + 4 * 8 + 2 * 8 + 4 * PERF_HISTOGRAM_BUCKETS;
+    EXPECT_EQ(size, (long)sizeof(header) + n_counters * record_size);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,110 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <atomic>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Semaphores.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/* Thread holding @sem for @hold_usec */
+class Holder {
+public:
+    Holder(Semaphore &sem, uint32_t hold_usec)
+        : _thread([this, &sem, hold_usec] {
+            pthread_setname_np(pthread_self(), "holder");
+            sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+            taken = true;
+            usleep(hold_usec);
+            sem.give();
+        })
+    {
+        while (!taken) {
+            usleep(100);
+        }
+    }
+
+    ~Holder() { _thread.join(); }
+
+    std::atomic<bool> taken{false};
+
+private:
+    std::thread _thread;
+};
+
+TEST(LinuxSemaphore, take_timeout)
+{
+    Semaphore sem;
+
+    EXPECT_TRUE(sem.take(10));
+    EXPECT_TRUE(sem.give());
+
+    {
+        Holder holder(sem, 50000);
+
+        EXPECT_FALSE(sem.take_nonblocking());
+
+        const uint64_t start = AP_HAL::micros64();
+        EXPECT_FALSE(sem.take(10));
+        const uint64_t waited = AP_HAL::micros64() - start;
+        EXPECT_GE(waited, 10000U);
+        EXPECT_LT(waited, 40000U);
+
+        /* Long enough for the holder to give it */
+        EXPECT_TRUE(sem.take(500));
+        EXPECT_TRUE(sem.give());
+    }
+}
+
+TEST(LinuxSemaphore, contention)
+{
+    Semaphore sem;
+    Semaphore::Contention c;
+
+    EXPECT_FALSE(sem.get_contention(c));
+
+    sem.enable_stats("test");
+    EXPECT_TRUE(sem.get_contention(c));
+    EXPECT_EQ(c.takes, 0U);
+
+    for (uint8_t i = 0; i < 10; i++) {
+        EXPECT_TRUE(sem.take(HAL_SEMAPHORE_BLOCK_FOREVER));
+        EXPECT_TRUE(sem.give());
+    }
+    EXPECT_TRUE(sem.get_contention(c));
+    EXPECT_EQ(c.takes, 10U);
+    EXPECT_EQ(c.contended, 0U);
+
+    {
+        Holder holder(sem, 20000);
+        EXPECT_TRUE(sem.take(HAL_SEMAPHORE_BLOCK_FOREVER));
+        EXPECT_TRUE(sem.give());
+    }
+
+    EXPECT_TRUE(sem.get_contention(c));
+    EXPECT_EQ(c.takes, 12U);
+    EXPECT_EQ(c.contended, 1U);
+    EXPECT_GE(c.max_wait_usec, 10000U);
+    EXPECT_STREQ(c.max_wait_owner, "holder");
+}
+
+AP_GTEST_MAIN()
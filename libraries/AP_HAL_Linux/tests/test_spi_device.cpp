@@ -0,0 +1,222 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <fcntl.h>
+#include <linux/spi/spidev.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/SPIBus.h>
+#include <AP_HAL_Linux/SPIDevice.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * spidev that records the requests it gets: each received byte is the
+ * index of the message it belongs to
+ */
+class FakeSPIBus : public SPIBus {
+public:
+    FakeSPIBus()
+    {
+        fd = ::open("/dev/null", O_RDWR | O_CLOEXEC);
+    }
+
+    int ioctl(unsigned long request, void *arg) override
+    {
+        n_ioctls++;
+
+        if (_IOC_TYPE(request) != SPI_IOC_MAGIC) {
+            return -1;
+        }
+        if (request == SPI_IOC_RD_MODE) {
+            *(uint8_t *)arg = mode;
+            return 0;
+        }
+        if (request == SPI_IOC_WR_MODE) {
+            mode = *(uint8_t *)arg;
+            return 0;
+        }
+
+        if (fail) {
+            return -1;
+        }
+
+        auto *msgs = (struct spi_ioc_transfer *)arg;
+        unsigned n = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+        n_messages++;
+        for (unsigned i = 0; i < n; i++) {
+            if (msgs[i].tx_buf) {
+                const uint8_t *tx = (const uint8_t *)(uintptr_t)msgs[i].tx_buf;
+                sent.insert(sent.end(), tx, tx + msgs[i].len);
+            }
+            if (msgs[i].rx_buf) {
+                memset((void *)(uintptr_t)msgs[i].rx_buf, i, msgs[i].len);
+            }
+            cs_change.push_back(msgs[i].cs_change);
+            speed_hz.push_back(msgs[i].speed_hz);
+        }
+        return 0;
+    }
+
+    uint8_t mode = 0;
+    bool fail = false;
+
+    unsigned n_ioctls = 0;
+    unsigned n_messages = 0;
+    std::vector<uint8_t> sent;
+    std::vector<uint8_t> cs_change;
+    std::vector<uint32_t> speed_hz;
+};
+
+class SPIDeviceQueue : public ::testing::Test {
+protected:
+    SPIDesc _desc{"fake", 0, 0, SPI_MODE_3, 8, SPI_CS_KERNEL, 1000000, 10000000};
+    FakeSPIBus _bus;
+    SPIDevice _dev{_bus, _desc};
+};
+
+TEST_F(SPIDeviceQueue, single_request)
+{
+    uint8_t val[2];
+
+    EXPECT_TRUE(_dev.queued_in_single_request());
+    EXPECT_TRUE(_dev.queue_write_register(0x6a, 0x01));
+    EXPECT_TRUE(_dev.queue_write_register(0x6a, 0x05));
+    EXPECT_TRUE(_dev.queue_read_registers(0x3b, val, sizeof(val)));
+    EXPECT_TRUE(_dev.submit_queued());
+
+    /* Setting the mode, then all the transfers at once */
+    EXPECT_EQ(_bus.n_messages, 1U);
+    EXPECT_EQ(_bus.n_ioctls, 2U);
+
+    const std::vector<uint8_t> sent = { 0x6a, 0x01, 0x6a, 0x05, 0x3b };
+    EXPECT_EQ(_bus.sent, sent);
+
+    /* The chip select is released at the end of each transaction */
+    const std::vector<uint8_t> cs_change = { 1, 1, 0, 0 };
+    EXPECT_EQ(_bus.cs_change, cs_change);
+
+    EXPECT_EQ(val[0], 3);
+    EXPECT_EQ(val[1], 3);
+}
+
+TEST_F(SPIDeviceQueue, fewer_syscalls)
+{
+    uint8_t fifo_count[2], fifo[8][14];
+
+    _dev.set_read_flag(0x80);
+
+    /* One transfer at a time, checking the mode before each of them */
+    _dev.read_registers(0x72, fifo_count, sizeof(fifo_count));
+    for (uint8_t i = 0; i < 8; i++) {
+        _dev.read_registers(0x74, fifo[i], sizeof(fifo[i]));
+    }
+    const unsigned unbatched = _bus.n_ioctls;
+    EXPECT_EQ(_bus.n_messages, 9U);
+    EXPECT_EQ(unbatched, 18U);
+
+    _bus.n_ioctls = 0;
+    _bus.n_messages = 0;
+    _bus.sent.clear();
+
+    EXPECT_TRUE(_dev.queue_read_registers(0x72, fifo_count, sizeof(fifo_count)));
+    for (uint8_t i = 0; i < 7; i++) {
+        EXPECT_TRUE(_dev.queue_read_registers(0x74, fifo[i], sizeof(fifo[i])));
+    }
+    /* the queue is full */
+    EXPECT_FALSE(_dev.queue_read_registers(0x74, fifo[7], sizeof(fifo[7])));
+    EXPECT_TRUE(_dev.submit_queued());
+
+    EXPECT_EQ(_bus.n_messages, 1U);
+    EXPECT_EQ(_bus.n_ioctls, 2U);
+    EXPECT_EQ(_bus.sent[0], 0xf2);
+    EXPECT_EQ(_bus.sent[1], 0xf4);
+    EXPECT_EQ(fifo[6][13], 15);
+}
+
+TEST_F(SPIDeviceQueue, register_check_in_sample_request)
+{
+    uint8_t fifo[14], fifo_count[2];
+
+    ASSERT_TRUE(_dev.setup_checked_registers(1, 1));
+    _dev.set_checked_register(0x1a, 5);
+    _dev.set_speed(AP_HAL::Device::SPEED_HIGH);
+
+    /* FIFO data, the next FIFO count and the register check in one go */
+    EXPECT_TRUE(_dev.queue_read_registers(0x74, fifo, sizeof(fifo)));
+    EXPECT_TRUE(_dev.queue_read_registers(0x72, fifo_count, sizeof(fifo_count)));
+    EXPECT_TRUE(_dev.queue_set_speed(AP_HAL::Device::SPEED_LOW));
+    EXPECT_TRUE(_dev.queue_check_next_register());
+    EXPECT_TRUE(_dev.queue_set_speed(AP_HAL::Device::SPEED_HIGH));
+    const bool ok = _dev.submit_queued();
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(_bus.n_messages, 1U);
+
+    /* The register is read at low speed, as it would be on its own */
+    const std::vector<uint32_t> speed_hz = {
+        10000000, 10000000, 10000000, 10000000, 1000000, 1000000
+    };
+    EXPECT_EQ(_bus.speed_hz, speed_hz);
+
+    /* The register was read back from the sixth message */
+    EXPECT_TRUE(_dev.check_queued_register(ok));
+    EXPECT_TRUE(_dev.check_queued_register(ok));
+
+    /* A wrong value is written back */
+    _dev.set_checked_register(0x1a, 7);
+    _bus.sent.clear();
+    EXPECT_TRUE(_dev.queue_check_next_register());
+    EXPECT_FALSE(_dev.check_queued_register(_dev.submit_queued()));
+    const std::vector<uint8_t> sent = { 0x1a, 0x1a, 0x07 };
+    EXPECT_EQ(_bus.sent, sent);
+}
+
+TEST_F(SPIDeviceQueue, completion_callback)
+{
+    class Completion {
+    public:
+        void done(bool ok) { n_calls++; result = ok; }
+        unsigned n_calls = 0;
+        bool result = false;
+    } completion;
+    AP_HAL::Device::TransferCb cb =
+        FUNCTOR_BIND(&completion, &Completion::done, void, bool);
+
+    EXPECT_TRUE(_dev.queue_write_register(0x6b, 0x80));
+    EXPECT_TRUE(_dev.submit_queued(cb));
+    EXPECT_EQ(completion.n_calls, 1U);
+    EXPECT_TRUE(completion.result);
+
+    _bus.fail = true;
+    EXPECT_TRUE(_dev.queue_write_register(0x6b, 0x80));
+    EXPECT_FALSE(_dev.submit_queued(cb));
+    EXPECT_EQ(completion.n_calls, 2U);
+    EXPECT_FALSE(completion.result);
+
+    /* the queue is empty after a failure too */
+    _bus.fail = false;
+    _bus.n_messages = 0;
+    EXPECT_TRUE(_dev.submit_queued(cb));
+    EXPECT_EQ(completion.n_calls, 3U);
+    EXPECT_EQ(_bus.n_messages, 0U);
+}
+
+AP_GTEST_MAIN()
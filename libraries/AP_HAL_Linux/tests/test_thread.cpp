@@ -117,4 +117,31 @@ TEST(LinuxThread, periodic_thread)
     EXPECT_TRUE(thr.join());
 }
 
+TEST(LinuxThread, periodic_thread_wakeup_stats)
+{
+    TestPeriodicThread1 thr;
+    PeriodicThread::WakeupStats stats;
+
+    EXPECT_TRUE(thr.set_rate(1000));
+    EXPECT_TRUE(thr.start(nullptr, 0, 0));
+
+    while (!thr.is_started()) {
+        usleep(1000);
+    }
+
+    // nothing has been published yet, this only asks for the stats
+    EXPECT_TRUE(thr.take_wakeup_stats(stats));
+    EXPECT_EQ(0U, stats.wakeups);
+
+    // handed over on the next wakeup
+    for (uint8_t i = 0; i < 100 && !thr.take_wakeup_stats(stats); i++) {
+        usleep(1000);
+    }
+    EXPECT_LT(0U, stats.wakeups);
+    EXPECT_LE(stats.total_late_usec, (uint64_t)stats.max_late_usec * stats.wakeups);
+
+    EXPECT_TRUE(thr.stop());
+    EXPECT_TRUE(thr.join());
+}
+
 AP_GTEST_MAIN()
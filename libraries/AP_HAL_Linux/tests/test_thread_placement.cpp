@@ -0,0 +1,107 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <sys/sysinfo.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/ThreadPlacement.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+TEST(LinuxThreadPlacement, cpu_list)
+{
+    cpu_set_t cpus;
+
+    EXPECT_TRUE(ThreadPlacement::parse_cpu_list("0", cpus));
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+    EXPECT_TRUE(CPU_ISSET(0, &cpus));
+
+    if (get_nprocs_conf() >= 4) {
+        EXPECT_TRUE(ThreadPlacement::parse_cpu_list("0,2-3", cpus));
+        EXPECT_EQ(CPU_COUNT(&cpus), 3);
+        EXPECT_TRUE(CPU_ISSET(0, &cpus));
+        EXPECT_FALSE(CPU_ISSET(1, &cpus));
+        EXPECT_TRUE(CPU_ISSET(3, &cpus));
+    }
+
+    EXPECT_FALSE(ThreadPlacement::parse_cpu_list("", cpus));
+    EXPECT_FALSE(ThreadPlacement::parse_cpu_list("a", cpus));
+    EXPECT_FALSE(ThreadPlacement::parse_cpu_list("0,", cpus));
+    EXPECT_FALSE(ThreadPlacement::parse_cpu_list("0-", cpus));
+    EXPECT_FALSE(ThreadPlacement::parse_cpu_list("1-0", cpus));
+    EXPECT_FALSE(ThreadPlacement::parse_cpu_list("0 1", cpus));
+    EXPECT_FALSE(ThreadPlacement::parse_cpu_list("100000", cpus));
+}
+
+TEST(LinuxThreadPlacement, matching)
+{
+    ThreadPlacement placement;
+    cpu_set_t cpus;
+
+    EXPECT_FALSE(placement.get_cpus("ap-timer", cpus));
+
+    EXPECT_TRUE(placement.parse("spi=0;timer=0"));
+    EXPECT_TRUE(placement.get_cpus("ap-timer", cpus));
+    EXPECT_TRUE(placement.get_cpus("ap-spi-0", cpus));
+    EXPECT_TRUE(placement.get_cpus("spi-1", cpus));
+    EXPECT_FALSE(placement.get_cpus("ap-spidev", cpus));
+    EXPECT_FALSE(placement.get_cpus("ap-io-0", cpus));
+    EXPECT_FALSE(placement.get_cpus("main", cpus));
+}
+
+TEST(LinuxThreadPlacement, longest_match)
+{
+    if (get_nprocs_conf() < 3) {
+        return;
+    }
+
+    ThreadPlacement placement;
+    cpu_set_t cpus;
+
+    EXPECT_TRUE(placement.parse("*=0;spi-1=2;spi=1"));
+
+    EXPECT_TRUE(placement.get_cpus("ap-spi-1", cpus));
+    EXPECT_TRUE(CPU_ISSET(2, &cpus));
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+
+    EXPECT_TRUE(placement.get_cpus("ap-spi-0", cpus));
+    EXPECT_TRUE(CPU_ISSET(1, &cpus));
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+
+    EXPECT_TRUE(placement.get_cpus("ap-uart", cpus));
+    EXPECT_TRUE(CPU_ISSET(0, &cpus));
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+}
+
+TEST(LinuxThreadPlacement, invalid)
+{
+    ThreadPlacement placement;
+    cpu_set_t cpus;
+
+    EXPECT_TRUE(placement.parse("timer=0"));
+
+    /* An invalid placement leaves the previous one */
+    EXPECT_FALSE(placement.parse("timer"));
+    EXPECT_FALSE(placement.parse("=0"));
+    EXPECT_FALSE(placement.parse("timer=0;uart=x"));
+    EXPECT_FALSE(placement.parse("a_very_long_thread_name=0"));
+    EXPECT_TRUE(placement.get_cpus("ap-timer", cpus));
+    EXPECT_FALSE(placement.get_cpus("ap-uart", cpus));
+}
+
+AP_GTEST_MAIN()
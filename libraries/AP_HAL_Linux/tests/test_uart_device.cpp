@@ -0,0 +1,122 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Poller.h>
+#include <AP_HAL_Linux/UARTDevice.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * Loopback over a pseudo terminal: the UARTDevice opens the slave side and
+ * the test plays the remote end on the master side.
+ */
+class UARTDeviceLoopback : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        _master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        ASSERT_GE(_master, 0);
+        ASSERT_EQ(grantpt(_master), 0);
+        ASSERT_EQ(unlockpt(_master), 0);
+
+        _dev = new UARTDevice(ptsname(_master));
+        ASSERT_TRUE(_dev->open());
+        _dev->set_blocking(false);
+    }
+
+    void TearDown() override
+    {
+        delete _dev;
+        if (_master >= 0) {
+            close(_master);
+        }
+    }
+
+    int _master = -1;
+    UARTDevice *_dev = nullptr;
+};
+
+class DevicePollable : public Pollable {
+public:
+    DevicePollable(int fd) : Pollable(fd) { }
+    ~DevicePollable() { _fd = -1; }
+
+    void on_can_read() override { n_read_events++; }
+
+    unsigned int n_read_events = 0;
+};
+
+TEST_F(UARTDeviceLoopback, writev_gathers_both_parts)
+{
+    uint8_t first[] = { 'a', 'b', 'c' };
+    uint8_t second[] = { 'd', 'e', 'f', 'g' };
+    ByteBuffer::IoVec vec[2] = {
+        { first, sizeof(first) },
+        { second, sizeof(second) },
+    };
+
+    EXPECT_EQ((ssize_t)(sizeof(first) + sizeof(second)), _dev->writev(vec, 2));
+
+    char buf[16] = { };
+    ssize_t n = 0;
+    for (unsigned i = 0; i < 100 && n < 7; i++) {
+        ssize_t r = read(_master, buf + n, sizeof(buf) - 1 - n);
+        if (r > 0) {
+            n += r;
+        } else {
+            usleep(1000);
+        }
+    }
+
+    EXPECT_EQ(7, n);
+    EXPECT_STREQ("abcdefg", buf);
+}
+
+TEST_F(UARTDeviceLoopback, poller_wakes_on_input)
+{
+    Poller poller;
+    ASSERT_TRUE((bool)poller);
+
+    DevicePollable p(_dev->get_fd());
+    ASSERT_TRUE(poller.register_pollable(&p, EPOLLIN));
+
+    // nothing to read yet
+    EXPECT_EQ(0, poller.poll(0));
+    EXPECT_EQ(0U, p.n_read_events);
+
+    const uint8_t msg[] = "ping";
+    ASSERT_EQ((ssize_t)sizeof(msg), write(_master, msg, sizeof(msg)));
+
+    EXPECT_EQ(1, poller.poll(1000));
+    EXPECT_EQ(1U, p.n_read_events);
+
+    uint8_t buf[sizeof(msg)];
+    EXPECT_EQ((ssize_t)sizeof(msg), _dev->read(buf, sizeof(buf)));
+    EXPECT_EQ(0, memcmp(msg, buf, sizeof(msg)));
+
+    poller.unregister_pollable(&p);
+}
+
+AP_GTEST_MAIN()
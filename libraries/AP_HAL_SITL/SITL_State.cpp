@@ -374,6 +374,7 @@ void SITL_State::_simulator_servos(SITL::Aircraft::sitl_input &input)
     float engine_mul = _sitl?_sitl->engine_mul.get():1;
     uint8_t engine_fail = _sitl?_sitl->engine_fail.get():0;
     bool motors_on = false;
+    float throttle = 0.0f;
     
     if (engine_fail >= ARRAY_SIZE(input.servos)) {
         engine_fail = 0;
@@ -386,11 +387,13 @@ void SITL_State::_simulator_servos(SITL::Aircraft::sitl_input &input)
     }
     
     if (_vehicle == ArduPlane) {
-        motors_on = ((input.servos[2] - 1000) / 1000.0f) > 0;
+        throttle = (input.servos[2] - 1000) / 1000.0f;
+        motors_on = throttle > 0;
     } else if (_vehicle == APMrover2) {
         input.servos[2] = static_cast<uint16_t>(constrain_int16(input.servos[2], 1000, 2000));
         input.servos[0] = static_cast<uint16_t>(constrain_int16(input.servos[0], 1000, 2000));
-        motors_on = ((input.servos[2] - 1500) / 500.0f) != 0;
+        throttle = (input.servos[2] - 1500) / 500.0f;
+        motors_on = throttle != 0;
     } else {
         motors_on = false;
         // run checks on each motor
@@ -402,10 +405,12 @@ void SITL_State::_simulator_servos(SITL::Aircraft::sitl_input &input)
             if ((input.servos[i]-1000)/1000.0f > 0) {
                 motors_on = true;
             }
+            throttle += (input.servos[i] - 1000) / 4000.0f;
         }
     }
     if (_sitl) {
         _sitl->motors_on = motors_on;
+        _sitl->throttle = constrain_float(fabsf(throttle), 0.0f, 1.0f);
     }
 
     float voltage = 0;
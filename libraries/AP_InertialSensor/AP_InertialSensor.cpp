@@ -9,6 +9,7 @@
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
 #include <AP_AHRS/AP_AHRS.h>
+#include <AP_Scheduler/LatencyTrace.h>
 
 #include "AP_InertialSensor.h"
 #include "AP_InertialSensor_BMI160.h"
@@ -444,6 +445,10 @@ const AP_Param::GroupInfo AP_InertialSensor::var_info[] = {
     // @Values: 1:FirstIMUOnly,3:FirstAndSecondIMU,7:FirstSecondAndThirdIMU,127:AllIMUs
     // @Bitmask: 0:FirstIMU,1:SecondIMU,2:ThirdIMU
     AP_GROUPINFO("ENABLE_MASK",  40, AP_InertialSensor, _enable_mask, 0x7F),
+
+    // @Group: HNTCH_
+    // @Path: ../Filter/HarmonicNotchFilter.cpp
+    AP_SUBGROUPINFO(_harmonic_notch_filter, "HNTCH_",  41, AP_InertialSensor, HarmonicNotchFilterParams),
     
     /*
       NOTE: parameter indexes have gaps above. When adding new
@@ -469,7 +474,9 @@ AP_InertialSensor::AP_InertialSensor() :
     _backends_detected(false),
     _accel_cal_requires_reboot(false),
     _startup_error_counts_set(false),
-    _startup_ms(0)
+    _startup_ms(0),
+    _gyro_trace_id(0),
+    _published_trace_id(0)
 {
     if (_s_instance) {
         AP_HAL::panic("Too many inertial sensors");
@@ -673,6 +680,9 @@ AP_InertialSensor::init(uint16_t sample_rate)
     _sample_period_usec = 1000*1000UL / _sample_rate;
 
     _notch_filter.init(sample_rate);
+
+    // start the harmonic notch at its base frequency until the vehicle updates it
+    _calculated_harmonic_notch_freq_hz = _harmonic_notch_filter.center_freq_hz();
     
     // establish the baseline time between samples
     _delta_time = 0;
@@ -1356,6 +1366,11 @@ void AP_InertialSensor::update(void)
 
     // apply notch filter to primary gyro
     _gyro[_primary_gyro] = _notch_filter.apply(_gyro[_primary_gyro]);
+
+    // the main loop is now handling any traced sample
+    AP::LatencyTrace::set_current(_published_trace_id);
+    _published_trace_id = 0;
+    AP::LatencyTrace::record(AP::LatencyTrace::STAGE_INS);
     
     _last_update_usec = AP_HAL::micros();
     
@@ -18,14 +18,20 @@
 
 #define DEFAULT_IMU_LOG_BAT_MASK 0
 
+// number of biquad stages applied to each raw gyro sample, stage 0 is the
+// low pass and the rest are the harmonic notches
+#define INS_GYRO_FILTER_STAGES (1 + HNF_MAX_HARMONICS)
+
 #include <stdint.h>
 
 #include <AP_AccelCal/AP_AccelCal.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <Filter/LowPassFilter2p.h>
+#include <Filter/BiquadFilterBank.h>
 #include <Filter/LowPassFilter.h>
 #include <Filter/NotchFilter.h>
+#include <Filter/HarmonicNotchFilter.h>
 
 class AP_InertialSensor_Backend;
 class AuxiliaryBus;
@@ -212,6 +218,12 @@ public:
     // get the accel filter rate in Hz
     uint8_t get_accel_filter_hz(void) const { return _accel_filter_cutoff; }
 
+    // harmonic notch parameters, used by the vehicle to calculate the notch base frequency
+    const HarmonicNotchFilterParams &get_harmonic_notch_params(void) const { return _harmonic_notch_filter; }
+
+    // set the harmonic notch base frequency, should be called at loop rate by vehicles tracking motor speed
+    void update_harmonic_notch_freq_hz(float freq_hz) { _calculated_harmonic_notch_freq_hz = freq_hz; }
+
     // indicate which bit in LOG_BITMASK indicates raw logging enabled
     void set_log_raw_bit(uint32_t log_raw_bit) { _log_raw_bit = log_raw_bit; }
 
@@ -388,7 +400,7 @@ private:
 
     // Low Pass filters for gyro and accel
     LowPassFilter2pVector3f _accel_filter[INS_MAX_INSTANCES];
-    LowPassFilter2pVector3f _gyro_filter[INS_MAX_INSTANCES];
+    BiquadFilterBank<3, INS_GYRO_FILTER_STAGES> _gyro_filter[INS_MAX_INSTANCES];
     Vector3f _accel_filtered[INS_MAX_INSTANCES];
     Vector3f _gyro_filtered[INS_MAX_INSTANCES];
     bool _new_accel_data[INS_MAX_INSTANCES];
@@ -397,6 +409,16 @@ private:
     // optional notch filter on gyro
     NotchFilterVector3fParam _notch_filter;
 
+    // optional harmonic notch filter on raw gyro samples, tracking motor speed
+    HarmonicNotchFilterParams _harmonic_notch_filter;
+    HarmonicNotch _harmonic_notch[INS_MAX_INSTANCES];
+    float _calculated_harmonic_notch_freq_hz;
+
+    // latency trace of the latest primary gyro sample, waiting to be
+    // published and then published by update()
+    uint16_t _gyro_trace_id;
+    uint16_t _published_trace_id;
+
     // Most recent gyro reading
     Vector3f _gyro[INS_MAX_INSTANCES];
     Vector3f _delta_angle[INS_MAX_INSTANCES];
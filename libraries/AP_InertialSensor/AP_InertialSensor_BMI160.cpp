@@ -338,6 +338,7 @@ void AP_InertialSensor_BMI160::_read_fifo()
     uint16_t num_bytes;
     uint16_t excess;
     uint8_t num_samples = 0;
+    bool flush;
     bool r = true;
 
     static_assert(sizeof(raw_data) <= 100, "Too big to keep on stack");
@@ -367,18 +368,23 @@ read_fifo_read_data:
         excess = 0;
     }
 
-    r = _dev->read_registers(BMI160_REG_FIFO_DATA,
-                             (uint8_t *)raw_data,
-                             num_bytes);
+    /* Read again just once, flushing the rest along with the second read */
+    flush = excess && num_samples;
+
+    _dev->queue_read_registers(BMI160_REG_FIFO_DATA,
+                               (uint8_t *)raw_data,
+                               num_bytes);
+    if (flush) {
+        _dev->queue_write_register(BMI160_REG_CMD, BMI160_CMD_FIFO_FLUSH);
+    }
+    r = _dev->submit_queued();
     if (!r) {
         goto read_fifo_end;
     }
 
-    /* Read again just once */
-    if (excess && num_samples) {
+    if (flush) {
         hal.console->printf("BMI160: dropping %u samples from fifo\n",
                             (uint8_t)(excess / sizeof(struct RawData)));
-        _dev->write_register(BMI160_REG_CMD, BMI160_CMD_FIFO_FLUSH);
         excess = 0;
     }
 
@@ -2,6 +2,7 @@
 #include "AP_InertialSensor.h"
 #include "AP_InertialSensor_Backend.h"
 #include <DataFlash/DataFlash.h>
+#include <AP_Scheduler/LatencyTrace.h>
 #if AP_MODULE_SUPPORTED
 #include <AP_Module/AP_Module.h>
 #include <stdio.h>
@@ -138,6 +139,7 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
                                                             uint64_t sample_us)
 {
     float dt;
+    uint16_t trace_id = 0;
 
     _update_sensor_rate(_imu._sample_gyro_count[instance], _imu._sample_gyro_start_us[instance],
                         _imu._gyro_raw_sample_rates[instance]);
@@ -162,6 +164,10 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
     }
     _imu._gyro_last_sample_us[instance] = sample_us;
 
+    if (instance == _imu._primary_gyro) {
+        trace_id = AP::LatencyTrace::start(sample_us ? sample_us : AP_HAL::micros64());
+    }
+
 #if AP_MODULE_SUPPORTED
     // call gyro_sample hook if any
     AP_Module::call_hook_gyro_sample(instance, dt, gyro);
@@ -201,6 +207,9 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
             _imu._gyro_filter[instance].reset();
         }
         _imu._new_gyro_data[instance] = true;
+        if (trace_id != 0) {
+            _imu._gyro_trace_id = trace_id;
+        }
         _sem->give();
     }
 
@@ -404,17 +413,49 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
     if (_imu._new_gyro_data[instance]) {
         _publish_gyro(instance, _imu._gyro_filtered[instance]);
         _imu._new_gyro_data[instance] = false;
+        if (instance == _imu._primary_gyro) {
+            _imu._published_trace_id = _imu._gyro_trace_id;
+            _imu._gyro_trace_id = 0;
+        }
     }
 
     // possibly update filter frequency
     if (_last_gyro_filter_hz[instance] != _gyro_filter_cutoff()) {
-        _imu._gyro_filter[instance].set_cutoff_frequency(_gyro_raw_sample_rate(instance), _gyro_filter_cutoff());
+        _imu._gyro_filter[instance].set_lowpass(0, _gyro_raw_sample_rate(instance), _gyro_filter_cutoff());
         _last_gyro_filter_hz[instance] = _gyro_filter_cutoff();
     }
 
+    update_harmonic_notch(instance);
+
     _sem->give();
 }
 
+/*
+  retune the harmonic notch stages of a gyro's filter bank to the latest
+  base frequency. Called with the semaphore held so the bank picks up all
+  stages together on its next sample
+ */
+void AP_InertialSensor_Backend::update_harmonic_notch(uint8_t instance)
+{
+    const HarmonicNotchFilterParams &params = _imu._harmonic_notch_filter;
+    HarmonicNotch &notch = _imu._harmonic_notch[instance];
+
+    if (params.enabled() && is_positive(params.center_freq_hz())) {
+        notch.configure(_gyro_raw_sample_rate(instance),
+                        params.bandwidth_hz() / params.center_freq_hz(),
+                        params.attenuation_dB(),
+                        params.harmonics());
+        notch.update(_imu._calculated_harmonic_notch_freq_hz);
+    } else {
+        // an unconfigured notch passes samples through
+        notch.configure(0, 0, 0, 0);
+    }
+
+    for (uint8_t i = 0; i < HNF_MAX_HARMONICS; i++) {
+        _imu._gyro_filter[instance].set_stage(1 + i, notch.get_coefficients(i));
+    }
+}
+
 /*
   common accel update function for all backends
  */
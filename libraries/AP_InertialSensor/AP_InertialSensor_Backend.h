@@ -202,6 +202,9 @@ protected:
     // common accel update function for all backends
     void update_accel(uint8_t instance);
 
+    // retune the harmonic notch stages of a gyro's filter bank
+    void update_harmonic_notch(uint8_t instance);
+
     // support for updating filter at runtime
     int8_t _last_accel_filter_hz[INS_MAX_INSTANCES];
     int8_t _last_gyro_filter_hz[INS_MAX_INSTANCES];
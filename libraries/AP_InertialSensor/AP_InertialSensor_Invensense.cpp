@@ -57,6 +57,8 @@ extern const AP_HAL::HAL& hal;
 
 #define MPU_SAMPLE_SIZE 14
 #define MPU_FIFO_BUFFER_LEN 16
+// FIFO samples and the FIFO count
+#define MPU_FIFO_BUFFER_SIZE (MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE + 2)
 
 #define int16_val(v, idx) ((int16_t)(((uint16_t)v[2*idx] << 8) | v[2*idx+1]))
 #define uint16_val(v, idx)(((uint16_t)v[2*idx] << 8) | v[2*idx+1])
@@ -88,7 +90,7 @@ AP_InertialSensor_Invensense::AP_InertialSensor_Invensense(AP_InertialSensor &im
 AP_InertialSensor_Invensense::~AP_InertialSensor_Invensense()
 {
     if (_fifo_buffer != nullptr) {
-        hal.util->free_type(_fifo_buffer, MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
+        hal.util->free_type(_fifo_buffer, MPU_FIFO_BUFFER_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
     }
     delete _auxiliary_bus;
 }
@@ -160,16 +162,20 @@ void AP_InertialSensor_Invensense::_fifo_reset()
     uint8_t user_ctrl = _last_stat_user_ctrl;
     user_ctrl &= ~(BIT_USER_CTRL_FIFO_RESET | BIT_USER_CTRL_FIFO_EN);
 
+    // this runs from the FIFO read when the sensor falls behind, so do all
+    // the writes in one go where the bus allows it
     _dev->set_speed(AP_HAL::Device::SPEED_LOW);
-    _register_write(MPUREG_FIFO_EN, 0);
-    _register_write(MPUREG_USER_CTRL, user_ctrl);
-    _register_write(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_RESET);
-    _register_write(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_EN);
-    _register_write(MPUREG_FIFO_EN, BIT_XG_FIFO_EN | BIT_YG_FIFO_EN |
-                    BIT_ZG_FIFO_EN | BIT_ACCEL_FIFO_EN | BIT_TEMP_FIFO_EN, true);
+    _dev->queue_write_register(MPUREG_FIFO_EN, 0);
+    _dev->queue_write_register(MPUREG_USER_CTRL, user_ctrl);
+    _dev->queue_write_register(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_RESET);
+    _dev->queue_write_register(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_EN);
+    _dev->queue_write_register(MPUREG_FIFO_EN, BIT_XG_FIFO_EN | BIT_YG_FIFO_EN |
+                               BIT_ZG_FIFO_EN | BIT_ACCEL_FIFO_EN | BIT_TEMP_FIFO_EN, true);
+    _dev->submit_queued();
     hal.scheduler->delay_microseconds(1);
     _dev->set_speed(AP_HAL::Device::SPEED_HIGH);
     _last_stat_user_ctrl = user_ctrl | BIT_USER_CTRL_FIFO_EN;
+    _fifo_pending = 0;
 
     notify_accel_fifo_reset(_accel_instance);
     notify_gyro_fifo_reset(_gyro_instance);
@@ -308,7 +314,7 @@ void AP_InertialSensor_Invensense::start()
     set_accel_orientation(_accel_instance, _rotation);
 
     // allocate fifo buffer
-    _fifo_buffer = (uint8_t *)hal.util->malloc_type(MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
+    _fifo_buffer = (uint8_t *)hal.util->malloc_type(MPU_FIFO_BUFFER_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
     if (_fifo_buffer == nullptr) {
         AP_HAL::panic("Invensense: Unable to allocate FIFO buffer");
     }
@@ -494,25 +500,12 @@ bool AP_InertialSensor_Invensense::_accumulate_fast_sampling(uint8_t *samples, u
     return ret;
 }
 
-void AP_InertialSensor_Invensense::_read_fifo()
+/*
+  limit the number of samples read from the FIFO at once. Returns true
+  if the FIFO needs a reset after they are read
+ */
+bool AP_InertialSensor_Invensense::_limit_fifo_samples(uint8_t &n_samples)
 {
-    uint8_t n_samples;
-    uint16_t bytes_read;
-    uint8_t *rx = _fifo_buffer;
-    bool need_reset = false;
-
-    if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
-        goto check_registers;
-    }
-
-    bytes_read = uint16_val(rx, 0);
-    n_samples = bytes_read / MPU_SAMPLE_SIZE;
-
-    if (n_samples == 0) {
-        /* Not enough data in FIFO */
-        goto check_registers;
-    }
-
     /*
       testing has shown that if we have more than 32 samples in the
       FIFO then some of those samples will be corrupt. It always is
@@ -525,16 +518,44 @@ void AP_InertialSensor_Invensense::_read_fifo()
      */
     if (_dev->bus_type() == AP_HAL::Device::BUS_TYPE_I2C) {
         if (n_samples > 4) {
-            need_reset = true;
             n_samples = 4;
+            return true;
         }
     } else {
         if (n_samples > 32) {
-            need_reset = true;
             n_samples = 24;
+            return true;
         }
     }
-    
+    return false;
+}
+
+void AP_InertialSensor_Invensense::_read_fifo()
+{
+    uint8_t n_samples;
+    uint16_t bytes_read;
+    uint8_t *rx = _fifo_buffer;
+    bool need_reset = false;
+
+    if (_dev->queued_in_single_request()) {
+        _read_fifo_pipelined();
+        return;
+    }
+
+    if (!_block_read(MPUREG_FIFO_COUNTH, rx, 2)) {
+        goto check_registers;
+    }
+
+    bytes_read = uint16_val(rx, 0);
+    n_samples = bytes_read / MPU_SAMPLE_SIZE;
+
+    if (n_samples == 0) {
+        /* Not enough data in FIFO */
+        goto check_registers;
+    }
+
+    need_reset = _limit_fifo_samples(n_samples);
+
     while (n_samples > 0) {
         uint8_t n = MIN(n_samples, MPU_FIFO_BUFFER_LEN);
         if (!_dev->set_chip_select(true)) {
@@ -574,7 +595,7 @@ void AP_InertialSensor_Invensense::_read_fifo()
         //debug("fifo reset n_samples %u", bytes_read/MPU_SAMPLE_SIZE);
         _fifo_reset();
     }
-    
+
 check_registers:
     // check next register value for correctness
     _dev->set_speed(AP_HAL::Device::SPEED_LOW);
@@ -585,6 +606,87 @@ check_registers:
     _dev->set_speed(AP_HAL::Device::SPEED_HIGH);
 }
 
+/*
+  read the samples in the FIFO on buses that do all queued transfers in
+  a single request. The samples counted by the previous read are still
+  in the FIFO, as nothing else takes them out, so their data, the FIFO
+  count for the next read and the register check are done in one
+  request. The cost is that samples wait in the FIFO until the read
+  after the one that counted them, so this is only worth it where a
+  request costs more than a poll period of latency, such as Linux spidev
+ */
+void AP_InertialSensor_Invensense::_read_fifo_pipelined()
+{
+    uint8_t n_samples = _fifo_pending;
+    uint8_t *rx = _fifo_buffer;
+    uint8_t *count_rx = _fifo_buffer + MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE;
+    bool last;
+
+    _fifo_pending = 0;
+
+    const bool need_reset = _limit_fifo_samples(n_samples);
+
+    do {
+        const uint8_t n = MIN(n_samples, MPU_FIFO_BUFFER_LEN);
+        n_samples -= n;
+        // count the FIFO with the last read, unless it is about to be reset
+        last = (n_samples == 0);
+        const bool count = last && !need_reset;
+
+        if (n > 0) {
+            _dev->queue_read_registers(MPUREG_FIFO_R_W, rx, n * MPU_SAMPLE_SIZE);
+        }
+        if (count) {
+            _dev->queue_read_registers(MPUREG_FIFO_COUNTH, count_rx, 2);
+            // check next register value for correctness
+            _dev->queue_set_speed(AP_HAL::Device::SPEED_LOW);
+            _dev->queue_check_next_register();
+            _dev->queue_set_speed(AP_HAL::Device::SPEED_HIGH);
+        }
+        const bool ok = _dev->submit_queued();
+
+        if (count) {
+            if (ok) {
+                _fifo_pending = MIN(uint16_val(count_rx, 0) / MPU_SAMPLE_SIZE, UINT8_MAX);
+            }
+            // a wrong register value is written back at low speed
+            _dev->set_speed(AP_HAL::Device::SPEED_LOW);
+            if (!_dev->check_queued_register(ok)) {
+                _inc_gyro_error_count(_gyro_instance);
+                _inc_accel_error_count(_accel_instance);
+            }
+            _dev->set_speed(AP_HAL::Device::SPEED_HIGH);
+        }
+        if (!ok) {
+            if (n > 0) {
+                hal.console->printf("MPU60x0: error in fifo read %u bytes\n", n * MPU_SAMPLE_SIZE);
+            }
+            // the FIFO is counted again on the next read
+            _fifo_pending = 0;
+            return;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        if (_fast_sampling) {
+            if (!_accumulate_fast_sampling(rx, n)) {
+                debug("IMU[%u] stop at %u of %u", _accel_instance, n, n + n_samples);
+                break;
+            }
+        } else {
+            if (!_accumulate(rx, n)) {
+                break;
+            }
+        }
+    } while (!last);
+
+    if (need_reset) {
+        //debug("fifo reset n_samples %u", n_samples);
+        _fifo_reset();
+    }
+}
+
 /*
   fetch temperature in order to detect FIFO sync errors
 */
@@ -81,6 +81,8 @@ private:
 
     /* Read samples from FIFO (FIFO enabled) */
     void _read_fifo();
+    void _read_fifo_pipelined();
+    bool _limit_fifo_samples(uint8_t &n_samples);
 
     /* Check if there's data available by either reading DRDY pin or register */
     bool _data_ready();
@@ -138,6 +140,9 @@ private:
     // buffer for fifo read
     uint8_t *_fifo_buffer;
 
+    // samples in the FIFO at the end of the last pipelined read
+    uint8_t _fifo_pending;
+
     /*
       accumulators for fast sampling
       See description in _accumulate_fast_sampling()
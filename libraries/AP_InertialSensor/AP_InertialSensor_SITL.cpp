@@ -39,6 +39,7 @@ bool AP_InertialSensor_SITL::init_sensor(void)
     for (uint8_t i=0; i<INS_SITL_INSTANCES; i++) {
         gyro_instance[i] = _imu.register_gyro(gyro_sample_hz[i], i);
         accel_instance[i] = _imu.register_accel(accel_sample_hz[i], i);
+        gyro_vibe_phase[i] = 0;
     }
 
     hal.scheduler->register_timer_process(FUNCTOR_BIND_MEMBER(&AP_InertialSensor_SITL::timer_update, void));
@@ -116,6 +117,16 @@ void AP_InertialSensor_SITL::generate_gyro(uint8_t instance)
     float q = radians(sitl->state.pitchRate) + gyro_drift();
     float r = radians(sitl->state.yawRate) + gyro_drift();
 
+    if (sitl->motors_on && is_positive(sitl->vibe_freq)) {
+        // motor vibration at a frequency following the motor speed, as seen by the harmonic notch
+        const float vibe_freq = sitl->vibe_freq * safe_sqrt(sitl->throttle);
+        gyro_vibe_phase[instance] = wrap_2PI(gyro_vibe_phase[instance] + M_2PI * vibe_freq / gyro_sample_hz[instance]);
+        const float vibe = ToRad(sitl->vibe_amp) * sinf(gyro_vibe_phase[instance]);
+        p += vibe;
+        q += vibe;
+        r += vibe;
+    }
+
     p += gyro_noise * rand_float();
     q += gyro_noise * rand_float();
     r += gyro_noise * rand_float();
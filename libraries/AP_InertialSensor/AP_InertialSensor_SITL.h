@@ -35,4 +35,5 @@ private:
     uint8_t accel_instance[INS_SITL_INSTANCES];
     uint64_t next_gyro_sample[INS_SITL_INSTANCES];
     uint64_t next_accel_sample[INS_SITL_INSTANCES];
+    float gyro_vibe_phase[INS_SITL_INSTANCES];
 };
@@ -0,0 +1,164 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+#define BENCH_POINTS 256
+
+static const struct Location bench_origin = { {0}, 0, -353632610, 1491652300 };
+
+// locations within about 5km of the origin, like a mission or fence
+static void bench_locations(struct Location *locs)
+{
+    for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+        locs[i] = bench_origin;
+        locs[i].lat += (int32_t)((i * 7919) % 2001 - 1000) * 450;
+        locs[i].lng += (int32_t)((i * 104729) % 2001 - 1000) * 450;
+    }
+}
+
+static void BM_LocationDiffScalar(benchmark::State& state)
+{
+    struct Location locs[BENCH_POINTS];
+    Vector2f ne[BENCH_POINTS];
+    bench_locations(locs);
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+            ne[i] = location_diff(bench_origin, locs[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationDiffBatch(benchmark::State& state)
+{
+    struct Location locs[BENCH_POINTS];
+    Vector2f ne[BENCH_POINTS];
+    bench_locations(locs);
+    while (state.KeepRunning()) {
+        Location_origin<float> origin(bench_origin);
+        origin.diff(locs, ne, BENCH_POINTS);
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationDistanceScalar(benchmark::State& state)
+{
+    struct Location locs[BENCH_POINTS];
+    float dist[BENCH_POINTS];
+    bench_locations(locs);
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+            dist[i] = get_distance(bench_origin, locs[i]);
+        }
+        gbenchmark_escape(dist);
+    }
+}
+
+static void BM_LocationDistanceBatch(benchmark::State& state)
+{
+    struct Location locs[BENCH_POINTS];
+    float dist[BENCH_POINTS];
+    bench_locations(locs);
+    while (state.KeepRunning()) {
+        Location_origin<float> origin(bench_origin);
+        origin.distance(locs, dist, BENCH_POINTS);
+        gbenchmark_escape(dist);
+    }
+}
+
+static void BM_LocationBearingScalar(benchmark::State& state)
+{
+    struct Location locs[BENCH_POINTS];
+    int32_t bearing[BENCH_POINTS];
+    bench_locations(locs);
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+            bearing[i] = get_bearing_cd(bench_origin, locs[i]);
+        }
+        gbenchmark_escape(bearing);
+    }
+}
+
+static void BM_LocationBearingBatch(benchmark::State& state)
+{
+    struct Location locs[BENCH_POINTS];
+    int32_t bearing[BENCH_POINTS];
+    bench_locations(locs);
+    while (state.KeepRunning()) {
+        Location_origin<float> origin(bench_origin);
+        origin.bearing_cd(locs, bearing, BENCH_POINTS);
+        gbenchmark_escape(bearing);
+    }
+}
+
+static void BM_LocationOffsetScalar(benchmark::State& state)
+{
+    Vector2f ne[BENCH_POINTS];
+    struct Location locs[BENCH_POINTS];
+    for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+        ne[i] = Vector2f((i * 7919) % 2001 - 1000, (i * 104729) % 2001 - 1000) * 5.0f;
+    }
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+            locs[i] = bench_origin;
+            location_offset(locs[i], ne[i].x, ne[i].y);
+        }
+        gbenchmark_escape(locs);
+    }
+}
+
+static void BM_LocationOffsetBatch(benchmark::State& state)
+{
+    Vector2f ne[BENCH_POINTS];
+    struct Location locs[BENCH_POINTS];
+    for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+        ne[i] = Vector2f((i * 7919) % 2001 - 1000, (i * 104729) % 2001 - 1000) * 5.0f;
+    }
+    while (state.KeepRunning()) {
+        Location_origin<float> origin(bench_origin);
+        origin.offset(ne, locs, BENCH_POINTS);
+        gbenchmark_escape(locs);
+    }
+}
+
+static void BM_LocationECEFScalar(benchmark::State& state)
+{
+    Vector3d llh[BENCH_POINTS];
+    Vector3d ecef[BENCH_POINTS];
+    for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+        llh[i] = Vector3d(-0.617 + i * 1.0e-5, 2.603 + i * 1.0e-5, 580.0);
+    }
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+            wgsllh2ecef(llh[i], ecef[i]);
+        }
+        gbenchmark_escape(ecef);
+    }
+}
+
+static void BM_LocationECEFBatch(benchmark::State& state)
+{
+    Vector3d llh[BENCH_POINTS];
+    Vector3d ecef[BENCH_POINTS];
+    for (uint16_t i = 0; i < BENCH_POINTS; i++) {
+        llh[i] = Vector3d(-0.617 + i * 1.0e-5, 2.603 + i * 1.0e-5, 580.0);
+    }
+    while (state.KeepRunning()) {
+        wgsllh2ecef(llh, ecef, BENCH_POINTS);
+        gbenchmark_escape(ecef);
+    }
+}
+
+BENCHMARK(BM_LocationDiffScalar);
+BENCHMARK(BM_LocationDiffBatch);
+BENCHMARK(BM_LocationDistanceScalar);
+BENCHMARK(BM_LocationDistanceBatch);
+BENCHMARK(BM_LocationBearingScalar);
+BENCHMARK(BM_LocationBearingBatch);
+BENCHMARK(BM_LocationOffsetScalar);
+BENCHMARK(BM_LocationOffsetBatch);
+BENCHMARK(BM_LocationECEFScalar);
+BENCHMARK(BM_LocationECEFBatch);
+
+BENCHMARK_MAIN()
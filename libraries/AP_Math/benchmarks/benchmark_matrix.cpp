@@ -1,6 +1,7 @@
 #include <AP_gbenchmark.h>
 
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
 
 static void BM_MatrixMultiplication(benchmark::State& state)
 {
@@ -17,6 +18,110 @@ static void BM_MatrixMultiplication(benchmark::State& state)
     }
 }
 
+// covariance like 9x9 matrix and gain vectors
+static void fill_covariance(MatrixN<float,9> &P, VectorN<float,9> &K, VectorN<float,9> &H)
+{
+    for (uint8_t i = 0; i < 9; i++) {
+        for (uint8_t j = 0; j < 9; j++) {
+            P[i][j] = (i == j) ? 1.0f : 0.01f * (i + j);
+        }
+        K[i] = 0.1f * i;
+        H[i] = cosf(i);
+    }
+}
+
+static void BM_MatrixNUpdateTemporary(benchmark::State& state)
+{
+    MatrixN<float,9> P;
+    VectorN<float,9> K, H, PH;
+    fill_covariance(P, K, H);
+    PH.mult(P, H);
+
+    while (state.KeepRunning()) {
+        MatrixN<float,9> tempM;
+        tempM.mult(K, PH);
+        P -= tempM;
+        gbenchmark_escape(&P);
+    }
+}
+
+static void BM_MatrixNUpdateFused(benchmark::State& state)
+{
+    MatrixN<float,9> P;
+    VectorN<float,9> K, H, PH;
+    fill_covariance(P, K, H);
+    PH.mult(P, H);
+
+    while (state.KeepRunning()) {
+        P -= outer_product(K, PH);
+        gbenchmark_escape(&P);
+    }
+}
+
+static void BM_MatrixNJosephUpdate(benchmark::State& state)
+{
+    MatrixN<float,9> P;
+    VectorN<float,9> K, H;
+    fill_covariance(P, K, H);
+
+    while (state.KeepRunning()) {
+        MatrixN<float,9> P2 = P;
+        P2.joseph_update(K, H, 0.25f);
+        gbenchmark_escape(&P2);
+    }
+}
+
+// A*P*A' as two loop products through temporaries
+static void BM_MatrixNPropagateLoops(benchmark::State& state)
+{
+    MatrixN<float,9> A, P;
+    VectorN<float,9> K, H;
+    fill_covariance(A, K, H);
+    fill_covariance(P, K, H);
+
+    while (state.KeepRunning()) {
+        float AP[9][9];
+        float APAt[9][9];
+        for (uint8_t i = 0; i < 9; i++) {
+            for (uint8_t j = 0; j < 9; j++) {
+                AP[i][j] = 0;
+                for (uint8_t k = 0; k < 9; k++) {
+                    AP[i][j] += A[i][k] * P[k][j];
+                }
+            }
+        }
+        for (uint8_t i = 0; i < 9; i++) {
+            for (uint8_t j = 0; j < 9; j++) {
+                APAt[i][j] = 0;
+                for (uint8_t k = 0; k < 9; k++) {
+                    APAt[i][j] += AP[i][k] * A[j][k];
+                }
+            }
+        }
+        gbenchmark_escape(APAt);
+    }
+}
+
+static void BM_MatrixNPropagateSymmetric(benchmark::State& state)
+{
+    MatrixN<float,9> A, P;
+    VectorN<float,9> K, H;
+    fill_covariance(A, K, H);
+    fill_covariance(P, K, H);
+
+    while (state.KeepRunning()) {
+        const MatrixN<float,9> AP = A * P;
+        MatrixN<float,9> APAt;
+        APAt.set_symmetric(AP * transposed(A));
+        gbenchmark_escape(&APAt);
+    }
+}
+
 BENCHMARK(BM_MatrixMultiplication);
+BENCHMARK(BM_MatrixNUpdateTemporary);
+BENCHMARK(BM_MatrixNUpdateFused);
+BENCHMARK(BM_MatrixNJosephUpdate);
+BENCHMARK(BM_MatrixNPropagateLoops);
+BENCHMARK(BM_MatrixNPropagateSymmetric);
 
 BENCHMARK_MAIN()
@@ -0,0 +1,75 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+/*
+ * fence like polygon with n vertices: a 2km wide field boundary in cm with
+ * a jagged edge, closed by repeating the first vertex
+ */
+static Vector2f *fence_polygon(unsigned n)
+{
+    Vector2f *V = new Vector2f[n+1];
+    for (unsigned i = 0; i < n; i++) {
+        const float angle = M_2PI * i / n;
+        const float r = 100000.0f * (1.0f + 0.1f * sinf(37.0f * angle) + ((i % 2) ? 0.02f : 0.0f));
+        V[i] = Vector2f(r * cosf(angle), r * sinf(angle));
+    }
+    V[n] = V[0];
+    return V;
+}
+
+// points spread over the polygon's bounding box
+static Vector2f test_point(unsigned i)
+{
+    return Vector2f((i * 7919) % 240000 - 120000.0f, (i * 104729) % 240000 - 120000.0f);
+}
+
+static void BM_PolygonOutside(benchmark::State& state)
+{
+    const unsigned n = state.range_x();
+    Vector2f *V = fence_polygon(n);
+    unsigned i = 0;
+
+    while (state.KeepRunning()) {
+        bool outside = Polygon_outside(test_point(i++), V, n+1);
+        gbenchmark_escape(&outside);
+    }
+
+    delete[] V;
+}
+
+static void BM_PolygonIndexOutside(benchmark::State& state)
+{
+    const unsigned n = state.range_x();
+    Vector2f *V = fence_polygon(n);
+    Polygon_index<float> index;
+    index.build(V, n+1);
+    unsigned i = 0;
+
+    while (state.KeepRunning()) {
+        bool outside = index.outside(test_point(i++));
+        gbenchmark_escape(&outside);
+    }
+
+    delete[] V;
+}
+
+static void BM_PolygonIndexBuild(benchmark::State& state)
+{
+    const unsigned n = state.range_x();
+    Vector2f *V = fence_polygon(n);
+    Polygon_index<float> index;
+
+    while (state.KeepRunning()) {
+        index.build(V, n+1);
+        gbenchmark_escape(&index);
+    }
+
+    delete[] V;
+}
+
+BENCHMARK(BM_PolygonOutside)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_PolygonIndexOutside)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_PolygonIndexBuild)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+BENCHMARK_MAIN()
@@ -313,6 +313,19 @@ void wgsecef2llh(const Vector3d &ecef, Vector3d &llh) {
   llh[2] = (p*e_c*C + fabs(ecef[2])*S - WGS84_A*e_c*A_n) / sqrt(e_c*e_c*C*C + S*S);
 }
 
+void wgsllh2ecef(const Vector3d *llh, Vector3d *ecef, uint16_t n) {
+  for (uint16_t i = 0; i < n; i++) {
+    const double sin_lat = sin(llh[i][0]);
+    const double cos_lat = cos(llh[i][0]);
+    const double d = WGS84_E * sin_lat;
+    const double N = WGS84_A / sqrt(1 - d*d);
+
+    ecef[i][0] = (N + llh[i][2]) * cos_lat * cos(llh[i][1]);
+    ecef[i][1] = (N + llh[i][2]) * cos_lat * sin(llh[i][1]);
+    ecef[i][2] = ((1 - WGS84_E*WGS84_E)*N + llh[i][2]) * sin_lat;
+  }
+}
+
 // return true when lat and lng are within range
 bool check_lat(float lat)
 {
@@ -342,3 +355,92 @@ bool check_latlng(Location loc)
 {
     return check_lat(loc.lat) && check_lng(loc.lng);
 }
+
+// double precision versions of LOCATION_SCALING_FACTOR and LOCATION_SCALING_FACTOR_INV
+static const double location_scaling_factor = 0.011131884502145034;
+static const double location_scaling_factor_inv = 89.83204953368922;
+
+static inline float location_cos(float x) { return cosf(x); }
+static inline double location_cos(double x) { return cos(x); }
+static inline float location_sin(float x) { return sinf(x); }
+static inline double location_sin(double x) { return sin(x); }
+static inline float location_sqrt(float x) { return sqrtf(x); }
+static inline double location_sqrt(double x) { return sqrt(x); }
+
+template <typename T>
+Location_origin<T>::Location_origin(const struct Location &origin) :
+    _origin(origin)
+{
+    const T lat_rad = origin.lat * (T)(1.0e-7 * DEG_TO_RAD_DOUBLE);
+    _cos_lat = location_cos(lat_rad);
+    _sin_lat = location_sin(lat_rad);
+    _lng_scale = constrain_value(_cos_lat, (T)0.01, (T)1.0);
+}
+
+/*
+  cos(lat) is cos(origin_lat + d), expanded using a series for the small
+  angle d. Within 0.02 radians (about 127km) of the origin the truncated
+  terms are below double precision
+ */
+template <typename T>
+T Location_origin<T>::longitude_scale(int32_t lat) const
+{
+    const T d = (lat - _origin.lat) * (T)(1.0e-7 * DEG_TO_RAD_DOUBLE);
+    T scale;
+    if (d < (T)0.02 && d > (T)-0.02) {
+        const T d2 = d * d;
+        scale = _cos_lat * (1 - d2 * ((T)0.5 - d2 * (T)(1.0 / 24))) - _sin_lat * d * (1 - d2 * (T)(1.0 / 6));
+    } else {
+        scale = location_cos(lat * (T)(1.0e-7 * DEG_TO_RAD_DOUBLE));
+    }
+    return constrain_value(scale, (T)0.01, (T)1.0);
+}
+
+template <typename T>
+void Location_origin<T>::diff(const struct Location *locs, Vector2<T> *ne, uint16_t n) const
+{
+    const T scale_north = location_scaling_factor;
+    const T scale_east = location_scaling_factor * _lng_scale;
+    for (uint16_t i = 0; i < n; i++) {
+        ne[i].x = (locs[i].lat - _origin.lat) * scale_north;
+        ne[i].y = (locs[i].lng - _origin.lng) * scale_east;
+    }
+}
+
+template <typename T>
+void Location_origin<T>::offset(const Vector2<T> *ne, struct Location *locs, uint16_t n) const
+{
+    const T scale_north = location_scaling_factor_inv;
+    const T scale_east = location_scaling_factor_inv / _lng_scale;
+    for (uint16_t i = 0; i < n; i++) {
+        locs[i] = _origin;
+        locs[i].lat += (int32_t)(ne[i].x * scale_north);
+        locs[i].lng += (int32_t)(ne[i].y * scale_east);
+    }
+}
+
+template <typename T>
+void Location_origin<T>::distance(const struct Location *locs, T *dist, uint16_t n) const
+{
+    for (uint16_t i = 0; i < n; i++) {
+        const T dlat = locs[i].lat - _origin.lat;
+        const T dlng = (locs[i].lng - _origin.lng) * longitude_scale(locs[i].lat);
+        dist[i] = location_sqrt(dlat * dlat + dlng * dlng) * (T)location_scaling_factor;
+    }
+}
+
+template <typename T>
+void Location_origin<T>::bearing_cd(const struct Location *locs, int32_t *bearing, uint16_t n) const
+{
+    for (uint16_t i = 0; i < n; i++) {
+        const int32_t off_x = locs[i].lng - _origin.lng;
+        const int32_t off_y = (locs[i].lat - _origin.lat) / longitude_scale(locs[i].lat);
+        bearing[i] = 9000 + atan2f(-off_y, off_x) * DEGX100;
+        if (bearing[i] < 0) {
+            bearing[i] += 36000;
+        }
+    }
+}
+
+template class Location_origin<float>;
+template class Location_origin<double>;
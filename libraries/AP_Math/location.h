@@ -91,6 +91,11 @@ void        print_latlon(AP_HAL::BetterStream *s, int32_t lat_or_lon);
 // (X, Y, Z)
 void        wgsllh2ecef(const Vector3d &llh, Vector3d &ecef);
 
+// Converts n WGS84 geodetic coordinates into ECEF coordinates,
+// same as calling wgsllh2ecef() for each but with one sin and cos of
+// latitude per point
+void        wgsllh2ecef(const Vector3d *llh, Vector3d *ecef, uint16_t n);
+
 // Converts from WGS84 Earth Centered, Earth Fixed (ECEF)
 // coordinates (X, Y, Z), into WHS84 geodetic
 // coordinates (lat, lon, height)
@@ -105,3 +110,39 @@ bool        check_latlng(float lat, float lng);
 bool        check_latlng(int32_t lat, int32_t lng);
 bool        check_latlng(Location loc);
 
+
+/*
+  origin of a local North/East tangent plane for converting arrays of
+  locations. The origin's latitude trig is calculated once, so the batch
+  methods need no trig calls for locations within about 100km of the
+  origin. T is float, or double when millimetre accuracy is needed over
+  long baselines (e.g. RTK)
+ */
+template <typename T>
+class Location_origin {
+public:
+    Location_origin(const struct Location &origin);
+
+    const struct Location &get_origin() const { return _origin; }
+
+    // longitude scale at the given latitude, same as longitude_scale() for a location at that latitude
+    T longitude_scale(int32_t lat) const;
+
+    // N/E distances in meters from the origin, same as location_diff(origin, locs[i])
+    void diff(const struct Location *locs, Vector2<T> *ne, uint16_t n) const;
+
+    // locations at N/E distances in meters from the origin, same as location_offset() on a copy of the origin
+    void offset(const Vector2<T> *ne, struct Location *locs, uint16_t n) const;
+
+    // distances in meters from the origin, same as get_distance(origin, locs[i])
+    void distance(const struct Location *locs, T *dist, uint16_t n) const;
+
+    // bearings in centi-degrees from the origin, same as get_bearing_cd(origin, locs[i])
+    void bearing_cd(const struct Location *locs, int32_t *bearing, uint16_t n) const;
+
+private:
+    struct Location _origin;
+    T _cos_lat;     // cosine of the origin's latitude
+    T _sin_lat;     // sine of the origin's latitude
+    T _lng_scale;   // longitude scale at the origin
+};
@@ -18,28 +18,21 @@ void MatrixN<T,N>::mult(const VectorN<T,N> &A, const VectorN<T,N> &B)
     }
 }
 
-// subtract B from the matrix
+// Joseph form covariance update for a scalar measurement, expanded so
+// that only the vectors P*H and H'*P need to be stored
 template <typename T, uint8_t N>
-MatrixN<T,N> &MatrixN<T,N>::operator -=(const MatrixN<T,N> &B)
+void MatrixN<T,N>::joseph_update(const VectorN<T,N> &K, const VectorN<T,N> &H, T R)
 {
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
-            v[i][j] -= B.v[i][j];
+    VectorN<T,N> PH;
+    VectorN<T,N> HP;
+    PH.mult(*this, H);
+    for (uint8_t j = 0; j < N; j++) {
+        for (uint8_t i = 0; i < N; i++) {
+            HP[j] += H[i] * v[i][j];
         }
     }
-    return *this;
-}
-
-// add B to the matrix
-template <typename T, uint8_t N>
-MatrixN<T,N> &MatrixN<T,N>::operator +=(const MatrixN<T,N> &B)
-{
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
-            v[i][j] += B.v[i][j];
-        }
-    }
-    return *this;
+    const T S = H * PH + R;
+    *this -= outer_product(K, HP) + outer_product(PH, K) - outer_product(K, K) * S;
 }
 
 // Matrix symmetry routine
@@ -47,7 +40,7 @@ template <typename T, uint8_t N>
 void MatrixN<T,N>::force_symmetry(void)
 {
     for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < (i - 1); j++) {
+        for (uint8_t j = 0; j < i; j++) {
             v[i][j] = (v[i][j] + v[j][i]) * 0.5;
             v[j][i] = v[i][j];
         }
@@ -55,6 +48,9 @@ void MatrixN<T,N>::force_symmetry(void)
 }
 
 template void MatrixN<float,4>::mult(const VectorN<float,4> &A, const VectorN<float,4> &B);
-template MatrixN<float,4> &MatrixN<float,4>::operator -=(const MatrixN<float,4> &B);
-template MatrixN<float,4> &MatrixN<float,4>::operator +=(const MatrixN<float,4> &B);
+template void MatrixN<float,4>::joseph_update(const VectorN<float,4> &K, const VectorN<float,4> &H, float R);
 template void MatrixN<float,4>::force_symmetry(void);
+
+template void MatrixN<float,9>::mult(const VectorN<float,9> &A, const VectorN<float,9> &B);
+template void MatrixN<float,9>::joseph_update(const VectorN<float,9> &K, const VectorN<float,9> &H, float R);
+template void MatrixN<float,9>::force_symmetry(void);
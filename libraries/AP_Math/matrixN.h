@@ -11,16 +11,117 @@
 template <typename T, uint8_t N>
 class VectorN;
 
+/*
+  expression templates for N dimensional matrices. Sums, differences,
+  scaling, transposes, outer products and products of matrices build small
+  expression objects which are only evaluated when assigned to a
+  MatrixN. Each element of the result is then calculated once, with no
+  temporary matrices, and the inner loop of a product is unrolled at
+  compile time.
+
+  The destination must not appear inside a product or transpose on the
+  right hand side, as its elements are overwritten while the expression
+  is evaluated. Expressions hold references to their operands, so must
+  not be stored beyond the statement that creates them.
+ */
+template <typename E, typename T, uint8_t N>
+class MatrixN_Expr {
+public:
+    T operator()(uint8_t i, uint8_t j) const {
+        return static_cast<const E &>(*this)(i, j);
+    }
+};
+
+template <typename A, typename B, typename T, uint8_t N>
+class MatrixN_Sum : public MatrixN_Expr<MatrixN_Sum<A,B,T,N>,T,N> {
+public:
+    MatrixN_Sum(const A &a, const B &b) : _a(a), _b(b) {}
+    T operator()(uint8_t i, uint8_t j) const { return _a(i, j) + _b(i, j); }
+private:
+    const A &_a;
+    const B &_b;
+};
+
+template <typename A, typename B, typename T, uint8_t N>
+class MatrixN_Difference : public MatrixN_Expr<MatrixN_Difference<A,B,T,N>,T,N> {
+public:
+    MatrixN_Difference(const A &a, const B &b) : _a(a), _b(b) {}
+    T operator()(uint8_t i, uint8_t j) const { return _a(i, j) - _b(i, j); }
+private:
+    const A &_a;
+    const B &_b;
+};
+
+template <typename A, typename T, uint8_t N>
+class MatrixN_Scaled : public MatrixN_Expr<MatrixN_Scaled<A,T,N>,T,N> {
+public:
+    MatrixN_Scaled(const A &a, T s) : _a(a), _s(s) {}
+    T operator()(uint8_t i, uint8_t j) const { return _a(i, j) * _s; }
+private:
+    const A &_a;
+    const T _s;
+};
+
+template <typename A, typename T, uint8_t N>
+class MatrixN_Transpose : public MatrixN_Expr<MatrixN_Transpose<A,T,N>,T,N> {
+public:
+    MatrixN_Transpose(const A &a) : _a(a) {}
+    T operator()(uint8_t i, uint8_t j) const { return _a(j, i); }
+private:
+    const A &_a;
+};
 
+// outer product of two vectors, A * B'
 template <typename T, uint8_t N>
-class MatrixN {
-  
+class MatrixN_Outer : public MatrixN_Expr<MatrixN_Outer<T,N>,T,N> {
+public:
+    MatrixN_Outer(const VectorN<T,N> &a, const VectorN<T,N> &b) : _a(a), _b(b) {}
+    T operator()(uint8_t i, uint8_t j) const { return _a[i] * _b[j]; }
+private:
+    const VectorN<T,N> &_a;
+    const VectorN<T,N> &_b;
+};
+
+// sum of a(i,k) * b(k,j) over k, unrolled
+template <typename T, uint8_t K, uint8_t N>
+struct MatrixN_Unroll {
+    template <typename A, typename B>
+    static T product(const A &a, const B &b, uint8_t i, uint8_t j, T sum) {
+        return MatrixN_Unroll<T,K+1,N>::product(a, b, i, j, sum + a(i, K) * b(K, j));
+    }
+};
+
+template <typename T, uint8_t N>
+struct MatrixN_Unroll<T,N,N> {
+    template <typename A, typename B>
+    static T product(const A &, const B &, uint8_t, uint8_t, T sum) {
+        return sum;
+    }
+};
+
+// matrix product. Operands are evaluated N times per element, so nested
+// products should be assigned to a MatrixN first
+template <typename A, typename B, typename T, uint8_t N>
+class MatrixN_Product : public MatrixN_Expr<MatrixN_Product<A,B,T,N>,T,N> {
+public:
+    MatrixN_Product(const A &a, const B &b) : _a(a), _b(b) {}
+    T operator()(uint8_t i, uint8_t j) const {
+        return MatrixN_Unroll<T,0,N>::product(_a, _b, i, j, 0);
+    }
+private:
+    const A &_a;
+    const B &_b;
+};
+
+template <typename T, uint8_t N>
+class MatrixN : public MatrixN_Expr<MatrixN<T,N>,T,N> {
+
     friend class VectorN<T,N>;
 
 public:
     // constructor from zeros
     MatrixN<T,N>(void) {
-        memset(v, 0, sizeof(v));        
+        memset(v, 0, sizeof(v));
     }
 
     // constructor from 4 diagonals
@@ -31,18 +132,109 @@ public:
         }
     }
 
+    // constructor from an expression
+    template <typename E>
+    MatrixN<T,N>(const MatrixN_Expr<E,T,N> &e) {
+        *this = e;
+    }
+
+    // element access
+    T operator()(uint8_t i, uint8_t j) const { return v[i][j]; }
+    T *operator[](uint8_t i) { return v[i]; }
+    const T *operator[](uint8_t i) const { return v[i]; }
+
     // multiply two vectors to give a matrix, in-place
     void mult(const VectorN<T,N> &A, const VectorN<T,N> &B);
 
-    // subtract B from the matrix
-    MatrixN<T,N> &operator -=(const MatrixN<T,N> &B);
+    // evaluate an expression into the matrix
+    template <typename E>
+    MatrixN<T,N> &operator =(const MatrixN_Expr<E,T,N> &e) {
+        for (uint8_t i = 0; i < N; i++) {
+            for (uint8_t j = 0; j < N; j++) {
+                v[i][j] = e(i, j);
+            }
+        }
+        return *this;
+    }
+
+    // subtract an expression from the matrix
+    template <typename E>
+    MatrixN<T,N> &operator -=(const MatrixN_Expr<E,T,N> &e) {
+        for (uint8_t i = 0; i < N; i++) {
+            for (uint8_t j = 0; j < N; j++) {
+                v[i][j] -= e(i, j);
+            }
+        }
+        return *this;
+    }
+
+    // add an expression to the matrix
+    template <typename E>
+    MatrixN<T,N> &operator +=(const MatrixN_Expr<E,T,N> &e) {
+        for (uint8_t i = 0; i < N; i++) {
+            for (uint8_t j = 0; j < N; j++) {
+                v[i][j] += e(i, j);
+            }
+        }
+        return *this;
+    }
+
+    // evaluate an expression known to be symmetric, e.g. A*P*A', into
+    // the matrix. Only the lower triangle is calculated
+    template <typename E>
+    void set_symmetric(const MatrixN_Expr<E,T,N> &e) {
+        for (uint8_t i = 0; i < N; i++) {
+            for (uint8_t j = 0; j <= i; j++) {
+                v[i][j] = e(i, j);
+                v[j][i] = v[i][j];
+            }
+        }
+    }
+
+    // Joseph form covariance update for a scalar measurement with
+    // observation vector H, noise variance R and Kalman gain K:
+    // P = (I - K*H')*P*(I - K*H')' + K*R*K'
+    void joseph_update(const VectorN<T,N> &K, const VectorN<T,N> &H, T R);
 
-    // add B to the matrix
-    MatrixN<T,N> &operator +=(const MatrixN<T,N> &B);
-    
     // Matrix symmetry routine
     void force_symmetry(void);
 
 private:
     T v[N][N];
 };
+
+template <typename A, typename B, typename T, uint8_t N>
+MatrixN_Sum<A,B,T,N> operator +(const MatrixN_Expr<A,T,N> &a, const MatrixN_Expr<B,T,N> &b)
+{
+    return MatrixN_Sum<A,B,T,N>(static_cast<const A &>(a), static_cast<const B &>(b));
+}
+
+template <typename A, typename B, typename T, uint8_t N>
+MatrixN_Difference<A,B,T,N> operator -(const MatrixN_Expr<A,T,N> &a, const MatrixN_Expr<B,T,N> &b)
+{
+    return MatrixN_Difference<A,B,T,N>(static_cast<const A &>(a), static_cast<const B &>(b));
+}
+
+template <typename A, typename T, uint8_t N>
+MatrixN_Scaled<A,T,N> operator *(const MatrixN_Expr<A,T,N> &a, T s)
+{
+    return MatrixN_Scaled<A,T,N>(static_cast<const A &>(a), s);
+}
+
+template <typename A, typename B, typename T, uint8_t N>
+MatrixN_Product<A,B,T,N> operator *(const MatrixN_Expr<A,T,N> &a, const MatrixN_Expr<B,T,N> &b)
+{
+    return MatrixN_Product<A,B,T,N>(static_cast<const A &>(a), static_cast<const B &>(b));
+}
+
+template <typename A, typename T, uint8_t N>
+MatrixN_Transpose<A,T,N> transposed(const MatrixN_Expr<A,T,N> &a)
+{
+    return MatrixN_Transpose<A,T,N>(static_cast<const A &>(a));
+}
+
+template <typename T, uint8_t N>
+MatrixN_Outer<T,N> outer_product(const VectorN<T,N> &a, const VectorN<T,N> &b)
+{
+    return MatrixN_Outer<T,N>(a, b);
+}
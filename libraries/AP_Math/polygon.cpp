@@ -34,43 +34,53 @@
  *  expect that to be very small over the distances involved in the
  *  fence boundary
  */
+/*
+ *  toggle the outside flag if a ray from P in the +x direction crosses the
+ *  edge from Vi to Vj
+ */
+template <typename T>
+static inline void Polygon_crossing(const Vector2<T> &P, const Vector2<T> &Vi, const Vector2<T> &Vj, bool &outside)
+{
+    if ((Vi.y > P.y) == (Vj.y > P.y)) {
+        return;
+    }
+    const int32_t dx1 = P.x - Vi.x;
+    const int32_t dx2 = Vj.x - Vi.x;
+    const int32_t dy1 = P.y - Vi.y;
+    const int32_t dy2 = Vj.y - Vi.y;
+    const int8_t dx1s = (dx1 < 0) ? -1 : 1;
+    const int8_t dx2s = (dx2 < 0) ? -1 : 1;
+    const int8_t dy1s = (dy1 < 0) ? -1 : 1;
+    const int8_t dy2s = (dy2 < 0) ? -1 : 1;
+    const int8_t m1 = dx1s * dy2s;
+    const int8_t m2 = dx2s * dy1s;
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 > m2) {
+            outside = !outside;
+        } else if (m1 < m2) {
+            return;
+        } else if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
+            outside = !outside;
+        }
+    } else {
+        if (m1 < m2) {
+            outside = !outside;
+        } else if (m1 > m2) {
+            return;
+        } else if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
+            outside = !outside;
+        }
+    }
+}
+
 template <typename T>
 bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
 {
     unsigned i, j;
     bool outside = true;
     for (i = 0, j = n-1; i < n; j = i++) {
-        if ((V[i].y > P.y) == (V[j].y > P.y)) {
-            continue;
-        }
-        const int32_t dx1 = P.x - V[i].x;
-        const int32_t dx2 = V[j].x - V[i].x;
-        const int32_t dy1 = P.y - V[i].y;
-        const int32_t dy2 = V[j].y - V[i].y;
-        const int8_t dx1s = (dx1 < 0) ? -1 : 1;
-        const int8_t dx2s = (dx2 < 0) ? -1 : 1;
-        const int8_t dy1s = (dy1 < 0) ? -1 : 1;
-        const int8_t dy2s = (dy2 < 0) ? -1 : 1;
-        const int8_t m1 = dx1s * dy2s;
-        const int8_t m2 = dx2s * dy1s;
-        // we avoid the 64 bit multiplies if we can based on sign checks.
-        if (dy2 < 0) {
-            if (m1 > m2) {
-                outside = !outside;
-            } else if (m1 < m2) {
-                continue;
-            } else if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
-                outside = !outside;
-            }
-        } else {
-            if (m1 < m2) {
-                outside = !outside;
-            } else if (m1 > m2) {
-                continue;
-            } else if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
-                outside = !outside;
-            }
-        }
+        Polygon_crossing(P, V[i], V[j], outside);
     }
     return outside;
 }
@@ -88,8 +98,121 @@ bool Polygon_complete(const Vector2<T> *V, unsigned n)
     return (n >= 4 && V[n-1] == V[0]);
 }
 
+/*
+ *  build the slab index for the polygon V[n] with V[n-1]=V[0].
+ *
+ *  Starts with one slab per edge and halves the number of slabs until
+ *  the edges crossing several slabs need no more than 4 entries per
+ *  edge, so long edges do not make the index grow quadratically.
+ */
+template <typename T>
+bool Polygon_index<T>::build(const Vector2<T> *V, unsigned n)
+{
+    clear();
+    if (V == nullptr || n == 0 || n > UINT16_MAX) {
+        return false;
+    }
+
+    _n = n;
+    _y_min = _y_max = V[0].y;
+    for (uint16_t i = 1; i < _n; i++) {
+        _y_min = MIN(_y_min, V[i].y);
+        _y_max = MAX(_y_max, V[i].y);
+    }
+
+    // choose the number of slabs
+    const float height = (float)_y_max - (float)_y_min;
+    uint32_t num_entries = 0;
+    for (_num_slabs = _n; ; _num_slabs = (_num_slabs + 1) / 2) {
+        _slabs_per_unit = is_positive(height) ? _num_slabs / height : 0.0f;
+        num_entries = 0;
+        for (uint16_t i = 0, j = _n-1; i < _n; j = i++) {
+            num_entries += slab(MAX(V[i].y, V[j].y)) - slab(MIN(V[i].y, V[j].y)) + 1;
+        }
+        if (_num_slabs == 1 || num_entries <= 4U * _n) {
+            break;
+        }
+    }
+
+    _slab_start = (uint32_t *)calloc(_num_slabs + 1, sizeof(uint32_t));
+    _slab_edges = (uint16_t *)calloc(num_entries, sizeof(uint16_t));
+    if (_slab_start == nullptr || _slab_edges == nullptr) {
+        clear();
+        return false;
+    }
+
+    // count the edges in each slab, then place each edge after the ones before it
+    for (uint16_t i = 0, j = _n-1; i < _n; j = i++) {
+        const uint16_t s_max = slab(MAX(V[i].y, V[j].y));
+        for (uint16_t s = slab(MIN(V[i].y, V[j].y)); s <= s_max; s++) {
+            _slab_start[s+1]++;
+        }
+    }
+    for (uint16_t s = 0; s < _num_slabs; s++) {
+        _slab_start[s+1] += _slab_start[s];
+    }
+    for (uint16_t i = 0, j = _n-1; i < _n; j = i++) {
+        const uint16_t s_max = slab(MAX(V[i].y, V[j].y));
+        for (uint16_t s = slab(MIN(V[i].y, V[j].y)); s <= s_max; s++) {
+            _slab_edges[_slab_start[s]++] = i;
+        }
+    }
+    // placing the edges moved each start to the next slab's start
+    for (uint16_t s = _num_slabs; s > 0; s--) {
+        _slab_start[s] = _slab_start[s-1];
+    }
+    _slab_start[0] = 0;
+
+    _V = V;
+    return true;
+}
+
+template <typename T>
+void Polygon_index<T>::clear()
+{
+    free(_slab_start);
+    free(_slab_edges);
+    _slab_start = nullptr;
+    _slab_edges = nullptr;
+    _V = nullptr;
+    _n = 0;
+    _num_slabs = 0;
+}
+
+/*
+ *  test for a point in the indexed polygon, only checking the edges in
+ *  the point's slab. Any edge a ray from P can cross spans P.y, so it is
+ *  in P's slab and the result is the same as Polygon_outside()
+ */
+template <typename T>
+bool Polygon_index<T>::outside(const Vector2<T> &P) const
+{
+    if (_V == nullptr || P.y < _y_min || P.y > _y_max) {
+        return true;
+    }
+    bool outside = true;
+    const uint16_t s = slab(P.y);
+    for (uint32_t e = _slab_start[s]; e < _slab_start[s+1]; e++) {
+        const uint16_t i = _slab_edges[e];
+        Polygon_crossing(P, _V[i], _V[i > 0 ? i-1 : _n-1], outside);
+    }
+    return outside;
+}
+
+template <typename T>
+uint16_t Polygon_index<T>::slab(T y) const
+{
+    const float s = ((float)y - (float)_y_min) * _slabs_per_unit;
+    if (s <= 0.0f) {
+        return 0;
+    }
+    return MIN((uint32_t)s, _num_slabs - 1U);
+}
+
 // Necessary to avoid linker errors
 template bool Polygon_outside<int32_t>(const Vector2l &P, const Vector2l *V, unsigned n);
 template bool Polygon_complete<int32_t>(const Vector2l *V, unsigned n);
 template bool Polygon_outside<float>(const Vector2f &P, const Vector2f *V, unsigned n);
 template bool Polygon_complete<float>(const Vector2f *V, unsigned n);
+template class Polygon_index<int32_t>;
+template class Polygon_index<float>;
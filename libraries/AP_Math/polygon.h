@@ -24,3 +24,44 @@ bool        Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n
 template <typename T>
 bool        Polygon_complete(const Vector2<T> *V, unsigned n);
 
+/*
+ *  Polygon_index: slab decomposition of a polygon for fast point in
+ *  polygon tests. The polygon's y extent is split into horizontal slabs,
+ *  and each slab holds the edges that cross it, so a test only looks at
+ *  the edges that can cross a ray from the point instead of every edge.
+ *
+ *  The vertex array is not copied and must not change while the index
+ *  is in use.
+ */
+template <typename T>
+class Polygon_index {
+public:
+    ~Polygon_index() { clear(); }
+
+    // build the index for the polygon V[n] with V[n-1]=V[0]. Returns
+    // false if memory could not be allocated
+    bool build(const Vector2<T> *V, unsigned n);
+
+    // free the index
+    void clear();
+
+    // true if the index has been built
+    bool built() const { return _V != nullptr; }
+
+    // same result as Polygon_outside(P, V, n) for the polygon the index was built for
+    bool outside(const Vector2<T> &P) const;
+
+private:
+    // slab holding the given y coordinate
+    uint16_t slab(T y) const;
+
+    const Vector2<T> *_V = nullptr;
+    uint16_t _n = 0;
+    T _y_min;
+    T _y_max;
+    float _slabs_per_unit;      // number of slabs per unit of y
+    uint16_t _num_slabs = 0;
+    uint32_t *_slab_start = nullptr;    // index into _slab_edges of the first edge of each slab, with an extra element for the end
+    uint16_t *_slab_edges = nullptr;    // edges crossing each slab, the edge i goes from vertex i to vertex i-1
+};
+
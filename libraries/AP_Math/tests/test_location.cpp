@@ -0,0 +1,137 @@
+#include <AP_gtest.h>
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+#define TEST_POINTS 200
+
+/*
+ * locations scattered up to ~50km around an origin, plus a few over 150km
+ * away to take the full cosine path in Location_origin::longitude_scale()
+ */
+static void scatter_locations(const struct Location &origin, struct Location *locs, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        const int32_t range = (i % 20 == 0) ? 15000000 : 4500000;
+        locs[i] = origin;
+        locs[i].lat += (int32_t)((i * 7919) % 2001 - 1000) * (range / 1000);
+        locs[i].lng += (int32_t)((i * 104729) % 2001 - 1000) * (range / 1000);
+    }
+}
+
+static const struct Location test_origins[] = {
+    { {0}, 0, -353632610, 1491652300 },    // Canberra
+    { {0}, 0, 515000000, -1200000 },       // London
+    { {0}, 0, 0, 1799000000 },             // equator, near the date line
+    { {0}, 0, 780000000, 155000000 },      // Svalbard
+};
+
+TEST(LocationTest, longitude_scale_matches_scalar)
+{
+    for (const struct Location &origin : test_origins) {
+        Location_origin<float> lo(origin);
+        struct Location locs[TEST_POINTS];
+        scatter_locations(origin, locs, TEST_POINTS);
+        for (uint16_t i = 0; i < TEST_POINTS; i++) {
+            EXPECT_NEAR(longitude_scale(locs[i]), lo.longitude_scale(locs[i].lat), 1.0e-6f);
+        }
+    }
+}
+
+TEST(LocationTest, diff_matches_scalar)
+{
+    for (const struct Location &origin : test_origins) {
+        Location_origin<float> lo(origin);
+        struct Location locs[TEST_POINTS];
+        Vector2f ne[TEST_POINTS];
+        scatter_locations(origin, locs, TEST_POINTS);
+        lo.diff(locs, ne, TEST_POINTS);
+        for (uint16_t i = 0; i < TEST_POINTS; i++) {
+            const Vector2f expected = location_diff(origin, locs[i]);
+            // the scalar longitude_scale() rounds the latitude to float
+            // first, which the batch version does not
+            EXPECT_FLOAT_EQ(expected.x, ne[i].x);
+            EXPECT_NEAR(expected.y, ne[i].y, 0.001f + fabsf(expected.y) * 1.0e-5f);
+        }
+    }
+}
+
+TEST(LocationTest, offset_matches_scalar)
+{
+    for (const struct Location &origin : test_origins) {
+        Location_origin<float> lo(origin);
+        Vector2f ne[TEST_POINTS];
+        struct Location locs[TEST_POINTS];
+        for (uint16_t i = 0; i < TEST_POINTS; i++) {
+            ne[i] = Vector2f((i * 7919) % 2001 - 1000.5f, (i * 104729) % 2001 - 1000.5f) * 50.0f;
+        }
+        lo.offset(ne, locs, TEST_POINTS);
+        for (uint16_t i = 0; i < TEST_POINTS; i++) {
+            struct Location expected = origin;
+            location_offset(expected, ne[i].x, ne[i].y);
+            // allow for truncation to int32 and the scalar
+            // longitude_scale() rounding the latitude to float
+            EXPECT_NEAR(expected.lat, locs[i].lat, 1);
+            EXPECT_NEAR(expected.lng, locs[i].lng, 1 + labs(expected.lng - origin.lng) * 1.0e-5f);
+            EXPECT_EQ(expected.alt, locs[i].alt);
+        }
+    }
+}
+
+TEST(LocationTest, distance_and_bearing_match_scalar)
+{
+    for (const struct Location &origin : test_origins) {
+        Location_origin<float> lo(origin);
+        struct Location locs[TEST_POINTS];
+        float dist[TEST_POINTS];
+        int32_t bearing[TEST_POINTS];
+        scatter_locations(origin, locs, TEST_POINTS);
+        lo.distance(locs, dist, TEST_POINTS);
+        lo.bearing_cd(locs, bearing, TEST_POINTS);
+        for (uint16_t i = 0; i < TEST_POINTS; i++) {
+            const float expected = get_distance(origin, locs[i]);
+            EXPECT_NEAR(expected, dist[i], expected * 1.0e-5f);
+            EXPECT_NEAR(get_bearing_cd(origin, locs[i]), bearing[i], 1);
+        }
+    }
+}
+
+TEST(LocationTest, double_round_trip)
+{
+    // over 100km a double origin gets back to within the 1cm resolution of a Location
+    for (const struct Location &origin : test_origins) {
+        Location_origin<double> lo(origin);
+        Vector2<double> ne[TEST_POINTS];
+        struct Location locs[TEST_POINTS];
+        Vector2<double> back[TEST_POINTS];
+        for (uint16_t i = 0; i < TEST_POINTS; i++) {
+            ne[i].x = ((i * 7919) % 2001 - 1000) * 100.0;
+            ne[i].y = ((i * 104729) % 2001 - 1000) * 100.0;
+        }
+        lo.offset(ne, locs, TEST_POINTS);
+        lo.diff(locs, back, TEST_POINTS);
+        for (uint16_t i = 0; i < TEST_POINTS; i++) {
+            EXPECT_NEAR(ne[i].x, back[i].x, 0.012);
+            EXPECT_NEAR(ne[i].y, back[i].y, 0.012 / lo.longitude_scale(origin.lat));
+        }
+    }
+}
+
+TEST(LocationTest, wgsllh2ecef_array)
+{
+    Vector3d llh[TEST_POINTS];
+    Vector3d ecef[TEST_POINTS];
+    for (uint16_t i = 0; i < TEST_POINTS; i++) {
+        llh[i] = Vector3d(((i * 7919) % 2001 - 1000) * 0.0015, ((i * 104729) % 2001 - 1000) * 0.003, i * 10.0);
+    }
+    wgsllh2ecef(llh, ecef, TEST_POINTS);
+    for (uint16_t i = 0; i < TEST_POINTS; i++) {
+        Vector3d expected;
+        wgsllh2ecef(llh[i], expected);
+        EXPECT_DOUBLE_EQ(expected.x, ecef[i].x);
+        EXPECT_DOUBLE_EQ(expected.y, ecef[i].y);
+        EXPECT_DOUBLE_EQ(expected.z, ecef[i].z);
+    }
+}
+
+AP_GTEST_MAIN()
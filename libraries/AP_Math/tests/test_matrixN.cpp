@@ -0,0 +1,125 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
+
+// fill a matrix with distinct, non symmetric values
+template <uint8_t N>
+static void fill(MatrixN<float,N> &m, float seed)
+{
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = 0; j < N; j++) {
+            m[i][j] = sinf(seed + i * 1.3f + j * 0.7f);
+        }
+    }
+}
+
+// a symmetric positive definite matrix, like a covariance
+template <uint8_t N>
+static void fill_covariance(MatrixN<float,N> &P)
+{
+    MatrixN<float,N> A;
+    fill(A, 0.3f);
+    P = A * transposed(A);
+    for (uint8_t i = 0; i < N; i++) {
+        P[i][i] += 1.0f;
+    }
+}
+
+TEST(MatrixNTest, expressions_match_loops)
+{
+    MatrixN<float,9> A, B, C;
+    fill(A, 0.1f);
+    fill(B, 2.0f);
+    fill(C, 5.0f);
+
+    const MatrixN<float,9> M = A * transposed(B) + C * 0.5f - A;
+
+    for (uint8_t i = 0; i < 9; i++) {
+        for (uint8_t j = 0; j < 9; j++) {
+            float expected = 0;
+            for (uint8_t k = 0; k < 9; k++) {
+                expected += A[i][k] * B[j][k];
+            }
+            expected += C[i][j] * 0.5f - A[i][j];
+            EXPECT_FLOAT_EQ(expected, M[i][j]);
+        }
+    }
+}
+
+TEST(MatrixNTest, outer_product_and_symmetric)
+{
+    float a[9], b[9];
+    for (uint8_t i = 0; i < 9; i++) {
+        a[i] = i + 1;
+        b[i] = 9 - i;
+    }
+    const VectorN<float,9> va(a), vb(b);
+
+    MatrixN<float,9> M;
+    M.mult(va, vb);
+    MatrixN<float,9> E;
+    E -= outer_product(va, vb);
+    E += M;
+    for (uint8_t i = 0; i < 9; i++) {
+        for (uint8_t j = 0; j < 9; j++) {
+            EXPECT_FLOAT_EQ(0.0f, E[i][j]);
+        }
+    }
+
+    // A*P*A' computed over the lower triangle only
+    MatrixN<float,9> A, P, AP, S;
+    fill(A, 1.0f);
+    fill_covariance(P);
+    AP = A * P;
+    S.set_symmetric(AP * transposed(A));
+    const MatrixN<float,9> F = AP * transposed(A);
+    for (uint8_t i = 0; i < 9; i++) {
+        for (uint8_t j = 0; j < 9; j++) {
+            EXPECT_FLOAT_EQ(S[i][j], S[j][i]);
+            EXPECT_NEAR(F[i][j], S[i][j], 1.0e-4f * fabsf(F[i][i]));
+        }
+    }
+}
+
+TEST(MatrixNTest, force_symmetry)
+{
+    MatrixN<float,4> M;
+    fill(M, 0.5f);
+    M.force_symmetry();
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = 0; j < 4; j++) {
+            EXPECT_FLOAT_EQ(M[i][j], M[j][i]);
+        }
+    }
+}
+
+TEST(MatrixNTest, joseph_matches_standard_form)
+{
+    // with the optimal gain, the Joseph form and P - K*H'*P agree
+    MatrixN<float,9> P;
+    fill_covariance(P);
+    float h[9];
+    for (uint8_t i = 0; i < 9; i++) {
+        h[i] = cosf(i);
+    }
+    const float R = 0.25f;
+    const VectorN<float,9> H(h);
+    VectorN<float,9> PH;
+    PH.mult(P, H);
+    const VectorN<float,9> K = PH / (H * PH + R);
+
+    MatrixN<float,9> standard = P;
+    standard -= outer_product(K, PH);
+    MatrixN<float,9> joseph = P;
+    joseph.joseph_update(K, H, R);
+
+    for (uint8_t i = 0; i < 9; i++) {
+        for (uint8_t j = 0; j < 9; j++) {
+            EXPECT_NEAR(standard[i][j], joseph[i][j], 1.0e-4f * fabsf(P[i][i]));
+            EXPECT_FLOAT_EQ(joseph[i][j], joseph[j][i]);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
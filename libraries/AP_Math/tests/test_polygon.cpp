@@ -0,0 +1,70 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+/*
+ * build a closed star shaped polygon with n vertices plus the closing vertex,
+ * with the vertex radius varying so that rays cross many edges
+ */
+template <typename T>
+static void star_polygon(Vector2<T> *V, unsigned n, T radius)
+{
+    for (unsigned i = 0; i < n; i++) {
+        const float angle = M_2PI * i / n;
+        const float r = radius * ((i % 2) ? 0.5f : 1.0f);
+        V[i] = Vector2<T>(r * cosf(angle), r * sinf(angle));
+    }
+    V[n] = V[0];
+}
+
+TEST(PolygonTest, outside)
+{
+    // unit square
+    const Vector2f square[] = {{0, 0}, {10, 0}, {10, 10}, {0, 10}, {0, 0}};
+    EXPECT_FALSE(Polygon_outside(Vector2f(5, 5), square, 5));
+    EXPECT_TRUE(Polygon_outside(Vector2f(15, 5), square, 5));
+    EXPECT_TRUE(Polygon_outside(Vector2f(5, -5), square, 5));
+    EXPECT_TRUE(Polygon_complete(square, 5));
+}
+
+TEST(PolygonTest, index_matches_outside)
+{
+    const unsigned sizes[] = {4, 10, 100, 1000};
+    for (unsigned n : sizes) {
+        Vector2l V[1001];
+        star_polygon<int32_t>(V, n, 100000);
+
+        Polygon_index<int32_t> index;
+        ASSERT_TRUE(index.build(V, n+1));
+        EXPECT_TRUE(index.built());
+
+        for (int32_t x = -120000; x <= 120000; x += 1733) {
+            for (int32_t y = -120000; y <= 120000; y += 1931) {
+                const Vector2l P(x, y);
+                EXPECT_EQ(Polygon_outside(P, V, n+1), index.outside(P)) << "n=" << n << " x=" << x << " y=" << y;
+            }
+        }
+        // points on vertices
+        for (unsigned i = 0; i <= n; i++) {
+            EXPECT_EQ(Polygon_outside(V[i], V, n+1), index.outside(V[i]));
+        }
+    }
+}
+
+TEST(PolygonTest, index_float)
+{
+    Vector2f V[101];
+    star_polygon<float>(V, 100, 5000.0f);
+
+    Polygon_index<float> index;
+    ASSERT_TRUE(index.build(V, 101));
+    EXPECT_FALSE(index.outside(Vector2f(0, 0)));
+    EXPECT_TRUE(index.outside(Vector2f(6000, 0)));
+    EXPECT_TRUE(index.outside(Vector2f(0, -6000)));
+
+    index.clear();
+    EXPECT_FALSE(index.built());
+    EXPECT_TRUE(index.outside(Vector2f(0, 0)));
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,284 @@
+/*
+  shared memory sensor tap
+
+  The sensortap module (see examples/SensorTap) publishes the samples
+  and states passed to the module hooks in a shared memory object, so
+  other processes can read them as soon as they are produced without
+  going through MAVLink.
+
+  Each kind of data is kept in a ring of slots. A writer claims the
+  next sequence number, marks the slot as being written, copies the
+  data and marks it as complete, never waiting for readers. A reader
+  copies a slot and checks it wasn't overwritten meanwhile, so readers
+  don't need write access to the memory and can't hold up ArduPilot.
+
+  Like AP_Module_Structures.h this only depends on the C library, so
+  it can be used outside of ArduPilot.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "AP_Module_Structures.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_TAP_SHM_NAME "/ardupilot_sensor_tap"
+
+#define sensor_tap_version 1
+
+// number of slots in each ring, a reader that falls further behind
+// loses the oldest samples
+#define SENSOR_TAP_GYRO_SLOTS   1024
+#define SENSOR_TAP_ACCEL_SLOTS  1024
+#define SENSOR_TAP_AHRS_SLOTS   64
+
+struct sensor_tap_ring {
+    // number of samples ever written
+    uint64_t head;
+    uint32_t n_slots;
+    uint32_t slot_size;
+};
+
+/*
+  seq is 2n+1 while sample n is being written to the slot and 2n+2 once
+  it is complete
+ */
+struct sensor_tap_gyro_slot {
+    uint64_t seq;
+    struct gyro_sample sample;
+};
+
+struct sensor_tap_accel_slot {
+    uint64_t seq;
+    struct accel_sample sample;
+};
+
+struct sensor_tap_AHRS_slot {
+    uint64_t seq;
+    struct AHRS_state state;
+};
+
+struct sensor_tap {
+    // version of this structure (sensor_tap_version)
+    uint32_t structure_version;
+
+    // size of this structure, to catch ABI mismatches
+    uint32_t size;
+
+    // CLOCK_MONOTONIC time in microseconds when ArduPilot's time_us
+    // was zero, to compare sample times with the reader's clock
+    uint64_t boot_time_us;
+
+    struct sensor_tap_ring gyro;
+    struct sensor_tap_gyro_slot gyro_slots[SENSOR_TAP_GYRO_SLOTS];
+
+    struct sensor_tap_ring accel;
+    struct sensor_tap_accel_slot accel_slots[SENSOR_TAP_ACCEL_SLOTS];
+
+    struct sensor_tap_ring AHRS;
+    struct sensor_tap_AHRS_slot AHRS_slots[SENSOR_TAP_AHRS_SLOTS];
+};
+
+static inline void sensor_tap_init(struct sensor_tap *tap, uint64_t boot_time_us)
+{
+    memset(tap, 0, sizeof(*tap));
+    tap->size = sizeof(*tap);
+    tap->boot_time_us = boot_time_us;
+    tap->gyro.n_slots = SENSOR_TAP_GYRO_SLOTS;
+    tap->gyro.slot_size = sizeof(struct sensor_tap_gyro_slot);
+    tap->accel.n_slots = SENSOR_TAP_ACCEL_SLOTS;
+    tap->accel.slot_size = sizeof(struct sensor_tap_accel_slot);
+    tap->AHRS.n_slots = SENSOR_TAP_AHRS_SLOTS;
+    tap->AHRS.slot_size = sizeof(struct sensor_tap_AHRS_slot);
+
+    // readers check the version last
+    __atomic_store_n(&tap->structure_version, sensor_tap_version, __ATOMIC_RELEASE);
+}
+
+/*
+  add a sample to a ring. Never blocks, several threads may write to the
+  same ring.
+ */
+static inline void sensor_tap_ring_write(struct sensor_tap_ring *ring, void *slots,
+                                         const void *data, uint32_t len)
+{
+    const uint64_t n = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    uint8_t *slot = (uint8_t *)slots + (n % ring->n_slots) * ring->slot_size;
+    uint64_t *seq = (uint64_t *)slot;
+
+    __atomic_store_n(seq, 2 * n + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(slot + sizeof(uint64_t), data, len);
+    __atomic_store_n(seq, 2 * n + 2, __ATOMIC_RELEASE);
+}
+
+/*
+  read sample *next from a ring. Returns 1 and advances *next if it was
+  read, 0 if it hasn't been written yet, or -1 if it was overwritten
+  before being read, in which case *next is moved to the oldest sample
+  still in the ring
+ */
+static inline int sensor_tap_ring_read(const struct sensor_tap_ring *ring, const void *slots,
+                                       void *data, uint32_t len, uint64_t *next)
+{
+    const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    const uint64_t n = *next;
+
+    if (n >= head) {
+        return 0;
+    }
+    if (head - n > ring->n_slots) {
+        *next = head - ring->n_slots;
+        return -1;
+    }
+
+    const uint8_t *slot = (const uint8_t *)slots + (n % ring->n_slots) * ring->slot_size;
+    const uint64_t *seq = (const uint64_t *)slot;
+
+    const uint64_t s = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+    if (s < 2 * n + 2) {
+        // still being written
+        return 0;
+    }
+    if (s == 2 * n + 2) {
+        memcpy(data, slot + sizeof(uint64_t), len);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(seq, __ATOMIC_RELAXED) == s) {
+            *next = n + 1;
+            return 1;
+        }
+    }
+
+    // a writer lapped us while we were reading
+    *next = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - ring->n_slots;
+    return -1;
+}
+
+static inline void sensor_tap_write_gyro(struct sensor_tap *tap, const struct gyro_sample *sample)
+{
+    sensor_tap_ring_write(&tap->gyro, tap->gyro_slots, sample, sizeof(*sample));
+}
+
+static inline void sensor_tap_write_accel(struct sensor_tap *tap, const struct accel_sample *sample)
+{
+    sensor_tap_ring_write(&tap->accel, tap->accel_slots, sample, sizeof(*sample));
+}
+
+static inline void sensor_tap_write_AHRS(struct sensor_tap *tap, const struct AHRS_state *state)
+{
+    sensor_tap_ring_write(&tap->AHRS, tap->AHRS_slots, state, sizeof(*state));
+}
+
+static inline int sensor_tap_read_gyro(const struct sensor_tap *tap, struct gyro_sample *sample, uint64_t *next)
+{
+    return sensor_tap_ring_read(&tap->gyro, tap->gyro_slots, sample, sizeof(*sample), next);
+}
+
+static inline int sensor_tap_read_accel(const struct sensor_tap *tap, struct accel_sample *sample, uint64_t *next)
+{
+    return sensor_tap_ring_read(&tap->accel, tap->accel_slots, sample, sizeof(*sample), next);
+}
+
+static inline int sensor_tap_read_AHRS(const struct sensor_tap *tap, struct AHRS_state *state, uint64_t *next)
+{
+    return sensor_tap_ring_read(&tap->AHRS, tap->AHRS_slots, state, sizeof(*state), next);
+}
+
+#ifdef __cplusplus
+}
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+  reader of a sensor tap published by another process, starting with
+  the samples written after open()
+ */
+class SensorTapClient {
+public:
+    ~SensorTapClient() { close(); }
+
+    bool open(const char *name = SENSOR_TAP_SHM_NAME)
+    {
+        close();
+
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        void *p = mmap(nullptr, sizeof(struct sensor_tap), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        return attach((const struct sensor_tap *)p, true);
+    }
+
+    // read from a tap already in memory
+    bool attach(const struct sensor_tap *tap, bool mapped = false)
+    {
+        if (__atomic_load_n(&tap->structure_version, __ATOMIC_ACQUIRE) != sensor_tap_version ||
+            tap->size != sizeof(struct sensor_tap)) {
+            if (mapped) {
+                munmap((void *)tap, sizeof(struct sensor_tap));
+            }
+            return false;
+        }
+        _tap = tap;
+        _mapped = mapped;
+        _next_gyro = __atomic_load_n(&tap->gyro.head, __ATOMIC_ACQUIRE);
+        _next_accel = __atomic_load_n(&tap->accel.head, __ATOMIC_ACQUIRE);
+        _next_AHRS = __atomic_load_n(&tap->AHRS.head, __ATOMIC_ACQUIRE);
+        _lost = 0;
+        return true;
+    }
+
+    void close()
+    {
+        if (_tap && _mapped) {
+            munmap((void *)_tap, sizeof(struct sensor_tap));
+        }
+        _tap = nullptr;
+    }
+
+    // true and the next sample if there is one
+    bool read_gyro(struct gyro_sample &sample) { return _read(sensor_tap_read_gyro(_tap, &sample, &_next_gyro), sample); }
+    bool read_accel(struct accel_sample &sample) { return _read(sensor_tap_read_accel(_tap, &sample, &_next_accel), sample); }
+    bool read_AHRS(struct AHRS_state &state) { return _read(sensor_tap_read_AHRS(_tap, &state, &_next_AHRS), state); }
+
+    // times samples were lost because the reader fell behind
+    uint32_t lost() const { return _lost; }
+
+    // CLOCK_MONOTONIC time of a sample's time_us
+    uint64_t monotonic_us(uint64_t time_us) const { return _tap->boot_time_us + time_us; }
+
+private:
+    template <typename T>
+    bool _read(int ret, T &data)
+    {
+        if (ret == -1) {
+            _lost++;
+            return _retry(data);
+        }
+        return ret == 1;
+    }
+
+    bool _retry(struct gyro_sample &s) { return sensor_tap_read_gyro(_tap, &s, &_next_gyro) == 1; }
+    bool _retry(struct accel_sample &s) { return sensor_tap_read_accel(_tap, &s, &_next_accel) == 1; }
+    bool _retry(struct AHRS_state &s) { return sensor_tap_read_AHRS(_tap, &s, &_next_AHRS) == 1; }
+
+    const struct sensor_tap *_tap = nullptr;
+    bool _mapped = false;
+    uint64_t _next_gyro = 0;
+    uint64_t _next_accel = 0;
+    uint64_t _next_AHRS = 0;
+    uint32_t _lost = 0;
+};
+
+#endif // __cplusplus
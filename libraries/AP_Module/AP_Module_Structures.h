@@ -7,6 +7,8 @@
   platform, and thus can depend on compilation options to some extent
  */
 
+#pragma once
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -0,0 +1,73 @@
+/*
+  example reader of the samples published by the sensortap module,
+  printing their rate and latency every second
+
+  build with:
+    g++ -O2 -I../../.. -o sensortap_client sensortap_client.cpp -lrt
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <AP_Module_SensorTap.h>
+
+static uint64_t monotonic_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+int main(int argc, const char *argv[])
+{
+    SensorTapClient client;
+
+    if (!client.open(argc > 1 ? argv[1] : SENSOR_TAP_SHM_NAME)) {
+        fprintf(stderr, "No sensor tap, is the sensortap module loaded?\n");
+        return 1;
+    }
+
+    uint64_t last_print_us = monotonic_us();
+    uint32_t n_gyro = 0, n_accel = 0, n_AHRS = 0;
+    uint64_t max_latency_us = 0;
+
+    while (true) {
+        struct gyro_sample gyro;
+        struct accel_sample accel;
+        struct AHRS_state ahrs;
+        bool idle = true;
+
+        while (client.read_gyro(gyro)) {
+            const uint64_t latency = monotonic_us() - client.monotonic_us(gyro.time_us);
+            if (latency > max_latency_us) {
+                max_latency_us = latency;
+            }
+            n_gyro++;
+            idle = false;
+        }
+        while (client.read_accel(accel)) {
+            n_accel++;
+            idle = false;
+        }
+        while (client.read_AHRS(ahrs)) {
+            n_AHRS++;
+            idle = false;
+        }
+
+        const uint64_t now = monotonic_us();
+        if (now - last_print_us >= 1000000) {
+            printf("gyro %uHz accel %uHz AHRS %uHz max gyro latency %lluus lost %u\n",
+                   n_gyro, n_accel, n_AHRS, (unsigned long long)max_latency_us, client.lost());
+            n_gyro = n_accel = n_AHRS = 0;
+            max_latency_us = 0;
+            last_print_us = now;
+        }
+
+        if (idle) {
+            usleep(100);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+  module publishing the gyro and accel samples and the AHRS state in
+  shared memory, see AP_Module_SensorTap.h
+
+  build with:
+    gcc -shared -fPIC -O2 -I../../.. -o sensortap.so sensortap.c -lrt
+  and copy sensortap.so to the module directory
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <AP_Module_Structures.h>
+#include <AP_Module_SensorTap.h>
+
+static struct sensor_tap *tap;
+
+void ap_hook_setup_start(uint64_t time_us)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t now_us = ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+
+    int fd = shm_open(SENSOR_TAP_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        printf("sensortap: shm_open(%s) failed\n", SENSOR_TAP_SHM_NAME);
+        return;
+    }
+    if (ftruncate(fd, sizeof(struct sensor_tap)) < 0) {
+        printf("sensortap: ftruncate failed\n");
+        close(fd);
+        return;
+    }
+    void *p = mmap(NULL, sizeof(struct sensor_tap), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        printf("sensortap: mmap failed\n");
+        return;
+    }
+
+    // the hooks must not fault on the first write to a page
+    mlock(p, sizeof(struct sensor_tap));
+
+    sensor_tap_init((struct sensor_tap *)p, now_us - time_us);
+    tap = (struct sensor_tap *)p;
+
+    printf("sensortap: publishing on %s\n", SENSOR_TAP_SHM_NAME);
+}
+
+void ap_hook_AHRS_update(const struct AHRS_state *state)
+{
+    if (tap) {
+        sensor_tap_write_AHRS(tap, state);
+    }
+}
+
+void ap_hook_gyro_sample(const struct gyro_sample *sample)
+{
+    if (tap) {
+        sensor_tap_write_gyro(tap, sample);
+    }
+}
+
+void ap_hook_accel_sample(const struct accel_sample *sample)
+{
+    if (tap) {
+        sensor_tap_write_accel(tap, sample);
+    }
+}
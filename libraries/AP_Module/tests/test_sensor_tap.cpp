@@ -0,0 +1,139 @@
+#include <AP_gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Module/AP_Module_SensorTap.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class SensorTap : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        sensor_tap_init(tap.get(), 1000);
+    }
+
+    static struct gyro_sample gyro(uint64_t time_us)
+    {
+        struct gyro_sample s {};
+        s.structure_version = gyro_sample_version;
+        s.time_us = time_us;
+        s.gyro[0] = time_us;
+        return s;
+    }
+
+    std::unique_ptr<struct sensor_tap> tap{new struct sensor_tap};
+};
+
+TEST_F(SensorTap, read_in_order)
+{
+    SensorTapClient client;
+    struct gyro_sample s;
+
+    /* Only samples written after the client attached */
+    struct gyro_sample before = gyro(1);
+    sensor_tap_write_gyro(tap.get(), &before);
+
+    EXPECT_TRUE(client.attach(tap.get()));
+    EXPECT_FALSE(client.read_gyro(s));
+
+    for (uint64_t t = 10; t < 20; t++) {
+        struct gyro_sample w = gyro(t);
+        sensor_tap_write_gyro(tap.get(), &w);
+    }
+    for (uint64_t t = 10; t < 20; t++) {
+        EXPECT_TRUE(client.read_gyro(s));
+        EXPECT_EQ(s.time_us, t);
+        EXPECT_EQ(s.gyro[0], (float)t);
+    }
+    EXPECT_FALSE(client.read_gyro(s));
+    EXPECT_EQ(client.lost(), 0U);
+    EXPECT_EQ(client.monotonic_us(20), 1020U);
+}
+
+TEST_F(SensorTap, reader_behind)
+{
+    SensorTapClient client;
+    struct gyro_sample s;
+
+    EXPECT_TRUE(client.attach(tap.get()));
+
+    /* The ring wraps around more than once before the reader reads */
+    const uint64_t n = 3 * SENSOR_TAP_GYRO_SLOTS + 5;
+    for (uint64_t t = 0; t < n; t++) {
+        struct gyro_sample w = gyro(t);
+        sensor_tap_write_gyro(tap.get(), &w);
+    }
+
+    /* It gets the oldest sample still in the ring and goes on from there */
+    EXPECT_TRUE(client.read_gyro(s));
+    EXPECT_EQ(client.lost(), 1U);
+    EXPECT_EQ(s.time_us, n - SENSOR_TAP_GYRO_SLOTS);
+    for (uint64_t t = n - SENSOR_TAP_GYRO_SLOTS + 1; t < n; t++) {
+        EXPECT_TRUE(client.read_gyro(s));
+        EXPECT_EQ(s.time_us, t);
+    }
+    EXPECT_FALSE(client.read_gyro(s));
+}
+
+TEST_F(SensorTap, incomplete_slot)
+{
+    uint64_t next = 0;
+    struct gyro_sample s;
+
+    /* A writer claimed sample 0 but hasn't finished copying it */
+    tap->gyro.head = 1;
+    tap->gyro_slots[0].seq = 1;
+    EXPECT_EQ(sensor_tap_read_gyro(tap.get(), &s, &next), 0);
+    EXPECT_EQ(next, 0U);
+
+    tap->gyro_slots[0].seq = 2;
+    EXPECT_EQ(sensor_tap_read_gyro(tap.get(), &s, &next), 1);
+    EXPECT_EQ(next, 1U);
+}
+
+TEST_F(SensorTap, version_mismatch)
+{
+    SensorTapClient client;
+
+    tap->structure_version = sensor_tap_version + 1;
+    EXPECT_FALSE(client.attach(tap.get()));
+}
+
+TEST_F(SensorTap, concurrent_reader)
+{
+    const uint64_t n = 100000;
+    uint64_t n_read = 0, last = 0;
+    bool ordered = true, consistent = true;
+
+    SensorTapClient client;
+    EXPECT_TRUE(client.attach(tap.get()));
+
+    std::thread writer([this] {
+        for (uint64_t t = 1; t <= n; t++) {
+            struct gyro_sample w = gyro(t);
+            sensor_tap_write_gyro(tap.get(), &w);
+        }
+    });
+
+    /* Samples are never torn and never go backwards */
+    while (last < n) {
+        struct gyro_sample s;
+        if (!client.read_gyro(s)) {
+            continue;
+        }
+        ordered = ordered && s.time_us > last;
+        consistent = consistent && s.gyro[0] == (float)s.time_us;
+        last = s.time_us;
+        n_read++;
+    }
+    writer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(consistent);
+    EXPECT_GT(n_read, 0U);
+}
+
+AP_GTEST_MAIN()
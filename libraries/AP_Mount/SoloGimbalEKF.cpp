@@ -43,7 +43,7 @@ void SoloGimbalEKF::reset()
 {
     memset(&states,0,sizeof(states));
     memset(&gSense,0,sizeof(gSense));
-    memset(&Cov,0,sizeof(Cov));
+    Cov = MatrixN<float,9>();
     TiltCorrection = 0;
     StartTime_ms = 0;
     FiltInit = false;
@@ -485,7 +485,7 @@ void SoloGimbalEKF::predictCovariance()
     float t1625 = Cov[2][8]*t1526;
     float t1626 = Cov[0][8]*t1523;
     float t1627 = Cov[5][8]+t1625+t1626-Cov[1][8]*t1521;
-    float nextCov[9][9];
+    MatrixN<float,9> nextCov;
     nextCov[0][0] = daxNoise*t1485+t1397*t1424+t1411*t1431-t1419*t1432-t1402*t1454;
     nextCov[1][0] = -t1397*t1478-t1411*t1481+t1419*t1484+t1402*(t1527+t1528-Cov[1][6]*t1468-Cov[2][6]*t1472);
     nextCov[2][0] = -t1397*t1538-t1411*t1541+t1419*t1544+t1402*(t1553+t1554-Cov[0][6]*t1491-Cov[2][6]*t1503);
@@ -573,23 +573,15 @@ void SoloGimbalEKF::predictCovariance()
         nextCov[i][i] = nextCov[i][i] + delAngBiasVariance;
     }
 
-    // copy predicted variances whilst constraining to be non-negative
+    // copy elements to covariance matrix whilst enforcing symmetry
+    Cov = (nextCov + transposed(nextCov)) * 0.5f;
+
+    // constrain predicted variances to be non-negative
     for (uint8_t index=0; index<=8; index++) {
-        if (nextCov[index][index] < 0.0f) {
+        if (Cov[index][index] < 0.0f) {
             Cov[index][index] = 0.0f;
-        } else {
-            Cov[index][index] = nextCov[index][index];
         }
     }
-
-    // copy elements to covariance matrix whilst enforcing symmetry
-    for (uint8_t rowIndex=1; rowIndex<=8; rowIndex++) {
-        for (uint8_t colIndex=0; colIndex<=rowIndex-1; colIndex++) {
-            Cov[rowIndex][colIndex] = 0.5f*(nextCov[rowIndex][colIndex] + nextCov[colIndex][rowIndex]);
-            Cov[colIndex][rowIndex] = Cov[rowIndex][colIndex];
-        }
-    }
-
 }
 
 // Fuse the SoloGimbalEKF velocity estimates - this enables alevel reference to be maintained during constant turns
@@ -604,7 +596,7 @@ void SoloGimbalEKF::fuseVelocity()
     float varInnov[3];
     Vector3f angErrVec;
     uint8_t stateIndex;
-    float K[9];
+    VectorN<float,9> K;
     // Fuse measurements sequentially
     for (uint8_t obsIndex=0;obsIndex<=2;obsIndex++) {
         stateIndex = 3 + obsIndex;
@@ -646,12 +638,10 @@ void SoloGimbalEKF::fuseVelocity()
         // re-normalise the quaternion
         state.quat.normalize();
 
-        // Update the covariance
-        for (uint8_t rowIndex=0;rowIndex<=8;rowIndex++) {
-            for (uint8_t colIndex=0;colIndex<=8;colIndex++) {
-                Cov[rowIndex][colIndex] = Cov[rowIndex][colIndex] - K[rowIndex]*Cov[stateIndex][colIndex];
-            }
-        }
+        // Update the covariance using P = P - K*H*P, where H*P is the
+        // observed state's row of P. The row is copied as P is updated in place
+        const VectorN<float,9> HP(Cov[stateIndex]);
+        Cov -= outer_product(K, HP);
 
         // force symmetry and constrain diagonals to be non-negative
         fixCovariance();
@@ -777,7 +767,7 @@ void SoloGimbalEKF::fuseCompass()
         }
         varInnov += H_MAG[rowIndex]*PH[rowIndex];
     }
-    float K_MAG[9];
+    VectorN<float,9> K_MAG;
     float varInnovInv = 1.0f / varInnov;
     for (uint8_t rowIndex=0;rowIndex<=8;rowIndex++) {
         K_MAG[rowIndex] = 0.0f;
@@ -811,18 +801,14 @@ void SoloGimbalEKF::fuseCompass()
     state.quat.normalize();
 
     // correct the covariance using P = P - K*H*P taking advantage of the fact that only the first 3 elements in H are non zero
-    float HP[9];
+    VectorN<float,9> HP;
     for (uint8_t colIndex=0;colIndex<=8;colIndex++) {
         HP[colIndex] = 0.0f;
         for (uint8_t rowIndex=0;rowIndex<=2;rowIndex++) {
             HP[colIndex] += H_MAG[rowIndex]*Cov[rowIndex][colIndex];
         }
     }
-    for (uint8_t rowIndex=0;rowIndex<=8;rowIndex++) {
-        for (uint8_t colIndex=0;colIndex<=8;colIndex++) {
-            Cov[rowIndex][colIndex] -= K_MAG[rowIndex] * HP[colIndex];
-        }
-    }
+    Cov -= outer_product(K_MAG, HP);
 
     // force symmetry and constrain diagonals to be non-negative
     fixCovariance();
@@ -908,12 +894,7 @@ float SoloGimbalEKF::calcMagHeadingInnov()
 void SoloGimbalEKF::fixCovariance()
 {
     // force symmetry
-    for (uint8_t rowIndex=1; rowIndex<=8; rowIndex++) {
-        for (uint8_t colIndex=0; colIndex<=rowIndex-1; colIndex++) {
-            Cov[rowIndex][colIndex] = 0.5f*(Cov[rowIndex][colIndex] + Cov[colIndex][rowIndex]);
-            Cov[colIndex][rowIndex] = Cov[rowIndex][colIndex];
-        }
-    }
+    Cov.force_symmetry();
 
     // constrain diagonals to be non-negative
     for (uint8_t index=1; index<=8; index++) {
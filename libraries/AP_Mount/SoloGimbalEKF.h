@@ -29,6 +29,7 @@
 //#include <AP_NavEKF2/AP_NavEKF2.h>
 
 #include <AP_Math/vectorN.h>
+#include <AP_Math/matrixN.h>
 
 class SoloGimbalEKF
 {
@@ -122,7 +123,7 @@ private:
         float gTheta;
     } gSense;
 
-    float Cov[9][9];                // covariance matrix
+    MatrixN<float,9> Cov;           // covariance matrix
     Matrix3f Tsn;                   // Sensor to NED rotation matrix
     float TiltCorrection;           // Angle correction applied to tilt from last velocity fusion (rad)
     bool newDataMag;                // true when new magnetometer data is waiting to be used
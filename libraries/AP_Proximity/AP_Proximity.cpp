@@ -333,6 +333,17 @@ bool AP_Proximity::get_horizontal_distance(float angle_deg, float &distance) con
     return get_horizontal_distance(primary_instance, angle_deg, distance);
 }
 
+// get distance in meters to the closest object within width_deg centred on angle_deg (0 is forward, clockwise)
+// returns true on success and places distance in distance
+bool AP_Proximity::get_obstacle_distance(float angle_deg, float width_deg, float &distance) const
+{
+    if ((drivers[primary_instance] == nullptr) || (_type[primary_instance] == Proximity_Type_None)) {
+        return false;
+    }
+    // get distance from backend
+    return drivers[primary_instance]->get_obstacle_distance(angle_deg, width_deg, distance);
+}
+
 // get distances in 8 directions. used for sending distances to ground station
 bool AP_Proximity::get_horizontal_distances(Proximity_Distance_Array &prx_dist_array) const
 {
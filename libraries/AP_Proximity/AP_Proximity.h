@@ -87,6 +87,10 @@ public:
     bool get_horizontal_distance(uint8_t instance, float angle_deg, float &distance) const;
     bool get_horizontal_distance(float angle_deg, float &distance) const;
 
+    // get distance in meters to the closest object within width_deg centred on angle_deg (0 is forward, clockwise)
+    // uses the full resolution occupancy grid for scanning sensors. returns true on success and places distance in distance
+    bool get_obstacle_distance(float angle_deg, float width_deg, float &distance) const;
+
     // get distances in PROXIMITY_MAX_DIRECTION directions. used for sending distances to ground station
     bool get_horizontal_distances(Proximity_Distance_Array &prx_dist_array) const;
 
@@ -24,7 +24,8 @@
 */
 AP_Proximity_Backend::AP_Proximity_Backend(AP_Proximity &_frontend, AP_Proximity::Proximity_State &_state) :
         frontend(_frontend),
-        state(_state)
+        state(_state),
+        _grid(nullptr)
 {
     // initialise sector edge vector used for building the boundary fence
     init_boundary();
@@ -43,6 +44,26 @@ bool AP_Proximity_Backend::get_horizontal_distance(float angle_deg, float &dista
     return false;
 }
 
+// get distance in meters to the closest object within width_deg centred on angle_deg (0 is forward, clockwise)
+bool AP_Proximity_Backend::get_obstacle_distance(float angle_deg, float width_deg, float &distance) const
+{
+    if (_grid == nullptr) {
+        // use the closest of the sectors overlapping the arc
+        bool found = false;
+        for (uint8_t i=0; i<_num_sectors; i++) {
+            if (_distance_valid[i] &&
+                fabsf(wrap_180(_sector_middle_deg[i] - angle_deg)) <= (width_deg + _sector_width_deg[i]) * 0.5f &&
+                (!found || _distance[i] < distance)) {
+                distance = _distance[i];
+                found = true;
+            }
+        }
+        return found;
+    }
+    float closest_angle_deg;
+    return _grid->get_closest_in_arc(angle_deg, width_deg, closest_angle_deg, distance, AP_HAL::millis());
+}
+
 // get distance and angle to closest object (used for pre-arm check)
 //   returns true on success, false if no valid readings
 bool AP_Proximity_Backend::get_closest_object(float& angle_deg, float &distance) const
@@ -228,6 +249,51 @@ void AP_Proximity_Backend::update_boundary_for_sector(uint8_t sector)
     }
 }
 
+// allocate an occupancy grid for drivers that return many points per revolution
+bool AP_Proximity_Backend::init_grid(uint16_t timeout_ms)
+{
+    if (_grid == nullptr) {
+        _grid = new AP_Proximity_Grid(PROXIMITY_GRID_HOLD_MS, timeout_ms);
+    }
+    return _grid != nullptr;
+}
+
+// add a return to the occupancy grid, ignoring readings outside the sensor's range or within ignore areas
+void AP_Proximity_Backend::add_grid_point(float angle_deg, float elevation_deg, float distance_m)
+{
+    if (_grid == nullptr || distance_m <= distance_min() || distance_m > distance_max() || ignore_angle(angle_deg)) {
+        return;
+    }
+    _grid->add_point(angle_deg, elevation_deg, distance_m, AP_HAL::millis());
+}
+
+// update sector distances and boundary points from the closest objects in the occupancy grid
+void AP_Proximity_Backend::update_sectors_from_grid()
+{
+    if (_grid == nullptr) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    _grid->expire(now_ms);
+    for (uint8_t sector=0; sector<_num_sectors; sector++) {
+        _distance_valid[sector] = _grid->get_closest_in_arc(_sector_middle_deg[sector], _sector_width_deg[sector], _angle[sector], _distance[sector], now_ms);
+        update_boundary_for_sector(sector);
+    }
+}
+
+// true if angle_deg falls within one of the user defined ignore areas
+bool AP_Proximity_Backend::ignore_angle(float angle_deg) const
+{
+    for (uint8_t i=0; i < PROXIMITY_MAX_IGNORE; i++) {
+        if (frontend._ignore_width_deg[i] != 0) {
+            if (fabsf(wrap_180(angle_deg - frontend._ignore_angle_deg[i])) <= frontend._ignore_width_deg[i] * 0.5f) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 // set status and update valid count
 void AP_Proximity_Backend::set_status(AP_Proximity::Proximity_Status status)
 {
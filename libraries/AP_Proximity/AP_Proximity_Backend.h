@@ -17,6 +17,7 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
 #include "AP_Proximity.h"
+#include "AP_Proximity_Grid.h"
 
 #define PROXIMITY_SECTORS_MAX   12  // maximum number of sectors
 #define PROXIMITY_BOUNDARY_DIST_MIN 0.6f    // minimum distance for a boundary point.  This ensures the object avoidance code doesn't think we are outside the boundary.
@@ -30,7 +31,7 @@ public:
 
     // we declare a virtual destructor so that Proximity drivers can
     // override with a custom destructor if need be
-    virtual ~AP_Proximity_Backend(void) {}
+    virtual ~AP_Proximity_Backend(void) { delete _grid; }
 
     // update the state structure
     virtual void update() = 0;
@@ -49,6 +50,10 @@ public:
     // returns true on successful read and places distance in distance
     bool get_horizontal_distance(float angle_deg, float &distance) const;
 
+    // get distance in meters to the closest object within width_deg centred on angle_deg (0 is forward, clockwise)
+    // uses the occupancy grid if the driver has one, otherwise the sectors overlapping the arc
+    bool get_obstacle_distance(float angle_deg, float width_deg, float &distance) const;
+
     // get boundary points around vehicle for use by avoidance
     //   returns nullptr and sets num_points to zero if no boundary can be returned
     const Vector2f* get_boundary_points(uint16_t& num_points) const;
@@ -81,6 +86,20 @@ protected:
     //   the boundary point is set to the shortest distance found in the two adjacent sectors, this is a conservative boundary around the vehicle
     void update_boundary_for_sector(uint8_t sector);
 
+    // allocate an occupancy grid for drivers that return many points per revolution
+    //   returns false if the grid could not be allocated, in which case the driver should update sectors directly
+    bool init_grid(uint16_t timeout_ms = PROXIMITY_GRID_TIMEOUT_MS);
+
+    // add a return to the occupancy grid, ignoring readings outside the sensor's range or within ignore areas
+    void add_grid_point(float angle_deg, float elevation_deg, float distance_m);
+
+    // update sector distances and boundary points from the closest objects in the occupancy grid
+    //   should be called from the driver's update
+    void update_sectors_from_grid();
+
+    // true if angle_deg falls within one of the user defined ignore areas
+    bool ignore_angle(float angle_deg) const;
+
     // get ignore area info
     uint8_t get_ignore_area_count() const;
     bool get_ignore_area(uint8_t index, uint16_t &angle_deg, uint8_t &width_deg) const;
@@ -102,4 +121,7 @@ protected:
     // fence boundary
     Vector2f _sector_edge_vector[PROXIMITY_SECTORS_MAX];    // vector for right-edge of each sector, used to speed up calculation of boundary
     Vector2f _boundary_point[PROXIMITY_SECTORS_MAX];        // bounding polygon around the vehicle calculated conservatively for object avoidance
+
+    // occupancy grid holding all returns, nullptr for drivers which only provide sector distances
+    AP_Proximity_Grid *_grid;
 };
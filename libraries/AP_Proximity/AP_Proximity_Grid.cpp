@@ -0,0 +1,189 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_Proximity_Grid.h"
+
+AP_Proximity_Grid::AP_Proximity_Grid(uint16_t hold_ms, uint16_t timeout_ms) :
+    _hold_ms(hold_ms),
+    _timeout_ms(timeout_ms)
+{
+    clear();
+}
+
+// add a single return. returns false if the elevation is outside the grid
+bool AP_Proximity_Grid::add_point(float angle_deg, float elevation_deg, float distance_m, uint32_t now_ms)
+{
+    if (!(distance_m > 0.0f) || isinf(distance_m)) {
+        return false;
+    }
+
+    // find layer, the grid is centred on the horizon
+    const float elevation_offset = elevation_deg + PROXIMITY_GRID_LAYERS * PROXIMITY_GRID_LAYER_DEG * 0.5f;
+    if (!(elevation_offset >= 0.0f) || elevation_offset >= PROXIMITY_GRID_LAYERS * PROXIMITY_GRID_LAYER_DEG) {
+        return false;
+    }
+    const uint8_t layer = (uint8_t)(elevation_offset * (1.0f / PROXIMITY_GRID_LAYER_DEG));
+    const uint8_t bin = angle_to_bin(angle_deg);
+    Cell &cell = _cells[layer][bin];
+
+    // within the hold time only closer readings are accepted, so the
+    // cell holds the closest return of the latest sweep past it
+    if (cell_valid(cell, now_ms) && (now_ms - cell.last_ms) < _hold_ms && distance_m >= cell.distance_m) {
+        return true;
+    }
+
+    Block &block = _blocks[bin / PROXIMITY_GRID_BLOCK_BINS];
+    const bool block_ok = block_valid(block, now_ms);
+    const bool block_source = (block.bin == bin) && (block.layer == layer);
+
+    cell.distance_m = distance_m;
+    cell.last_ms = now_ms;
+
+    if (block.distance_m <= 0.0f || (block_ok && distance_m <= block.distance_m)) {
+        // new closest cell in the block
+        block.distance_m = distance_m;
+        block.bin = bin;
+        block.layer = layer;
+    } else if (!block_ok || block_source) {
+        // the closest cell has expired or moved away
+        refresh_block(bin / PROXIMITY_GRID_BLOCK_BINS, now_ms);
+    }
+    return true;
+}
+
+// empty all cells
+void AP_Proximity_Grid::clear()
+{
+    memset(_cells, 0, sizeof(_cells));
+    memset(_blocks, 0, sizeof(_blocks));
+}
+
+// recalculate coarse blocks whose closest cell has expired
+void AP_Proximity_Grid::expire(uint32_t now_ms)
+{
+    for (uint8_t i=0; i<PROXIMITY_GRID_BLOCKS; i++) {
+        if (!block_valid(_blocks[i], now_ms)) {
+            refresh_block(i, now_ms);
+        }
+    }
+}
+
+// get closest distance in all layers of the bin holding angle_deg
+bool AP_Proximity_Grid::get_distance(float angle_deg, float &distance_m, uint32_t now_ms) const
+{
+    uint8_t closest_bin = 0;
+    float closest_dist = 0.0f;
+    closest_in_bin(angle_to_bin(angle_deg), now_ms, closest_bin, closest_dist);
+    if (closest_dist <= 0.0f) {
+        return false;
+    }
+    distance_m = closest_dist;
+    return true;
+}
+
+// get angle and distance to the closest object within width_deg centred on angle_deg
+bool AP_Proximity_Grid::get_closest_in_arc(float angle_deg, float width_deg, float &closest_angle_deg, float &distance_m, uint32_t now_ms) const
+{
+    if (!(width_deg > 0.0f)) {
+        return false;
+    }
+
+    // find range of bins covered by the arc. An arc that leaves a gap
+    // narrower than one bin touches every bin, even though both of its
+    // ends may fall in the same bin
+    uint8_t first_bin = 0;
+    uint8_t num_bins = PROXIMITY_GRID_BINS;
+    if (width_deg < 360.0f - PROXIMITY_GRID_BIN_WIDTH) {
+        first_bin = angle_to_bin(angle_deg - width_deg * 0.5f);
+        const uint8_t last_bin = angle_to_bin(angle_deg + width_deg * 0.5f);
+        num_bins = ((last_bin + PROXIMITY_GRID_BINS - first_bin) % PROXIMITY_GRID_BINS) + 1;
+    }
+
+    uint8_t closest_bin = 0;
+    float closest_dist = 0.0f;
+    uint8_t i = 0;
+    while (i < num_bins) {
+        const uint8_t bin = (first_bin + i) % PROXIMITY_GRID_BINS;
+        if ((bin % PROXIMITY_GRID_BLOCK_BINS == 0) && (num_bins - i >= PROXIMITY_GRID_BLOCK_BINS)) {
+            // the whole block is within the arc, use its closest cell if still current
+            const Block &block = _blocks[bin / PROXIMITY_GRID_BLOCK_BINS];
+            if (block_valid(block, now_ms)) {
+                if (block.distance_m > 0.0f && (closest_dist <= 0.0f || block.distance_m < closest_dist)) {
+                    closest_dist = block.distance_m;
+                    closest_bin = block.bin;
+                }
+                i += PROXIMITY_GRID_BLOCK_BINS;
+                continue;
+            }
+        }
+        closest_in_bin(bin, now_ms, closest_bin, closest_dist);
+        i++;
+    }
+
+    if (closest_dist <= 0.0f) {
+        return false;
+    }
+    closest_angle_deg = bin_to_angle(closest_bin);
+    distance_m = closest_dist;
+    return true;
+}
+
+// convert an angle in degrees to a bin, bin 0 is centred on forward
+uint8_t AP_Proximity_Grid::angle_to_bin(float angle_deg)
+{
+    const float angle = wrap_360(angle_deg + 180.0f / PROXIMITY_GRID_BINS);
+    const uint8_t bin = (uint8_t)(angle * (PROXIMITY_GRID_BINS / 360.0f));
+    return (bin < PROXIMITY_GRID_BINS) ? bin : 0;
+}
+
+// true if the block is known to be empty or its closest cell is still the one recorded
+bool AP_Proximity_Grid::block_valid(const Block &block, uint32_t now_ms) const
+{
+    if (block.distance_m <= 0.0f) {
+        return true;
+    }
+    const Cell &cell = _cells[block.layer][block.bin];
+    return cell_valid(cell, now_ms) && is_equal(cell.distance_m, block.distance_m);
+}
+
+// recalculate a block from its cells
+void AP_Proximity_Grid::refresh_block(uint8_t block, uint32_t now_ms)
+{
+    Block &b = _blocks[block];
+    b.distance_m = 0.0f;
+    const uint8_t first_bin = block * PROXIMITY_GRID_BLOCK_BINS;
+    for (uint8_t bin=first_bin; bin<first_bin+PROXIMITY_GRID_BLOCK_BINS; bin++) {
+        for (uint8_t layer=0; layer<PROXIMITY_GRID_LAYERS; layer++) {
+            const Cell &cell = _cells[layer][bin];
+            if (cell_valid(cell, now_ms) && (b.distance_m <= 0.0f || cell.distance_m < b.distance_m)) {
+                b.distance_m = cell.distance_m;
+                b.bin = bin;
+                b.layer = layer;
+            }
+        }
+    }
+}
+
+// check one bin against the closest distance found so far
+void AP_Proximity_Grid::closest_in_bin(uint8_t bin, uint32_t now_ms, uint8_t &closest_bin, float &closest_dist) const
+{
+    for (uint8_t layer=0; layer<PROXIMITY_GRID_LAYERS; layer++) {
+        const Cell &cell = _cells[layer][bin];
+        if (cell_valid(cell, now_ms) && (closest_dist <= 0.0f || cell.distance_m < closest_dist)) {
+            closest_dist = cell.distance_m;
+            closest_bin = bin;
+        }
+    }
+}
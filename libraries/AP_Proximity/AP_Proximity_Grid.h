@@ -0,0 +1,102 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+#define PROXIMITY_GRID_BINS         72  // number of azimuth bins, giving 5 degrees per bin
+#define PROXIMITY_GRID_BIN_WIDTH    (360.0f / PROXIMITY_GRID_BINS)
+#define PROXIMITY_GRID_LAYERS       3   // number of elevation layers
+#define PROXIMITY_GRID_LAYER_DEG    30  // height (in degrees) of each elevation layer, the middle layer is centred on the horizon
+#define PROXIMITY_GRID_BLOCK_BINS   9   // number of azimuth bins summarised by each coarse block
+#define PROXIMITY_GRID_BLOCKS       (PROXIMITY_GRID_BINS / PROXIMITY_GRID_BLOCK_BINS)
+#define PROXIMITY_GRID_HOLD_MS      50  // closer readings within a cell are held for this long before farther readings replace them
+#define PROXIMITY_GRID_TIMEOUT_MS   500 // cells not updated for this long are considered empty
+
+static_assert(PROXIMITY_GRID_BINS % PROXIMITY_GRID_BLOCK_BINS == 0, "PROXIMITY_GRID_BLOCK_BINS must divide PROXIMITY_GRID_BINS");
+
+/*
+  polar occupancy grid holding the closest return in each azimuth bin
+  and elevation layer around the vehicle. Each coarse block keeps the
+  closest cell of its bins so that queries covering whole blocks do not
+  need to look at individual cells. Memory use is fixed and cells decay
+  once they have not been updated for the timeout.
+
+  Angles are in degrees, with azimuth 0 forward increasing clockwise and
+  elevation positive upwards. Times are passed in so the grid has no
+  dependency on the HAL.
+ */
+class AP_Proximity_Grid
+{
+public:
+    AP_Proximity_Grid(uint16_t hold_ms = PROXIMITY_GRID_HOLD_MS, uint16_t timeout_ms = PROXIMITY_GRID_TIMEOUT_MS);
+
+    // add a single return. returns false if the elevation is outside the grid
+    bool add_point(float angle_deg, float elevation_deg, float distance_m, uint32_t now_ms);
+
+    // empty all cells
+    void clear();
+
+    // recalculate coarse blocks whose closest cell has expired. Should
+    // be called regularly so that queries can keep using the blocks
+    void expire(uint32_t now_ms);
+
+    // get closest distance in all layers of the bin holding angle_deg
+    // returns true on success and places distance in distance_m
+    bool get_distance(float angle_deg, float &distance_m, uint32_t now_ms) const;
+
+    // get angle and distance to the closest object within width_deg
+    // centred on angle_deg. returns true if any cell in the arc is occupied
+    bool get_closest_in_arc(float angle_deg, float width_deg, float &closest_angle_deg, float &distance_m, uint32_t now_ms) const;
+
+    // get angle and distance to the closest object in the grid
+    bool get_closest(float &angle_deg, float &distance_m, uint32_t now_ms) const {
+        return get_closest_in_arc(180.0f, 360.0f, angle_deg, distance_m, now_ms);
+    }
+
+    // convert between angles and bins. bin 0 is centred on forward
+    static uint8_t angle_to_bin(float angle_deg);
+    static float bin_to_angle(uint8_t bin) { return bin * PROXIMITY_GRID_BIN_WIDTH; }
+
+private:
+    struct Cell {
+        float distance_m;   // closest distance in the cell, zero if empty
+        uint32_t last_ms;   // system time the cell was last set
+    };
+
+    struct Block {
+        float distance_m;   // distance of the closest cell in the block, zero if empty
+        uint8_t bin;        // bin and layer of the closest cell
+        uint8_t layer;
+    };
+
+    bool cell_valid(const Cell &cell, uint32_t now_ms) const {
+        return cell.distance_m > 0.0f && (now_ms - cell.last_ms) <= _timeout_ms;
+    }
+
+    // true if the block's closest cell is still the one recorded
+    bool block_valid(const Block &block, uint32_t now_ms) const;
+
+    // recalculate a block from its cells
+    void refresh_block(uint8_t block, uint32_t now_ms);
+
+    // check one bin against the closest distance found so far
+    void closest_in_bin(uint8_t bin, uint32_t now_ms, uint8_t &closest_bin, float &closest_dist) const;
+
+    Cell _cells[PROXIMITY_GRID_LAYERS][PROXIMITY_GRID_BINS];
+    Block _blocks[PROXIMITY_GRID_BLOCKS];
+    const uint16_t _hold_ms;
+    const uint16_t _timeout_ms;
+};
@@ -81,6 +81,9 @@ AP_Proximity_RPLidarA2::AP_Proximity_RPLidarA2(AP_Proximity &_frontend,
     _cnt = 0 ;
     _sync_error = 0 ;
     _byte_count = 0;
+
+    // keep every return in an occupancy grid, sectors are filled from it
+    init_grid();
 }
 
 // detect if a RPLidarA2 proximity sensor is connected by looking for a configured serial port
@@ -104,6 +107,7 @@ void AP_Proximity_RPLidarA2::update(void)
     // if LIDAR in known state
     if (_initialised) {
         get_readings();
+        update_sectors_from_grid();
     }
 
     // check for timeout and set health status
@@ -402,7 +406,9 @@ void AP_Proximity_RPLidarA2::parse_response_data()
 #endif
                 _last_distance_received_ms = AP_HAL::millis();
                 uint8_t sector;
-                if (convert_angle_to_sector(angle_deg, sector)) {
+                if (_grid != nullptr) {
+                    add_grid_point(angle_deg, 0.0f, distance_m);
+                } else if (convert_angle_to_sector(angle_deg, sector)) {
                     if (distance_m > distance_min()) {
                         if (_last_sector == sector) {
                             if (_distance_m_last > distance_m) {
@@ -24,6 +24,7 @@ extern const AP_HAL::HAL& hal;
 
 #define PROXIMITY_MAX_RANGE 200.0f
 #define PROXIMITY_ACCURACY 0.1f
+#define PROXIMITY_SITL_BINS_PER_UPDATE 8    // grid bins scanned per update, a full revolution takes 9 updates
 
 /* 
    The constructor also initialises the proximity sensor. 
@@ -42,6 +43,7 @@ AP_Proximity_SITL::AP_Proximity_SITL(AP_Proximity &_frontend,
     if (fence_alt_max == nullptr || ptype != AP_PARAM_FLOAT) {
         AP_HAL::panic("Proximity_SITL: Failed to find FENCE_ALT_MAX");
     }
+    init_grid();
 }
 
 // update the state of the sensor
@@ -52,6 +54,23 @@ void AP_Proximity_SITL::update(void)
     current_loc.lng = sitl->state.longitude * 1.0e7;
     current_loc.alt = sitl->state.altitude * 1.0e2;
     if (fence && fence_loader.boundary_valid(fence_count->get(), fence, true)) {
+        if (_grid != nullptr) {
+            // scan the next few grid bins like a rotating lidar
+            for (uint8_t i=0; i<PROXIMITY_SITL_BINS_PER_UPDATE; i++) {
+                const float angle_deg = AP_Proximity_Grid::bin_to_angle(last_bin);
+                float distance;
+                if (get_distance_to_fence(angle_deg, distance)) {
+                    add_grid_point(angle_deg, 0.0f, distance);
+                }
+                last_bin++;
+                if (last_bin >= PROXIMITY_GRID_BINS) {
+                    last_bin = 0;
+                }
+            }
+            update_sectors_from_grid();
+            set_status(AP_Proximity::Proximity_Good);
+            return;
+        }
         // update distance in one sector
         if (get_distance_to_fence(_sector_middle_deg[last_sector], _distance[last_sector])) {
             set_status(AP_Proximity::Proximity_Good);
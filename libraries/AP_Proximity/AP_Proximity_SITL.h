@@ -35,6 +35,9 @@ private:
     // latest sector updated
     uint8_t last_sector;
 
+    // next grid bin to scan
+    uint8_t last_bin;
+
     void load_fence(void);
 
     // get distance in meters to fence in a particular direction in degrees (0 is forward, angles increase in the clockwise direction)
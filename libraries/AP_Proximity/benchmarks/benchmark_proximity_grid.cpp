@@ -0,0 +1,69 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Proximity/AP_Proximity_Grid.h>
+
+/*
+  synthetic 8000 point per second scan from a lidar rotating at 10Hz,
+  i.e. a point every 125us and 800 points per revolution
+ */
+#define SCAN_POINTS_PER_REV 800
+#define SCAN_POINT_US       125
+
+static float scan_distance(uint16_t point)
+{
+    // a wall with a post standing in front of it
+    const float angle = point * (360.0f / SCAN_POINTS_PER_REV);
+    return (angle > 40.0f && angle < 44.0f) ? 2.5f : 6.0f + 0.01f * (point % 50);
+}
+
+static void BM_ProximityGridAddPoint(benchmark::State& state)
+{
+    AP_Proximity_Grid grid;
+    uint32_t t_us = 0;
+    uint16_t point = 0;
+    while (state.KeepRunning()) {
+        grid.add_point(point * (360.0f / SCAN_POINTS_PER_REV), 0.0f, scan_distance(point), t_us / 1000);
+        t_us += SCAN_POINT_US;
+        point = (point + 1) % SCAN_POINTS_PER_REV;
+    }
+    gbenchmark_escape(&grid);
+}
+
+// the per-update work of a backend: expire blocks and refresh 12 sectors
+static void BM_ProximityGridSectors(benchmark::State& state)
+{
+    AP_Proximity_Grid grid;
+    uint32_t t_us = 0;
+    for (uint16_t point=0; point<SCAN_POINTS_PER_REV; point++) {
+        grid.add_point(point * (360.0f / SCAN_POINTS_PER_REV), 0.0f, scan_distance(point), t_us / 1000);
+        t_us += SCAN_POINT_US;
+    }
+    const uint32_t now_ms = t_us / 1000;
+    while (state.KeepRunning()) {
+        grid.expire(now_ms);
+        for (uint8_t sector=0; sector<12; sector++) {
+            float angle, distance;
+            grid.get_closest_in_arc(sector * 30.0f, 30.0f, angle, distance, now_ms);
+            gbenchmark_escape(&distance);
+        }
+    }
+}
+
+static void BM_ProximityGridClosest(benchmark::State& state)
+{
+    AP_Proximity_Grid grid;
+    for (uint16_t point=0; point<SCAN_POINTS_PER_REV; point++) {
+        grid.add_point(point * (360.0f / SCAN_POINTS_PER_REV), 0.0f, scan_distance(point), 0);
+    }
+    while (state.KeepRunning()) {
+        float angle, distance;
+        grid.get_closest(angle, distance, 0);
+        gbenchmark_escape(&distance);
+    }
+}
+
+BENCHMARK(BM_ProximityGridAddPoint);
+BENCHMARK(BM_ProximityGridSectors);
+BENCHMARK(BM_ProximityGridClosest);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,147 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Proximity/AP_Proximity_Grid.h>
+
+TEST(ProximityGridTest, angle_to_bin)
+{
+    EXPECT_EQ(0, AP_Proximity_Grid::angle_to_bin(0.0f));
+    EXPECT_EQ(0, AP_Proximity_Grid::angle_to_bin(2.4f));
+    EXPECT_EQ(1, AP_Proximity_Grid::angle_to_bin(2.6f));
+    EXPECT_EQ(0, AP_Proximity_Grid::angle_to_bin(-2.4f));
+    EXPECT_EQ(0, AP_Proximity_Grid::angle_to_bin(360.0f));
+    EXPECT_EQ(PROXIMITY_GRID_BINS - 1, AP_Proximity_Grid::angle_to_bin(-5.0f));
+    EXPECT_EQ(PROXIMITY_GRID_BINS / 2, AP_Proximity_Grid::angle_to_bin(180.0f));
+    EXPECT_FLOAT_EQ(90.0f, AP_Proximity_Grid::bin_to_angle(AP_Proximity_Grid::angle_to_bin(90.0f)));
+}
+
+TEST(ProximityGridTest, layers)
+{
+    AP_Proximity_Grid grid;
+    float distance;
+
+    // outside the grid vertically
+    EXPECT_FALSE(grid.add_point(0.0f, 60.0f, 3.0f, 10));
+    EXPECT_FALSE(grid.add_point(0.0f, -45.0f - 0.1f, 3.0f, 10));
+    EXPECT_FALSE(grid.get_distance(0.0f, distance, 10));
+
+    // each layer counts towards the distance in a direction
+    EXPECT_TRUE(grid.add_point(0.0f, 30.0f, 5.0f, 10));
+    EXPECT_TRUE(grid.add_point(0.0f, 0.0f, 7.0f, 10));
+    EXPECT_TRUE(grid.get_distance(0.0f, distance, 10));
+    EXPECT_FLOAT_EQ(5.0f, distance);
+    EXPECT_TRUE(grid.add_point(0.0f, -30.0f, 4.0f, 10));
+    EXPECT_TRUE(grid.get_distance(0.0f, distance, 10));
+    EXPECT_FLOAT_EQ(4.0f, distance);
+}
+
+TEST(ProximityGridTest, hold_and_timeout)
+{
+    AP_Proximity_Grid grid(50, 500);
+    float angle, distance;
+
+    grid.add_point(90.0f, 0.0f, 10.0f, 1000);
+
+    // within the hold time only closer readings are kept
+    grid.add_point(91.0f, 0.0f, 12.0f, 1010);
+    EXPECT_TRUE(grid.get_distance(90.0f, distance, 1010));
+    EXPECT_FLOAT_EQ(10.0f, distance);
+    grid.add_point(89.0f, 0.0f, 8.0f, 1020);
+    EXPECT_TRUE(grid.get_distance(90.0f, distance, 1020));
+    EXPECT_FLOAT_EQ(8.0f, distance);
+
+    // after the hold time a farther reading replaces the cell
+    grid.add_point(90.0f, 0.0f, 15.0f, 1100);
+    EXPECT_TRUE(grid.get_closest(angle, distance, 1100));
+    EXPECT_FLOAT_EQ(90.0f, angle);
+    EXPECT_FLOAT_EQ(15.0f, distance);
+
+    // a second, farther object
+    grid.add_point(100.0f, 0.0f, 20.0f, 1500);
+
+    // the closer cell decays, and the block falls back to the farther one
+    EXPECT_TRUE(grid.get_closest(angle, distance, 1600));
+    EXPECT_FLOAT_EQ(15.0f, distance);
+    EXPECT_TRUE(grid.get_closest(angle, distance, 1601));
+    EXPECT_FLOAT_EQ(100.0f, angle);
+    EXPECT_FLOAT_EQ(20.0f, distance);
+    grid.expire(1601);
+    EXPECT_TRUE(grid.get_closest(angle, distance, 1601));
+    EXPECT_FLOAT_EQ(20.0f, distance);
+    EXPECT_FALSE(grid.get_closest(angle, distance, 2001));
+
+    grid.add_point(0.0f, 0.0f, 1.0f, 2100);
+    grid.clear();
+    EXPECT_FALSE(grid.get_closest(angle, distance, 2100));
+}
+
+// closest distance of any bin touched by an arc, found by stepping through its angles
+static bool closest_by_angle(const AP_Proximity_Grid &grid, float centre, float width, float &closest, uint32_t now_ms)
+{
+    const float start = centre - width * 0.5f;
+    const float end = centre + width * 0.5f;
+    bool touched[PROXIMITY_GRID_BINS] {};
+    for (float a=start; a<end; a+=0.1f) {
+        touched[AP_Proximity_Grid::angle_to_bin(a)] = true;
+    }
+    touched[AP_Proximity_Grid::angle_to_bin(end)] = true;
+
+    bool found = false;
+    for (uint8_t b=0; b<PROXIMITY_GRID_BINS; b++) {
+        float d;
+        if (touched[b] && grid.get_distance(AP_Proximity_Grid::bin_to_angle(b), d, now_ms) &&
+            (!found || d < closest)) {
+            closest = d;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// an arc leaving a gap narrower than one bin still covers every bin
+TEST(ProximityGridTest, arc_nearly_full_circle)
+{
+    AP_Proximity_Grid grid;
+    float angle, distance;
+
+    grid.add_point(90.0f, 0.0f, 3.0f, 10);
+    for (float width = 355.0f; width <= 360.0f; width += 0.5f) {
+        EXPECT_TRUE(grid.get_closest_in_arc(0.0f, width, angle, distance, 10));
+        EXPECT_FLOAT_EQ(3.0f, distance);
+        EXPECT_FLOAT_EQ(90.0f, angle);
+    }
+}
+
+// queries using the coarse blocks must match a search of every angle in the arc
+TEST(ProximityGridTest, arc_matches_angles)
+{
+    AP_Proximity_Grid grid;
+    uint32_t now_ms = 1;
+    srand(0);
+
+    for (uint16_t i=0; i<5000; i++) {
+        now_ms += rand() % 5;
+        grid.add_point(rand() % 3600 * 0.1f, (rand() % 90) - 45.0f, 0.2f + (rand() % 1000) * 0.02f, now_ms);
+        if (i % 7 == 0) {
+            grid.expire(now_ms);
+        }
+
+        const float centre = rand() % 3600 * 0.1f - 180.0f;
+        // bias towards nearly full circles
+        const float width = (i % 4 == 0) ? 350.0f + rand() % 100 * 0.1f : 0.1f + rand() % 3600 * 0.1f;
+        float angle = 0.0f, distance = 0.0f;
+        const bool found = grid.get_closest_in_arc(centre, width, angle, distance, now_ms);
+
+        float expected = 0.0f;
+        const bool expected_found = closest_by_angle(grid, centre, width, expected, now_ms);
+        ASSERT_EQ(expected_found, found) << "centre " << centre << " width " << width;
+        if (found) {
+            ASSERT_FLOAT_EQ(expected, distance);
+            float at_angle;
+            ASSERT_TRUE(grid.get_distance(angle, at_angle, now_ms));
+            ASSERT_FLOAT_EQ(expected, at_angle);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
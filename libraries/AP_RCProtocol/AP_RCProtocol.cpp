@@ -27,15 +27,24 @@ void AP_RCProtocol::init()
     backend[AP_RCProtocol::DSM] = new AP_RCProtocol_DSM(*this);
 }
 
+bool AP_RCProtocol::locked(uint32_t now_ms) const
+{
+    return _detected_protocol != AP_RCProtocol::NONE && now_ms - _last_input_ms < 200;
+}
+
 void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
 {
     uint32_t now = AP_HAL::millis();
     // first try current protocol
-    if (_detected_protocol != AP_RCProtocol::NONE && now - _last_input_ms < 200) {
+    if (locked(now)) {
+        if (_detected_with_bytes) {
+            // input comes from a UART, ignore the pulse input
+            return;
+        }
         backend[_detected_protocol]->process_pulse(width_s0, width_s1);
         if (backend[_detected_protocol]->new_input()) {
             _new_input = true;
-            _last_input_ms = AP_HAL::millis();
+            _last_input_ms = now;
         }
         return;
     }
@@ -47,7 +56,39 @@ void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
             if (backend[i]->new_input()) {
                 _new_input = true;
                 _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
-                _last_input_ms = AP_HAL::millis();
+                _detected_with_bytes = false;
+                _last_input_ms = now;
+            }
+        }
+    }
+}
+
+void AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate, uint32_t timestamp_us)
+{
+    uint32_t now = AP_HAL::millis();
+    // first try current protocol
+    if (locked(now)) {
+        if (!_detected_with_bytes) {
+            // input comes from pulses, ignore the UART input
+            return;
+        }
+        backend[_detected_protocol]->process_byte(byte, baudrate, timestamp_us);
+        if (backend[_detected_protocol]->new_input()) {
+            _new_input = true;
+            _last_input_ms = now;
+        }
+        return;
+    }
+
+    // otherwise scan all protocols
+    for (uint8_t i = 0; i < AP_RCProtocol::NONE; i++) {
+        if (backend[i] != nullptr) {
+            backend[i]->process_byte(byte, baudrate, timestamp_us);
+            if (backend[i]->new_input()) {
+                _new_input = true;
+                _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
+                _detected_with_bytes = true;
+                _last_input_ms = now;
             }
         }
     }
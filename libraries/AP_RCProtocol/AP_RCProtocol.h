@@ -32,12 +32,19 @@ public:
     };
     void init();
     void process_pulse(uint32_t width_s0, uint32_t width_s1);
+    // process a byte from a UART, timestamp_us is when it was received
+    void process_byte(uint8_t byte, uint32_t baudrate, uint32_t timestamp_us);
     enum rcprotocol_t protocol_detected() { return _detected_protocol; }
     uint8_t num_channels();
     uint16_t read(uint8_t chan);
     bool new_input();
 private:
+    // true if the protocol has input within the last 200ms. Once locked
+    // only the detected backend is given input
+    bool locked(uint32_t now_ms) const;
+
     enum rcprotocol_t _detected_protocol = NONE;
+    bool _detected_with_bytes = false;
     AP_RCProtocol_Backend *backend[NONE];
     uint8_t num_backends = NONE;
     bool _new_input = false;
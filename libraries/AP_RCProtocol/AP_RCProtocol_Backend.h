@@ -26,6 +26,10 @@ class AP_RCProtocol_Backend
 public:
     AP_RCProtocol_Backend(AP_RCProtocol &_frontend);
     virtual void process_pulse(uint32_t width_s0, uint32_t width_s1) = 0;
+    // process a byte received from a UART at the given baudrate at
+    // timestamp_us. Only needed by protocols that can be read from a
+    // serial port
+    virtual void process_byte(uint8_t byte, uint32_t baudrate, uint32_t timestamp_us) {}
     uint16_t read(uint8_t chan);
     bool new_input();
     uint8_t num_channels();
@@ -32,6 +32,33 @@ extern const AP_HAL::HAL& hal;
 #define DSM_FRAME_SIZE		16		/**<DSM frame size in bytes*/
 #define DSM_FRAME_CHANNELS	7		/**<Max supported DSM channels*/
 
+/*
+  decode a complete DSM frame, from either pulses or bytes. frame_time
+  is when the frame was received
+ */
+void AP_RCProtocol_DSM::process_frame(const uint8_t frame[16], uint32_t frame_time)
+{
+    uint16_t values[8];
+    uint16_t num_values=0;
+    if (dsm_decode(frame_time, frame, values, &num_values, 8) &&
+        num_values >= MIN_RCIN_CHANNELS) {
+        add_input(num_values, values, false);
+    }
+}
+
+/*
+  process a DSM byte from a UART
+ */
+void AP_RCProtocol_DSM::process_byte(uint8_t byte, uint32_t baudrate, uint32_t timestamp_us)
+{
+    if (baudrate != 115200) {
+        return;
+    }
+    if (byte_parser.add_byte(byte, timestamp_us)) {
+        process_frame(byte_parser.frame(), timestamp_us);
+    }
+}
+
 void AP_RCProtocol_DSM::process_pulse(uint32_t width_s0, uint32_t width_s1)
 {
     // convert to bit widths, allowing for up to 1usec error, assuming 115200 bps
@@ -81,12 +108,7 @@ void AP_RCProtocol_DSM::process_pulse(uint32_t width_s0, uint32_t width_s1)
                 }
                 bytes[i] = ((v>>1) & 0xFF);
             }
-            uint16_t values[8];
-            uint16_t num_values=0;
-            if (dsm_decode(AP_HAL::micros64(), bytes, values, &num_values, 8) &&
-                num_values >= MIN_RCIN_CHANNELS) {
-                add_input(num_values, values, false);
-            }
+            process_frame(bytes, AP_HAL::micros());
         }
         memset(&dsm_state, 0, sizeof(dsm_state));
     }
@@ -241,7 +263,7 @@ void AP_RCProtocol_DSM::dsm_guess_format(bool reset, const uint8_t dsm_frame[16]
  * Decode the entire dsm frame (all contained channels)
  *
  */
-bool AP_RCProtocol_DSM::dsm_decode(uint64_t frame_time, const uint8_t dsm_frame[16], 
+bool AP_RCProtocol_DSM::dsm_decode(uint32_t frame_time, const uint8_t dsm_frame[16], 
                                    uint16_t *values, uint16_t *num_values, uint16_t max_values)
 {
 #if 0
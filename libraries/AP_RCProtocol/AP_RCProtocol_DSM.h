@@ -18,23 +18,29 @@
 #pragma once
 
 #include "AP_RCProtocol.h"
+#include "AP_RCProtocol_FrameParser.h"
 
 class AP_RCProtocol_DSM : public AP_RCProtocol_Backend {
 public:
     AP_RCProtocol_DSM(AP_RCProtocol &_frontend) : AP_RCProtocol_Backend(_frontend) {}
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
+    void process_byte(uint8_t byte, uint32_t baudrate, uint32_t timestamp_us) override;
 private:
+    void process_frame(const uint8_t frame[16], uint32_t frame_time);
     void dsm_decode();
     bool dsm_decode_channel(uint16_t raw, unsigned shift, unsigned *channel, unsigned *value);
     void dsm_guess_format(bool reset, const uint8_t dsm_frame[16]);
-    bool dsm_decode(uint64_t frame_time, const uint8_t dsm_frame[16], 
+    bool dsm_decode(uint32_t frame_time, const uint8_t dsm_frame[16], 
                     uint16_t *values, uint16_t *num_values, uint16_t max_values);
 
-    uint64_t dsm_last_frame_time;		/**< Timestamp for start of last dsm frame */
-    unsigned dsm_channel_shift;			/**< Channel resolution, 0=unknown, 10=10 bit, 11=11 bit */
+    uint32_t dsm_last_frame_time = 0;	/**< Timestamp for start of last dsm frame */
+    unsigned dsm_channel_shift = 0;		/**< Channel resolution, 0=unknown, 10=10 bit, 11=11 bit */
     // state of DSM decoder
     struct {
         uint16_t bytes[16]; // including start bit and stop bit
         uint16_t bit_ofs;
     } dsm_state;
-};
\ No newline at end of file
+
+    // frames take 1.4ms and are sent at least every 11ms
+    AP_RCProtocol_FrameParser byte_parser{16, 5000};
+};
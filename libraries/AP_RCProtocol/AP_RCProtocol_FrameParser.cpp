@@ -0,0 +1,42 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_RCProtocol_FrameParser.h"
+
+AP_RCProtocol_FrameParser::AP_RCProtocol_FrameParser(uint8_t frame_size, uint32_t frame_gap_us) :
+    _frame_size(frame_size < AP_RCPROTOCOL_MAX_FRAME_SIZE ? frame_size : AP_RCPROTOCOL_MAX_FRAME_SIZE),
+    _ofs(0),
+    _frame_gap_us(frame_gap_us),
+    _last_byte_us(0)
+{
+}
+
+bool AP_RCProtocol_FrameParser::add_byte(uint8_t b, uint32_t timestamp_us)
+{
+    if (timestamp_us - _last_byte_us > _frame_gap_us) {
+        // a long gap means this is the first byte of a frame
+        _ofs = 0;
+    }
+    _last_byte_us = timestamp_us;
+
+    if (_ofs >= _frame_size) {
+        // more bytes than a frame without a gap, wait for the next gap
+        return false;
+    }
+
+    _frame[_ofs++] = b;
+
+    return _ofs == _frame_size;
+}
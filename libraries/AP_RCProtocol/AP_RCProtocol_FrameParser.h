@@ -0,0 +1,48 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define AP_RCPROTOCOL_MAX_FRAME_SIZE 25
+
+/*
+  Common framing for byte oriented RC protocols that have fixed size
+  frames and no explicit frame delimiter (SBUS, DSM). A gap of more than
+  frame_gap_us between two bytes marks the start of a new frame.
+ */
+class AP_RCProtocol_FrameParser {
+public:
+    AP_RCProtocol_FrameParser(uint8_t frame_size, uint32_t frame_gap_us);
+
+    /*
+      add a byte received at timestamp_us. Returns true when it
+      completes a frame, which is then available from frame() until the
+      next call
+     */
+    bool add_byte(uint8_t b, uint32_t timestamp_us);
+
+    const uint8_t *frame() const { return _frame; }
+
+    void reset() { _ofs = 0; }
+
+private:
+    uint8_t _frame[AP_RCPROTOCOL_MAX_FRAME_SIZE];
+    const uint8_t _frame_size;
+    uint8_t _ofs;
+    const uint32_t _frame_gap_us;
+    uint32_t _last_byte_us;
+};
@@ -199,6 +199,22 @@ bool AP_RCProtocol_SBUS::sbus_decode(const uint8_t frame[25], uint16_t *values,
 }
 
 
+/*
+  decode a complete SBUS frame, from either pulses or bytes
+ */
+void AP_RCProtocol_SBUS::process_frame(const uint8_t frame[25])
+{
+    uint16_t values[MAX_RCIN_CHANNELS];
+    uint16_t num_values=0;
+    bool sbus_failsafe=false, sbus_frame_drop=false;
+    if (sbus_decode(frame, values, &num_values,
+                    &sbus_failsafe, &sbus_frame_drop,
+                    MAX_RCIN_CHANNELS) &&
+        num_values >= MIN_RCIN_CHANNELS) {
+        add_input(num_values, values, sbus_failsafe);
+    }
+}
+
 /*
   process a SBUS input pulse of the given width
  */
@@ -260,15 +276,7 @@ void AP_RCProtocol_SBUS::process_pulse(uint32_t width_s0, uint32_t width_s1)
             }
             bytes[i] = ((v>>1) & 0xFF);
         }
-        uint16_t values[MAX_RCIN_CHANNELS];
-        uint16_t num_values=0;
-        bool sbus_failsafe=false, sbus_frame_drop=false;
-        if (sbus_decode(bytes, values, &num_values,
-                        &sbus_failsafe, &sbus_frame_drop,
-                        MAX_RCIN_CHANNELS) &&
-            num_values >= MIN_RCIN_CHANNELS) {
-            add_input(num_values, values, sbus_failsafe);
-        }
+        process_frame(bytes);
         goto reset;
     } else if (bits_s1 > 12) {
         // break
@@ -278,3 +286,16 @@ void AP_RCProtocol_SBUS::process_pulse(uint32_t width_s0, uint32_t width_s1)
 reset:
     memset(&sbus_state, 0, sizeof(sbus_state));
 }
+
+/*
+  process a SBUS byte from a UART
+ */
+void AP_RCProtocol_SBUS::process_byte(uint8_t byte, uint32_t baudrate, uint32_t timestamp_us)
+{
+    if (baudrate != 100000) {
+        return;
+    }
+    if (byte_parser.add_byte(byte, timestamp_us)) {
+        process_frame(byte_parser.frame());
+    }
+}
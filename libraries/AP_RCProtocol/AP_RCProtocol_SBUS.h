@@ -18,16 +18,22 @@
 #pragma once
 
 #include "AP_RCProtocol.h"
+#include "AP_RCProtocol_FrameParser.h"
 
 class AP_RCProtocol_SBUS : public AP_RCProtocol_Backend {
 public:
     AP_RCProtocol_SBUS(AP_RCProtocol &_frontend) : AP_RCProtocol_Backend(_frontend) {}
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
+    void process_byte(uint8_t byte, uint32_t baudrate, uint32_t timestamp_us) override;
 private:
+    void process_frame(const uint8_t frame[25]);
     bool sbus_decode(const uint8_t frame[25], uint16_t *values, uint16_t *num_values,
                     bool *sbus_failsafe, bool *sbus_frame_drop, uint16_t max_values);
     struct {
         uint16_t bytes[25]; // including start bit, parity and stop bits
         uint16_t bit_ofs;
     } sbus_state;
-};
\ No newline at end of file
+
+    // frames are 3ms long and sent at least every 14ms
+    AP_RCProtocol_FrameParser byte_parser{25, 2000};
+};
@@ -0,0 +1,77 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <AP_RCProtocol/tests/rcprotocol_trace.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  cost of decoding one frame of pulses, with every backend scanning the
+  input until the protocol is detected and locked
+ */
+static void BM_RCProtocolDecode(benchmark::State &state, const RCPulseTrace &trace)
+{
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    while (state.KeepRunning()) {
+        for (const RCPulse &p : trace.pulses) {
+            rcprot.process_pulse(p.width_s0, p.width_s1);
+        }
+        gbenchmark_escape(&rcprot);
+    }
+}
+
+static RCPulseTrace ppm_trace()
+{
+    const uint16_t widths[8] = { 1100, 1200, 1300, 1400, 1500, 1600, 1700, 1800 };
+    RCPulseTrace trace;
+    trace.add_ppm_frame(widths, 8);
+    return trace;
+}
+
+static RCPulseTrace sbus_trace()
+{
+    uint16_t raw[16];
+    uint8_t frame[25];
+    for (uint8_t i = 0; i < 16; i++) {
+        raw[i] = 300 + 100 * i;
+    }
+    sbus_encode(raw, frame);
+    RCPulseTrace trace;
+    trace.add_sbus_frame(frame, 3000);
+    return trace;
+}
+
+static RCPulseTrace dsm_trace()
+{
+    uint16_t raw[7];
+    uint8_t frame[16];
+    for (uint8_t i = 0; i < 7; i++) {
+        raw[i] = 1100 + 100 * i;
+    }
+    dsm_encode(raw, frame);
+    RCPulseTrace trace;
+    trace.add_dsm_frame(frame, 5000);
+    return trace;
+}
+
+BENCHMARK_CAPTURE(BM_RCProtocolDecode, ppm, ppm_trace());
+BENCHMARK_CAPTURE(BM_RCProtocolDecode, sbus, sbus_trace());
+BENCHMARK_CAPTURE(BM_RCProtocolDecode, dsm, dsm_trace());
+
+BENCHMARK_MAIN()
@@ -0,0 +1,158 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Generate RC input pulse traces, in the form a timer capture on the RC
+ * input pin delivers them to AP_RCProtocol::process_pulse(): the width of
+ * each high period followed by the width of the following low period.
+ * Used to replay the same input through the unit tests and benchmarks.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include <AP_Math/AP_Math.h>
+
+struct RCPulse {
+    uint32_t width_s0;
+    uint32_t width_s1;
+};
+
+class RCPulseTrace {
+public:
+    /*
+      append a PPM-sum frame with the given channel widths in usec
+     */
+    void add_ppm_frame(const uint16_t *widths, uint8_t n)
+    {
+        for (uint8_t i = 0; i < n; i++) {
+            pulses.push_back({400, (uint32_t)widths[i] - 400U});
+        }
+        // sync pulse
+        pulses.push_back({400, 5000});
+    }
+
+    /*
+      append an SBUS frame: 100000 baud, 8E2, inverted, idle low after
+      inversion
+     */
+    void add_sbus_frame(const uint8_t frame[25], uint32_t gap_us)
+    {
+        _levels.clear();
+        for (uint8_t i = 0; i < 25; i++) {
+            uint8_t parity = 0;
+            for (uint8_t j = 0; j < 8; j++) {
+                parity ^= (frame[i] >> j) & 1;
+            }
+            // start bit, data bits, parity, two stop bits, then inverted
+            uint16_t v = (frame[i] << 1) | (parity << 9) | 0xC00;
+            _add_bits(~v, 12);
+        }
+        _add_level(false, gap_us / 10);
+        _add_pulses(100000);
+    }
+
+    /*
+      append a DSM frame: 115200 baud, 8N1, idle high. The frame is
+      surrounded by idle time, as the decoder only sees the end of a
+      frame once the line has been high for more than a byte
+     */
+    void add_dsm_frame(const uint8_t frame[16], uint32_t gap_us)
+    {
+        const uint32_t gap_bits = (gap_us * 115200ULL) / 1000000ULL;
+        _levels.clear();
+        _add_level(true, gap_bits);
+        for (uint8_t i = 0; i < 16; i++) {
+            uint16_t v = (frame[i] << 1) | 0x200;
+            _add_bits(v, 10);
+        }
+        _add_level(true, gap_bits);
+        _add_pulses(115200);
+    }
+
+    std::vector<RCPulse> pulses;
+
+private:
+    void _add_bits(uint16_t v, uint8_t n)
+    {
+        for (uint8_t i = 0; i < n; i++) {
+            _levels.push_back((v >> i) & 1);
+        }
+    }
+
+    void _add_level(bool level, uint32_t nbits)
+    {
+        _levels.insert(_levels.end(), nbits, level);
+    }
+
+    // convert the line levels into high/low pulse pairs
+    void _add_pulses(uint32_t baudrate)
+    {
+        size_t i = 0;
+        while (i < _levels.size()) {
+            uint32_t nhigh = 0, nlow = 0;
+            while (i < _levels.size() && _levels[i]) {
+                nhigh++;
+                i++;
+            }
+            while (i < _levels.size() && !_levels[i]) {
+                nlow++;
+                i++;
+            }
+            if (nlow == 0) {
+                // the trace ends high, close the pulse with one low bit
+                nlow = 1;
+            }
+            pulses.push_back({_bits_to_usec(nhigh, baudrate), _bits_to_usec(nlow, baudrate)});
+        }
+    }
+
+    static uint32_t _bits_to_usec(uint32_t nbits, uint32_t baudrate)
+    {
+        return (nbits * 1000000ULL + baudrate / 2) / baudrate;
+    }
+
+    std::vector<bool> _levels;
+};
+
+/*
+  build an SBUS frame from 16 raw 11 bit channel values
+ */
+static inline void sbus_encode(const uint16_t raw[16], uint8_t frame[25])
+{
+    memset(frame, 0, 25);
+    frame[0] = 0x0f;
+    for (uint16_t bit = 0; bit < 16 * 11; bit++) {
+        if (raw[bit / 11] & (1U << (bit % 11))) {
+            frame[1 + bit / 8] |= 1U << (bit % 8);
+        }
+    }
+}
+
+/*
+  build a DSM frame from 7 raw 11 bit channel values
+ */
+static inline void dsm_encode(const uint16_t raw[7], uint8_t frame[16])
+{
+    frame[0] = 0;
+    frame[1] = 0x12;
+    for (uint8_t i = 0; i < 7; i++) {
+        uint16_t v = (i << 11) | (raw[i] & 0x7ff);
+        frame[2 + 2 * i] = v >> 8;
+        frame[3 + 2 * i] = v & 0xff;
+    }
+}
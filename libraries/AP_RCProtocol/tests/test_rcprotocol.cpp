@@ -0,0 +1,217 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_RCProtocol/AP_RCProtocol.h>
+
+#include "rcprotocol_trace.h"
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static void replay(AP_RCProtocol &rcprot, const RCPulseTrace &trace)
+{
+    for (const RCPulse &p : trace.pulses) {
+        rcprot.process_pulse(p.width_s0, p.width_s1);
+    }
+}
+
+/*
+  feed bytes to the protocol as a UART at baudrate would deliver them,
+  starting at time_us, with bits_per_byte bits on the line per byte.
+  Returns the time the last byte was received
+ */
+static uint32_t send_bytes(AP_RCProtocol &rcprot, const uint8_t *bytes, uint8_t n,
+                           uint32_t baudrate, uint8_t bits_per_byte, uint32_t time_us)
+{
+    const uint32_t byte_us = (bits_per_byte * 1000000UL) / baudrate;
+    for (uint8_t i = 0; i < n; i++) {
+        time_us += byte_us;
+        rcprot.process_byte(bytes[i], baudrate, time_us);
+    }
+    return time_us;
+}
+
+static void sbus_test_frame(uint8_t frame[25])
+{
+    uint16_t raw[16];
+    for (uint8_t i = 0; i < 16; i++) {
+        raw[i] = 300 + 100 * i;
+    }
+    sbus_encode(raw, frame);
+}
+
+static void dsm_test_frame(uint8_t frame[16])
+{
+    uint16_t raw[7];
+    for (uint8_t i = 0; i < 7; i++) {
+        raw[i] = 1100 + 100 * i;
+    }
+    dsm_encode(raw, frame);
+}
+
+// channel value the DSM decoder gives for raw channel i of dsm_test_frame()
+static uint16_t dsm_expected(uint8_t i)
+{
+    return (((1100 + 100 * i) - 1024) * 1000) / 1700 + 1500;
+}
+
+TEST(AP_RCProtocol, ppm_pulses)
+{
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    const uint16_t widths[8] = { 1100, 1200, 1300, 1400, 1500, 1600, 1700, 1800 };
+    RCPulseTrace trace;
+    // sync pulse first so the decoder starts on channel 1
+    trace.pulses.push_back({400, 5000});
+    trace.add_ppm_frame(widths, 8);
+    replay(rcprot, trace);
+
+    EXPECT_TRUE(rcprot.new_input());
+    EXPECT_EQ(AP_RCProtocol::PPM, rcprot.protocol_detected());
+    ASSERT_EQ(8, rcprot.num_channels());
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_EQ(widths[i], rcprot.read(i));
+    }
+}
+
+TEST(AP_RCProtocol, sbus_pulses)
+{
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    uint8_t frame[25];
+    sbus_test_frame(frame);
+    RCPulseTrace trace;
+    trace.add_sbus_frame(frame, 3000);
+    replay(rcprot, trace);
+
+    EXPECT_TRUE(rcprot.new_input());
+    EXPECT_EQ(AP_RCProtocol::SBUS, rcprot.protocol_detected());
+    ASSERT_EQ(16, rcprot.num_channels());
+    for (uint8_t i = 0; i < 16; i++) {
+        const float expected = 1000 + ((300 + 100 * i) - 200) * 0.625f;
+        EXPECT_NEAR(expected, rcprot.read(i), 2);
+    }
+}
+
+TEST(AP_RCProtocol, sbus_bytes)
+{
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    uint8_t frame[25];
+    sbus_test_frame(frame);
+
+    // a partial frame followed by a gap must not shift the next frame
+    uint32_t t = send_bytes(rcprot, frame, 10, 100000, 12, 10000);
+    EXPECT_FALSE(rcprot.new_input());
+
+    t = send_bytes(rcprot, frame, 25, 100000, 12, t + 3000);
+    EXPECT_TRUE(rcprot.new_input());
+    EXPECT_EQ(AP_RCProtocol::SBUS, rcprot.protocol_detected());
+    ASSERT_EQ(16, rcprot.num_channels());
+    EXPECT_NEAR(1000 + 100 * 0.625f, rcprot.read(0), 2);
+
+    // wrong baudrate is not SBUS
+    send_bytes(rcprot, frame, 25, 115200, 10, t + 3000);
+    EXPECT_FALSE(rcprot.new_input());
+}
+
+TEST(AP_RCProtocol, dsm_pulses)
+{
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    uint8_t frame[16];
+    dsm_test_frame(frame);
+    RCPulseTrace trace;
+    // the decoder needs several frames to decide on the channel format
+    for (uint8_t i = 0; i < 8; i++) {
+        trace.add_dsm_frame(frame, 5000);
+    }
+    replay(rcprot, trace);
+
+    EXPECT_TRUE(rcprot.new_input());
+    EXPECT_EQ(AP_RCProtocol::DSM, rcprot.protocol_detected());
+    ASSERT_EQ(7, rcprot.num_channels());
+    EXPECT_EQ(dsm_expected(1), rcprot.read(0));
+    EXPECT_EQ(dsm_expected(2), rcprot.read(1));
+    EXPECT_EQ(dsm_expected(0), rcprot.read(2));
+    EXPECT_EQ(dsm_expected(6), rcprot.read(6));
+}
+
+TEST(AP_RCProtocol, dsm_bytes)
+{
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    uint8_t frame[16];
+    dsm_test_frame(frame);
+    uint32_t t = 10000;
+    for (uint8_t n = 0; n < 8; n++) {
+        t = send_bytes(rcprot, frame, 16, 115200, 10, t + 6000);
+    }
+
+    EXPECT_TRUE(rcprot.new_input());
+    EXPECT_EQ(AP_RCProtocol::DSM, rcprot.protocol_detected());
+    ASSERT_EQ(7, rcprot.num_channels());
+    EXPECT_EQ(dsm_expected(1), rcprot.read(0));
+    EXPECT_EQ(dsm_expected(3), rcprot.read(3));
+}
+
+TEST(AP_RCProtocol, dsm_bytes_fades_counter)
+{
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    // remote satellites send a 16 bit fades counter in place of the
+    // system byte, so any value must be accepted
+    uint8_t frame[16];
+    dsm_test_frame(frame);
+    frame[0] = 0x12;
+    frame[1] = 0x55;
+    uint32_t t = 10000;
+    for (uint8_t n = 0; n < 8; n++) {
+        t = send_bytes(rcprot, frame, 16, 115200, 10, t + 6000);
+    }
+
+    EXPECT_TRUE(rcprot.new_input());
+    EXPECT_EQ(AP_RCProtocol::DSM, rcprot.protocol_detected());
+    EXPECT_EQ(dsm_expected(1), rcprot.read(0));
+}
+
+TEST(AP_RCProtocol, locked_to_input_kind)
+{
+    AP_RCProtocol rcprot;
+    rcprot.init();
+
+    uint8_t frame[25];
+    sbus_test_frame(frame);
+    send_bytes(rcprot, frame, 25, 100000, 12, 10000);
+    EXPECT_TRUE(rcprot.new_input());
+
+    // pulses are ignored while the UART input is live
+    const uint16_t widths[8] = { 1100, 1200, 1300, 1400, 1500, 1600, 1700, 1800 };
+    RCPulseTrace trace;
+    trace.pulses.push_back({400, 5000});
+    trace.add_ppm_frame(widths, 8);
+    replay(rcprot, trace);
+
+    EXPECT_FALSE(rcprot.new_input());
+    EXPECT_EQ(AP_RCProtocol::SBUS, rcprot.protocol_detected());
+}
+
+AP_GTEST_MAIN()
@@ -27,6 +27,7 @@
 #include <AP_InertialSensor/AP_InertialSensor.h>
 
 #include <stdio.h>
+#include <string.h>
 
 #if APM_BUILD_TYPE(APM_BUILD_ArduCopter) || APM_BUILD_TYPE(APM_BUILD_ArduSub)
 #define SCHEDULER_DEFAULT_LOOP_RATE 400
@@ -34,6 +35,8 @@
 #define SCHEDULER_DEFAULT_LOOP_RATE  50
 #endif
 
+#define SCHEDULER_THREAD_STATS_INTERVAL_MS 1000
+
 #define debug(level, fmt, args...)   do { if ((level) <= _debug.get()) { hal.console->printf(fmt, ##args); }} while (0)
 
 extern const AP_HAL::HAL& hal;
@@ -88,6 +91,9 @@ void AP_Scheduler::init(const AP_Scheduler::Task *tasks, uint8_t num_tasks, uint
     perf_info.reset();
 
     _log_performance_bit = log_performance_bit;
+
+    // HAL thread stats may need file access to read, keep that off the main loop
+    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Scheduler::Log_Write_Threads, void));
 }
 
 // one tick has passed
@@ -278,3 +284,39 @@ void AP_Scheduler::Log_Write_Performance()
     };
     DataFlash_Class::instance()->WriteCriticalBlock(&pkt, sizeof(pkt));
 }
+
+/*
+  write a THRD message for each HAL thread with where it ran and how
+  late it woke up. Runs as an IO process
+ */
+void AP_Scheduler::Log_Write_Threads()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _last_thread_stats_ms < SCHEDULER_THREAD_STATS_INTERVAL_MS) {
+        return;
+    }
+    _last_thread_stats_ms = now_ms;
+
+    DataFlash_Class *dataflash = DataFlash_Class::instance();
+    if (dataflash == nullptr ||
+        _log_performance_bit == (uint32_t)-1 ||
+        !dataflash->should_log(_log_performance_bit)) {
+        return;
+    }
+
+    AP_HAL::Scheduler::thread_stats stats;
+    for (uint8_t i=0; hal.scheduler->get_thread_stats(i, stats); i++) {
+        char name[16] {};
+        strncpy(name, stats.name, sizeof(name)-1);
+        dataflash->Log_Write("THRD", "TimeUS,Name,CPU,Run,Wait,Preempt,Wake,LateMax,LateAvg", "QNhIIIIII",
+                             AP_HAL::micros64(),
+                             name,
+                             stats.cpu,
+                             stats.run_ms,
+                             stats.wait_ms,
+                             stats.preemptions,
+                             stats.wakeups,
+                             stats.max_late_us,
+                             stats.avg_late_us);
+    }
+}
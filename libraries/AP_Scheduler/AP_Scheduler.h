@@ -200,4 +200,10 @@ private:
 
     // bitmask bit which indicates if we should log PERF message to dataflash
     uint32_t _log_performance_bit;
+
+    // last time the HAL thread stats were logged
+    uint32_t _last_thread_stats_ms;
+
+    // write THRD messages from an IO process
+    void Log_Write_Threads();
 };
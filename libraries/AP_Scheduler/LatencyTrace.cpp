@@ -0,0 +1,127 @@
+#include "LatencyTrace.h"
+
+#if LATENCY_TRACE_ENABLED
+
+#include <DataFlash/DataFlash.h>
+
+extern const AP_HAL::HAL& hal;
+
+AP::LatencyTrace::Trace AP::LatencyTrace::_traces[LATENCY_TRACE_SLOTS];
+uint16_t AP::LatencyTrace::_logged_id[LATENCY_TRACE_SLOTS];
+uint16_t AP::LatencyTrace::_next_id;
+uint64_t AP::LatencyTrace::_last_start_us;
+
+// trace of the sample being handled by each thread
+static thread_local uint16_t current_trace_id;
+
+/*
+  start a trace on the first sample every LATENCY_TRACE_INTERVAL_US. This
+  is by time rather than sample count so that the slots outlast the log
+  delay at any gyro rate
+ */
+uint16_t AP::LatencyTrace::start(uint64_t sample_us)
+{
+    if (sample_us - _last_start_us < LATENCY_TRACE_INTERVAL_US) {
+        current_trace_id = 0;
+        return 0;
+    }
+    _last_start_us = sample_us;
+
+    if (++_next_id == 0) {
+        // zero means no trace
+        _next_id = 1;
+    }
+    const uint16_t trace_id = _next_id;
+
+    // mark the slot as being rewritten so the log writer discards any copy it is taking
+    Trace &trace = _traces[trace_id % LATENCY_TRACE_SLOTS];
+    trace.id.store(0);
+    trace.time_us[STAGE_SAMPLE] = sample_us;
+    for (uint8_t i=STAGE_SAMPLE+1; i<STAGE_COUNT; i++) {
+        trace.time_us[i] = 0;
+    }
+    trace.id.store(trace_id);
+
+    current_trace_id = trace_id;
+    hal.util->perf_trace(trace_id, STAGE_SAMPLE);
+    return trace_id;
+}
+
+uint16_t AP::LatencyTrace::get_current()
+{
+    return current_trace_id;
+}
+
+void AP::LatencyTrace::set_current(uint16_t trace_id)
+{
+    current_trace_id = trace_id;
+}
+
+// record the first time the current trace reaches a stage
+void AP::LatencyTrace::record(Stage stage)
+{
+    const uint16_t trace_id = current_trace_id;
+    if (trace_id == 0) {
+        return;
+    }
+    Trace &trace = _traces[trace_id % LATENCY_TRACE_SLOTS];
+    if (trace.id.load() != trace_id) {
+        // slot reused by a newer trace
+        return;
+    }
+    uint64_t not_reached = 0;
+    if (!trace.time_us[stage].compare_exchange_strong(not_reached, AP_HAL::micros64())) {
+        // stage already recorded, possibly by another thread
+        return;
+    }
+    hal.util->perf_trace(trace_id, stage);
+}
+
+/*
+  write a LAT message for each trace that has not been logged yet, with
+  the delay from the sample to each stage in microseconds, or -1 for
+  stages the sample did not reach
+ */
+void AP::LatencyTrace::write_log()
+{
+    DataFlash_Class *dataflash = DataFlash_Class::instance();
+    if (dataflash == nullptr) {
+        return;
+    }
+    const uint64_t now_us = AP_HAL::micros64();
+
+    for (uint8_t i=0; i<LATENCY_TRACE_SLOTS; i++) {
+        Trace &trace = _traces[i];
+        const uint16_t trace_id = trace.id.load();
+        if (trace_id == 0 || trace_id == _logged_id[i]) {
+            continue;
+        }
+        uint64_t time_us[STAGE_COUNT];
+        for (uint8_t s=0; s<STAGE_COUNT; s++) {
+            time_us[s] = trace.time_us[s];
+        }
+        if (trace.id.load() != trace_id) {
+            // restarted while we were copying it
+            continue;
+        }
+        if (now_us - time_us[STAGE_SAMPLE] < LATENCY_TRACE_LOG_DELAY_US) {
+            // give all stages a chance to see it
+            continue;
+        }
+        _logged_id[i] = trace_id;
+
+        int32_t delay_us[STAGE_COUNT];
+        for (uint8_t s=STAGE_SAMPLE+1; s<STAGE_COUNT; s++) {
+            delay_us[s] = (time_us[s] != 0) ? (int32_t)(time_us[s] - time_us[STAGE_SAMPLE]) : -1;
+        }
+        dataflash->Log_Write("LAT", "TimeUS,Id,Ins,Rate,Out,AHRS", "QHiiii",
+                             time_us[STAGE_SAMPLE],
+                             trace_id,
+                             delay_us[STAGE_INS],
+                             delay_us[STAGE_RATE],
+                             delay_us[STAGE_OUTPUT],
+                             delay_us[STAGE_AHRS]);
+    }
+}
+
+#endif // LATENCY_TRACE_ENABLED
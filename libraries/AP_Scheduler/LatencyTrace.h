@@ -0,0 +1,78 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <atomic>
+
+#ifndef LATENCY_TRACE_ENABLED
+#define LATENCY_TRACE_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#define LATENCY_TRACE_INTERVAL_US   20000   // trace the first primary gyro sample after this long
+#define LATENCY_TRACE_SLOTS         8       // number of traces kept until they are logged
+#define LATENCY_TRACE_LOG_DELAY_US  100000  // traces are logged once this long has passed since their sample
+
+// a slot must not be reused before its trace has been logged, whatever the gyro rate
+static_assert(LATENCY_TRACE_SLOTS * LATENCY_TRACE_INTERVAL_US > LATENCY_TRACE_LOG_DELAY_US + LATENCY_TRACE_INTERVAL_US,
+              "too few latency trace slots for the log delay");
+
+namespace AP {
+
+/*
+  trace the latency of sensor samples through the control loop.
+
+  The first primary gyro sample every LATENCY_TRACE_INTERVAL_US is given
+  a trace id, which becomes the current trace of each thread that
+  handles the sample. Stages record the first time they handled the
+  current trace. Stage times are set with a compare and swap, so a stage
+  reached from more than one thread keeps the earliest record without
+  locks; the log writer checks the trace id is unchanged after copying
+  a trace. Stages are also passed to the HAL's perf_trace(), which sends
+  them to LTTng on Linux.
+ */
+class LatencyTrace {
+public:
+    enum Stage {
+        STAGE_SAMPLE = 0,   // gyro sample taken
+        STAGE_INS,          // sample published to the main loop by AP_InertialSensor::update()
+        STAGE_RATE,         // rate controller run on the sample
+        STAGE_OUTPUT,       // outputs pushed to RCOutput
+        STAGE_AHRS,         // AHRS and EKF updated with the sample
+        STAGE_COUNT
+    };
+
+#if LATENCY_TRACE_ENABLED
+    // called with each primary gyro sample. Returns the id of a new
+    // trace if this sample is traced, otherwise zero. The new trace, or
+    // none, becomes the current trace of the calling thread
+    static uint16_t start(uint64_t sample_us);
+
+    // get and set the trace of the sample the calling thread is handling
+    static uint16_t get_current();
+    static void set_current(uint16_t trace_id);
+
+    // record the time the current trace of the calling thread reached a stage
+    static void record(Stage stage);
+
+    // log traces whose stages are complete, called from the main loop
+    static void write_log();
+
+private:
+    struct Trace {
+        std::atomic<uint16_t> id;           // zero while the trace is being started
+        std::atomic<uint64_t> time_us[STAGE_COUNT]; // zero for stages not reached
+    };
+
+    static Trace _traces[LATENCY_TRACE_SLOTS];
+    static uint16_t _logged_id[LATENCY_TRACE_SLOTS];
+    static uint16_t _next_id;
+    static uint64_t _last_start_us;
+#else
+    static uint16_t start(uint64_t sample_us) { return 0; }
+    static uint16_t get_current() { return 0; }
+    static void set_current(uint16_t trace_id) {}
+    static void record(Stage stage) {}
+    static void write_log() {}
+#endif
+};
+
+};
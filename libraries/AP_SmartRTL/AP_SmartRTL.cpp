@@ -26,8 +26,8 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 
     // @Param: POINTS
     // @DisplayName: SmartRTL maximum number of points on path
-    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.
-    // @Range: 0 500
+    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.  Linux and SITL boards support up to 30000 points, other boards up to 500.
+    // @Range: 0 30000
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("POINTS", 1, AP_SmartRTL, _points_max, SMARTRTL_POINTS_DEFAULT),
@@ -70,6 +70,11 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 *    which is run as the vehicle initiates the SmartRTL flight mode, waits for
 *    these flags to become true.  This can force the vehicle to pause for a few
 *    seconds before initiating the return journey.
+*
+*    On Linux and SITL boards the cleanup runs with longer time slices
+*    and the path can hold many more points.  To keep pruning of long paths
+*    fast, segments are hashed into a horizontal grid so that each segment is
+*    only compared with the segments near it.
 */
 
 AP_SmartRTL::AP_SmartRTL(const AP_AHRS& ahrs, bool example_mode) :
@@ -123,8 +128,16 @@ void AP_SmartRTL::init()
 
     _path_points_max = _points_max;
 
+    // allocate loop detection grid for long paths
+    init_loop_grid();
+
     // when running the example sketch, we want the cleanup tasks to run when we tell them to, not in the background (so that they can be timed.)
     if (!_example_mode){
+#if SMARTRTL_LONG_PATHS
+        // longer time slices do not delay the main loop on these boards
+        _simplify_time_us = SMARTRTL_LONG_PATHS_TIME_US;
+        _pruning_time_us = SMARTRTL_LONG_PATHS_TIME_US;
+#endif
         // register background cleanup to run in IO thread
         hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_SmartRTL::run_background_cleanup, void));
     }
@@ -180,13 +193,14 @@ void AP_SmartRTL::set_home(bool position_ok, const Vector3f& current_pos)
         return;
     }
 
-    // clear path
+    // clear path and ask the background thread to reset simplification and pruning.  They are
+    // only touched by the background thread, which may be running if home is being reset
+    if (!_path_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
     _path_points_count = 0;
-
-    // reset simplification and pruning.  These functions access members that should normally only
-    // be touched by the background thread but it will not be running because active should be false
-    reset_simplification();
-    reset_pruning();
+    _cleanup_reset_required = true;
+    _path_sem->give();
 
     // don't continue if no position at take-off
     if (!position_ok) {
@@ -332,8 +346,16 @@ void AP_SmartRTL::run_background_cleanup()
     const uint16_t path_points_count = _path_points_count;
     const uint16_t path_points_completed_limit = _path_points_completed_limit;
     _path_points_completed_limit = SMARTRTL_POINTS_MAX;
+    const bool cleanup_reset_required = _cleanup_reset_required;
+    _cleanup_reset_required = false;
     _path_sem->give();
 
+    // path has been cleared by set_home so start simplification and pruning again
+    if (cleanup_reset_required) {
+        reset_simplification();
+        reset_pruning();
+    }
+
     // check if thorough cleanup is required
     if (_thorough_clean_request_ms > 0) {
         // check if we have already completed the request
@@ -472,7 +494,7 @@ void AP_SmartRTL::detect_simplifications()
     while (_simplify.stack_count > 0) { // while there is something to do
 
         // if this method has run for long enough, exit
-        if (AP_HAL::micros() - start_time_us > SMARTRTL_SIMPLIFY_TIME_US) {
+        if (AP_HAL::micros() - start_time_us > _simplify_time_us) {
             return;
         }
 
@@ -532,11 +554,17 @@ void AP_SmartRTL::detect_loops()
         return;
     }
 
+    // for long paths only compare segments that are near each other
+    if (_loop_grid.valid) {
+        detect_loops_using_grid();
+        return;
+    }
+
     // capture start time
     const uint32_t start_time_us = AP_HAL::micros();
 
     // run for defined amount of time
-    while (AP_HAL::micros() - start_time_us < SMARTRTL_PRUNING_LOOP_TIME_US) {
+    while (AP_HAL::micros() - start_time_us < _pruning_time_us) {
 
         // advance inner loop
         _prune.j++;
@@ -567,6 +595,198 @@ void AP_SmartRTL::detect_loops()
     }
 }
 
+// detect_loops using the loop detection grid.  Finds the same loops as detect_loops but
+// for each segment only calculates the distance to segments in the same grid cells
+void AP_SmartRTL::detect_loops_using_grid()
+{
+    // capture start time
+    const uint32_t start_time_us = AP_HAL::micros();
+
+    // run for defined amount of time
+    while (AP_HAL::micros() - start_time_us < _pruning_time_us) {
+        // check the segment ending at the outer loop index
+        if (!detect_loop_at_segment(_prune.i)) {
+            // if the buffer is full, stop trying to prune
+            _prune.complete = true;
+            return;
+        }
+
+        // reduce outer loop
+        _prune.i--;
+        // complete when outer loop has run out of new points to check
+        if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
+            _prune.complete = true;
+            _prune.path_points_completed = _prune.path_points_count;
+            return;
+        }
+    }
+}
+
+// check the segment ending at index i against all earlier segments and add the first loop found
+// returns false if the loop array is full
+bool AP_SmartRTL::detect_loop_at_segment(uint16_t i)
+{
+    uint16_t candidates[SMARTRTL_LOOP_GRID_CANDIDATES_MAX];
+    const int16_t num_candidates = get_loop_grid_candidates(i, candidates);
+
+    if (num_candidates < 0) {
+        // too many segments nearby, check all of them
+        for (uint16_t j = 1; j <= i - 2; j++) {
+            dist_point dp = segment_segment_dist(_path[i], _path[i-1], _path[j-1], _path[j]);
+            if (dp.distance < SMARTRTL_PRUNING_DELTA) {
+                return add_loop(j, i-1, dp.midpoint);
+            }
+        }
+        return true;
+    }
+
+    // candidates are sorted so the first loop found matches detect_loops
+    for (int16_t c = 0; c < num_candidates; c++) {
+        const uint16_t j = candidates[c];
+        dist_point dp = segment_segment_dist(_path[i], _path[i-1], _path[j-1], _path[j]);
+        if (dp.distance < SMARTRTL_PRUNING_DELTA) {
+            return add_loop(j, i-1, dp.midpoint);
+        }
+    }
+    return true;
+}
+
+// allocate the loop detection grid, it is only used when the path can hold many points
+void AP_SmartRTL::init_loop_grid()
+{
+    if (_path_points_max < SMARTRTL_LOOP_GRID_POINTS_MIN) {
+        return;
+    }
+
+    // one bucket per point, rounded up to a power of two so the bucket can be found with a mask
+    _loop_grid.buckets_max = 1;
+    while (_loop_grid.buckets_max < _path_points_max) {
+        _loop_grid.buckets_max <<= 1;
+    }
+    _loop_grid.buckets = (uint32_t*)calloc(_loop_grid.buckets_max, sizeof(uint32_t));
+
+    _loop_grid.entries_max = _path_points_max * SMARTRTL_LOOP_GRID_ENTRIES_MULT;
+    _loop_grid.entries = (loop_grid_entry_t*)calloc(_loop_grid.entries_max, sizeof(loop_grid_entry_t));
+
+    _loop_grid.large_max = _path_points_max * SMARTRTL_LOOP_GRID_LARGE_MULT;
+    _loop_grid.large = (uint16_t*)calloc(_loop_grid.large_max, sizeof(uint16_t));
+
+    // the grid is optional, fall back to comparing all segments if memory allocation failed
+    if (_loop_grid.buckets == nullptr || _loop_grid.entries == nullptr || _loop_grid.large == nullptr) {
+        free(_loop_grid.buckets);
+        free(_loop_grid.entries);
+        free(_loop_grid.large);
+        _loop_grid.buckets = nullptr;
+        _loop_grid.entries = nullptr;
+        _loop_grid.large = nullptr;
+    }
+}
+
+// rebuild the loop detection grid from the first path_points_count points of the path
+void AP_SmartRTL::build_loop_grid(uint16_t path_points_count)
+{
+    _loop_grid.valid = false;
+    _loop_grid.cell_size = SMARTRTL_LOOP_GRID_CELL_SIZE;
+    if (_loop_grid.buckets == nullptr || !is_positive(_loop_grid.cell_size)) {
+        return;
+    }
+
+    memset(_loop_grid.buckets, 0xff, _loop_grid.buckets_max * sizeof(uint32_t));
+    _loop_grid.entries_count = 0;
+    _loop_grid.large_count = 0;
+
+    // add each segment to the cells covered by its bounding box
+    for (uint16_t i = 1; i < path_points_count; i++) {
+        int32_t x_min, y_min, x_max, y_max;
+        get_loop_grid_cells(i, 0.0f, x_min, y_min, x_max, y_max);
+        if ((int64_t)(x_max - x_min + 1) * (y_max - y_min + 1) > SMARTRTL_LOOP_GRID_SEGMENT_CELLS_MAX) {
+            if (_loop_grid.large_count >= _loop_grid.large_max) {
+                return;
+            }
+            _loop_grid.large[_loop_grid.large_count++] = i;
+            continue;
+        }
+        for (int32_t x = x_min; x <= x_max; x++) {
+            for (int32_t y = y_min; y <= y_max; y++) {
+                if (_loop_grid.entries_count >= _loop_grid.entries_max) {
+                    return;
+                }
+                const uint32_t bucket = loop_grid_bucket(x, y);
+                _loop_grid.entries[_loop_grid.entries_count] = loop_grid_entry_t {i, _loop_grid.buckets[bucket]};
+                _loop_grid.buckets[bucket] = _loop_grid.entries_count++;
+            }
+        }
+    }
+    _loop_grid.valid = true;
+}
+
+// get the segments that may come close to the segment ending at index i, sorted by index
+// returns the number of segments or -1 if all segments must be checked
+int16_t AP_SmartRTL::get_loop_grid_candidates(uint16_t i, uint16_t candidates[SMARTRTL_LOOP_GRID_CANDIDATES_MAX]) const
+{
+    // a segment can only come within SMARTRTL_PRUNING_DELTA if its cells overlap this segment's expanded bounding box
+    int32_t x_min, y_min, x_max, y_max;
+    get_loop_grid_cells(i, SMARTRTL_PRUNING_DELTA, x_min, y_min, x_max, y_max);
+    if ((int64_t)(x_max - x_min + 1) * (y_max - y_min + 1) > SMARTRTL_LOOP_GRID_SEGMENT_CELLS_MAX) {
+        return -1;
+    }
+
+    // only segments that do not touch this one, as in detect_loops
+    const uint16_t j_max = i - 2;
+    int16_t count = 0;
+    for (uint16_t l = 0; l < _loop_grid.large_count; l++) {
+        const uint16_t j = _loop_grid.large[l];
+        if (j <= j_max) {
+            if (count >= SMARTRTL_LOOP_GRID_CANDIDATES_MAX) {
+                return -1;
+            }
+            candidates[count++] = j;
+        }
+    }
+    for (int32_t x = x_min; x <= x_max; x++) {
+        for (int32_t y = y_min; y <= y_max; y++) {
+            for (uint32_t e = _loop_grid.buckets[loop_grid_bucket(x, y)]; e != UINT32_MAX; e = _loop_grid.entries[e].next) {
+                const uint16_t j = _loop_grid.entries[e].segment;
+                if (j > j_max) {
+                    continue;
+                }
+                // insert in order, skipping segments already found through another cell
+                int16_t k = count;
+                while (k > 0 && candidates[k-1] > j) {
+                    k--;
+                }
+                if (k > 0 && candidates[k-1] == j) {
+                    continue;
+                }
+                if (count >= SMARTRTL_LOOP_GRID_CANDIDATES_MAX) {
+                    return -1;
+                }
+                memmove(&candidates[k+1], &candidates[k], (count - k) * sizeof(uint16_t));
+                candidates[k] = j;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// get the range of grid cells covered by the segment ending at index i with its bounding box expanded by margin
+void AP_SmartRTL::get_loop_grid_cells(uint16_t i, float margin, int32_t &x_min, int32_t &y_min, int32_t &x_max, int32_t &y_max) const
+{
+    const Vector3f &p1 = _path[i-1];
+    const Vector3f &p2 = _path[i];
+    x_min = floorf((MIN(p1.x, p2.x) - margin) / _loop_grid.cell_size);
+    y_min = floorf((MIN(p1.y, p2.y) - margin) / _loop_grid.cell_size);
+    x_max = floorf((MAX(p1.x, p2.x) + margin) / _loop_grid.cell_size);
+    y_max = floorf((MAX(p1.y, p2.y) + margin) / _loop_grid.cell_size);
+}
+
+// get the grid bucket for the cell x, y
+uint32_t AP_SmartRTL::loop_grid_bucket(int32_t x, int32_t y) const
+{
+    return (((uint32_t)x * 73856093U) ^ ((uint32_t)y * 19349663U)) & (_loop_grid.buckets_max - 1);
+}
+
 // restart simplify if new points have been added to path
 // path_points_count is _path_points_count but passed in to avoid having to take the semaphore
 void AP_SmartRTL::restart_simplify_if_new_points(uint16_t path_points_count)
@@ -610,6 +830,7 @@ void AP_SmartRTL::restart_pruning(uint16_t path_points_count)
     _prune.i = (path_points_count > 0) ? path_points_count - 1 : 0;
     _prune.j = 0;
     _prune.path_points_count = path_points_count;
+    build_loop_grid(path_points_count);
 }
 
 // reset pruning algorithm so that it will re-check all points in the path
@@ -627,6 +848,11 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
     if (!_path_sem->take_nonblocking()) {
         return;
     }
+    // path has been cleared since the simplifications were found
+    if (_cleanup_reset_required) {
+        _path_sem->give();
+        return;
+    }
     uint16_t dest = 1;
     uint16_t removed = 0;
     for (uint16_t src = 1; src < _path_points_count; src++) {
@@ -670,6 +896,11 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
     if (!_path_sem->take_nonblocking()) {
         return false;
     }
+    // path has been cleared since the loops were found
+    if (_cleanup_reset_required) {
+        _path_sem->give();
+        return false;
+    }
 
     uint16_t removed_points = 0;
     uint16_t i = _prune.loops_count;
@@ -8,10 +8,21 @@
 #include <DataFlash/DataFlash.h>
 #include <GCS_MAVLink/GCS.h>
 
+// Linux runs IO processes on their own thread and SITL is not bound by real time, so the cleanup can use longer time slices and much longer paths
+#ifndef SMARTRTL_LONG_PATHS
+#define SMARTRTL_LONG_PATHS (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
 // definitions and macros
 #define SMARTRTL_ACCURACY_DEFAULT        2.0f   // default _ACCURACY parameter value.  Points will be no closer than this distance (in meters) together.
 #define SMARTRTL_POINTS_DEFAULT          150    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 20bytes * this number.
+#ifndef SMARTRTL_POINTS_MAX
+#if SMARTRTL_LONG_PATHS
+#define SMARTRTL_POINTS_MAX              30000  // the absolute maximum number of points this library can support.
+#else
 #define SMARTRTL_POINTS_MAX              500    // the absolute maximum number of points this library can support.
+#endif
+#endif
 #define SMARTRTL_TIMEOUT                 15000  // the time in milliseconds with no points saved to the path (for whatever reason), before SmartRTL is disabled for the flight
 #define SMARTRTL_CLEANUP_POINT_TRIGGER   50     // simplification will trigger when this many points are added to the path
 #define SMARTRTL_CLEANUP_START_MARGIN    10     // routine cleanup algorithms begin when the path array has only this many empty slots remaining
@@ -24,6 +35,13 @@
 #define SMARTRTL_PRUNING_DELTA (_accuracy * 0.99)   // How many meters apart must two points be, such that we can assume that there is no obstacle between them.  must be smaller than _ACCURACY parameter
 #define SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT 0.25f // pruning loop buffer size as compared to maximum number of points
 #define SMARTRTL_PRUNING_LOOP_TIME_US    200    // maximum time (in microseconds) that the loop finding algorithm will run before returning
+#define SMARTRTL_LONG_PATHS_TIME_US      2000   // maximum time (in microseconds) each algorithm will run before returning on boards supporting long paths
+#define SMARTRTL_LOOP_GRID_POINTS_MIN    1000   // loop detection uses a spatial grid when the path can hold at least this many points
+#define SMARTRTL_LOOP_GRID_CELL_SIZE (_accuracy * 10.0f)   // width (in meters) of the loop detection grid's cells
+#define SMARTRTL_LOOP_GRID_ENTRIES_MULT  4      // loop detection grid entries as compared to maximum number of points
+#define SMARTRTL_LOOP_GRID_LARGE_MULT    0.125f // loop detection grid buffer size for segments too large to hash as compared to maximum number of points
+#define SMARTRTL_LOOP_GRID_SEGMENT_CELLS_MAX 16 // segments covering more grid cells than this are compared against every segment
+#define SMARTRTL_LOOP_GRID_CANDIDATES_MAX 64    // maximum number of nearby segments checked using the grid, beyond this every segment is checked
 
 class AP_SmartRTL {
 
@@ -120,6 +138,29 @@ private:
     // restart pruning if new points have been simplified
     void restart_pruning_if_new_points();
 
+    // detect_loops using the loop detection grid to only compare segments that are near each other
+    void detect_loops_using_grid();
+
+    // check the segment ending at index i against all earlier segments and add the first loop found
+    // returns false if the loop array is full
+    bool detect_loop_at_segment(uint16_t i);
+
+    // allocate the loop detection grid, it is only used when the path can hold many points
+    void init_loop_grid();
+
+    // rebuild the loop detection grid from the first path_points_count points of the path
+    void build_loop_grid(uint16_t path_points_count);
+
+    // get the segments that may come close to the segment ending at index i, sorted by index
+    // returns the number of segments or -1 if all segments must be checked
+    int16_t get_loop_grid_candidates(uint16_t i, uint16_t candidates[SMARTRTL_LOOP_GRID_CANDIDATES_MAX]) const;
+
+    // get the range of grid cells covered by the segment ending at index i with its bounding box expanded by margin
+    void get_loop_grid_cells(uint16_t i, float margin, int32_t &x_min, int32_t &y_min, int32_t &x_max, int32_t &y_max) const;
+
+    // get the grid bucket for the cell x, y
+    uint32_t loop_grid_bucket(int32_t x, int32_t y) const;
+
     // restart simplify algorithm so that detect_simplify will check all new points that have been added
     // to the path since it last completed.
     // path_points_count is _path_points_count but passed in to avoid having to take the semaphore
@@ -181,12 +222,15 @@ private:
     uint32_t _thorough_clean_request_ms;// the last system time the thorough cleanup was requested (set by thorough_cleanup method, used by background cleanup)
     uint32_t _thorough_clean_complete_ms; // set to _thorough_clean_request_ms when the background thread completes the thorough cleanup
     ThoroughCleanupType _thorough_clean_type;   // used by example sketch to test simplify and prune separately
+    uint32_t _simplify_time_us = SMARTRTL_SIMPLIFY_TIME_US;     // maximum time the simplification algorithm will run before returning
+    uint32_t _pruning_time_us = SMARTRTL_PRUNING_LOOP_TIME_US;  // maximum time the loop finding algorithm will run before returning
 
     // path variables
     Vector3f* _path;    // points are stored in meters from EKF origin in NED
     uint16_t _path_points_max;  // after the array has been allocated, we will need to know how big it is. We can't use the parameter, because a user could change the parameter in-flight
     uint16_t _path_points_count;// number of points in the path array
     uint16_t _path_points_completed_limit;  // set by main thread to the path_point_count when a point is popped.  used by simplify and prune algorithms to detect path shrinking
+    bool _cleanup_reset_required;   // set by main thread when the path is cleared.  the background thread then resets simplification and pruning before using them again
     AP_HAL::Semaphore *_path_sem;   // semaphore for updating path
 
     // Simplify
@@ -224,6 +268,26 @@ private:
         uint16_t loops_count;   // number of elements in the _prunable_loops array
     } _prune;
 
+    // Loop detection grid
+    // segments are hashed by horizontal position into grid cells so that for long paths detect_loops
+    // only compares each segment with the segments near it instead of with every earlier segment
+    typedef struct {
+        uint16_t segment;   // index of the last point of the segment
+        uint32_t next;      // index of the next entry in the same bucket or UINT32_MAX
+    } loop_grid_entry_t;
+    struct {
+        bool valid;         // true if the grid holds every segment of the path being pruned
+        float cell_size;    // width of a cell in meters
+        uint32_t* buckets;  // index of the first entry in each bucket or UINT32_MAX
+        uint32_t buckets_max;   // number of elements in the buckets array, always a power of two
+        loop_grid_entry_t* entries;
+        uint32_t entries_max;   // maximum number of elements in the entries array
+        uint32_t entries_count; // number of elements in the entries array
+        uint16_t* large;    // segments that cover too many cells to be hashed
+        uint16_t large_max;     // maximum number of elements in the large array
+        uint16_t large_count;   // number of elements in the large array
+    } _loop_grid;
+
     // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
     bool loops_overlap(const prune_loop_t& loop1, const prune_loop_t& loop2) const;
 };
@@ -30,18 +30,24 @@ static DummyVehicle vehicle;
 
 AP_AHRS_NavEKF &ahrs(vehicle.ahrs);
 AP_SmartRTL smart_rtl{ahrs, true};
+AP_SmartRTL smart_rtl_long{ahrs, true};
 AP_BoardConfig board_config;
 
 void setup();
 void loop();
 void reset();
 void check_path(const std::vector<Vector3f> &correct_path, const char* test_name, uint32_t time_us);
+void random_walk_test(uint16_t num_points);
 
 void setup()
 {
     hal.console->printf("SmartRTL test\n");
     board_config.init();
     smart_rtl.init();
+
+    // second instance holding as many points as this board supports, for timing cleanup of long paths
+    AP_Param::set_object_value(&smart_rtl_long, smart_rtl_long.var_info, "POINTS", SMARTRTL_POINTS_MAX);
+    smart_rtl_long.init();
 }
 
 void loop()
@@ -79,6 +85,12 @@ void loop()
     run_time = AP_HAL::micros() - reference_time;
     check_path(test_path_complete, "simplify and pruning", run_time);
 
+    // time cleanup of long random walks
+    for (uint32_t num_points = 500; num_points <= SMARTRTL_POINTS_MAX; num_points *= 4) {
+        hal.scheduler->delay(5);
+        random_walk_test(num_points);
+    }
+
     // delay before next display
     hal.scheduler->delay(5e3); // 5 seconds
 }
@@ -92,6 +104,35 @@ void reset()
     }
 }
 
+// add a random walk of num_points points to smart_rtl_long and time a thorough cleanup
+void random_walk_test(uint16_t num_points)
+{
+    Vector3f pos;
+    float heading = 0.0f;
+    smart_rtl_long.set_home(true, pos);
+    for (uint16_t i = 1; i < num_points; i++) {
+        // wander with steps longer than the accuracy so that every point is added
+        heading += (get_random16() / 65535.0f - 0.5f) * 1.2f;
+        const float step = 2.0f + get_random16() / 16384.0f;
+        pos.x += step * cosf(heading);
+        pos.y += step * sinf(heading);
+        pos.z += (get_random16() / 65535.0f - 0.5f) * 0.5f;
+        smart_rtl_long.update(true, pos);
+    }
+    const uint16_t points_before = smart_rtl_long.get_num_points();
+
+    const uint32_t reference_time = AP_HAL::micros();
+    while (!smart_rtl_long.request_thorough_cleanup(AP_SmartRTL::THOROUGH_CLEAN_ALL)) {
+        smart_rtl_long.run_background_cleanup();
+    }
+    const uint32_t run_time = AP_HAL::micros() - reference_time;
+
+    hal.console->printf("random walk: %u points reduced to %u time:%u us\n",
+                        (unsigned)points_before,
+                        (unsigned)smart_rtl_long.get_num_points(),
+                        (unsigned)run_time);
+}
+
 // compare the vector array passed in with the path held in the smart_rtl object
 void check_path(const std::vector<Vector3f>& correct_path, const char* test_name, uint32_t time_us)
 {
@@ -31,7 +31,6 @@ void ExtendedKalmanFilter::reset(const VectorN<float,N> &x, const MatrixN<float,
 
 void ExtendedKalmanFilter::update(float z, float Vx, float Vy)
 {
-    MatrixN<float,N> tempM;
     VectorN<float,N> H;
     VectorN<float,N> P12;
     VectorN<float,N> K;
@@ -70,10 +69,10 @@ void ExtendedKalmanFilter::update(float z, float Vx, float Vy)
 
     // Correct the covariance too.
     // LINE 46
-    // NB should be altered to reflect Stengel
-    // P = P_predict - K * P12';
-    tempM.mult(K, P12);
-    P -= tempM;
-    
+    // P = P_predict - K * P12', using the Joseph form
+    // P = (I - K*H)*P_predict*(I - K*H)' + K*R*K'
+    // which keeps P positive definite despite rounding
+    P.joseph_update(K, H, R);
+
     P.force_symmetry();
 }
@@ -29,6 +29,8 @@
 
 extern const AP_HAL::HAL& hal;
 
+static_assert(AP_UAVCAN_MAX_LISTENERS <= 8, "listeners of a node must fit in a uint8_t bitmask");
+
 #define debug_uavcan(level, fmt, args...) do { if ((level) <= AP_BoardConfig_CAN::get_can_debug()) { hal.console->printf(fmt, ##args); }} while (0)
 
 // Translation of all messages from UAVCAN structures into AP structures is done
@@ -317,19 +319,26 @@ AP_UAVCAN::AP_UAVCAN() :
     for (uint8_t i = 0; i < AP_UAVCAN_MAX_GPS_NODES; i++) {
         _gps_nodes[i] = UINT8_MAX;
         _gps_node_taken[i] = 0;
+        _gps_node_listeners[i] = 0;
     }
 
     for (uint8_t i = 0; i < AP_UAVCAN_MAX_BARO_NODES; i++) {
         _baro_nodes[i] = UINT8_MAX;
         _baro_node_taken[i] = 0;
+        _baro_node_listeners[i] = 0;
     }
 
     for (uint8_t i = 0; i < AP_UAVCAN_MAX_MAG_NODES; i++) {
         _mag_nodes[i] = UINT8_MAX;
         _mag_node_taken[i] = 0;
+        _mag_node_listeners[i] = 0;
         _mag_node_max_sensorid_count[i] = 1;
     }
 
+    memset(_gps_node_index, UINT8_MAX, sizeof(_gps_node_index));
+    memset(_baro_node_index, UINT8_MAX, sizeof(_baro_node_index));
+    memset(_mag_node_index, UINT8_MAX, sizeof(_mag_node_index));
+
     for (uint8_t i = 0; i < AP_UAVCAN_MAX_LISTENERS; i++) {
         _gps_listener_to_node[i] = UINT8_MAX;
         _gps_listeners[i] = nullptr;
@@ -532,7 +541,7 @@ void AP_UAVCAN::rc_out_send_servos(void)
         if (i > 0) {
             act_out_array[_uavcan_i]->broadcast(msg);
 
-            if (i == 15) {
+            if (i == 15 && starting_servo < UAVCAN_RCO_NUMBER) {
                 repeat_send = true;
             }
         }
@@ -547,11 +556,14 @@ void AP_UAVCAN::rc_out_send_esc(void)
     uint8_t active_esc_num = 0, max_esc_num = 0;
     uint8_t k = 0;
 
-    // find out how many esc we have enabled and if they are active at all
+    // find out how many esc we have enabled and if they are active at all.
+    // Only send up to the last ESC that has an output, so that the
+    // commands take as few frames as possible: up to 4 ESCs fit in a
+    // single frame, while the 8 of the default bitmask take 3 frames
     for (uint8_t i = 0; i < UAVCAN_RCO_NUMBER; i++) {
         if ((((uint32_t) 1) << i) & _esc_bm) {
-            max_esc_num = i + 1;
             if (_rco_conf[i].active) {
+                max_esc_num = i + 1;
                 active_esc_num++;
             }
         }
@@ -714,6 +726,7 @@ uint8_t AP_UAVCAN::register_gps_listener(AP_GPS_Backend* new_listener, uint8_t p
                 _gps_listeners[sel_place] = new_listener;
                 _gps_listener_to_node[sel_place] = preferred_channel - 1;
                 _gps_node_taken[_gps_listener_to_node[sel_place]]++;
+                _gps_node_listeners[_gps_listener_to_node[sel_place]] |= 1U << sel_place;
                 ret = preferred_channel;
 
                 debug_uavcan(2, "reg_GPS place:%d, chan: %d\n\r", sel_place, preferred_channel);
@@ -724,6 +737,7 @@ uint8_t AP_UAVCAN::register_gps_listener(AP_GPS_Backend* new_listener, uint8_t p
                     _gps_listeners[sel_place] = new_listener;
                     _gps_listener_to_node[sel_place] = i;
                     _gps_node_taken[i]++;
+                    _gps_node_listeners[i] |= 1U << sel_place;
                     ret = i + 1;
 
                     debug_uavcan(2, "reg_GPS place:%d, chan: %d\n\r", sel_place, i);
@@ -753,6 +767,7 @@ uint8_t AP_UAVCAN::register_gps_listener_to_node(AP_GPS_Backend* new_listener, u
                 _gps_listeners[sel_place] = new_listener;
                 _gps_listener_to_node[sel_place] = i;
                 _gps_node_taken[i]++;
+                _gps_node_listeners[i] |= 1U << sel_place;
                 ret = i + 1;
 
                 debug_uavcan(2, "reg_GPS place:%d, chan: %d\n\r", sel_place, i);
@@ -775,6 +790,7 @@ void AP_UAVCAN::remove_gps_listener(AP_GPS_Backend* rem_listener)
             if (_gps_node_taken[_gps_listener_to_node[i]] > 0) {
                 _gps_node_taken[_gps_listener_to_node[i]]--;
             }
+            _gps_node_listeners[_gps_listener_to_node[i]] &= ~(1U << i);
             _gps_listener_to_node[i] = UINT8_MAX;
         }
     }
@@ -782,17 +798,21 @@ void AP_UAVCAN::remove_gps_listener(AP_GPS_Backend* rem_listener)
 
 AP_GPS::GPS_State *AP_UAVCAN::find_gps_node(uint8_t node)
 {
+    if (node > uavcan::NodeID::Max) {
+        return nullptr;
+    }
+
     // Check if such node is already defined
-    for (uint8_t i = 0; i < AP_UAVCAN_MAX_GPS_NODES; i++) {
-        if (_gps_nodes[i] == node) {
-            return &_gps_node_state[i];
-        }
+    const uint8_t idx = _gps_node_index[node];
+    if (idx != UINT8_MAX) {
+        return &_gps_node_state[idx];
     }
 
     // If not - try to find free space for it
     for (uint8_t i = 0; i < AP_UAVCAN_MAX_GPS_NODES; i++) {
         if (_gps_nodes[i] == UINT8_MAX) {
             _gps_nodes[i] = node;
+            _gps_node_index[node] = i;
             return &_gps_node_state[i];
         }
     }
@@ -803,14 +823,16 @@ AP_GPS::GPS_State *AP_UAVCAN::find_gps_node(uint8_t node)
 
 void AP_UAVCAN::update_gps_state(uint8_t node)
 {
+    const uint8_t i = node_index(_gps_node_index, node);
+    if (i == UINT8_MAX) {
+        return;
+    }
+
     // Go through all listeners of specified node and call their's update methods
-    for (uint8_t i = 0; i < AP_UAVCAN_MAX_GPS_NODES; i++) {
-        if (_gps_nodes[i] == node) {
-            for (uint8_t j = 0; j < AP_UAVCAN_MAX_LISTENERS; j++) {
-                if (_gps_listener_to_node[j] == i) {
-                    _gps_listeners[j]->handle_gnss_msg(_gps_node_state[i]);
-                }
-            }
+    uint8_t listeners = _gps_node_listeners[i];
+    for (uint8_t j = 0; listeners != 0; j++, listeners >>= 1) {
+        if (listeners & 1) {
+            _gps_listeners[j]->handle_gnss_msg(_gps_node_state[i]);
         }
     }
 }
@@ -832,6 +854,7 @@ uint8_t AP_UAVCAN::register_baro_listener(AP_Baro_Backend* new_listener, uint8_t
                 _baro_listeners[sel_place] = new_listener;
                 _baro_listener_to_node[sel_place] = preferred_channel - 1;
                 _baro_node_taken[_baro_listener_to_node[sel_place]]++;
+                _baro_node_listeners[_baro_listener_to_node[sel_place]] |= 1U << sel_place;
                 ret = preferred_channel;
 
                 debug_uavcan(2, "reg_Baro place:%d, chan: %d\n\r", sel_place, preferred_channel);
@@ -842,6 +865,7 @@ uint8_t AP_UAVCAN::register_baro_listener(AP_Baro_Backend* new_listener, uint8_t
                     _baro_listeners[sel_place] = new_listener;
                     _baro_listener_to_node[sel_place] = i;
                     _baro_node_taken[i]++;
+                    _baro_node_listeners[i] |= 1U << sel_place;
                     ret = i + 1;
 
                     debug_uavcan(2, "reg_BARO place:%d, chan: %d\n\r", sel_place, i);
@@ -871,6 +895,7 @@ uint8_t AP_UAVCAN::register_baro_listener_to_node(AP_Baro_Backend* new_listener,
                 _baro_listeners[sel_place] = new_listener;
                 _baro_listener_to_node[sel_place] = i;
                 _baro_node_taken[i]++;
+                _baro_node_listeners[i] |= 1U << sel_place;
                 ret = i + 1;
 
                 debug_uavcan(2, "reg_BARO place:%d, chan: %d\n\r", sel_place, i);
@@ -894,6 +919,7 @@ void AP_UAVCAN::remove_baro_listener(AP_Baro_Backend* rem_listener)
             if (_baro_node_taken[_baro_listener_to_node[i]] > 0) {
                 _baro_node_taken[_baro_listener_to_node[i]]--;
             }
+            _baro_node_listeners[_baro_listener_to_node[i]] &= ~(1U << i);
             _baro_listener_to_node[i] = UINT8_MAX;
         }
     }
@@ -901,11 +927,14 @@ void AP_UAVCAN::remove_baro_listener(AP_Baro_Backend* rem_listener)
 
 AP_UAVCAN::Baro_Info *AP_UAVCAN::find_baro_node(uint8_t node)
 {
+    if (node > uavcan::NodeID::Max) {
+        return nullptr;
+    }
+
     // Check if such node is already defined
-    for (uint8_t i = 0; i < AP_UAVCAN_MAX_BARO_NODES; i++) {
-        if (_baro_nodes[i] == node) {
-            return &_baro_node_state[i];
-        }
+    const uint8_t idx = _baro_node_index[node];
+    if (idx != UINT8_MAX) {
+        return &_baro_node_state[idx];
     }
 
     // If not - try to find free space for it
@@ -913,6 +942,7 @@ AP_UAVCAN::Baro_Info *AP_UAVCAN::find_baro_node(uint8_t node)
         if (_baro_nodes[i] == UINT8_MAX) {
 
             _baro_nodes[i] = node;
+            _baro_node_index[node] = i;
             return &_baro_node_state[i];
         }
     }
@@ -923,14 +953,16 @@ AP_UAVCAN::Baro_Info *AP_UAVCAN::find_baro_node(uint8_t node)
 
 void AP_UAVCAN::update_baro_state(uint8_t node)
 {
+    const uint8_t i = node_index(_baro_node_index, node);
+    if (i == UINT8_MAX) {
+        return;
+    }
+
     // Go through all listeners of specified node and call their's update methods
-    for (uint8_t i = 0; i < AP_UAVCAN_MAX_BARO_NODES; i++) {
-        if (_baro_nodes[i] == node) {
-            for (uint8_t j = 0; j < AP_UAVCAN_MAX_LISTENERS; j++) {
-                if (_baro_listener_to_node[j] == i) {
-                    _baro_listeners[j]->handle_baro_msg(_baro_node_state[i].pressure, _baro_node_state[i].temperature);
-                }
-            }
+    uint8_t listeners = _baro_node_listeners[i];
+    for (uint8_t j = 0; listeners != 0; j++, listeners >>= 1) {
+        if (listeners & 1) {
+            _baro_listeners[j]->handle_baro_msg(_baro_node_state[i].pressure, _baro_node_state[i].temperature);
         }
     }
 }
@@ -967,6 +999,7 @@ uint8_t AP_UAVCAN::register_mag_listener(AP_Compass_Backend* new_listener, uint8
                 _mag_listeners[sel_place] = new_listener;
                 _mag_listener_to_node[sel_place] = preferred_channel - 1;
                 _mag_node_taken[_mag_listener_to_node[sel_place]]++;
+                _mag_node_listeners[_mag_listener_to_node[sel_place]] |= 1U << sel_place;
                 ret = preferred_channel;
 
                 debug_uavcan(2, "reg_Compass place:%d, chan: %d\n\r", sel_place, preferred_channel);
@@ -977,6 +1010,7 @@ uint8_t AP_UAVCAN::register_mag_listener(AP_Compass_Backend* new_listener, uint8
                     _mag_listeners[sel_place] = new_listener;
                     _mag_listener_to_node[sel_place] = i;
                     _mag_node_taken[i]++;
+                    _mag_node_listeners[i] |= 1U << sel_place;
                     ret = i + 1;
 
                     debug_uavcan(2, "reg_MAG place:%d, chan: %d\n\r", sel_place, i);
@@ -1007,6 +1041,7 @@ uint8_t AP_UAVCAN::register_mag_listener_to_node(AP_Compass_Backend* new_listene
                 _mag_listener_to_node[sel_place] = i;
                 _mag_listener_sensor_ids[sel_place] = 0;
                 _mag_node_taken[i]++;
+                _mag_node_listeners[i] |= 1U << sel_place;
                 ret = i + 1;
 
                 debug_uavcan(2, "reg_MAG place:%d, chan: %d\n\r", sel_place, i);
@@ -1029,6 +1064,7 @@ void AP_UAVCAN::remove_mag_listener(AP_Compass_Backend* rem_listener)
             if (_mag_node_taken[_mag_listener_to_node[i]] > 0) {
                 _mag_node_taken[_mag_listener_to_node[i]]--;
             }
+            _mag_node_listeners[_mag_listener_to_node[i]] &= ~(1U << i);
             _mag_listener_to_node[i] = UINT8_MAX;
         }
     }
@@ -1036,21 +1072,25 @@ void AP_UAVCAN::remove_mag_listener(AP_Compass_Backend* rem_listener)
 
 AP_UAVCAN::Mag_Info *AP_UAVCAN::find_mag_node(uint8_t node, uint8_t sensor_id)
 {
+    if (node > uavcan::NodeID::Max) {
+        return nullptr;
+    }
+
     // Check if such node is already defined
-    for (uint8_t i = 0; i < AP_UAVCAN_MAX_MAG_NODES; i++) {
-        if (_mag_nodes[i] == node) {
-            if (_mag_node_max_sensorid_count[i] < sensor_id) {
-                _mag_node_max_sensorid_count[i] = sensor_id;
-                debug_uavcan(2, "AP_UAVCAN: Compass: found sensor id %d on node %d\n\r", (int)(sensor_id), (int)(node));
-            }
-            return &_mag_node_state[i];
+    const uint8_t idx = _mag_node_index[node];
+    if (idx != UINT8_MAX) {
+        if (_mag_node_max_sensorid_count[idx] < sensor_id) {
+            _mag_node_max_sensorid_count[idx] = sensor_id;
+            debug_uavcan(2, "AP_UAVCAN: Compass: found sensor id %d on node %d\n\r", (int)(sensor_id), (int)(node));
         }
+        return &_mag_node_state[idx];
     }
 
     // If not - try to find free space for it
     for (uint8_t i = 0; i < AP_UAVCAN_MAX_MAG_NODES; i++) {
         if (_mag_nodes[i] == UINT8_MAX) {
             _mag_nodes[i] = node;
+            _mag_node_index[node] = i;
             _mag_node_max_sensorid_count[i] = (sensor_id ? sensor_id : 1);
             debug_uavcan(2, "AP_UAVCAN: Compass: register sensor id %d on node %d\n\r", (int)(sensor_id), (int)(node));  
             return &_mag_node_state[i];
@@ -1082,35 +1122,36 @@ uint8_t AP_UAVCAN::find_smallest_free_mag_node()
 
 void AP_UAVCAN::update_mag_state(uint8_t node, uint8_t sensor_id)
 {
+    const uint8_t i = node_index(_mag_node_index, node);
+    if (i == UINT8_MAX) {
+        return;
+    }
+
     // Go through all listeners of specified node and call their's update methods
-    for (uint8_t i = 0; i < AP_UAVCAN_MAX_MAG_NODES; i++) {
-        if (_mag_nodes[i] == node) {
-            for (uint8_t j = 0; j < AP_UAVCAN_MAX_LISTENERS; j++) {
-                if (_mag_listener_to_node[j] == i) {
-                    
-                    /*If the current listener has default sensor_id,
-                      while our sensor_id is not default, we have
-                      to assign our sensor_id to this listener*/ 
-                    if ((_mag_listener_sensor_ids[j] == 0) && (sensor_id != 0)) {
-                        bool already_taken = false;
-                        for (uint8_t k = 0; k < AP_UAVCAN_MAX_LISTENERS; k++) {
-                            if (_mag_listener_sensor_ids[k] == sensor_id) {
-                                already_taken = true;
-                            }
-                        }
-                        if (!already_taken) {
-                            debug_uavcan(2, "AP_UAVCAN: Compass: sensor_id updated to %d for listener %d\n", sensor_id, j);
-                            _mag_listener_sensor_ids[j] = sensor_id;
-                        }
-                    }
-                    
-                    /*If the current listener has the sensor_id that we have,
-                      or our sensor_id is default, ask the listener to handle the measurements
-                      (the default one is used for the nodes that have only one compass*/
-                    if ((sensor_id == 0) || (_mag_listener_sensor_ids[j] == sensor_id)) {
-                        _mag_listeners[j]->handle_mag_msg(_mag_node_state[i].mag_vector);
+    uint8_t listeners = _mag_node_listeners[i];
+    for (uint8_t j = 0; listeners != 0; j++, listeners >>= 1) {
+        if (listeners & 1) {
+            /*If the current listener has default sensor_id,
+              while our sensor_id is not default, we have
+              to assign our sensor_id to this listener*/
+            if ((_mag_listener_sensor_ids[j] == 0) && (sensor_id != 0)) {
+                bool already_taken = false;
+                for (uint8_t k = 0; k < AP_UAVCAN_MAX_LISTENERS; k++) {
+                    if (_mag_listener_sensor_ids[k] == sensor_id) {
+                        already_taken = true;
                     }
                 }
+                if (!already_taken) {
+                    debug_uavcan(2, "AP_UAVCAN: Compass: sensor_id updated to %d for listener %d\n", sensor_id, j);
+                    _mag_listener_sensor_ids[j] = sensor_id;
+                }
+            }
+
+            /*If the current listener has the sensor_id that we have,
+              or our sensor_id is default, ask the listener to handle the measurements
+              (the default one is used for the nodes that have only one compass*/
+            if ((sensor_id == 0) || (_mag_listener_sensor_ids[j] == sensor_id)) {
+                _mag_listeners[j]->handle_mag_msg(_mag_node_state[i].mag_vector);
             }
         }
     }
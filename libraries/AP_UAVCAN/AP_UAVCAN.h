@@ -30,6 +30,7 @@
 #define UAVCAN_RCO_NUMBER 18
 #endif
 
+// at most 8, the listeners of each node are kept in a bitmask
 #define AP_UAVCAN_MAX_LISTENERS 4
 #define AP_UAVCAN_MAX_GPS_NODES 4
 #define AP_UAVCAN_MAX_MAG_NODES 4
@@ -103,11 +104,22 @@ public:
     void rc_out_send_esc();
 
 private:
+    // Index of the source with UAVCAN node ID node in one of the
+    // _xxx_node_index tables, 255 if there is none
+    static uint8_t node_index(const uint8_t *index_table, uint8_t node)
+    {
+        return node <= uavcan::NodeID::Max ? index_table[node] : UINT8_MAX;
+    }
+
     // ------------------------- GPS
     // 255 - means free node
     uint8_t _gps_nodes[AP_UAVCAN_MAX_GPS_NODES];
+    // Source of each node ID, so received messages don't search _gps_nodes
+    uint8_t _gps_node_index[uavcan::NodeID::Max + 1];
     // Counter of how many listeners are connected to this source
     uint8_t _gps_node_taken[AP_UAVCAN_MAX_GPS_NODES];
+    // Bitmask of the listeners connected to this source
+    uint8_t _gps_node_listeners[AP_UAVCAN_MAX_GPS_NODES];
     // GPS data of the sources
     AP_GPS::GPS_State _gps_node_state[AP_UAVCAN_MAX_GPS_NODES];
 
@@ -118,14 +130,18 @@ private:
 
     // ------------------------- BARO
     uint8_t _baro_nodes[AP_UAVCAN_MAX_BARO_NODES];
+    uint8_t _baro_node_index[uavcan::NodeID::Max + 1];
     uint8_t _baro_node_taken[AP_UAVCAN_MAX_BARO_NODES];
+    uint8_t _baro_node_listeners[AP_UAVCAN_MAX_BARO_NODES];
     Baro_Info _baro_node_state[AP_UAVCAN_MAX_BARO_NODES];
     uint8_t _baro_listener_to_node[AP_UAVCAN_MAX_LISTENERS];
     AP_Baro_Backend* _baro_listeners[AP_UAVCAN_MAX_LISTENERS];
 
     // ------------------------- MAG
     uint8_t _mag_nodes[AP_UAVCAN_MAX_MAG_NODES];
+    uint8_t _mag_node_index[uavcan::NodeID::Max + 1];
     uint8_t _mag_node_taken[AP_UAVCAN_MAX_MAG_NODES];
+    uint8_t _mag_node_listeners[AP_UAVCAN_MAX_MAG_NODES];
     Mag_Info _mag_node_state[AP_UAVCAN_MAX_MAG_NODES];
     uint8_t _mag_node_max_sensorid_count[AP_UAVCAN_MAX_MAG_NODES];
     uint8_t _mag_listener_to_node[AP_UAVCAN_MAX_LISTENERS];
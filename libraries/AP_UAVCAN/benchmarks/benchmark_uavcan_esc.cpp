@@ -0,0 +1,132 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_WITH_UAVCAN && CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <AP_HAL_Linux/CAN.h>
+#include <uavcan/uavcan.hpp>
+#include <uavcan/equipment/esc/RawCommand.hpp>
+
+#include <linux/can.h>
+#include <unistd.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  ESC commands published through libuavcan and the SocketCAN driver, as
+  AP_UAVCAN::rc_out_send_esc() does, on a virtual CAN interface set up with:
+
+    ip link add dev vcan0 type vcan && ip link set up vcan0
+
+  Each iteration is the time from broadcasting the command until its last
+  frame is read by another socket on the bus, so it is the output latency,
+  and the items processed are the frames on the bus.
+ */
+#define BENCH_CAN_IFACE "vcan0"
+#define BENCH_NODE_ID   10
+
+class BenchClock : public uavcan::ISystemClock {
+public:
+    uavcan::MonotonicTime getMonotonic() const override
+    {
+        return uavcan::MonotonicTime::fromUSec(AP_HAL::micros64());
+    }
+
+    uavcan::UtcTime getUtc() const override
+    {
+        return uavcan::UtcTime::fromUSec(AP_HAL::micros64());
+    }
+
+    void adjustUtc(uavcan::UtcDuration) override { }
+};
+
+static void BM_UAVCANRawCommand(benchmark::State& state)
+{
+    static const int cmd_max = uavcan::equipment::esc::RawCommand::FieldTypes::cmd::RawValueType::max();
+    static const uint16_t dtid = uavcan::equipment::esc::RawCommand::DefaultDataTypeID;
+
+    Linux::CANManager can_mgr;
+    if (can_mgr.addIface(BENCH_CAN_IFACE) < 0) {
+        fprintf(stderr, "error: couldn't open " BENCH_CAN_IFACE "\n");
+        return;
+    }
+
+    const int rx_fd = Linux::CAN::openSocket(BENCH_CAN_IFACE);
+    if (rx_fd < 0) {
+        fprintf(stderr, "error: couldn't open second socket on " BENCH_CAN_IFACE "\n");
+        return;
+    }
+
+    BenchClock clock;
+    uavcan::PoolAllocator<UAVCAN_NODE_POOL_SIZE, UAVCAN_NODE_POOL_BLOCK_SIZE> allocator;
+    uavcan::Node<0> node(can_mgr, clock, allocator);
+    node.setNodeID(uavcan::NodeID(BENCH_NODE_ID));
+
+    uavcan::Publisher<uavcan::equipment::esc::RawCommand> esc_raw(node);
+    esc_raw.setTxTimeout(uavcan::MonotonicDuration::fromMSec(20));
+    esc_raw.setPriority(uavcan::TransferPriority::OneLowerThanHighest);
+
+    uavcan::equipment::esc::RawCommand msg;
+    for (int i = 0; i < state.range_x(); i++) {
+        msg.cmd.push_back(cmd_max / 2);
+    }
+
+    uint64_t frames = 0;
+    while (state.KeepRunning()) {
+        esc_raw.broadcast(msg);
+
+        // spin until the frame with the end of transfer bit is on the bus
+        const uint64_t start_usec = AP_HAL::micros64();
+        bool done = false;
+        while (!done) {
+            node.spinOnce();
+
+            can_frame frame;
+            while (read(rx_fd, &frame, sizeof(frame)) == sizeof(frame)) {
+                if (((frame.can_id >> 8) & 0xFFFF) != dtid || frame.can_dlc == 0) {
+                    continue;
+                }
+                frames++;
+                if (frame.data[frame.can_dlc - 1] & 0x40) {
+                    done = true;
+                }
+            }
+
+            if (!done && AP_HAL::micros64() - start_usec > 1000000) {
+                fprintf(stderr, "error: command not seen on " BENCH_CAN_IFACE "\n");
+                close(rx_fd);
+                return;
+            }
+        }
+    }
+
+    close(rx_fd);
+
+    state.SetItemsProcessed(frames);
+
+    char label[32];
+    snprintf(label, sizeof(label), "%.1f frames/command",
+             state.iterations() ? (double)frames / state.iterations() : 0.0);
+    state.SetLabel(label);
+}
+
+// 4 ESCs fit in one frame, 8 take 3 and 12 take 4
+BENCHMARK(BM_UAVCANRawCommand)->Arg(4)->Arg(8)->Arg(12);
+
+#endif
+
+BENCHMARK_MAIN()
@@ -306,12 +306,21 @@ bool DataFlash_Backend::Log_Write_Parameter(const AP_Param *ap,
 // Write an GPS packet
 void DataFlash_Class::Log_Write_GPS(const AP_GPS &gps, uint8_t i, uint64_t time_us)
 {
+    // log messages exist for the first two receivers and the blended instance only
+    uint8_t msg_offset;
+    if (i == GPS_BLENDED_INSTANCE) {
+        msg_offset = LOG_GPSB_MSG - LOG_GPS_MSG;
+    } else if (i <= LOG_GPS2_MSG - LOG_GPS_MSG) {
+        msg_offset = i;
+    } else {
+        return;
+    }
     if (time_us == 0) {
         time_us = AP_HAL::micros64();
     }
     const struct Location &loc = gps.location(i);
     struct log_GPS pkt = {
-        LOG_PACKET_HEADER_INIT((uint8_t)(LOG_GPS_MSG+i)),
+        LOG_PACKET_HEADER_INIT((uint8_t)(LOG_GPS_MSG+msg_offset)),
         time_us       : time_us,
         status        : (uint8_t)gps.status(i),
         gps_week_ms   : gps.time_week_ms(i),
@@ -334,7 +343,7 @@ void DataFlash_Class::Log_Write_GPS(const AP_GPS &gps, uint8_t i, uint64_t time_
     gps.vertical_accuracy(i, vacc);
     gps.speed_accuracy(i, sacc);
     struct log_GPA pkt2 = {
-        LOG_PACKET_HEADER_INIT((uint8_t)(LOG_GPA_MSG+i)),
+        LOG_PACKET_HEADER_INIT((uint8_t)(LOG_GPA_MSG+msg_offset)),
         time_us       : time_us,
         vdop          : gps.get_vdop(i),
         hacc          : (uint16_t)MIN((hacc*100), UINT16_MAX),
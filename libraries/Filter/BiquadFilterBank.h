@@ -0,0 +1,232 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file   BiquadFilterBank.h
+/// @brief  Cascaded biquad filters applied to several channels at once, e.g. the
+///         axes of one or more IMUs.
+///
+///         The state of each stage is stored as one array per delay element, with
+///         channels padded to a multiple of BIQUAD_BANK_LANES, so the inner loop over
+///         channels maps directly onto SIMD registers when built with -O3. Stages use
+///         direct form I, holding past inputs and outputs rather than internal states,
+///         so coefficients can be changed between samples without transients.
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+#include <string.h>
+
+#define BIQUAD_BANK_LANES   4   // channels are padded to a multiple of this
+
+// normalised coefficients of one biquad stage, a0 is one
+struct BiquadCoefficients {
+    float b0, b1, b2;
+    float a1, a2;
+
+    void set_pass_through() {
+        b0 = 1.0f;
+        b1 = b2 = a1 = a2 = 0.0f;
+    }
+};
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+class BiquadFilterBank {
+public:
+    typedef BiquadCoefficients coefficients;
+
+    BiquadFilterBank();
+
+    // calculate coefficients matching LowPassFilter2p and NotchFilter. A zero
+    // cutoff or center frequency gives a pass through stage
+    static void compute_lowpass(float sample_freq, float cutoff_freq, coefficients &ret);
+    static void compute_notch(float sample_freq, float center_freq_hz, float bandwidth_hz, float attenuation_dB, coefficients &ret);
+
+    // change the coefficients of a stage. The change takes effect at the start
+    // of the next call to apply() so no sample sees a partially updated bank
+    void set_stage(uint8_t stage, const coefficients &coeffs);
+    void set_lowpass(uint8_t stage, float sample_freq, float cutoff_freq);
+    void set_notch(uint8_t stage, float sample_freq, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
+    void set_pass_through(uint8_t stage);
+
+    // filter one sample of every channel through all stages
+    void apply(const float in[CHANNELS], float out[CHANNELS]);
+
+    // filter the three axes of one sensor, only for banks with three channels
+    Vector3f apply(const Vector3f &sample);
+
+    // clear the state of all stages
+    void reset();
+
+private:
+    static_assert(STAGES <= 32, "too many stages");
+
+    static const uint8_t LANES = ((CHANNELS + BIQUAD_BANK_LANES - 1) / BIQUAD_BANK_LANES) * BIQUAD_BANK_LANES;
+
+    struct stage_state {
+        float x1[LANES];
+        float x2[LANES];
+        float y1[LANES];
+        float y2[LANES];
+    };
+
+    stage_state _state[STAGES];
+    coefficients _coeffs[STAGES];
+    coefficients _pending_coeffs[STAGES];
+    uint32_t _pending_mask;
+};
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+BiquadFilterBank<CHANNELS, STAGES>::BiquadFilterBank() :
+    _pending_mask(0)
+{
+    for (uint8_t i = 0; i < STAGES; i++) {
+        _coeffs[i].set_pass_through();
+    }
+    reset();
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::compute_lowpass(float sample_freq, float cutoff_freq, coefficients &ret)
+{
+    if (!is_positive(cutoff_freq) || !is_positive(sample_freq)) {
+        ret.set_pass_through();
+        return;
+    }
+
+    // same design as DigitalBiquadFilter::compute_params()
+    const float fr = sample_freq / cutoff_freq;
+    const float ohm = tanf(M_PI / fr);
+    const float c = 1.0f + 2.0f * cosf(M_PI / 4.0f) * ohm + ohm * ohm;
+
+    ret.b0 = ohm * ohm / c;
+    ret.b1 = 2.0f * ret.b0;
+    ret.b2 = ret.b0;
+    ret.a1 = 2.0f * (ohm * ohm - 1.0f) / c;
+    ret.a2 = (1.0f - 2.0f * cosf(M_PI / 4.0f) * ohm + ohm * ohm) / c;
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::compute_notch(float sample_freq, float center_freq_hz, float bandwidth_hz, float attenuation_dB, coefficients &ret)
+{
+    if (!is_positive(center_freq_hz) || !is_positive(sample_freq) || !is_positive(bandwidth_hz) ||
+        center_freq_hz <= bandwidth_hz * 0.5f) {
+        ret.set_pass_through();
+        return;
+    }
+
+    // same design as NotchFilter::init(), normalised by a0
+    const float omega = 2.0f * M_PI * center_freq_hz / sample_freq;
+    const float octaves = log2f(center_freq_hz / (center_freq_hz - bandwidth_hz * 0.5f)) * 2.0f;
+    const float A = powf(10, -attenuation_dB / 40.0f);
+    const float Q = sqrtf(powf(2, octaves)) / (powf(2, octaves) - 1.0f);
+    const float alpha = sinf(omega) / (2.0f * Q / A);
+    const float a0_inv = 1.0f / (1.0f + alpha / A);
+
+    ret.b0 = (1.0f + alpha * A) * a0_inv;
+    ret.b1 = -2.0f * cosf(omega) * a0_inv;
+    ret.b2 = (1.0f - alpha * A) * a0_inv;
+    ret.a1 = ret.b1;
+    ret.a2 = (1.0f - alpha / A) * a0_inv;
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::set_stage(uint8_t stage, const coefficients &coeffs)
+{
+    if (stage >= STAGES) {
+        return;
+    }
+    _pending_coeffs[stage] = coeffs;
+    _pending_mask |= (1U << stage);
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::set_lowpass(uint8_t stage, float sample_freq, float cutoff_freq)
+{
+    coefficients coeffs;
+    compute_lowpass(sample_freq, cutoff_freq, coeffs);
+    set_stage(stage, coeffs);
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::set_notch(uint8_t stage, float sample_freq, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
+{
+    coefficients coeffs;
+    compute_notch(sample_freq, center_freq_hz, bandwidth_hz, attenuation_dB, coeffs);
+    set_stage(stage, coeffs);
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::set_pass_through(uint8_t stage)
+{
+    coefficients coeffs;
+    coeffs.set_pass_through();
+    set_stage(stage, coeffs);
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::apply(const float in[CHANNELS], float out[CHANNELS])
+{
+    // pick up changed coefficients between samples
+    if (_pending_mask != 0) {
+        for (uint8_t s = 0; s < STAGES; s++) {
+            if (_pending_mask & (1U << s)) {
+                _coeffs[s] = _pending_coeffs[s];
+            }
+        }
+        _pending_mask = 0;
+    }
+
+    float x[LANES];
+    memcpy(x, in, CHANNELS * sizeof(float));
+    for (uint8_t l = CHANNELS; l < LANES; l++) {
+        x[l] = 0.0f;
+    }
+
+    // pass through stages are run like any other so their history
+    // follows the signal, and enabling them later does not cause a step
+    for (uint8_t s = 0; s < STAGES; s++) {
+        const float b0 = _coeffs[s].b0;
+        const float b1 = _coeffs[s].b1;
+        const float b2 = _coeffs[s].b2;
+        const float a1 = _coeffs[s].a1;
+        const float a2 = _coeffs[s].a2;
+        stage_state &st = _state[s];
+        for (uint8_t l = 0; l < LANES; l++) {
+            const float y = b0 * x[l] + b1 * st.x1[l] + b2 * st.x2[l] - a1 * st.y1[l] - a2 * st.y2[l];
+            st.x2[l] = st.x1[l];
+            st.x1[l] = x[l];
+            st.y2[l] = st.y1[l];
+            st.y1[l] = y;
+            x[l] = y;
+        }
+    }
+
+    memcpy(out, x, CHANNELS * sizeof(float));
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+Vector3f BiquadFilterBank<CHANNELS, STAGES>::apply(const Vector3f &sample)
+{
+    static_assert(CHANNELS == 3, "Vector3f samples need a bank with three channels");
+    const float in[CHANNELS] = { sample.x, sample.y, sample.z };
+    float out[CHANNELS];
+    apply(in, out);
+    return Vector3f(out[0], out[1], out[2]);
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::reset()
+{
+    memset(_state, 0, sizeof(_state));
+}
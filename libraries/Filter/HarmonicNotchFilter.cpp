@@ -0,0 +1,209 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HarmonicNotchFilter.h"
+
+HarmonicNotch::HarmonicNotch()
+{
+    memset(_multiplier, 0, sizeof(_multiplier));
+    memset(_omega, 0, sizeof(_omega));
+    _sample_freq_hz = 0;
+    _bandwidth_ratio = 0;
+    _attenuation_dB = 0;
+    _harmonics = 0;
+    _A = 1;
+    _alpha_scale = 0;
+    _updates_since_full = 0;
+    for (uint8_t i = 0; i < HNF_MAX_HARMONICS; i++) {
+        _coeffs[i].set_pass_through();
+    }
+}
+
+/*
+  set sample rate and notch shape
+ */
+void HarmonicNotch::configure(float sample_freq_hz, float bandwidth_ratio, float attenuation_dB, uint8_t harmonics)
+{
+    if (is_equal(sample_freq_hz, _sample_freq_hz) &&
+        is_equal(bandwidth_ratio, _bandwidth_ratio) &&
+        is_equal(attenuation_dB, _attenuation_dB) &&
+        harmonics == _harmonics) {
+        return;
+    }
+    _sample_freq_hz = sample_freq_hz;
+    _bandwidth_ratio = bandwidth_ratio;
+    _attenuation_dB = attenuation_dB;
+    _harmonics = harmonics;
+
+    // everything is recalculated on the next update
+    memset(_multiplier, 0, sizeof(_multiplier));
+    memset(_omega, 0, sizeof(_omega));
+    for (uint8_t i = 0; i < HNF_MAX_HARMONICS; i++) {
+        _coeffs[i].set_pass_through();
+    }
+
+    if (!is_positive(sample_freq_hz) || !is_positive(bandwidth_ratio) || bandwidth_ratio >= 2.0f) {
+        return;
+    }
+
+    // with the bandwidth proportional to frequency the notch shape does
+    // not depend on the frequency, see NotchFilter::init()
+    const float octaves = log2f(1.0f / (1.0f - bandwidth_ratio * 0.5f)) * 2.0f;
+    const float Q = sqrtf(powf(2, octaves)) / (powf(2, octaves) - 1.0f);
+    _A = powf(10, -attenuation_dB / 40.0f);
+    _alpha_scale = _A / (2.0f * Q);
+
+    uint8_t notch = 0;
+    for (uint8_t bit = 0; bit < 8 && notch < HNF_MAX_HARMONICS; bit++) {
+        if (harmonics & (1U << bit)) {
+            _multiplier[notch++] = bit + 1;
+        }
+    }
+}
+
+/*
+  move the notches to harmonics of base_freq_hz
+ */
+void HarmonicNotch::update(float base_freq_hz)
+{
+    const bool full_update = (_updates_since_full >= HNF_FULL_UPDATE_INTERVAL);
+    if (full_update) {
+        _updates_since_full = 0;
+    } else {
+        _updates_since_full++;
+    }
+
+    for (uint8_t i = 0; i < HNF_MAX_HARMONICS; i++) {
+        if (_multiplier[i] == 0) {
+            continue;
+        }
+        const float freq_hz = base_freq_hz * _multiplier[i];
+        if (!is_positive(freq_hz) || freq_hz > _sample_freq_hz * HNF_MAX_FREQ_RATIO) {
+            // out of range, leave the signal alone
+            if (is_positive(_omega[i])) {
+                _coeffs[i].set_pass_through();
+                _omega[i] = 0;
+            }
+            continue;
+        }
+
+        const float omega = M_2PI * freq_hz / _sample_freq_hz;
+        const float delta = omega - _omega[i];
+        float c, s;
+        if (is_positive(_omega[i]) && fabsf(delta) < 0.1f && !full_update) {
+            if (is_zero(delta)) {
+                continue;
+            }
+            // rotate by delta using the series for its cosine and sine,
+            // then pull back onto the unit circle
+            const float delta_sq = delta * delta;
+            const float cos_delta = 1.0f - delta_sq * 0.5f * (1.0f - delta_sq * (1.0f / 12.0f));
+            const float sin_delta = delta * (1.0f - delta_sq * (1.0f / 6.0f));
+            c = _cos_omega[i] * cos_delta - _sin_omega[i] * sin_delta;
+            s = _sin_omega[i] * cos_delta + _cos_omega[i] * sin_delta;
+            const float scale = 1.5f - 0.5f * (c * c + s * s);
+            c *= scale;
+            s *= scale;
+        } else {
+            c = cosf(omega);
+            s = sinf(omega);
+        }
+        _omega[i] = omega;
+        _cos_omega[i] = c;
+        _sin_omega[i] = s;
+        set_coefficients(i, c, s);
+    }
+}
+
+/*
+  calculate coefficients from the cosine and sine of the notch frequency
+ */
+void HarmonicNotch::set_coefficients(uint8_t notch, float cos_omega, float sin_omega)
+{
+    const float alpha = sin_omega * _alpha_scale;
+    const float a0_inv = 1.0f / (1.0f + alpha / _A);
+    BiquadCoefficients &c = _coeffs[notch];
+    c.b0 = (1.0f + alpha * _A) * a0_inv;
+    c.b1 = -2.0f * cos_omega * a0_inv;
+    c.b2 = (1.0f - alpha * _A) * a0_inv;
+    c.a1 = c.b1;
+    c.a2 = (1.0f - alpha / _A) * a0_inv;
+}
+
+// table of user settable parameters
+const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
+
+    // @Param: ENABLE
+    // @DisplayName: Harmonic Notch Filter enable
+    // @Description: Enable harmonic notch filter on the raw gyro samples
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO_FLAGS("ENABLE", 1, HarmonicNotchFilterParams, _enable, 0, AP_PARAM_FLAG_ENABLE),
+
+    // @Param: FREQ
+    // @DisplayName: Harmonic Notch Filter base frequency
+    // @Description: Notch base center frequency in Hz. With throttle tracking this is the frequency at the reference throttle, and the notch does not go below it
+    // @Range: 10 400
+    // @Units: Hz
+    // @User: Advanced
+    AP_GROUPINFO("FREQ", 2, HarmonicNotchFilterParams, _center_freq_hz, 80),
+
+    // @Param: BW
+    // @DisplayName: Harmonic Notch Filter bandwidth
+    // @Description: Notch bandwidth in Hz at the base frequency. The bandwidth scales with the frequency of each notch
+    // @Range: 5 100
+    // @Units: Hz
+    // @User: Advanced
+    AP_GROUPINFO("BW", 3, HarmonicNotchFilterParams, _bandwidth_hz, 40),
+
+    // @Param: ATT
+    // @DisplayName: Harmonic Notch Filter attenuation
+    // @Description: Notch attenuation in dB
+    // @Range: 5 30
+    // @Units: dB
+    // @User: Advanced
+    AP_GROUPINFO("ATT", 4, HarmonicNotchFilterParams, _attenuation_dB, 15),
+
+    // @Param: HMNCS
+    // @DisplayName: Harmonic Notch Filter harmonics
+    // @Description: Bitmask of harmonics to apply notches to, up to three notches are used
+    // @Bitmask: 0:1st harmonic,1:2nd harmonic,2:3rd harmonic,3:4th harmonic,4:5th harmonic,5:6th harmonic
+    // @User: Advanced
+    AP_GROUPINFO("HMNCS", 5, HarmonicNotchFilterParams, _harmonics, 3),
+
+    // @Param: REF
+    // @DisplayName: Harmonic Notch Filter reference value
+    // @Description: With throttle tracking, the throttle at which the base frequency is measured, zero to use the learned hover throttle. With RPM tracking, a scale factor applied to the measured rotation rate, for example a gear ratio, zero for none
+    // @Range: 0 10
+    // @User: Advanced
+    AP_GROUPINFO("REF", 6, HarmonicNotchFilterParams, _reference, 0),
+
+    // @Param: MODE
+    // @DisplayName: Harmonic Notch Filter tracking mode
+    // @Description: Source of the harmonic notch base frequency
+    // @Values: 0:Fixed,1:Throttle,2:RPM Sensor
+    // @User: Advanced
+    AP_GROUPINFO("MODE", 7, HarmonicNotchFilterParams, _mode, Tracking_Throttle),
+
+    AP_GROUPEND
+};
+
+/*
+  a harmonic notch filter's parameters - constructor
+ */
+HarmonicNotchFilterParams::HarmonicNotchFilterParams(void)
+{
+    AP_Param::setup_object_defaults(this, var_info);
+}
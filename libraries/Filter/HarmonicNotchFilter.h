@@ -0,0 +1,112 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  notch filters on harmonics of a frequency that changes in flight,
+  such as the rotation rate of the motors.
+
+  The bandwidth is kept proportional to the centre frequency, so only
+  the cosine and sine of each notch's frequency change as it moves. These
+  are advanced by a small rotation from the last frequency rather than
+  recalculated, with a full recalculation after large steps and every
+  HNF_FULL_UPDATE_INTERVAL updates to bound rounding errors.
+ */
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+#include "BiquadFilterBank.h"
+
+#define HNF_MAX_HARMONICS           3       // maximum number of notches
+#define HNF_MAX_FREQ_RATIO          0.4f    // notches above this fraction of the sample rate are disabled
+#define HNF_FULL_UPDATE_INTERVAL    256     // updates between full recalculations of each notch
+
+/*
+  coefficients of notches at up to HNF_MAX_HARMONICS harmonics of a base frequency
+ */
+class HarmonicNotch {
+public:
+    HarmonicNotch();
+
+    // set sample rate and notch shape. bandwidth_ratio is the bandwidth
+    // divided by the centre frequency. harmonics is a bitmask with bit 0
+    // for the base frequency, bit 1 for the 2nd harmonic and so on.
+    // Notches are recalculated in full if anything has changed
+    void configure(float sample_freq_hz, float bandwidth_ratio, float attenuation_dB, uint8_t harmonics);
+
+    // move the notches to harmonics of base_freq_hz
+    void update(float base_freq_hz);
+
+    // coefficients of each notch, pass through for unused notches
+    const BiquadCoefficients &get_coefficients(uint8_t notch) const { return _coeffs[notch]; }
+
+private:
+    // calculate coefficients from the cosine and sine of the notch frequency
+    void set_coefficients(uint8_t notch, float cos_omega, float sin_omega);
+
+    float _sample_freq_hz;
+    float _bandwidth_ratio;
+    float _attenuation_dB;
+    uint8_t _harmonics;
+
+    // constant shape terms, A and A / 2Q from NotchFilter
+    float _A;
+    float _alpha_scale;
+
+    // harmonic multiplier of each notch, zero if unused
+    uint8_t _multiplier[HNF_MAX_HARMONICS];
+
+    // current frequency of each notch in radians per sample, zero if not set
+    float _omega[HNF_MAX_HARMONICS];
+    float _cos_omega[HNF_MAX_HARMONICS];
+    float _sin_omega[HNF_MAX_HARMONICS];
+    uint16_t _updates_since_full;
+
+    BiquadCoefficients _coeffs[HNF_MAX_HARMONICS];
+};
+
+/*
+  harmonic notch filter parameters
+ */
+class HarmonicNotchFilterParams {
+public:
+    // source of the base frequency
+    enum Tracking_Mode {
+        Tracking_Fixed    = 0,
+        Tracking_Throttle = 1,
+        Tracking_RPM      = 2,
+    };
+
+    HarmonicNotchFilterParams(void);
+
+    bool enabled(void) const { return _enable != 0; }
+    float center_freq_hz(void) const { return _center_freq_hz; }
+    float bandwidth_hz(void) const { return _bandwidth_hz; }
+    float attenuation_dB(void) const { return _attenuation_dB; }
+    uint8_t harmonics(void) const { return _harmonics; }
+    float reference(void) const { return _reference; }
+    Tracking_Mode tracking_mode(void) const { return (Tracking_Mode)_mode.get(); }
+
+    static const struct AP_Param::GroupInfo var_info[];
+
+private:
+    AP_Int8 _enable;
+    AP_Float _center_freq_hz;
+    AP_Float _bandwidth_hz;
+    AP_Float _attenuation_dB;
+    AP_Int8 _harmonics;
+    AP_Float _reference;
+    AP_Int8 _mode;
+};
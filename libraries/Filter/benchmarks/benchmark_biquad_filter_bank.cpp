@@ -0,0 +1,81 @@
+#include <AP_gbenchmark.h>
+
+#include <Filter/BiquadFilterBank.h>
+#include <Filter/LowPassFilter2p.h>
+
+/*
+  a low pass and three notches on the gyros of three IMUs, as one bank
+  and as chained DigitalBiquadFilter objects. Each iteration filters one
+  sample of all nine axes
+ */
+#define BENCH_IMUS      3
+#define BENCH_STAGES    4
+#define BENCH_RATE_HZ   8000
+
+static void BM_BiquadFilterBank(benchmark::State& state)
+{
+    BiquadFilterBank<BENCH_IMUS * 3, BENCH_STAGES> bank;
+    bank.set_lowpass(0, BENCH_RATE_HZ, 80);
+    for (uint8_t s = 1; s < BENCH_STAGES; s++) {
+        bank.set_notch(s, BENCH_RATE_HZ, 120 * s, 40, 30);
+    }
+    float sample[BENCH_IMUS * 3];
+    float out[BENCH_IMUS * 3];
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        n++;
+        for (uint8_t i = 0; i < BENCH_IMUS * 3; i++) {
+            sample[i] = (float)((n + i) & 0xFF);
+        }
+        bank.apply(sample, out);
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_DigitalBiquadFilterChain(benchmark::State& state)
+{
+    // each LowPassFilter2p wraps one DigitalBiquadFilter. Notches have the
+    // same biquad structure, so low pass stages are representative of the cost
+    LowPassFilter2pVector3f filters[BENCH_IMUS][BENCH_STAGES];
+    for (uint8_t i = 0; i < BENCH_IMUS; i++) {
+        for (uint8_t s = 0; s < BENCH_STAGES; s++) {
+            filters[i][s].set_cutoff_frequency(BENCH_RATE_HZ, 80 * (s + 1));
+        }
+    }
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        n++;
+        for (uint8_t i = 0; i < BENCH_IMUS; i++) {
+            Vector3f v((float)((n + i) & 0xFF), (float)((n + i + 1) & 0xFF), (float)((n + i + 2) & 0xFF));
+            for (uint8_t s = 0; s < BENCH_STAGES; s++) {
+                v = filters[i][s].apply(v);
+            }
+            gbenchmark_escape(&v);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// one IMU at a time, as AP_InertialSensor_Backend filters each sample
+static void BM_BiquadFilterBankVector3f(benchmark::State& state)
+{
+    BiquadFilterBank<3, BENCH_STAGES> bank;
+    bank.set_lowpass(0, BENCH_RATE_HZ, 80);
+    for (uint8_t s = 1; s < BENCH_STAGES; s++) {
+        bank.set_notch(s, BENCH_RATE_HZ, 120 * s, 40, 30);
+    }
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        n++;
+        Vector3f v = bank.apply(Vector3f((float)(n & 0xFF), (float)((n + 1) & 0xFF), (float)((n + 2) & 0xFF)));
+        gbenchmark_escape(&v);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BiquadFilterBank);
+BENCHMARK(BM_DigitalBiquadFilterChain);
+BENCHMARK(BM_BiquadFilterBankVector3f);
+
+BENCHMARK_MAIN()
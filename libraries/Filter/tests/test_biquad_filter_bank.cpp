@@ -0,0 +1,83 @@
+#include <AP_gtest.h>
+
+#include <Filter/BiquadFilterBank.h>
+#include <Filter/LowPassFilter2p.h>
+#include <Filter/NotchFilter.h>
+
+// each stage must give the same output as the existing single filters
+TEST(BiquadFilterBankTest, matches_single_filters)
+{
+    BiquadFilterBank<3, 2> bank;
+    bank.set_lowpass(0, 1000, 80);
+    bank.set_notch(1, 1000, 120, 40, 20);
+
+    LowPassFilter2pVector3f lpf(1000, 80);
+    NotchFilterVector3f notch;
+    notch.init(1000, 120, 40, 20);
+
+    for (uint16_t i = 0; i < 500; i++) {
+        const Vector3f sample(sinf(i * 0.37f), cosf(i * 0.11f), (i % 17) * 0.1f);
+        const Vector3f expected = notch.apply(lpf.apply(sample));
+        const Vector3f out = bank.apply(sample);
+        EXPECT_NEAR(expected.x, out.x, 1.0e-4f);
+        EXPECT_NEAR(expected.y, out.y, 1.0e-4f);
+        EXPECT_NEAR(expected.z, out.z, 1.0e-4f);
+    }
+}
+
+// channels do not affect each other, including those sharing a SIMD lane group
+TEST(BiquadFilterBankTest, channels_independent)
+{
+    BiquadFilterBank<9, 3> bank;
+    BiquadFilterBank<3, 3> single;
+    for (uint8_t s = 0; s < 3; s++) {
+        bank.set_notch(s, 2000, 100 * (s + 1), 30, 25);
+        single.set_notch(s, 2000, 100 * (s + 1), 30, 25);
+    }
+
+    for (uint16_t i = 0; i < 200; i++) {
+        float in[9];
+        float out[9];
+        for (uint8_t c = 0; c < 9; c++) {
+            in[c] = (c == 7) ? sinf(i * 0.5f) : 0.0f;
+        }
+        bank.apply(in, out);
+        const Vector3f expected = single.apply(Vector3f(0, in[7], 0));
+        for (uint8_t c = 0; c < 9; c++) {
+            EXPECT_FLOAT_EQ((c == 7) ? expected.y : 0.0f, out[c]);
+        }
+    }
+}
+
+// stages are pass through until set, and changing them on a steady signal
+// does not disturb the output
+TEST(BiquadFilterBankTest, retune_without_step)
+{
+    BiquadFilterBank<1, 2> bank;
+    float in = 3.0f;
+    float out = 0.0f;
+    bank.apply(&in, &out);
+    EXPECT_FLOAT_EQ(3.0f, out);
+
+    for (uint16_t i = 0; i < 100; i++) {
+        bank.apply(&in, &out);
+    }
+
+    // enable both stages, then keep moving the notch
+    bank.set_lowpass(0, 1000, 50);
+    bank.set_notch(1, 1000, 100, 20, 30);
+    for (uint16_t i = 0; i < 200; i++) {
+        bank.set_notch(1, 1000, 100 + i * 0.5f, 20, 30);
+        bank.apply(&in, &out);
+        EXPECT_NEAR(3.0f, out, 1.0e-4f);
+    }
+
+    bank.reset();
+    bank.set_pass_through(0);
+    bank.set_pass_through(1);
+    in = -1.0f;
+    bank.apply(&in, &out);
+    EXPECT_FLOAT_EQ(-1.0f, out);
+}
+
+AP_GTEST_MAIN()
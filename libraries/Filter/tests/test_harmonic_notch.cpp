@@ -0,0 +1,58 @@
+#include <AP_gtest.h>
+
+#include <Filter/HarmonicNotchFilter.h>
+
+typedef BiquadFilterBank<1, 1> SingleBiquad;
+
+static void expect_coeffs_near(const BiquadCoefficients &expected, const BiquadCoefficients &c, float tolerance)
+{
+    EXPECT_NEAR(expected.b0, c.b0, tolerance);
+    EXPECT_NEAR(expected.b1, c.b1, tolerance);
+    EXPECT_NEAR(expected.b2, c.b2, tolerance);
+    EXPECT_NEAR(expected.a1, c.a1, tolerance);
+    EXPECT_NEAR(expected.a2, c.a2, tolerance);
+}
+
+// notches moved in small steps must match a full calculation at each harmonic
+TEST(HarmonicNotchTest, incremental_matches_full)
+{
+    HarmonicNotch notch;
+    notch.configure(1000, 0.5f, 20, 0x7);
+
+    float freq = 60.0f;
+    for (uint16_t i = 0; i < 1000; i++) {
+        freq = 60.0f + 40.0f * sinf(i * 0.01f);
+        notch.update(freq);
+    }
+
+    for (uint8_t h = 0; h < HNF_MAX_HARMONICS; h++) {
+        BiquadCoefficients expected;
+        const float f = freq * (h + 1);
+        SingleBiquad::compute_notch(1000, f, 0.5f * f, 20, expected);
+        expect_coeffs_near(expected, notch.get_coefficients(h), 1.0e-4f);
+    }
+}
+
+// harmonics above the usable range and unused notches pass the signal through
+TEST(HarmonicNotchTest, out_of_range_pass_through)
+{
+    HarmonicNotch notch;
+    notch.configure(1000, 0.5f, 20, 0x5);
+    notch.update(150);
+
+    BiquadCoefficients pass;
+    pass.set_pass_through();
+    BiquadCoefficients expected;
+    SingleBiquad::compute_notch(1000, 150, 75, 20, expected);
+    expect_coeffs_near(expected, notch.get_coefficients(0), 1.0e-5f);
+    // 3rd harmonic at 450Hz is above HNF_MAX_FREQ_RATIO
+    expect_coeffs_near(pass, notch.get_coefficients(1), 0);
+    expect_coeffs_near(pass, notch.get_coefficients(2), 0);
+
+    // moving back into range enables it again
+    notch.update(100);
+    SingleBiquad::compute_notch(1000, 300, 150, 20, expected);
+    expect_coeffs_near(expected, notch.get_coefficients(1), 1.0e-5f);
+}
+
+AP_GTEST_MAIN()
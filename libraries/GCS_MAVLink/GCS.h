@@ -370,6 +370,12 @@ private:
     char _perf_packet_name[16];
     char _perf_update_name[16];
 
+    // bytes read from the port but not parsed yet, when update() ran
+    // out of time in the middle of a block
+    uint8_t _rx_buf[64];
+    uint8_t _rx_buf_ofs;
+    uint8_t _rx_buf_len;
+
     // deferred message handling.  We size the deferred_message
     // ringbuffer so we can defer every message type
     enum ap_message deferred_messages[MSG_LAST];
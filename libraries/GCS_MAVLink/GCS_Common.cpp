@@ -44,7 +44,9 @@ uint32_t GCS_MAVLINK::reserve_param_space_start_ms;
 
 GCS *GCS::_singleton = nullptr;
 
-GCS_MAVLINK::GCS_MAVLINK()
+GCS_MAVLINK::GCS_MAVLINK() :
+    _rx_buf_ofs(0),
+    _rx_buf_len(0)
 {
     AP_Param::setup_object_defaults(this, var_info);
 }
@@ -867,23 +869,35 @@ GCS_MAVLINK::update(uint32_t max_time_us)
 
     status.packet_rx_drop_count = 0;
 
-    // process received bytes
-    uint16_t nbytes = comm_get_available(chan);
-    for (uint16_t i=0; i<nbytes; i++)
+    // process received bytes, reading them from the port in blocks
+    uint16_t nbytes = comm_get_available(chan) + (_rx_buf_len - _rx_buf_ofs);
+    uint16_t next_time_check = 100;
+    for (uint16_t i=0; i<nbytes; )
     {
-        uint8_t c = comm_receive_ch(chan);
+        if (_rx_buf_ofs == _rx_buf_len) {
+            _rx_buf_ofs = 0;
+            _rx_buf_len = comm_receive_buffer(chan, _rx_buf, MIN(nbytes - i, (uint16_t)sizeof(_rx_buf)));
+            if (_rx_buf_len == 0) {
+                break;
+            }
+        }
 
-        bool parsed_packet = false;
-        
-        // Try to get a new message
-        if (mavlink_parse_char(chan, c, &msg, &status)) {
+        // Try to get a new message, stopping at the next time check
+        uint16_t used;
+        const bool parsed_packet = comm_parse_buffer(chan, &_rx_buf[_rx_buf_ofs],
+                                                     MIN(_rx_buf_len - _rx_buf_ofs, next_time_check - i),
+                                                     used, &msg, &status);
+        _rx_buf_ofs += used;
+        i += used;
+
+        if (parsed_packet) {
             hal.util->perf_begin(_perf_packet);
             packetReceived(status, msg);
             hal.util->perf_end(_perf_packet);
-            parsed_packet = true;
         }
 
-        if (parsed_packet || i % 100 == 0) {
+        if (parsed_packet || i >= next_time_check) {
+            next_time_check = i + 100;
             // make sure we don't spend too much time parsing mavlink messages
             if (AP_HAL::micros() - tstart_us > max_time_us) {
                 break;
@@ -99,6 +99,76 @@ uint8_t comm_receive_ch(mavlink_channel_t chan)
     return (uint8_t)mavlink_comm_port[chan]->read();
 }
 
+/// Read up to len bytes from the nominated MAVLink channel
+///
+/// @param chan		Channel to receive on
+/// @param buf		Buffer for the bytes
+/// @param len		Size of the buffer
+/// @returns		Number of bytes read
+///
+uint16_t comm_receive_buffer(mavlink_channel_t chan, uint8_t *buf, uint16_t len)
+{
+    if (!valid_channel(chan)) {
+        return 0;
+    }
+
+    ssize_t ret = mavlink_comm_port[chan]->read(buf, len);
+    if (ret <= 0) {
+        return 0;
+    }
+    return (uint16_t)ret;
+}
+
+/// Find the first byte that can start a MAVLink1 or MAVLink2 frame
+///
+/// @param buf		Received bytes
+/// @param len		Number of bytes
+/// @returns		Number of bytes before it, len if there is none
+///
+uint16_t comm_find_stx(const uint8_t *buf, uint16_t len)
+{
+    const uint8_t *stx = (const uint8_t *)memchr(buf, MAVLINK_STX, len);
+    if (stx != nullptr) {
+        len = stx - buf;
+    }
+    stx = (const uint8_t *)memchr(buf, MAVLINK_STX_MAVLINK1, len);
+    if (stx != nullptr) {
+        len = stx - buf;
+    }
+    return len;
+}
+
+/// Parse received bytes up to the end of the first complete message
+///
+/// @param chan		Channel the bytes were received on
+/// @param buf		Received bytes
+/// @param len		Number of bytes
+/// @param used		Set to the number of bytes consumed
+/// @param msg		Receives the message
+/// @param status	Receives the parser status
+/// @returns		true if a message was completed
+///
+bool comm_parse_buffer(mavlink_channel_t chan, const uint8_t *buf, uint16_t len, uint16_t &used,
+                       mavlink_message_t *msg, mavlink_status_t *status)
+{
+    const mavlink_status_t *chan_status = mavlink_get_channel_status(chan);
+    used = 0;
+    while (used < len) {
+        // an idle parser ignores everything but the start of a frame,
+        // so skip straight to it
+        if (chan_status->parse_state <= MAVLINK_PARSE_STATE_IDLE) {
+            used += comm_find_stx(&buf[used], len - used);
+            if (used == len) {
+                break;
+            }
+        }
+        if (mavlink_parse_char(chan, buf[used++], msg, status)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /// Check for available transmit space on the nominated MAVLink channel
 ///
 /// @param chan		Channel to check
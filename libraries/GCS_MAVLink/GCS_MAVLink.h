@@ -67,6 +67,38 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len);
 ///
 uint8_t comm_receive_ch(mavlink_channel_t chan);
 
+/// Read up to len bytes from the nominated MAVLink channel
+///
+/// @param chan		Channel to receive on
+/// @param buf		Buffer for the bytes
+/// @param len		Size of the buffer
+/// @returns		Number of bytes read
+///
+uint16_t comm_receive_buffer(mavlink_channel_t chan, uint8_t *buf, uint16_t len);
+
+/// Find the first byte that can start a MAVLink1 or MAVLink2 frame
+///
+/// @param buf		Received bytes
+/// @param len		Number of bytes
+/// @returns		Number of bytes before it, len if there is none
+///
+uint16_t comm_find_stx(const uint8_t *buf, uint16_t len);
+
+/// Parse received bytes up to the end of the first complete message. While
+/// the channel's parser is between frames, bytes that cannot start a frame
+/// are skipped without being passed to it
+///
+/// @param chan		Channel the bytes were received on
+/// @param buf		Received bytes
+/// @param len		Number of bytes
+/// @param used		Set to the number of bytes consumed
+/// @param msg		Receives the message
+/// @param status	Receives the parser status
+/// @returns		true if a message was completed
+///
+bool comm_parse_buffer(mavlink_channel_t chan, const uint8_t *buf, uint16_t len, uint16_t &used,
+                       mavlink_message_t *msg, mavlink_status_t *status);
+
 /// Check for available data on the nominated MAVLink channel
 ///
 /// @param chan		Channel to check
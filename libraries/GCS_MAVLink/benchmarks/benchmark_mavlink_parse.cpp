@@ -0,0 +1,86 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <GCS_MAVLink/GCS_MAVLink.h>
+#include <GCS_MAVLink/tests/mavlink_stream.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  a telemetry stream of 2000 frames. With noise, a quarter of the frames
+  are preceded by up to 31 bytes of noise and one frame in ten is damaged
+ */
+static std::vector<uint8_t> make_stream(bool noise)
+{
+    srand(0);
+    MAVLinkStream stream(MAVLINK_COMM_2);
+    if (noise) {
+        stream.add_frames(2000, 10);
+    } else {
+        for (uint32_t i = 0; i < 2000; i++) {
+            stream.add_frame(i, false);
+        }
+    }
+    return stream.bytes;
+}
+
+/*
+  every byte passed to mavlink_parse_char()
+ */
+static void BM_MAVLinkParseByte(benchmark::State &state, const std::vector<uint8_t> &bytes)
+{
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    uint32_t count = 0;
+
+    while (state.KeepRunning()) {
+        for (uint8_t c : bytes) {
+            count += mavlink_parse_char(MAVLINK_COMM_0, c, &msg, &status);
+        }
+        gbenchmark_escape(&msg);
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+    state.SetItemsProcessed(count);
+}
+
+/*
+  blocks of 64 bytes passed to comm_parse_buffer(), as
+  GCS_MAVLINK::update() reads them
+ */
+static void BM_MAVLinkParseBuffer(benchmark::State &state, const std::vector<uint8_t> &bytes)
+{
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    uint32_t count = 0;
+
+    while (state.KeepRunning()) {
+        for (size_t ofs = 0; ofs < bytes.size(); ) {
+            uint16_t used;
+            count += comm_parse_buffer(MAVLINK_COMM_1, &bytes[ofs], MIN(bytes.size() - ofs, (size_t)64), used, &msg, &status);
+            ofs += used;
+        }
+        gbenchmark_escape(&msg);
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+    state.SetItemsProcessed(count);
+}
+
+BENCHMARK_CAPTURE(BM_MAVLinkParseByte, clean, make_stream(false));
+BENCHMARK_CAPTURE(BM_MAVLinkParseBuffer, clean, make_stream(false));
+BENCHMARK_CAPTURE(BM_MAVLinkParseByte, noisy, make_stream(true));
+BENCHMARK_CAPTURE(BM_MAVLinkParseBuffer, noisy, make_stream(true));
+
+BENCHMARK_MAIN()
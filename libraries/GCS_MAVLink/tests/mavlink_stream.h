@@ -0,0 +1,134 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Generate streams of MAVLink1 and MAVLink2 frames, optionally damaged
+ * and mixed with line noise, as a telemetry port would receive them.
+ * Used to replay the same input through the unit tests and benchmarks.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+class MAVLinkStream {
+public:
+    // channel is only used to number and frame the generated messages
+    MAVLinkStream(mavlink_channel_t chan) :
+        _chan(chan)
+    {}
+
+    /*
+      append one frame of a message chosen by n, in MAVLink1 or MAVLink2
+     */
+    void add_frame(uint32_t n, bool mavlink1)
+    {
+        mavlink_status_t *status = mavlink_get_channel_status(_chan);
+        if (mavlink1) {
+            status->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        } else {
+            status->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
+
+        mavlink_message_t msg;
+        switch (n % 3) {
+        case 0:
+            mavlink_msg_heartbeat_pack_chan(1, 1, _chan, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA,
+                                            MAV_MODE_FLAG_CUSTOM_MODE_ENABLED, n, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+            mavlink_msg_system_time_pack_chan(1, 1, _chan, &msg, 1500000000000000ULL + n, n);
+            break;
+        default:
+            mavlink_msg_statustext_pack_chan(1, 1, _chan, &msg, MAV_SEVERITY_INFO, "MAVLink stream test");
+            break;
+        }
+
+        uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
+        bytes.insert(bytes.end(), buf, buf + len);
+    }
+
+    /*
+      append len bytes of line noise, including frame start bytes
+     */
+    void add_noise(uint16_t len)
+    {
+        for (uint16_t i = 0; i < len; i++) {
+            switch (rand() % 8) {
+            case 0:
+                bytes.push_back(MAVLINK_STX);
+                break;
+            case 1:
+                bytes.push_back(MAVLINK_STX_MAVLINK1);
+                break;
+            default:
+                bytes.push_back(rand() & 0xFF);
+                break;
+            }
+        }
+    }
+
+    /*
+      damage the last len bytes appended: flip bits, drop the tail of the
+      frame or repeat bytes
+     */
+    void damage(uint16_t len)
+    {
+        if (len == 0 || len > bytes.size()) {
+            return;
+        }
+        const size_t start = bytes.size() - len;
+        switch (rand() % 3) {
+        case 0:
+            bytes[start + rand() % len] ^= 1U << (rand() % 8);
+            break;
+        case 1:
+            bytes.resize(start + rand() % len);
+            break;
+        default: {
+            const size_t pos = start + rand() % len;
+            bytes.insert(bytes.begin() + pos, bytes[pos]);
+            break;
+        }
+        }
+    }
+
+    /*
+      append count frames with noise between some of them, damaging one
+      frame in every damage_one_in, or none if damage_one_in is zero
+     */
+    void add_frames(uint32_t count, uint8_t damage_one_in)
+    {
+        for (uint32_t i = 0; i < count; i++) {
+            if (rand() % 4 == 0) {
+                add_noise(rand() % 32);
+            }
+            const size_t before = bytes.size();
+            add_frame(i, rand() % 4 == 0);
+            if (damage_one_in != 0 && rand() % damage_one_in == 0) {
+                damage(bytes.size() - before);
+            }
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+
+private:
+    mavlink_channel_t _chan;
+};
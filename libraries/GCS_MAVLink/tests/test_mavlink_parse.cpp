@@ -0,0 +1,116 @@
+#include <AP_gtest.h>
+
+#include <GCS_MAVLink/GCS_MAVLink.h>
+#include <GCS_MAVLink/tests/mavlink_stream.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+struct ParsedMessage {
+    mavlink_message_t msg;
+    uint8_t drop_count;
+};
+
+// start parsing on a channel from scratch, so tests can reuse channels
+static void reset_channel(mavlink_channel_t chan)
+{
+    memset(mavlink_get_channel_status(chan), 0, sizeof(mavlink_status_t));
+}
+
+// feed every byte to mavlink_parse_char(), as GCS_MAVLINK::update() used to
+static std::vector<ParsedMessage> parse_bytes(mavlink_channel_t chan, const std::vector<uint8_t> &bytes)
+{
+    reset_channel(chan);
+    std::vector<ParsedMessage> parsed;
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    for (uint8_t c : bytes) {
+        if (mavlink_parse_char(chan, c, &msg, &status)) {
+            parsed.push_back({msg, status.packet_rx_drop_count});
+        }
+    }
+    return parsed;
+}
+
+// feed blocks of random size to comm_parse_buffer()
+static std::vector<ParsedMessage> parse_blocks(mavlink_channel_t chan, const std::vector<uint8_t> &bytes)
+{
+    reset_channel(chan);
+    std::vector<ParsedMessage> parsed;
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    size_t ofs = 0;
+    while (ofs < bytes.size()) {
+        uint16_t len = MIN((size_t)(1 + rand() % 64), bytes.size() - ofs);
+        while (len > 0) {
+            uint16_t used;
+            if (comm_parse_buffer(chan, &bytes[ofs], len, used, &msg, &status)) {
+                parsed.push_back({msg, status.packet_rx_drop_count});
+            }
+            ofs += used;
+            len -= used;
+        }
+    }
+    return parsed;
+}
+
+static void expect_same(const std::vector<ParsedMessage> &expected, const std::vector<ParsedMessage> &parsed)
+{
+    ASSERT_EQ(expected.size(), parsed.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        const mavlink_message_t &a = expected[i].msg;
+        const mavlink_message_t &b = parsed[i].msg;
+        EXPECT_EQ(expected[i].drop_count, parsed[i].drop_count) << "message " << i;
+        EXPECT_EQ(a.magic, b.magic) << "message " << i;
+        EXPECT_EQ((uint32_t)a.msgid, (uint32_t)b.msgid) << "message " << i;
+        EXPECT_EQ(a.seq, b.seq) << "message " << i;
+        EXPECT_EQ(a.len, b.len) << "message " << i;
+        EXPECT_EQ(a.checksum, b.checksum) << "message " << i;
+        EXPECT_EQ(0, memcmp(_MAV_PAYLOAD(&a), _MAV_PAYLOAD(&b), a.len)) << "message " << i;
+    }
+}
+
+static void expect_same_status(mavlink_channel_t expected_chan, mavlink_channel_t chan)
+{
+    const mavlink_status_t *a = mavlink_get_channel_status(expected_chan);
+    const mavlink_status_t *b = mavlink_get_channel_status(chan);
+    EXPECT_EQ(a->parse_state, b->parse_state);
+    EXPECT_EQ(a->packet_idx, b->packet_idx);
+    EXPECT_EQ(a->packet_rx_success_count, b->packet_rx_success_count);
+    EXPECT_EQ(a->packet_rx_drop_count, b->packet_rx_drop_count);
+    EXPECT_EQ(a->current_rx_seq, b->current_rx_seq);
+}
+
+// every frame of a clean stream is received
+TEST(MAVLinkParseTest, clean_frames)
+{
+    srand(0);
+    MAVLinkStream stream(MAVLINK_COMM_2);
+    for (uint32_t i = 0; i < 1000; i++) {
+        stream.add_frame(i, rand() % 4 == 0);
+    }
+
+    const std::vector<ParsedMessage> expected = parse_bytes(MAVLINK_COMM_0, stream.bytes);
+    const std::vector<ParsedMessage> parsed = parse_blocks(MAVLINK_COMM_1, stream.bytes);
+    EXPECT_EQ(1000U, expected.size());
+    expect_same(expected, parsed);
+    expect_same_status(MAVLINK_COMM_0, MAVLINK_COMM_1);
+}
+
+// noise and damaged, truncated and repeated frames give the same
+// messages and parser state as parsing byte by byte
+TEST(MAVLinkParseTest, malformed_input)
+{
+    srand(1);
+    for (uint8_t run = 0; run < 20; run++) {
+        MAVLinkStream stream(MAVLINK_COMM_2);
+        stream.add_frames(500, 3);
+        stream.add_noise(200);
+
+        const std::vector<ParsedMessage> expected = parse_bytes(MAVLINK_COMM_0, stream.bytes);
+        const std::vector<ParsedMessage> parsed = parse_blocks(MAVLINK_COMM_1, stream.bytes);
+        expect_same(expected, parsed);
+        expect_same_status(MAVLINK_COMM_0, MAVLINK_COMM_1);
+    }
+}
+
+AP_GTEST_MAIN()
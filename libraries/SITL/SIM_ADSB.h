@@ -51,8 +51,8 @@ private:
     const uint16_t target_port = 5762;
 
     Location home;
-    uint8_t num_vehicles = 0;
-    static const uint8_t num_vehicles_MAX = 200;
+    uint16_t num_vehicles = 0;
+    static const uint16_t num_vehicles_MAX = 500;
     ADSB_Vehicle vehicles[num_vehicles_MAX];
     
     // reporting period in ms
@@ -22,6 +22,7 @@
 
 #include "SITL.h"
 #include <AP_Terrain/AP_Terrain.h>
+#include <AP_Declination/AP_Declination.h>
 
 
 namespace SITL {
@@ -148,6 +149,7 @@ protected:
     float turbulence_vertical_speed = 0.0f;    // m/s
 
     Vector3f mag_bf;  // local earth magnetic field vector in Gauss, earth frame
+    AP_Declination::cell_cache mag_cell_cache; // field table cell used by update_mag_field_bf()
 
     uint64_t time_now_us;
 
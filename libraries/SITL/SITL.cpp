@@ -109,6 +109,16 @@ const AP_Param::GroupInfo SITL::var_info2[] = {
     AP_GROUPINFO("GPS_ALT_OFS",  8, SITL,  gps_alt_offset, 0),
     AP_GROUPINFO("ARSPD_SIGN",   9, SITL,  arspd_signflip, 0),
     AP_GROUPINFO("WIND_DIR_Z",  10, SITL,  wind_dir_z,     0),
+    // @Param: VIB_FREQ
+    // @DisplayName: Motor vibration frequency
+    // @Description: Frequency of simulated motor vibration on the gyros at full throttle, scaled by the square root of throttle
+    // @Units: Hz
+    AP_GROUPINFO("VIB_FREQ",    11, SITL,  vibe_freq,      0),
+    // @Param: VIB_AMP
+    // @DisplayName: Motor vibration amplitude
+    // @Description: Amplitude of simulated motor vibration on the gyros when the motors are on and SIM_VIB_FREQ is set
+    // @Units: deg/s
+    AP_GROUPINFO("VIB_AMP",     12, SITL,  vibe_amp,       0),
     AP_GROUPEND
 };
     
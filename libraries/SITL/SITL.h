@@ -64,6 +64,9 @@ public:
     // true when motors are active
     bool motors_on;
 
+    // average motor throttle from 0 to 1
+    float throttle;
+
     // height above ground
     float height_agl;
     
@@ -75,6 +78,8 @@ public:
     AP_Float baro_drift;  // in metres per second
     AP_Float baro_glitch; // glitch in meters
     AP_Float gyro_noise;  // in degrees/second
+    AP_Float vibe_freq;   // frequency of motor vibration at full throttle, in Hz
+    AP_Float vibe_amp;    // amplitude of motor vibration, in degrees/second
     AP_Vector3f gyro_scale;  // percentage
     AP_Float accel_noise; // in m/s/s
     AP_Float accel2_noise; // in m/s/s
@@ -20,6 +20,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Vehicle/AP_Vehicle.h>
+#include <AP_Scheduler/LatencyTrace.h>
 #include "SRV_Channel.h"
 
 extern const AP_HAL::HAL& hal;
@@ -204,6 +205,7 @@ void SRV_Channels::cork()
 void SRV_Channels::push()
 {
     hal.rcout->push();
+    AP::LatencyTrace::record(AP::LatencyTrace::STAGE_OUTPUT);
 
     // give volz library a chance to update
     volz_ptr->update();